@@ -3,9 +3,9 @@ OBJ_DIR := obj
 
 ASSEMBLY := engine
 EXTENSION := .so
-COMPILER_FLAGS := -g -fdeclspec -Werror=vla  -fPIC -std=c++17
+COMPILER_FLAGS := -g -fdeclspec -Werror=vla  -fPIC -std=c++20 -pthread
 INCLUDE_FLAGS := -Iengine/src -I$(VULKAN_SDK)/include
-LINKER_FLAGS := -g -shared -lvulkan  -lX11  -L$(VULKAN_SDK)/lib 
+LINKER_FLAGS := -g -shared -pthread -lvulkan  -lX11  -L$(VULKAN_SDK)/lib 
 DEFINES := -D_QDEBUG -DQEXPORT
 
 
@@ -0,0 +1,43 @@
+BUILD_DIR := bin
+OBJ_DIR := obj
+
+ASSEMBLY := qlog_decode
+SOURCE_DIR := tools/qlog_decode
+EXTENSION := 
+COMPILER_FLAGS := -g -Werror=vla -std=c++20
+INCLUDE_FLAGS := -Iengine/src
+LINKER_FLAGS := 
+DEFINES := -D_DEBUG
+
+# Only needs core/qlog_binary.hh from the engine, so it does not link against it
+
+SRC_FILES := $(shell find $(SOURCE_DIR) -name *.cc)		# .c files
+DIRECTORIES := $(shell find $(SOURCE_DIR) -type d)		# directories with .h files
+OBJ_FILES := $(SRC_FILES:%=$(OBJ_DIR)/%.o)		# compiled .o objects
+
+all: scaffold compile link
+
+.PHONY: scaffold
+scaffold: # create build directory
+	@echo Scaffolding folder structure...
+	@mkdir -p $(BUILD_DIR)
+	@mkdir -p $(addprefix $(OBJ_DIR)/,$(DIRECTORIES))
+	@echo Done.
+
+.PHONY: link
+link: scaffold $(OBJ_FILES) # link
+	@echo Linking $(ASSEMBLY)...
+	clang++ $(OBJ_FILES) -o $(BUILD_DIR)/$(ASSEMBLY)$(EXTENSION) $(LINKER_FLAGS)
+
+.PHONY: compile
+compile: #compile .c files
+	@echo Compiling...
+
+.PHONY: clean
+clean: # clean build directory
+	rm -rf $(BUILD_DIR)/$(ASSEMBLY)
+	rm -rf $(OBJ_DIR)/$(SOURCE_DIR)
+
+$(OBJ_DIR)/%.cc.o: %.cc # compile .c to .o object
+	@echo   $<...
+	@clang++ $< $(COMPILER_FLAGS) -c -o $@ $(DEFINES) $(INCLUDE_FLAGS)
@@ -3,9 +3,9 @@ OBJ_DIR := obj
 
 ASSEMBLY := testbed
 EXTENSION := 
-COMPILER_FLAGS := -g -fdeclspec -Werror=vla -fPIC -std=c++17
+COMPILER_FLAGS := -g -fdeclspec -Werror=vla -fPIC -std=c++20 -pthread
 INCLUDE_FLAGS := -Iengine/src -I$(VULKAN_SDK)\include -Iengine
-LINKER_FLAGS := -L./$(BUILD_DIR)/ -lengine -Wl,-rpath,./bin/
+LINKER_FLAGS := -L./$(BUILD_DIR)/ -lengine -pthread -Wl,-rpath,./bin/
 DEFINES := -D_DEBUG -DQIMPORT
 
 # Make does not offer a recursive wildcard function, so here's one:
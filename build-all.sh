@@ -18,5 +18,20 @@ then
     echo "Error: $ERRORLEVEL" && exit
 fi
 
+# Tools
+make -f "Makefile.qlog_decode.linux.mak" all
+errorlevel=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+    echo "Error: $ERRORLEVEL" && exit
+fi
+
+make -f "Makefile.qpack.linux.mak" all
+errorlevel=$?
+if [ $ERRORLEVEL -ne 0 ]
+then
+    echo "Error: $ERRORLEVEL" && exit
+fi
+
 echo "All assemblies built successfully"
 
@@ -5,3 +5,7 @@ make -f "Makefile.engine.linux.mak" clean
 
 # Testbed
 make -f "Makefile.testbed.linux.mak" clean
+
+# Tools
+make -f "Makefile.qlog_decode.linux.mak" clean
+make -f "Makefile.qpack.linux.mak" clean
@@ -0,0 +1,65 @@
+#pragma once
+#include "defines.hh"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * qhash.hh
+ *
+ * Hash functions used by the engine containers. HashMap splits the hash into a group index
+ * and a 7 bit tag stored in the control bytes, so every bit of the result has to be well mixed.
+*/
+
+// Final avalanche step from MurmurHash3
+inline uint64_t
+qhash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+// Hash an arbitrary run of bytes, 8 bytes at a time
+inline uint64_t
+qhash_bytes(const void* data, uint64_t length, uint64_t seed = 0) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = seed ^ (length * 0x9E3779B97F4A7C15ull);
+
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, bytes, 8);
+        h ^= word * 0x87C37B91114253D5ull;
+        h = ((h << 27) | (h >> 37)) * 0x4CF5AD432745937Full;
+        bytes += 8;
+        length -= 8;
+    }
+
+    uint64_t tail = 0;
+    memcpy(&tail, bytes, length);
+    h ^= tail;
+    return qhash_mix(h);
+}
+
+// Default hash. Integers, enums and pointers are mixed directly, strings hash their bytes.
+// Specialize for other key types
+template <typename T, typename Enable = void>
+struct QHash;
+
+template <typename T>
+struct QHash<T, typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type> {
+    uint64_t operator()(T value) const { return qhash_mix(static_cast<uint64_t>(value)); }
+};
+
+template <typename T>
+struct QHash<T*, void> {
+    uint64_t operator()(const T* value) const { return qhash_mix(reinterpret_cast<uintptr_t>(value)); }
+};
+
+template <>
+struct QHash<std::string, void> {
+    uint64_t operator()(const std::string& value) const { return qhash_bytes(value.data(), value.size()); }
+};
@@ -0,0 +1,508 @@
+#pragma once
+#include "defines.hh"
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "core/qlogger.hh"
+#include "core/qmemory.hh"
+#include "memory/qcontainer_allocator.hh"
+#include "containers/qhash.hh"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QHASHMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/**
+ * Open addressing hash map (Swiss table layout)
+ *
+ * Every slot has a control byte: empty, deleted, or the low 7 bits of the key's hash.
+ * Control bytes are scanned 16 at a time, so a lookup compares one SSE register of tags
+ * and only touches the keys whose tag matches. Keys and values live inline in one slot
+ * array next to the control bytes, in a single allocation from a QContainerAllocator.
+ *
+ * Pointers returned by find/insert are invalidated when the map grows.
+ *
+ * An arena or pool allocator can run out. Growing then logs an error and keeps the old table:
+ * insert and reserve return false, set drops the value and operator[] returns a scratch value.
+ *
+ * insert, set and reserve pass their caller's file and line down to the allocation tracker.
+ * operator[] cannot take them, so its growth is credited to this file
+*/
+
+namespace qhashmap_detail {
+    static constexpr int8_t ctrl_empty = -128;  // 0b10000000
+    static constexpr int8_t ctrl_deleted = -2;  // 0b11111110
+    static constexpr uint64_t group_width = 16;
+
+    // Bitmask of matching positions in a group of 16 control bytes
+    struct group {
+#ifdef QHASHMAP_SSE2
+        __m128i ctrl;
+
+        explicit group(const int8_t* pos) : ctrl(_mm_load_si128(reinterpret_cast<const __m128i*>(pos))) {}
+
+        uint32_t match(int8_t tag) const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), ctrl)));
+        }
+
+        uint32_t match_empty() const { return match(ctrl_empty); }
+
+        // Empty and deleted both have the top bit set
+        uint32_t match_empty_or_deleted() const {
+            return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+        }
+#else
+        const int8_t* ctrl;
+
+        explicit group(const int8_t* pos) : ctrl(pos) {}
+
+        uint32_t match(int8_t tag) const {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < group_width; i++) {
+                mask |= static_cast<uint32_t>(ctrl[i] == tag) << i;
+            }
+            return mask;
+        }
+
+        uint32_t match_empty() const { return match(ctrl_empty); }
+
+        uint32_t match_empty_or_deleted() const {
+            uint32_t mask = 0;
+            for (uint32_t i = 0; i < group_width; i++) {
+                mask |= static_cast<uint32_t>(ctrl[i] < 0) << i;
+            }
+            return mask;
+        }
+#endif
+    };
+
+    inline uint32_t
+    lowest_bit(uint32_t mask) {
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+    }
+}
+
+template <typename K, typename V, typename H = QHash<K>>
+class QAPI HashMap {
+public:
+    HashMap();
+    HashMap(memory_tag tag);
+    HashMap(memory_tag tag, qmemory::QContainerAllocator allocator);
+    HashMap(HashMap&& other) noexcept;
+    HashMap(const HashMap&) = delete;
+    ~HashMap();
+
+    HashMap& operator= (HashMap&& other) noexcept;
+    HashMap& operator= (const HashMap&) = delete;
+
+    /**
+     * @brief Add key -> value if key is not in the map yet
+     * @returns true if it was added, false if the key already existed (its value is left alone)
+     *     or the map could not grow
+    */
+    bool insert(const K& key, const V& value, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+
+    /**
+     * @brief Add key -> value, replacing the value if the key already exists.
+     *     Nothing is added if the map could not grow
+    */
+    void set(const K& key, V value, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+
+    /**
+     * @brief Value for key, default constructed and inserted if missing.
+     *     If the map could not grow this is a scratch value that is not in the map
+    */
+    V& operator[] (const K& key);
+
+    // nullptr if the key is not in the map
+    V* find(const K& key);
+    const V* find(const K& key) const;
+    bool contains(const K& key) const;
+
+    // returns false if the key was not in the map
+    bool remove(const K& key);
+
+    // Make room for count entries without growing again. false if the allocator ran out
+    bool reserve(uint64_t count, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+    void clear();
+
+    uint64_t size() const { return m_size; }
+    uint64_t capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+    memory_tag tag() const { return m_tag; }
+    qmemory::QContainerAllocator allocator() const { return m_allocator; }
+
+    /**
+     * @brief Call func(key, value) for every entry, in slot order
+    */
+    template <typename F> void for_each(F&& func) const {
+        for (uint64_t i = 0; i < m_capacity; i++) {
+            if (m_ctrl[i] >= 0) {
+                func(static_cast<const K&>(m_slots[i].key), m_slots[i].value);
+            }
+        }
+    }
+
+private:
+    struct slot {
+        K key;
+        V value;
+    };
+
+    static constexpr uint64_t npos = ~uint64_t(0);
+    static constexpr uint64_t slot_alignment = alignof(slot) > 16 ? alignof(slot) : 16;
+
+    static uint64_t max_load(uint64_t capacity) { return capacity - capacity / 8; }
+    static uint64_t ctrl_bytes(uint64_t capacity) {
+        return (capacity + slot_alignment - 1) & ~(slot_alignment - 1);
+    }
+    static uint64_t allocation_size(uint64_t capacity) { return ctrl_bytes(capacity) + capacity * sizeof(slot); }
+
+    uint64_t find_index(const K& key, uint64_t hash) const;
+    uint64_t find_insert_slot(uint64_t hash) const;
+    template <typename... Args> slot* insert_new(const char* file, uint32_t line, const K& key, uint64_t hash, Args&&... args);
+    bool rehash(uint64_t new_capacity, const char* file, uint32_t line);
+    void release();
+
+    int8_t* m_ctrl;
+    slot* m_slots;
+    uint64_t m_capacity;    // 0 or a power of two >= 16
+    uint64_t m_size;
+    uint64_t m_growth_left; // inserts into empty slots left before a rehash
+    memory_tag m_tag;
+    qmemory::QContainerAllocator m_allocator;
+    H m_hash;
+};
+
+//
+// Constructors
+//
+template <typename K, typename V, typename H>
+HashMap<K, V, H>::HashMap()
+    : m_ctrl(nullptr),
+    m_slots(nullptr),
+    m_capacity(0),
+    m_size(0),
+    m_growth_left(0),
+    m_tag(MEMORY_TAG_DICT),
+    m_allocator(qmemory::QContainerAllocator::Default())
+{
+
+}
+
+template <typename K, typename V, typename H>
+HashMap<K, V, H>::HashMap(memory_tag tag)
+    : m_ctrl(nullptr),
+    m_slots(nullptr),
+    m_capacity(0),
+    m_size(0),
+    m_growth_left(0),
+    m_tag(tag),
+    m_allocator(qmemory::QContainerAllocator::Default())
+{
+
+}
+
+template <typename K, typename V, typename H>
+HashMap<K, V, H>::HashMap(memory_tag tag, qmemory::QContainerAllocator allocator)
+    : m_ctrl(nullptr),
+    m_slots(nullptr),
+    m_capacity(0),
+    m_size(0),
+    m_growth_left(0),
+    m_tag(tag),
+    m_allocator(allocator)
+{
+
+}
+
+template <typename K, typename V, typename H>
+HashMap<K, V, H>::HashMap(HashMap&& other) noexcept
+    : m_ctrl(other.m_ctrl),
+    m_slots(other.m_slots),
+    m_capacity(other.m_capacity),
+    m_size(other.m_size),
+    m_growth_left(other.m_growth_left),
+    m_tag(other.m_tag),
+    m_allocator(other.m_allocator),
+    m_hash(other.m_hash)
+{
+    other.m_ctrl = nullptr;
+    other.m_slots = nullptr;
+    other.m_capacity = 0;
+    other.m_size = 0;
+    other.m_growth_left = 0;
+}
+
+template <typename K, typename V, typename H>
+HashMap<K, V, H>::~HashMap() {
+    release();
+}
+
+template <typename K, typename V, typename H> HashMap<K, V, H>&
+HashMap<K, V, H>::operator= (HashMap&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    release();
+    m_ctrl = other.m_ctrl;
+    m_slots = other.m_slots;
+    m_capacity = other.m_capacity;
+    m_size = other.m_size;
+    m_growth_left = other.m_growth_left;
+    m_tag = other.m_tag;
+    m_allocator = other.m_allocator;
+    m_hash = other.m_hash;
+
+    other.m_ctrl = nullptr;
+    other.m_slots = nullptr;
+    other.m_capacity = 0;
+    other.m_size = 0;
+    other.m_growth_left = 0;
+    return *this;
+}
+
+//
+// Probing
+//
+
+// Groups are visited in triangular steps (+1, +2, +3...), which covers every group
+// of a power of two sized table. A group with an empty slot ends the search
+template <typename K, typename V, typename H> uint64_t
+HashMap<K, V, H>::find_index(const K& key, uint64_t hash) const {
+    if (m_capacity == 0) {
+        return npos;
+    }
+
+    const int8_t tag = static_cast<int8_t>(hash & 0x7F);
+    const uint64_t group_mask = m_capacity / qhashmap_detail::group_width - 1;
+    uint64_t group_index = (hash >> 7) & group_mask;
+
+    for (uint64_t step = 1; ; step++) {
+        const uint64_t base = group_index * qhashmap_detail::group_width;
+        qhashmap_detail::group g(m_ctrl + base);
+
+        for (uint32_t match = g.match(tag); match; match &= match - 1) {
+            uint64_t index = base + qhashmap_detail::lowest_bit(match);
+            if (m_slots[index].key == key) {
+                return index;
+            }
+        }
+
+        if (g.match_empty()) {
+            return npos;
+        }
+        group_index = (group_index + step) & group_mask;
+    }
+}
+
+template <typename K, typename V, typename H> uint64_t
+HashMap<K, V, H>::find_insert_slot(uint64_t hash) const {
+    const uint64_t group_mask = m_capacity / qhashmap_detail::group_width - 1;
+    uint64_t group_index = (hash >> 7) & group_mask;
+
+    for (uint64_t step = 1; ; step++) {
+        const uint64_t base = group_index * qhashmap_detail::group_width;
+        uint32_t free_slots = qhashmap_detail::group(m_ctrl + base).match_empty_or_deleted();
+        if (free_slots) {
+            return base + qhashmap_detail::lowest_bit(free_slots);
+        }
+        group_index = (group_index + step) & group_mask;
+    }
+}
+
+// Key is known not to be in the map. nullptr if the table was full and could not grow
+template <typename K, typename V, typename H> template <typename... Args> typename HashMap<K, V, H>::slot*
+HashMap<K, V, H>::insert_new(const char* file, uint32_t line, const K& key, uint64_t hash, Args&&... args) {
+    if (m_growth_left == 0) {
+        // Mostly tombstones: rehash in place. Otherwise double
+        uint64_t new_capacity = m_capacity == 0 ? qhashmap_detail::group_width : m_capacity * 2;
+        if (m_capacity && m_size * 2 < max_load(m_capacity)) {
+            new_capacity = m_capacity;
+        }
+        if (!rehash(new_capacity, file, line)) {
+            return nullptr;
+        }
+    }
+
+    uint64_t index = find_insert_slot(hash);
+    if (m_ctrl[index] == qhashmap_detail::ctrl_empty) {
+        m_growth_left--;
+    }
+    m_ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+
+    slot& s = m_slots[index];
+    new (&s.key) K(key);
+    new (&s.value) V(std::forward<Args>(args)...);
+    m_size++;
+    return &s;
+}
+
+//
+// Methods
+//
+template <typename K, typename V, typename H> bool
+HashMap<K, V, H>::insert(const K& key, const V& value, const char* file, uint32_t line) {
+    uint64_t hash = m_hash(key);
+    if (find_index(key, hash) != npos) {
+        return false;
+    }
+
+    return insert_new(file, line, key, hash, value) != nullptr;
+}
+
+template <typename K, typename V, typename H> void
+HashMap<K, V, H>::set(const K& key, V value, const char* file, uint32_t line) {
+    uint64_t hash = m_hash(key);
+    uint64_t index = find_index(key, hash);
+    if (index != npos) {
+        m_slots[index].value = std::move(value);
+        return;
+    }
+
+    insert_new(file, line, key, hash, std::move(value));
+}
+
+template <typename K, typename V, typename H> V&
+HashMap<K, V, H>::operator[] (const K& key) {
+    uint64_t hash = m_hash(key);
+    uint64_t index = find_index(key, hash);
+    if (index != npos) {
+        return m_slots[index].value;
+    }
+
+    slot* s = insert_new(Q_CALLER_FILE, Q_CALLER_LINE, key, hash);
+    if (!s) {
+        // Nowhere to put it. The caller gets a fresh value to write to, and the write is lost
+        static thread_local V discarded;
+        discarded.~V();
+        new (&discarded) V();
+        return discarded;
+    }
+    return s->value;
+}
+
+template <typename K, typename V, typename H> V*
+HashMap<K, V, H>::find(const K& key) {
+    uint64_t index = find_index(key, m_hash(key));
+    return index == npos ? nullptr : &m_slots[index].value;
+}
+
+template <typename K, typename V, typename H> const V*
+HashMap<K, V, H>::find(const K& key) const {
+    uint64_t index = find_index(key, m_hash(key));
+    return index == npos ? nullptr : &m_slots[index].value;
+}
+
+template <typename K, typename V, typename H> bool
+HashMap<K, V, H>::contains(const K& key) const {
+    return find_index(key, m_hash(key)) != npos;
+}
+
+template <typename K, typename V, typename H> bool
+HashMap<K, V, H>::remove(const K& key) {
+    uint64_t index = find_index(key, m_hash(key));
+    if (index == npos) {
+        return false;
+    }
+
+    m_slots[index].key.~K();
+    m_slots[index].value.~V();
+    m_size--;
+
+    // If the group still has an empty slot no probe ever continued past it,
+    // so the slot can go straight back to empty instead of becoming a tombstone
+    uint64_t base = index & ~(qhashmap_detail::group_width - 1);
+    if (qhashmap_detail::group(m_ctrl + base).match_empty()) {
+        m_ctrl[index] = qhashmap_detail::ctrl_empty;
+        m_growth_left++;
+    } else {
+        m_ctrl[index] = qhashmap_detail::ctrl_deleted;
+    }
+    return true;
+}
+
+template <typename K, typename V, typename H> bool
+HashMap<K, V, H>::reserve(uint64_t count, const char* file, uint32_t line) {
+    uint64_t capacity = m_capacity ? m_capacity : qhashmap_detail::group_width;
+    while (max_load(capacity) < count) {
+        capacity *= 2;
+    }
+
+    if (capacity > m_capacity) {
+        return rehash(capacity, file, line);
+    }
+    return true;
+}
+
+template <typename K, typename V, typename H> void
+HashMap<K, V, H>::clear() {
+    if (m_capacity == 0) {
+        return;
+    }
+
+    if (!std::is_trivially_destructible<K>::value || !std::is_trivially_destructible<V>::value) {
+        for (uint64_t i = 0; i < m_capacity; i++) {
+            if (m_ctrl[i] >= 0) {
+                m_slots[i].key.~K();
+                m_slots[i].value.~V();
+            }
+        }
+    }
+
+    QAllocator::Set(m_ctrl, qhashmap_detail::ctrl_empty, m_capacity);
+    m_size = 0;
+    m_growth_left = max_load(m_capacity);
+}
+
+// Move every entry into a fresh table of new_capacity slots. The old table stays if the allocator runs out
+template <typename K, typename V, typename H> bool
+HashMap<K, V, H>::rehash(uint64_t new_capacity, const char* file, uint32_t line) {
+    uint8_t* block = static_cast<uint8_t*>(m_allocator.Allocate(allocation_size(new_capacity), slot_alignment, m_tag, file, line));
+    if (!block) {
+        qlogger::Error("HashMap: out of memory growing to %llu slots of %llu bytes", new_capacity, (uint64_t)sizeof(slot));
+        return false;
+    }
+
+    int8_t* old_ctrl = m_ctrl;
+    slot* old_slots = m_slots;
+    uint64_t old_capacity = m_capacity;
+    m_ctrl = reinterpret_cast<int8_t*>(block);
+    m_slots = reinterpret_cast<slot*>(block + ctrl_bytes(new_capacity));
+    m_capacity = new_capacity;
+    m_growth_left = max_load(new_capacity) - m_size;
+    QAllocator::Set(m_ctrl, qhashmap_detail::ctrl_empty, new_capacity);
+
+    for (uint64_t i = 0; i < old_capacity; i++) {
+        if (old_ctrl[i] >= 0) {
+            slot& old = old_slots[i];
+            uint64_t hash = m_hash(old.key);
+            uint64_t index = find_insert_slot(hash);
+            m_ctrl[index] = static_cast<int8_t>(hash & 0x7F);
+            new (&m_slots[index].key) K(std::move(old.key));
+            new (&m_slots[index].value) V(std::move(old.value));
+            old.key.~K();
+            old.value.~V();
+        }
+    }
+
+    if (old_ctrl) {
+        m_allocator.Free(old_ctrl, allocation_size(old_capacity), slot_alignment, m_tag);
+    }
+    return true;
+}
+
+template <typename K, typename V, typename H> void
+HashMap<K, V, H>::release() {
+    clear();
+    if (m_ctrl) {
+        m_allocator.Free(m_ctrl, allocation_size(m_capacity), slot_alignment, m_tag);
+    }
+    m_ctrl = nullptr;
+    m_slots = nullptr;
+    m_capacity = 0;
+    m_growth_left = 0;
+}
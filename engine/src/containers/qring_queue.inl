@@ -0,0 +1,262 @@
+#pragma once
+#include "defines.hh"
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include "core/qmemory.hh"
+#include "memory/qcontainer_allocator.hh"
+
+/**
+ * Bounded lock-free ring queues
+ *
+ * SPSCQueue: one producer thread, one consumer thread. push and pop are wait-free.
+ * MPMCQueue: any number of producers and consumers. Every cell carries a sequence number
+ *     that tells producers and consumers whose turn it is (Dmitry Vyukov's design), so
+ *     push and pop are a single CAS on the shared index in the common case.
+ *
+ * Capacity is rounded up to a power of two and fixed at construction. push returns false
+ * when the queue is full and pop returns false when it is empty; neither blocks.
+ * Producer and consumer indices live on separate cache lines so the two sides do not
+ * invalidate each other's cache lines on every operation.
+*/
+
+static constexpr uint64_t QCACHE_LINE_SIZE = 64;
+
+inline uint64_t
+qring_queue_capacity(uint64_t requested) {
+    uint64_t capacity = 2;
+    while (capacity < requested) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+template <typename T>
+class QAPI SPSCQueue {
+public:
+    SPSCQueue(uint64_t capacity, memory_tag tag = MEMORY_TAG_RING_QUEUE,
+              qmemory::QContainerAllocator allocator = qmemory::QContainerAllocator::Default(),
+              const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+    ~SPSCQueue();
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator= (const SPSCQueue&) = delete;
+
+    // Producer thread only
+    bool push(const T& value) { return emplace(value); }
+    bool push(T&& value) { return emplace(std::move(value)); }
+    template <typename... Args> bool emplace(Args&&... args);
+
+    // Consumer thread only
+    bool pop(T& out);
+
+    // Exact when called from either side while the other is idle, approximate otherwise
+    uint64_t size() const;
+    uint64_t capacity() const { return m_capacity; }
+
+private:
+    // Producer side
+    alignas(QCACHE_LINE_SIZE) std::atomic<uint64_t> m_tail;
+    uint64_t m_cached_head; // last head the producer saw, saves loading the consumer's line
+
+    // Consumer side
+    alignas(QCACHE_LINE_SIZE) std::atomic<uint64_t> m_head;
+    uint64_t m_cached_tail;
+
+    // Read-only after construction
+    alignas(QCACHE_LINE_SIZE) T* m_slots;
+    uint64_t m_capacity;
+    uint64_t m_mask;
+    memory_tag m_tag;
+    qmemory::QContainerAllocator m_allocator;
+};
+
+template <typename T>
+class QAPI MPMCQueue {
+public:
+    MPMCQueue(uint64_t capacity, memory_tag tag = MEMORY_TAG_RING_QUEUE,
+              qmemory::QContainerAllocator allocator = qmemory::QContainerAllocator::Default(),
+              const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+    ~MPMCQueue();
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator= (const MPMCQueue&) = delete;
+
+    bool push(const T& value) { return emplace(value); }
+    bool push(T&& value) { return emplace(std::move(value)); }
+    template <typename... Args> bool emplace(Args&&... args);
+    bool pop(T& out);
+
+    // Approximate while other threads are using the queue
+    uint64_t size() const;
+    uint64_t capacity() const { return m_capacity; }
+
+private:
+    struct cell {
+        std::atomic<uint64_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() { return reinterpret_cast<T*>(storage); }
+    };
+
+    alignas(QCACHE_LINE_SIZE) std::atomic<uint64_t> m_enqueue_pos;
+    alignas(QCACHE_LINE_SIZE) std::atomic<uint64_t> m_dequeue_pos;
+
+    alignas(QCACHE_LINE_SIZE) cell* m_cells;
+    uint64_t m_capacity;
+    uint64_t m_mask;
+    memory_tag m_tag;
+    qmemory::QContainerAllocator m_allocator;
+};
+
+//
+// SPSCQueue
+//
+template <typename T>
+SPSCQueue<T>::SPSCQueue(uint64_t capacity, memory_tag tag, qmemory::QContainerAllocator allocator, const char* file, uint32_t line)
+    : m_tail(0),
+    m_cached_head(0),
+    m_head(0),
+    m_cached_tail(0),
+    m_capacity(qring_queue_capacity(capacity)),
+    m_mask(qring_queue_capacity(capacity) - 1),
+    m_tag(tag),
+    m_allocator(allocator)
+{
+    m_slots = static_cast<T*>(m_allocator.Allocate(m_capacity * sizeof(T), alignof(T) > 16 ? alignof(T) : 16, m_tag, file, line));
+}
+
+template <typename T>
+SPSCQueue<T>::~SPSCQueue() {
+    // Both sides are expected to be done, destroy whatever was never popped
+    const uint64_t tail = m_tail.load(std::memory_order_acquire);
+    for (uint64_t i = m_head.load(std::memory_order_acquire); i != tail; i++) {
+        m_slots[i & m_mask].~T();
+    }
+    m_allocator.Free(m_slots, m_capacity * sizeof(T), alignof(T) > 16 ? alignof(T) : 16, m_tag);
+}
+
+template <typename T> template <typename... Args> bool
+SPSCQueue<T>::emplace(Args&&... args) {
+    const uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_cached_head == m_capacity) {
+        m_cached_head = m_head.load(std::memory_order_acquire);
+        if (tail - m_cached_head == m_capacity) {
+            return false;
+        }
+    }
+
+    new (&m_slots[tail & m_mask]) T(std::forward<Args>(args)...);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> bool
+SPSCQueue<T>::pop(T& out) {
+    const uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cached_tail) {
+        m_cached_tail = m_tail.load(std::memory_order_acquire);
+        if (head == m_cached_tail) {
+            return false;
+        }
+    }
+
+    T& slot = m_slots[head & m_mask];
+    out = std::move(slot);
+    slot.~T();
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> uint64_t
+SPSCQueue<T>::size() const {
+    return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+}
+
+//
+// MPMCQueue
+//
+template <typename T>
+MPMCQueue<T>::MPMCQueue(uint64_t capacity, memory_tag tag, qmemory::QContainerAllocator allocator, const char* file, uint32_t line)
+    : m_enqueue_pos(0),
+    m_dequeue_pos(0),
+    m_capacity(qring_queue_capacity(capacity)),
+    m_mask(qring_queue_capacity(capacity) - 1),
+    m_tag(tag),
+    m_allocator(allocator)
+{
+    m_cells = static_cast<cell*>(m_allocator.Allocate(m_capacity * sizeof(cell), alignof(cell) > 16 ? alignof(cell) : 16, m_tag, file, line));
+    for (uint64_t i = 0; i < m_capacity; i++) {
+        new (&m_cells[i].sequence) std::atomic<uint64_t>(i);
+    }
+}
+
+template <typename T>
+MPMCQueue<T>::~MPMCQueue() {
+    const uint64_t enqueued = m_enqueue_pos.load(std::memory_order_acquire);
+    for (uint64_t i = m_dequeue_pos.load(std::memory_order_acquire); i != enqueued; i++) {
+        m_cells[i & m_mask].value()->~T();
+    }
+    m_allocator.Free(m_cells, m_capacity * sizeof(cell), alignof(cell) > 16 ? alignof(cell) : 16, m_tag);
+}
+
+// A cell is free for the producer at position pos when its sequence equals pos,
+// and holds a value for the consumer at pos when its sequence equals pos + 1
+template <typename T> template <typename... Args> bool
+MPMCQueue<T>::emplace(Args&&... args) {
+    uint64_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    cell* c;
+    for (;;) {
+        c = &m_cells[pos & m_mask];
+        uint64_t sequence = c->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // full
+        } else {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    new (c->value()) T(std::forward<Args>(args)...);
+    c->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> bool
+MPMCQueue<T>::pop(T& out) {
+    uint64_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    cell* c;
+    for (;;) {
+        c = &m_cells[pos & m_mask];
+        uint64_t sequence = c->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos + 1);
+        if (diff == 0) {
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // empty
+        } else {
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    T* value = c->value();
+    out = std::move(*value);
+    value->~T();
+    // Hand the cell to the producer one lap ahead
+    c->sequence.store(pos + m_capacity, std::memory_order_release);
+    return true;
+}
+
+template <typename T> uint64_t
+MPMCQueue<T>::size() const {
+    uint64_t enqueued = m_enqueue_pos.load(std::memory_order_acquire);
+    uint64_t dequeued = m_dequeue_pos.load(std::memory_order_acquire);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
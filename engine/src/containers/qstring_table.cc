@@ -0,0 +1,90 @@
+#include "qstring_table.hh"
+/**
+ * Implementation for the string table
+*/
+
+static constexpr uint64_t chunk_size = 16 * 1024;
+
+QStringTable::QStringTable()
+    : m_lookup(MEMORY_TAG_STRING),
+    m_strings(MEMORY_TAG_STRING),
+    m_chunks(nullptr)
+{
+
+}
+
+QStringTable::~QStringTable() {
+    while (m_chunks) {
+        chunk* next = m_chunks->next;
+        QAllocator::Free(m_chunks, sizeof(chunk) + m_chunks->size, MEMORY_TAG_STRING);
+        m_chunks = next;
+    }
+}
+
+// Copy the string into the current chunk, starting a new one when it is full.
+// Strings longer than a chunk get a chunk of their own
+char*
+QStringTable::store(const char* str, uint64_t length) {
+    uint64_t needed = length + 1;
+    if (!m_chunks || m_chunks->size - m_chunks->used < needed) {
+        uint64_t size = needed > chunk_size ? needed : chunk_size;
+        chunk* c = static_cast<chunk*>(QAllocator::Allocate(1, sizeof(chunk) + size, MEMORY_TAG_STRING));
+        c->next = m_chunks;
+        c->size = size;
+        c->used = 0;
+        m_chunks = c;
+    }
+
+    char* out = reinterpret_cast<char*>(m_chunks + 1) + m_chunks->used;
+    QAllocator::Copy(out, str, length);
+    out[length] = 0;
+    m_chunks->used += needed;
+    return out;
+}
+
+QStringId
+QStringTable::intern(const char* str) {
+    return intern(str, strlen(str));
+}
+
+QStringId
+QStringTable::intern(const char* str, uint64_t length) {
+    QStringId id;
+    QStringView view = { str, length };
+    if (const uint32_t* existing = m_lookup.find(view)) {
+        id.value = *existing;
+        return id;
+    }
+
+    QStringView stored = { store(str, length), length };
+    id.value = static_cast<uint32_t>(m_strings.size());
+    m_strings.push(stored);
+    m_lookup.insert(stored, id.value);
+    return id;
+}
+
+QStringId
+QStringTable::find(const char* str) const {
+    QStringId id;
+    QStringView view = { str, strlen(str) };
+    if (const uint32_t* existing = m_lookup.find(view)) {
+        id.value = *existing;
+    }
+    return id;
+}
+
+const char*
+QStringTable::get(QStringId id) const {
+    if (id.value >= m_strings.size()) {
+        return nullptr;
+    }
+    return m_strings[id.value].data;
+}
+
+uint64_t
+QStringTable::length(QStringId id) const {
+    if (id.value >= m_strings.size()) {
+        return 0;
+    }
+    return m_strings[id.value].length;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "defines.hh"
+#include "core/qmemory.hh"
+#include "containers/qhash.hh"
+#include "containers/qhashmap.inl"
+#include "containers/qvector.inl"
+#include <cstdint>
+
+/**
+ * qstring_table.hh
+ *
+ * String interning. Each distinct string is stored once and gets a small integer id, so
+ * names (resources, materials, shaders...) can be compared and hashed as integers and used
+ * as HashMap keys without keeping std::string copies around.
+*/
+
+// Id of an interned string. Only meaningful for the table that produced it
+struct QStringId {
+    static constexpr uint32_t invalid_value = 0xFFFFFFFF;
+
+    uint32_t value = invalid_value;
+
+    bool is_null() const { return value == invalid_value; }
+    bool operator==(const QStringId& other) const { return value == other.value; }
+    bool operator!=(const QStringId& other) const { return value != other.value; }
+};
+
+template <>
+struct QHash<QStringId, void> {
+    uint64_t operator()(QStringId id) const { return qhash_mix(id.value); }
+};
+
+// Non-owning view of string bytes, used as the key of the table's lookup map
+struct QStringView {
+    const char* data;
+    uint64_t length;
+
+    bool operator==(const QStringView& other) const {
+        return length == other.length && memcmp(data, other.data, length) == 0;
+    }
+};
+
+template <>
+struct QHash<QStringView, void> {
+    uint64_t operator()(const QStringView& view) const { return qhash_bytes(view.data, view.length); }
+};
+
+class QAPI QStringTable {
+public:
+    QStringTable();
+    ~QStringTable();
+
+    QStringTable(const QStringTable&) = delete;
+    QStringTable& operator= (const QStringTable&) = delete;
+
+    /**
+     * @brief Id for str, storing a copy of it the first time it is seen
+    */
+    QStringId intern(const char* str);
+    QStringId intern(const char* str, uint64_t length);
+
+    /**
+     * @brief Id for str if it has been interned, a null id otherwise. Never stores anything
+    */
+    QStringId find(const char* str) const;
+
+    // Null terminated string for id, or nullptr for ids that did not come from this table
+    const char* get(QStringId id) const;
+    uint64_t length(QStringId id) const;
+
+    // Number of distinct strings
+    uint64_t size() const { return m_strings.size(); }
+
+private:
+    char* store(const char* str, uint64_t length);
+
+    // Strings are packed into chunks that never move, so views into them stay valid
+    struct chunk {
+        chunk* next;
+        uint64_t size;
+        uint64_t used;
+    };
+
+    HashMap<QStringView, uint32_t> m_lookup;
+    Vector<QStringView> m_strings;
+    chunk* m_chunks;
+};
@@ -1,45 +1,136 @@
 #pragma once
 #include "defines.hh"
 #include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "core/qlogger.hh"
 #include "core/qmemory.hh"
+#include "memory/qcontainer_allocator.hh"
 
+/**
+ * Growable array
+ *
+ * Memory comes from a QContainerAllocator (QAllocator by default) and is accounted under the
+ * vector's memory tag. Nothing is allocated until the first element is added.
+ * Elements are moved, not copied, when the buffer grows, and trivially copyable types
+ * are copied with memcpy and grown in place when the allocator can do it.
+ *
+ * An arena or pool allocator can run out. Growing then logs an error and leaves the vector as
+ * it was: push and reserve return false, emplace_back returns nullptr.
+ *
+ * push, reserve and resize pass their caller's file and line down to the allocation tracker.
+ * emplace_back cannot take them after its arguments, so its growth is credited to this file
+*/
 template <typename T>
 class QAPI Vector {
 public:
     Vector();
     Vector(memory_tag tag);
+    Vector(memory_tag tag, qmemory::QContainerAllocator allocator);
     Vector(const Vector& v);
+    Vector(Vector&& v) noexcept;
     ~Vector();
 
     T& at(uint64_t index) const;
     T pop();
-    void push(T obj);
+    bool push(const T& obj, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+    bool push(T&& obj, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+    // The new element, or nullptr if there was no room and the buffer could not grow
+    template <typename... Args> T* emplace_back(Args&&... args);
     bool set(uint64_t index, T obj);
     uint64_t size() const;
     uint64_t capacity() const;
+    bool empty() const;
     memory_tag tag() const;
+    qmemory::QContainerAllocator allocator() const;
     T* data() const;
+    T& back() const;
 
+    /**
+     * @brief Make room for at least new_capacity elements without changing size()
+    */
+    bool reserve(uint64_t new_capacity, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+
+    /**
+     * @brief Grow with value-initialized elements or shrink, destroying the removed ones
+     * @return false, with the size unchanged, if the buffer could not grow
+    */
+    bool resize(uint64_t new_size, const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+
+    // Destroy every element. The buffer is kept for reuse
     void clear();
 
-    T& operator[] (int index) const; 
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_length; }
+
+    T& operator[] (uint64_t index) const;
     Vector<T>& operator= (const Vector<T>& v2);
-    
+    Vector<T>& operator= (Vector<T>&& v2) noexcept;
+
 private:
+    static constexpr bool trivial = std::is_trivially_copyable<T>::value;
+    static constexpr uint64_t alignment = alignof(T) > 16 ? alignof(T) : 16;
+    static constexpr uint64_t min_capacity = 4;
+
+    template <typename... Args> T* construct_back(const char* file, uint32_t line, Args&&... args);
+    bool grow(uint64_t new_capacity, const char* file, uint32_t line);
+    void release();
+
     T* m_data;
     uint64_t m_length;
     uint64_t m_capacity;
     memory_tag m_tag;
+    qmemory::QContainerAllocator m_allocator;
 };
 
-// 
+//
 // Operator Overloads
 //
-template <typename T> Vector<T>& 
-Vector<T>::operator= (const Vector<T>& other) { return *this; }
+template <typename T> Vector<T>&
+Vector<T>::operator= (const Vector<T>& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    clear();
+    if (!reserve(other.m_length)) {
+        return *this;
+    }
+    if constexpr (trivial) {
+        if (other.m_length) {
+            QAllocator::Copy(m_data, other.m_data, other.m_length * sizeof(T));
+        }
+    } else {
+        for (uint64_t i = 0; i < other.m_length; i++) {
+            new (&m_data[i]) T(other.m_data[i]);
+        }
+    }
+    m_length = other.m_length;
+    return *this;
+}
+
+template <typename T> Vector<T>&
+Vector<T>::operator= (Vector<T>&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    release();
+    m_data = other.m_data;
+    m_length = other.m_length;
+    m_capacity = other.m_capacity;
+    m_tag = other.m_tag;
+    m_allocator = other.m_allocator;
+
+    other.m_data = nullptr;
+    other.m_length = 0;
+    other.m_capacity = 0;
+    return *this;
+}
 
 template <typename T> T&
-Vector<T>::operator[](int index) const { return this->at(index); }
+Vector<T>::operator[](uint64_t index) const { return m_data[index]; }
 
 //
 // Accessors
@@ -50,24 +141,32 @@ Vector<T>::data() const { return m_data; }
 template <typename T> uint64_t
 Vector<T>::size() const { return m_length; }
 
+template <typename T> bool
+Vector<T>::empty() const { return m_length == 0; }
+
 template <typename T> memory_tag
 Vector<T>::tag() const { return m_tag; }
 
+template <typename T> qmemory::QContainerAllocator
+Vector<T>::allocator() const { return m_allocator; }
+
 template <typename T> uint64_t
 Vector<T>::capacity() const { return m_capacity; }
 
+template <typename T> T&
+Vector<T>::back() const { return m_data[m_length - 1]; }
+
 //
 // Constructors
-// 
+//
 // Constructor without memory tag
 template <typename T>
 Vector<T>::Vector()
-    : m_data(
-        new (QAllocator::Allocate(1, sizeof(T), MEMORY_TAG_UNKNOWN)) T[1]
-    ), 
-    m_length(0), 
-    m_capacity(1),
-    m_tag(MEMORY_TAG_UNKNOWN)
+    : m_data(nullptr),
+    m_length(0),
+    m_capacity(0),
+    m_tag(MEMORY_TAG_DARRAY),
+    m_allocator(qmemory::QContainerAllocator::Default())
 {
 
 }
@@ -75,30 +174,51 @@ Vector<T>::Vector()
 // Constructor specifying memory tag
 template <typename T>
 Vector<T>::Vector(memory_tag tag)
-    : m_data(
-        new (QAllocator::Allocate(1, sizeof(T), tag)) T[1]
-    ), 
-    m_length(0), 
-    m_capacity(1),
-    m_tag(tag)
+    : m_data(nullptr),
+    m_length(0),
+    m_capacity(0),
+    m_tag(tag),
+    m_allocator(qmemory::QContainerAllocator::Default())
 {
 
 }
 
-// Copy constructor
+// Constructor specifying memory tag and where the memory comes from
 template <typename T>
-Vector<T>::Vector(const Vector<T>& v) 
-    : m_data(
-        new (static_cast<T*>(QAllocator::Allocate(1, sizeof(T), v.tag())))
-        T[1]
-    ), 
-    m_length(0), 
-    m_capacity(1),
-    m_tag(v.tag()) 
+Vector<T>::Vector(memory_tag tag, qmemory::QContainerAllocator allocator)
+    : m_data(nullptr),
+    m_length(0),
+    m_capacity(0),
+    m_tag(tag),
+    m_allocator(allocator)
 {
-    for (uint64_t i = 0; i < v.size(); i++) {
-        this->push(v[i]);
-    }
+
+}
+
+// Copy constructor. The copy uses the same allocator as the source
+template <typename T>
+Vector<T>::Vector(const Vector<T>& v)
+    : m_data(nullptr),
+    m_length(0),
+    m_capacity(0),
+    m_tag(v.m_tag),
+    m_allocator(v.m_allocator)
+{
+    *this = v;
+}
+
+// Move constructor. Takes the buffer, leaves v empty
+template <typename T>
+Vector<T>::Vector(Vector<T>&& v) noexcept
+    : m_data(v.m_data),
+    m_length(v.m_length),
+    m_capacity(v.m_capacity),
+    m_tag(v.m_tag),
+    m_allocator(v.m_allocator)
+{
+    v.m_data = nullptr;
+    v.m_length = 0;
+    v.m_capacity = 0;
 }
 
 //
@@ -108,7 +228,7 @@ Vector<T>::Vector(const Vector<T>& v)
 // Destructor
 template <typename T>
 Vector<T>::~Vector() {
-    QAllocator::Free((void*)m_data, sizeof(T) * m_capacity, m_tag);
+    release();
 }
 
 //
@@ -118,8 +238,8 @@ Vector<T>::~Vector() {
 // Get object at an index
 template <typename T> T&
 Vector<T>::at(uint64_t index) const {
-    if (index < m_length && index >= 0) {
-        return (T&)m_data[index];
+    if (index < m_length) {
+        return m_data[index];
     }
 
     // throw std::runtime_error("QVector: accessing invalid index");
@@ -129,49 +249,139 @@ Vector<T>::at(uint64_t index) const {
 // Remove and return the last item in the list
 template <typename T> T
 Vector<T>::pop() {
-    if (index < m_length && index >= 0) {
-        T = m_data[index];
-        m_length--;
-        return T;
-    }
-
-    // throw std::runtime_error("QVector: accessing invalid index");
-    return m_data[0];
+    T last = std::move(m_data[m_length - 1]);
+    m_data[m_length - 1].~T();
+    m_length--;
+    return last;
 }
 
 // Set an index of the Vector to specified object
 template <typename T> bool
 Vector<T>::set(uint64_t index, T obj) {
-    if (index < m_length && index >= 0) {
-        m_data[index] = obj;
+    if (index < m_length) {
+        m_data[index] = std::move(obj);
+        return true;
     }
 
     return false;
 }
 
 // Append an item to the end of the Vector<>
-template <typename T> void
-Vector<T>::push(T obj) {
-    if (m_length == m_capacity) { 
-        // T *new_arr = new T[m_length * 2];
-        T *buf = (T*)QAllocator::Allocate(m_length * 2, sizeof(T), m_tag);
-        T *new_arr = new (buf) T[m_length * 2];
-
-        for (int i = 0; i < m_length; i++) {
-            new_arr[i] = (T)m_data[i];
+template <typename T> bool
+Vector<T>::push(const T& obj, const char* file, uint32_t line) {
+    return construct_back(file, line, obj) != nullptr;
+}
+
+template <typename T> bool
+Vector<T>::push(T&& obj, const char* file, uint32_t line) {
+    return construct_back(file, line, std::move(obj)) != nullptr;
+}
+
+// Construct an item in place at the end of the Vector<>
+template <typename T> template <typename... Args> T*
+Vector<T>::emplace_back(Args&&... args) {
+    return construct_back(Q_CALLER_FILE, Q_CALLER_LINE, std::forward<Args>(args)...);
+}
+
+template <typename T> template <typename... Args> T*
+Vector<T>::construct_back(const char* file, uint32_t line, Args&&... args) {
+    if (m_length == m_capacity) {
+        // Build the element first in case args refers to an element that moves when growing
+        T value(std::forward<Args>(args)...);
+        if (!grow(m_capacity < min_capacity ? min_capacity : m_capacity * 2, file, line)) {
+            return nullptr;
+        }
+        new (&m_data[m_length]) T(std::move(value));
+    } else {
+        new (&m_data[m_length]) T(std::forward<Args>(args)...);
+    }
+    return &m_data[m_length++];
+}
+
+template <typename T> bool
+Vector<T>::reserve(uint64_t new_capacity, const char* file, uint32_t line) {
+    if (new_capacity > m_capacity) {
+        return grow(new_capacity, file, line);
+    }
+    return true;
+}
+
+template <typename T> bool
+Vector<T>::resize(uint64_t new_size, const char* file, uint32_t line) {
+    if (new_size > m_capacity) {
+        uint64_t doubled = m_capacity * 2;
+        if (!grow(new_size > doubled ? new_size : doubled, file, line)) {
+            return false;
+        }
+    }
+
+    if (new_size > m_length) {
+        // Zeroing is only the same as T() without a constructor or default member initializers
+        if constexpr (std::is_trivially_default_constructible_v<T>) {
+            QAllocator::Zero(m_data + m_length, (new_size - m_length) * sizeof(T));
+        } else {
+            for (uint64_t i = m_length; i < new_size; i++) {
+                new (&m_data[i]) T();
+            }
+        }
+    } else if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (uint64_t i = new_size; i < m_length; i++) {
+            m_data[i].~T();
         }
-        
-        QAllocator::Free(m_data, m_length * sizeof(T), m_tag);
-        m_data = new_arr;
-        m_capacity = m_capacity * 2;
     }
-    m_data[m_length] = obj;
-    m_length++;
+    m_length = new_size;
+    return true;
 }
 
 template <typename T> void
 Vector<T>::clear() {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+        for (uint64_t i = 0; i < m_length; i++) {
+            m_data[i].~T();
+        }
+    }
+    m_length = 0;
+}
+
+// Move everything into a buffer of new_capacity elements. If the allocator is out of memory
+// the old buffer is kept as it is
+template <typename T> bool
+Vector<T>::grow(uint64_t new_capacity, const char* file, uint32_t line) {
+    if constexpr (trivial) {
+        T* new_data = static_cast<T*>(m_allocator.Reallocate(m_data, m_capacity * sizeof(T), new_capacity * sizeof(T), alignment, m_tag, file, line));
+        if (!new_data) {
+            qlogger::Error("Vector: out of memory growing to %llu elements of %llu bytes", new_capacity, (uint64_t)sizeof(T));
+            return false;
+        }
+        m_data = new_data;
+        m_capacity = new_capacity;
+        return true;
+    }
+
+    T* new_data = static_cast<T*>(m_allocator.Allocate(new_capacity * sizeof(T), alignment, m_tag, file, line));
+    if (!new_data) {
+        qlogger::Error("Vector: out of memory growing to %llu elements of %llu bytes", new_capacity, (uint64_t)sizeof(T));
+        return false;
+    }
     for (uint64_t i = 0; i < m_length; i++) {
-        delete[] m_data[i];
+        new (&new_data[i]) T(std::move(m_data[i]));
+        m_data[i].~T();
     }
-}
\ No newline at end of file
+
+    if (m_data) {
+        m_allocator.Free(m_data, m_capacity * sizeof(T), alignment, m_tag);
+    }
+    m_data = new_data;
+    m_capacity = new_capacity;
+    return true;
+}
+
+template <typename T> void
+Vector<T>::release() {
+    clear();
+    if (m_data) {
+        m_allocator.Free(m_data, m_capacity * sizeof(T), alignment, m_tag);
+    }
+    m_data = nullptr;
+    m_capacity = 0;
+}
@@ -6,7 +6,9 @@
 #include "containers/qvector.inl"
 #include "core/qmemory.hh"
 #include "core/qlogger.hh"
+#include "core/qjobs.hh"
 #include "memory/qlinear_allocator.hh"
+#include "memory/qdynamic_allocator.hh"
 #include <chrono>
 
 #define GLM_FORCE_RADIANS
@@ -35,6 +37,16 @@ struct ApplicationState {
 
     qmemory::QLinearAllocator systems_allocator;
 
+    // Per-frame scratch memory. The two arenas are alternated every frame so that
+    // data built during one frame is still valid while the next one is recorded
+    qmemory::QLinearAllocator frame_allocators[2];
+    uint32_t frame_allocator_index;
+
+    // Long-lived resources (textures, materials, shaders) that come and go in any order
+    uint64_t resource_allocator_memory_requirement;
+    void* resource_allocator_state;
+    qmemory::QDynamicAllocator resource_allocator;
+
     uint64_t logging_system_memory_requirement;
     void* logging_system_state;
 
@@ -44,6 +56,9 @@ struct ApplicationState {
     uint64_t event_system_memory_requirement;
     void* event_system_state;
 
+    uint64_t job_system_memory_requirement;
+    void* job_system_state;
+
     uint64_t memory_system_memory_requirement;
     void* memory_system_state;
     
@@ -70,7 +85,7 @@ Application::Create(
     }
     
     // Initialize Application State
-    game.application_state = static_cast<ApplicationState*>(QAllocator::Allocate(1, sizeof(ApplicationState), MEMORY_TAG_APPLICATION));
+    game.application_state = static_cast<ApplicationState*>(QAllocator::AllocateZeroed(1, sizeof(ApplicationState), MEMORY_TAG_APPLICATION));
     app_state = new (game.application_state) ApplicationState;
     app_state->game_inst = &game;
     app_state->is_running = false;
@@ -84,12 +99,29 @@ Application::Create(
     app_state->memory_system_state = app_state->systems_allocator.Allocate(app_state->memory_system_memory_requirement);
     QAllocator::Initialize(app_state->memory_system_memory_requirement, app_state->memory_system_state);
 
+    // Setup the frame allocators out of the systems allocator
+    uint64_t frame_allocator_total_size = 4 * 1024 * 1024; // 4 MB per frame
+    for (uint32_t i = 0; i < 2; i++) {
+        void* frame_memory = app_state->systems_allocator.Allocate(frame_allocator_total_size);
+        app_state->frame_allocators[i].Create(frame_allocator_total_size, frame_memory);
+    }
+    app_state->frame_allocator_index = 0;
+
+    // Setup the resource allocator out of the systems allocator
+    uint64_t resource_allocator_total_size = 32 * 1024 * 1024; // 32 MB
+    app_state->resource_allocator.Create(resource_allocator_total_size, app_state->resource_allocator_memory_requirement, nullptr);
+    app_state->resource_allocator_state = app_state->systems_allocator.Allocate(app_state->resource_allocator_memory_requirement, 16);
+    if (!app_state->resource_allocator.Create(resource_allocator_total_size, app_state->resource_allocator_memory_requirement, app_state->resource_allocator_state)) {
+        qlogger::Fatal("Failed to create the resource allocator");
+        return false;
+    }
+
     app_state->name = name;
     app_state->asset_path = asset_path;
 
     // Startup subsystems
     qlogger::Initialize(app_state->logging_system_memory_requirement, nullptr);
-    app_state->logging_system_state = app_state->systems_allocator.Allocate(app_state->logging_system_memory_requirement);
+    app_state->logging_system_state = app_state->systems_allocator.Allocate(app_state->logging_system_memory_requirement, 64);
     if (!qlogger::Initialize(app_state->logging_system_memory_requirement, app_state->logging_system_state)) {
         qlogger::Error("Failed to initialize logging system.");
         return false;
@@ -101,12 +133,19 @@ Application::Create(
 
 
     EventHandler::Startup(app_state->event_system_memory_requirement, nullptr);
-    app_state->event_system_state = app_state->systems_allocator.Allocate(app_state->event_system_memory_requirement);    
+    app_state->event_system_state = app_state->systems_allocator.Allocate(app_state->event_system_memory_requirement, 64);
     if (!EventHandler::Startup(app_state->event_system_memory_requirement, app_state->event_system_state)) {
         qlogger::Error("Error: failed to initialize event handler");
         return false;
     }
     qlogger::Info("Event System created...");
+
+    JobSystem::Startup(app_state->job_system_memory_requirement, nullptr);
+    app_state->job_system_state = app_state->systems_allocator.Allocate(app_state->job_system_memory_requirement, 64);
+    if (!JobSystem::Startup(app_state->job_system_memory_requirement, app_state->job_system_state)) {
+        qlogger::Error("Error: failed to initialize job system");
+        return false;
+    }
     
     // Register for events
     EventHandler::Register(EVENT_CODE_APPLICATION_QUIT, nullptr, Application::OnEvent);
@@ -129,6 +168,12 @@ Application::Create(
     }
     qlogger::Info("Renderer created.");
 
+    // The game's world allocates through QAllocator, so it waits until the memory system is up
+    if (!Pegasus::Game::Initialize(game)) {
+        qlogger::Error("Error: failed to initialize game");
+        return false;
+    }
+
     app_state->initialized = true;
     return true;
 }
@@ -217,10 +262,17 @@ Application::run() {
 
     // Application Event loop
     while (app_state->is_running) {
+        // Swap frame allocators. This releases everything allocated two frames ago
+        app_state->frame_allocator_index ^= 1;
+        qmemory::QLinearAllocator& frame_allocator = app_state->frame_allocators[app_state->frame_allocator_index];
+        frame_allocator.FreeAll();
 
         if (!Platform::pump_messages())
             app_state->is_running = false;
 
+        // Everything posted since the last frame, from the platform layer or from worker threads
+        EventHandler::DispatchQueued();
+
         if (!app_state->is_suspended) {
             // Update timer
             app_state->clock.update();
@@ -277,11 +329,13 @@ Application::run() {
             RenderPacket packet = {};
             packet.ubo = ubo;
             packet.delta_time = (float)delta;
+            packet.frame_allocator = &frame_allocator;
             // packet.delta_time = time;
             Renderer::DrawFrame(packet);
 
             // InputHandler::Update(time);
             InputHandler::Update((float)delta);
+            QAllocator::Update();
 
             app_state->last_time = current_time;
         }
@@ -298,16 +352,23 @@ Application::run() {
 
     qlogger::Info("Shutting down application");
 
+    // Before the job and memory systems go, the world's chunks are QAllocator blocks
+    Pegasus::Game::Destroy(*app_state->game_inst);
+
     EventHandler::Unregister(EVENT_CODE_APPLICATION_QUIT, nullptr);
     EventHandler::Unregister(EVENT_CODE_KEY_PRESSED, nullptr);
     EventHandler::Unregister(EVENT_CODE_KEY_RELEASED, nullptr);
     EventHandler::Unregister(EVENT_CODE_RESIZED, nullptr);
 
+    JobSystem::Shutdown();
     EventHandler::Shutdown();
     InputHandler::Shutdown();
     qlogger::Shutdown(app_state->logging_system_state);
     Renderer::Shutdown();
     Platform::Shutdown();
+    app_state->frame_allocators[0].Destroy();
+    app_state->frame_allocators[1].Destroy();
+    app_state->resource_allocator.Destroy();
     QAllocator::Shutdown();
     qlogger::Info("Application shutdown successfully.");
     return true; 
@@ -423,4 +484,14 @@ void
 Application::GetFramebufferSize(uint32_t& width, uint32_t& height) {
     width = app_state->width;
     height = app_state->height;
-}
\ No newline at end of file
+}
+
+qmemory::QLinearAllocator&
+Application::GetFrameAllocator() {
+    return app_state->frame_allocators[app_state->frame_allocator_index];
+}
+
+qmemory::QDynamicAllocator&
+Application::GetResourceAllocator() {
+    return app_state->resource_allocator;
+}
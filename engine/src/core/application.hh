@@ -4,6 +4,8 @@
 #include "events.hh"
 #include "platform/platform_timer.hh"
 #include "game_types.hh"
+#include "memory/qlinear_allocator.hh"
+#include "memory/qdynamic_allocator.hh"
 #include <cstdint>
 
 struct Settings {
@@ -26,6 +28,19 @@ class  QAPI Application {
         static bool OnResize(uint16_t code, void* sender, void* listener, EventContext context);
 
         static void GetFramebufferSize(uint32_t& width, uint32_t& height);
+
+        /**
+         * @brief Scratch allocator for the current frame
+         *     Reset at the start of every frame, so anything allocated from it is only
+         *     valid until the end of the next frame. Nothing allocated here needs to be freed
+        */
+        static qmemory::QLinearAllocator& GetFrameAllocator();
+
+        /**
+         * @brief General purpose allocator for long-lived engine data such as textures,
+         *     materials and shaders. Blocks must be returned with Free
+        */
+        static qmemory::QDynamicAllocator& GetResourceAllocator();
     private:
         StepTimer m_timer;
 
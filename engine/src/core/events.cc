@@ -1,8 +1,180 @@
 #include "events.hh"
+#include "core/qlogger.hh"
+#include <new>
 
 // static EventState event_state_ptr = {};
 static EventState *event_state_ptr = nullptr;
 
+// Calls a listener registered with a CallbackFunc
+static bool
+call_boxed_callback(const EventDelegate& delegate, uint16_t code, void* sender, EventContext data) {
+    return (*delegate.callback)(code, sender, delegate.listener, data);
+}
+
+// A callback may unregister itself while it is running, so it is only deleted once nothing is firing
+static void
+retire_callback(CallbackFunc* callback) {
+    if (!callback) {
+        return;
+    }
+    if (event_state_ptr->fire_depth > 0) {
+        event_state_ptr->retired.push(callback);
+        return;
+    }
+    delete callback;
+}
+
+// Marks queued events dropped in favour of a later one with the same code
+static constexpr uint16_t SUPERSEDED_EVENT = 0xFFFF;
+
+static bool
+bit_test(const uint64_t* bits, uint16_t index) {
+    return bits[index / 64] & (1ull << (index % 64));
+}
+
+static void
+bit_assign(uint64_t* bits, uint16_t index, bool value) {
+    if (value) {
+        bits[index / 64] |= 1ull << (index % 64);
+    } else {
+        bits[index / 64] &= ~(1ull << (index % 64));
+    }
+}
+
+// Marks a code with no listeners
+static constexpr uint64_t NO_CODE = ~0ull;
+
+// Where code should go in codes to keep it sorted, only needed when a code gets its first listener
+static uint64_t
+lower_bound_code(uint16_t code) {
+    const Vector<EventCodeEntry>& codes = event_state_ptr->codes;
+    uint64_t low = 0;
+    uint64_t high = codes.size();
+    while (low < high) {
+        const uint64_t middle = (low + high) / 2;
+        if (codes[middle].code < code) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// code's slot in code_slots, or nullptr when its page has not been added
+static uint16_t*
+code_slot(uint16_t code) {
+    const uint16_t page = event_state_ptr->code_pages[code / EVENT_CODE_PAGE_SIZE];
+    if (page == 0) {
+        return nullptr;
+    }
+    return &event_state_ptr->code_slots[(page - 1) * EVENT_CODE_PAGE_SIZE + code % EVENT_CODE_PAGE_SIZE];
+}
+
+static uint64_t
+find_code(uint16_t code) {
+    if (code >= MAX_MESSAGE_CODES) {
+        return NO_CODE;
+    }
+    const uint16_t* slot = code_slot(code);
+    if (!slot || *slot == 0) {
+        return NO_CODE;
+    }
+    return *slot - 1;
+}
+
+// Give code's page its slots, all empty, if it does not have them yet
+static bool
+add_code_page(uint16_t code) {
+    uint16_t& page = event_state_ptr->code_pages[code / EVENT_CODE_PAGE_SIZE];
+    if (page != 0) {
+        return true;
+    }
+    Vector<uint16_t>& slots = event_state_ptr->code_slots;
+    if (!slots.resize(slots.size() + EVENT_CODE_PAGE_SIZE)) {
+        return false;
+    }
+    page = static_cast<uint16_t>(slots.size() / EVENT_CODE_PAGE_SIZE);
+    return true;
+}
+
+// Point the slots of every code from index on at where its entry now sits
+static void
+update_code_slots(uint64_t index) {
+    const Vector<EventCodeEntry>& codes = event_state_ptr->codes;
+    for (uint64_t i = index; i < codes.size(); i++) {
+        *code_slot(codes[i].code) = static_cast<uint16_t>(i + 1);
+    }
+}
+
+// Vector has no insert or erase, and these only ever hold a few dozen elements
+template <typename T>
+static void
+insert_at(Vector<T>& vector, uint64_t index, const T& value) {
+    vector.push(value);
+    for (uint64_t i = vector.size() - 1; i > index; i--) {
+        vector[i] = vector[i - 1];
+    }
+    vector[index] = value;
+}
+
+template <typename T>
+static void
+erase_at(Vector<T>& vector, uint64_t index) {
+    for (uint64_t i = index + 1; i < vector.size(); i++) {
+        vector[i - 1] = vector[i];
+    }
+    vector.pop();
+}
+
+static bool
+is_registered(uint16_t code, void* listener) {
+    const uint64_t index = find_code(code);
+    if (index == NO_CODE) {
+        return false;
+    }
+    const EventCodeEntry& entry = event_state_ptr->codes[index];
+    for (uint32_t i = 0; i < entry.count; i++) {
+        if (event_state_ptr->listeners[entry.first + i].listener == listener) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// A listener can be added for a code it is not registered for yet, once the code has a slot
+static bool
+can_register(uint16_t code, void* listener) {
+    if (code >= MAX_MESSAGE_CODES) {
+        qlogger::Warn("EventHandler::Register: event code %u is not below MAX_MESSAGE_CODES", code);
+        return false;
+    }
+    return !is_registered(code, listener) && add_code_page(code);
+}
+
+// Add delegate after the code's other listeners, moving every later code's listeners up one
+static void
+add_delegate(uint16_t code, const EventDelegate& delegate) {
+    Vector<EventCodeEntry>& codes = event_state_ptr->codes;
+    Vector<EventDelegate>& listeners = event_state_ptr->listeners;
+
+    uint64_t index = find_code(code);
+    if (index == NO_CODE) {
+        index = lower_bound_code(code);
+        const uint32_t first = index < codes.size() ? codes[index].first : static_cast<uint32_t>(listeners.size());
+        insert_at(codes, index, EventCodeEntry { code, first, 0 });
+        update_code_slots(index);
+    }
+
+    EventCodeEntry& entry = codes[index];
+    insert_at(listeners, entry.first + entry.count, delegate);
+    entry.count++;
+    for (uint64_t i = index + 1; i < codes.size(); i++) {
+        codes[i].first++;
+    }
+    event_state_ptr->generation++;
+}
+
 bool EventHandler::Startup(uint64_t& memory_requirements, void* state) {
     memory_requirements = sizeof(EventState);
     if (state == nullptr) {
@@ -10,69 +182,90 @@ bool EventHandler::Startup(uint64_t& memory_requirements, void* state) {
     }
     
     event_state_ptr = new (static_cast<EventState*>(state)) EventState;
-
-    for (size_t i = 0; i < MAX_MESSAGE_CODES; i++)
-        event_state_ptr->registered[i].events.clear();
-
+    SetCoalesced(EVENT_CODE_MOUSE_MOVED, true);
+    SetCoalesced(EVENT_CODE_RESIZED, true);
     event_state_ptr->initialized = true;
     return true;
 }
 
 void EventHandler::Shutdown() {
-    for (size_t i = 0; i < MAX_MESSAGE_CODES; i++) {
-        event_state_ptr->registered[i].events.clear();
+    for (EventDelegate& delegate : event_state_ptr->listeners) {
+        delete delegate.callback;
+    }
+    for (CallbackFunc* callback : event_state_ptr->retired) {
+        delete callback;
     }
 
-    event_state_ptr->initialized = false;
+    event_state_ptr->~EventState();
     event_state_ptr = nullptr;
 }
 
-// Registers to listen to events that are sent with the specified code
 // listener/callback combos won't be registered twice, and will return 'false' if that is attempted
+bool EventHandler::Register(
+        uint16_t code,
+        void* listener,
+        PFN_on_event on_event
+        ) {
+    if (!can_register(code, listener)) {
+        return false;
+    }
+
+    add_delegate(code, EventDelegate { on_event, listener, nullptr });
+    return true;
+}
+
 bool EventHandler::Register(
         uint16_t code,
         void* listener,
         CallbackFunc callback
         ) {
-    // Check if the listener has already been registered
-    size_t registered_count = event_state_ptr->registered[code].events.size();
-    for (size_t i = 0; i < registered_count; i++) {
-        if (event_state_ptr->registered[code].events[i].listener == listener)
-            return false;
-    }
-
-    // Proceed with registration since it has not been registered yet
-    RegisteredEvent event = {};
-    event.listener = listener;
-    event.callback = callback;
-    event_state_ptr->registered[code].events.push_back(event);
+    if (!can_register(code, listener)) {
+        return false;
+    }
+
+    // A plain function wrapped in a std::function does not need to stay wrapped
+    if (PFN_on_event* on_event = callback.target<PFN_on_event>()) {
+        return Register(code, listener, *on_event);
+    }
+
+    CallbackFunc* boxed = new CallbackFunc(std::move(callback));
+    add_delegate(code, EventDelegate { nullptr, listener, boxed });
     return true;
 }
 
 // Unregister an event with the specified code from the listener
-// bool Unregister(uint16_t code, void* listener, PFN_on_event on_event);
-// bool Unregister(uint16_t code, void* listener, bool (T::*)(uint16_t, void*, void*, EventContext));
 bool EventHandler::Unregister(
         uint16_t code,
         void* listener
         ) {
-    // Check that the listener is actually registered for the event
-    if (event_state_ptr->registered[code].events.size() == 0)
+    const uint64_t index = find_code(code);
+    if (index == NO_CODE) {
         return false;
+    }
 
-    // Iterate through the list of listeners registered for the event
-    // and check if both the listener and the specified callback function
-    // match. If they match, remove the listener from the vector
-    // Removing element from vector at an index is obviously not efficient, but for
-    // the sake of prototyping this is fine for now. Also there are not too many elements
-    // that would be registered for an event, so even in worst case it is not that bad
-    size_t registered_count = event_state_ptr->registered[code].events.size();
-    for (size_t i = 0; i < registered_count; i++) {
-        RegisteredEvent ev = event_state_ptr->registered[code].events[i];
-        if (ev.listener == listener) {
-            event_state_ptr->registered[code].events.erase(event_state_ptr->registered[code].events.begin() + i);
-            return true;
+    // Remove the listener, keeping the others in registration order. Later codes' listeners
+    // move down one, there are only ever a few dozen listeners in total
+    Vector<EventCodeEntry>& codes = event_state_ptr->codes;
+    EventCodeEntry& entry = codes[index];
+    for (uint32_t i = 0; i < entry.count; i++) {
+        EventDelegate& delegate = event_state_ptr->listeners[entry.first + i];
+        if (delegate.listener != listener) {
+            continue;
+        }
+
+        retire_callback(delegate.callback);
+        erase_at(event_state_ptr->listeners, entry.first + i);
+        entry.count--;
+        for (uint64_t j = index + 1; j < codes.size(); j++) {
+            codes[j].first--;
         }
+        if (entry.count == 0) {
+            *code_slot(code) = 0;
+            erase_at(codes, index);
+            update_code_slots(index);
+        }
+        event_state_ptr->generation++;
+        return true;
     }
 
     return false;
@@ -82,21 +275,102 @@ bool EventHandler::Unregister(
 // If the handler returns true, the event is considered handled
 // If not, the handler passes on to any more listeners
 bool EventHandler::Fire(uint16_t code, void* sender, EventContext context) {
-    if (event_state_ptr->registered[code].events.size() == 0) {
+    uint64_t index = find_code(code);
+    if (index == NO_CODE) {
         return false;
     }
 
-    for (size_t i = 0; i < event_state_ptr->registered[code].events.size(); i++) {
-        RegisteredEvent ev = event_state_ptr->registered[code].events[i];
-        auto func = ev.callback;
-        if (ev.callback(code, sender, ev.listener, context)) {
+    // Listeners may register or unregister while being called, which moves the pool around.
+    // Look the code up again when that happened, and read its count every time round
+    uint32_t generation = event_state_ptr->generation;
+    bool handled = false;
+    event_state_ptr->fire_depth++;
+    for (uint32_t i = 0; ; i++) {
+        if (generation != event_state_ptr->generation) {
+            generation = event_state_ptr->generation;
+            index = find_code(code);
+            if (index == NO_CODE) {
+                break;
+            }
+        }
+        const EventCodeEntry& entry = event_state_ptr->codes[index];
+        if (i >= entry.count) {
+            break;
+        }
+
+        // Copied, the pool may grow while the listener runs
+        const EventDelegate delegate = event_state_ptr->listeners[entry.first + i];
+        handled = delegate.callback
+            ? call_boxed_callback(delegate, code, sender, context)
+            : delegate.on_event(code, sender, delegate.listener, context);
+        if (handled) {
             // message was handled if callback returned true
-            return true;
+            break;
         }
     }
+    event_state_ptr->fire_depth--;
 
-    return false;
+    if (event_state_ptr->fire_depth == 0 && !event_state_ptr->retired.empty()) {
+        for (CallbackFunc* callback : event_state_ptr->retired) {
+            delete callback;
+        }
+        event_state_ptr->retired.clear();
+    }
+    return handled;
+}
+
+bool EventHandler::Post(uint16_t code, void* sender, EventContext context) {
+    if (code >= MAX_MESSAGE_CODES) {
+        return false;
+    }
+
+    if (!event_state_ptr->queued.push(QueuedEvent { code, sender, context })) {
+        qlogger::Warn("EventHandler::Post: event queue is full, dropping event %u", code);
+        return false;
+    }
+    return true;
+}
+
+uint32_t EventHandler::DispatchQueued() {
+    // Take a snapshot first, so listeners that post do not keep this loop going
+    Vector<QueuedEvent>& batch = event_state_ptr->batch;
+    batch.clear();
+    QueuedEvent event;
+    while (event_state_ptr->queued.pop(event)) {
+        batch.push(event);
+    }
+
+    // Walk back from the newest, so the first of a coalesced code seen is the one that stays
+    uint64_t* seen = event_state_ptr->coalesce_seen;
+    for (uint64_t i = batch.size(); i-- > 0;) {
+        const uint16_t code = batch[i].code;
+        if (!bit_test(event_state_ptr->coalesced, code)) {
+            continue;
+        }
+        if (bit_test(seen, code)) {
+            batch[i].code = SUPERSEDED_EVENT;
+        } else {
+            bit_assign(seen, code, true);
+        }
+    }
+
+    uint32_t fired = 0;
+    for (const QueuedEvent& queued : batch) {
+        if (queued.code == SUPERSEDED_EVENT) {
+            continue;
+        }
+        bit_assign(seen, queued.code, false);
+        Fire(queued.code, queued.sender, queued.context);
+        fired++;
+    }
+    return fired;
+}
+
+void EventHandler::SetCoalesced(uint16_t code, bool coalesced) {
+    if (code < MAX_MESSAGE_CODES) {
+        bit_assign(event_state_ptr->coalesced, code, coalesced);
+    }
 }
 
 // Accessors
-bool EventHandler::GetInitialized() { return event_state_ptr->initialized; }
+bool EventHandler::GetInitialized() { return event_state_ptr && event_state_ptr->initialized; }
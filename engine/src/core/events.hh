@@ -7,10 +7,17 @@
  *  is registered for a given event will receive a message when an message for that event is fired
  */
 
-#include "stdafx.hh"
+#include "defines.hh"
+#include "containers/qring_queue.inl"
+#include "containers/qvector.inl"
+#include <cstdint>
 #include <functional>
 
 #define MAX_MESSAGE_CODES 16384
+// Codes are looked up a page of this many at a time, see EventState
+#define EVENT_CODE_PAGE_SIZE 256
+// Events that can be posted between two calls to DispatchQueued
+#define MAX_QUEUED_EVENTS 4096
 
 struct EventContext {
     union {
@@ -61,27 +68,58 @@ enum EventCodes {
     MAX_EVENT_CODE = 0xFF
 };
 
+typedef bool (*PFN_on_event)(uint16_t code, void* sender, void* listener, EventContext data);
 using  CallbackFunc = std::function <bool (uint16_t code, void* sender, void* listener, EventContext data)>;
 
-// Holds a pointer to the listener and the callback
-// function to be used to communicate to them
-struct RegisteredEvent {
+// One registered listener: a plain function pointer and the listener it is called with.
+// Listeners registered with a std::function keep it boxed on the side, so the
+// delegates stay small and firing never copies or allocates
+struct EventDelegate {
+    PFN_on_event on_event;
     void* listener;
-
-    CallbackFunc callback;
-    // bool (T::*callback)(uint16_t code, void* sender, void* listener, EventContext data);
+    CallbackFunc* callback; // nullptr unless registered with a CallbackFunc, owned by the delegate
 };
 
-// Holds a vector of registered events
+// The listeners for one code: count delegates starting at first in the listener pool
 struct EventCodeEntry {
-    
-    std::vector <RegisteredEvent>  events;
+    uint16_t code;
+    uint32_t first;
+    uint32_t count;
+};
+
+// An event posted for the next DispatchQueued
+struct QueuedEvent {
+    uint16_t code;
+    void* sender;
+    EventContext context;
 };
 
-// Holds an array of events
-// One for each event code
+// Only codes that have listeners take up space. codes is sorted by code, and listeners holds
+// every delegate grouped in the same order, so a code's listeners sit next to each other.
+// Fire finds a code's entry through a two level table: code_pages maps each page of
+// EVENT_CODE_PAGE_SIZE codes to a page of code_slots, which holds the entry's index plus one.
+// A page is only added once one of its codes gets a listener
 struct EventState {
-    EventCodeEntry registered[MAX_MESSAGE_CODES];
+    Vector<EventCodeEntry> codes;
+    Vector<EventDelegate> listeners;
+    // Page number plus one, 0 while none of the page's codes has had a listener
+    uint16_t code_pages[MAX_MESSAGE_CODES / EVENT_CODE_PAGE_SIZE] = {};
+    // Index in codes plus one for every code of every added page, 0 for codes without listeners
+    Vector<uint16_t> code_slots;
+    // Bumped on every Register and Unregister, so Fire notices when listeners move under it
+    uint32_t generation = 0;
+
+    // Posted from any thread, fired on the main thread by DispatchQueued
+    MPMCQueue<QueuedEvent> queued { MAX_QUEUED_EVENTS };
+    // Events taken off the queue for the dispatch in progress, reused every frame
+    Vector<QueuedEvent> batch;
+    // Codes where only the latest queued event is fired, and scratch bits for finding it
+    uint64_t coalesced[MAX_MESSAGE_CODES / 64] = {};
+    uint64_t coalesce_seen[MAX_MESSAGE_CODES / 64] = {};
+
+    // Callbacks unregistered while an event was firing, deleted once it is done
+    Vector<CallbackFunc*> retired;
+    uint32_t fire_depth = 0;
     bool initialized = false;
 };
 
@@ -91,9 +129,25 @@ class EventHandler {
     public:
         static bool Startup(uint64_t& memory_requirements, void* state);
         static void Shutdown();
+        // Registers to listen to events that are sent with the specified code.
+        // A listener is registered at most once per code, a second Register returns false.
+        // Codes must be below MAX_MESSAGE_CODES
+        static bool Register(uint16_t code, void* listener, PFN_on_event on_event);
         static bool Register(uint16_t code, void* listener, CallbackFunc callback);
         static bool Unregister(uint16_t code, void* listener);
         static bool Fire(uint16_t code, void* sender, EventContext context);
+
+        // Queue an event to be fired by the next DispatchQueued. Safe to call from any thread,
+        // which Fire is not. Returns false if the queue is full and the event was dropped
+        static bool Post(uint16_t code, void* sender, EventContext context);
+
+        // Fire everything posted so far, in order, on the calling thread. For coalesced codes only the
+        // latest event is fired. Events posted by listeners wait for the next call
+        // @return number of events fired
+        static uint32_t DispatchQueued();
+
+        // Only fire the latest of this code's queued events. On by default for mouse moves and resizes
+        static void SetCoalesced(uint16_t code, bool coalesced);
         static bool GetInitialized();
 //        static bool Startup() {
 //            if (event_state.initialized)
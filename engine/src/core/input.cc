@@ -54,7 +54,8 @@ InputHandler::ProcessResize(uint32_t w, uint32_t h) {
     data.u32[0] = static_cast<uint32_t>(w);
     data.u32[1] = static_cast<uint32_t>(h);
 
-    EventHandler::Fire(EVENT_CODE_RESIZED, nullptr, data);
+    // Window drags send a stream of these, only the final size matters
+    EventHandler::Post(EVENT_CODE_RESIZED, nullptr, data);
 }
 
 void
@@ -93,11 +94,11 @@ InputHandler::ProcessMouseMove(int32_t x, int32_t y) {
         input_state_ptr->mouseCurrent.x = x;
         input_state_ptr->mouseCurrent.y = y;
 
-        // TODO: fire an event
+        // Queued and coalesced, listeners see the latest position once per frame
         EventContext data = {};
         data.u16[0] = x;
         data.u16[1] = y;
-        EventHandler::Fire(EVENT_CODE_MOUSE_MOVED, nullptr, data);
+        EventHandler::Post(EVENT_CODE_MOUSE_MOVED, nullptr, data);
 
     }
 }
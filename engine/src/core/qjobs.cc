@@ -0,0 +1,457 @@
+#include "qjobs.hh"
+#include "core/qlogger.hh"
+#include "core/qmemory.hh"
+#include "core/qtask.hh"
+#include "containers/qring_queue.inl"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+
+// Jobs a single deque can hold before Run falls back to running them inline
+#define QJOB_DEQUE_CAPACITY 4096
+// Jobs waiting in the shared queue, submitted from threads without a deque or held back by a dependency
+#define QJOB_SHARED_CAPACITY 1024
+// Failed attempts to find work before a worker goes to sleep
+#define QJOB_SPIN_COUNT 64
+// How often a sleeping worker rechecks jobs parked on a ready check nobody signals
+#define QJOB_PARKED_POLL_MS 1
+
+struct queued_job {
+    PFN_job_entry entry;
+    void* data;
+    QJobCounter* counter;
+    PFN_job_ready ready;
+    void* ready_data;
+};
+
+// A slot may be read by a thief while the owner reuses it, so every field is atomic.
+// The thief's CAS on top rejects whatever it read in that case
+struct job_slot {
+    std::atomic<PFN_job_entry> entry;
+    std::atomic<void*> data;
+    std::atomic<QJobCounter*> counter;
+    std::atomic<PFN_job_ready> ready;
+    std::atomic<void*> ready_data;
+};
+
+// Chase-Lev deque with a fixed ring buffer (orderings from Le et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). The owner pushes and pops at the bottom, thieves take from the top
+struct job_deque {
+    alignas(QCACHE_LINE_SIZE) std::atomic<int64_t> top;
+    alignas(QCACHE_LINE_SIZE) std::atomic<int64_t> bottom;
+    alignas(QCACHE_LINE_SIZE) job_slot slots[QJOB_DEQUE_CAPACITY];
+
+    // Owner only
+    bool push(const queued_job& job);
+    bool pop(queued_job& out);
+
+    // Any thread
+    bool steal(queued_job& out);
+
+    void write_slot(int64_t index, const queued_job& job);
+    void read_slot(int64_t index, queued_job& out);
+};
+
+struct job_system_state {
+    uint32_t thread_count;
+    job_deque* deques; // one per thread, the main thread's is deques[0]
+    std::thread workers[QJOB_MAX_THREADS];
+    MPMCQueue<queued_job> shared;
+
+    std::atomic<bool> running;
+    std::atomic<uint32_t> sleeping;
+    std::atomic<uint64_t> wake_epoch;
+    std::mutex wake_lock;
+    std::condition_variable wake;
+    bool initialized;
+
+    job_system_state()
+        : thread_count(0),
+        deques(nullptr),
+        shared(QJOB_SHARED_CAPACITY, MEMORY_TAG_JOB),
+        running(false),
+        sleeping(0),
+        wake_epoch(0),
+        initialized(false)
+    {
+
+    }
+};
+
+static job_system_state* state_ptr = nullptr;
+static thread_local int32_t thread_index = -1;
+static thread_local uint32_t steal_seed = 0;
+
+//
+// job_deque
+//
+void
+job_deque::write_slot(int64_t index, const queued_job& job) {
+    job_slot& slot = slots[index & (QJOB_DEQUE_CAPACITY - 1)];
+    slot.entry.store(job.entry, std::memory_order_relaxed);
+    slot.data.store(job.data, std::memory_order_relaxed);
+    slot.counter.store(job.counter, std::memory_order_relaxed);
+    slot.ready.store(job.ready, std::memory_order_relaxed);
+    slot.ready_data.store(job.ready_data, std::memory_order_relaxed);
+}
+
+void
+job_deque::read_slot(int64_t index, queued_job& out) {
+    job_slot& slot = slots[index & (QJOB_DEQUE_CAPACITY - 1)];
+    out.entry = slot.entry.load(std::memory_order_relaxed);
+    out.data = slot.data.load(std::memory_order_relaxed);
+    out.counter = slot.counter.load(std::memory_order_relaxed);
+    out.ready = slot.ready.load(std::memory_order_relaxed);
+    out.ready_data = slot.ready_data.load(std::memory_order_relaxed);
+}
+
+bool
+job_deque::push(const queued_job& job) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    if (b - t >= QJOB_DEQUE_CAPACITY) {
+        return false;
+    }
+
+    write_slot(b, job);
+    bottom.store(b + 1, std::memory_order_release);
+    return true;
+}
+
+bool
+job_deque::pop(queued_job& out) {
+    // Claim the bottom slot first, then look at top. Both are seq_cst so a thief
+    // racing for the same last job sees one of the two updates
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    bottom.store(b, std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_seq_cst);
+
+    if (t > b) {
+        // Empty
+        bottom.store(b + 1, std::memory_order_release);
+        return false;
+    }
+
+    read_slot(b, out);
+    if (t == b) {
+        // Last job, race the thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release);
+        return won;
+    }
+    return true;
+}
+
+bool
+job_deque::steal(queued_job& out) {
+    int64_t t = top.load(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_seq_cst);
+    if (t >= b) {
+        return false;
+    }
+
+    read_slot(t, out);
+    return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+//
+// Scheduling
+//
+static void
+wake_workers(uint32_t count) {
+    state_ptr->wake_epoch.fetch_add(1, std::memory_order_seq_cst);
+    if (state_ptr->sleeping.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+
+    // Taking the lock orders this with a worker that is between checking the epoch and blocking
+    { std::lock_guard<std::mutex> lock(state_ptr->wake_lock); }
+    if (count > 1) {
+        state_ptr->wake.notify_all();
+    } else {
+        state_ptr->wake.notify_one();
+    }
+}
+
+static bool
+execute(const queued_job& job);
+
+static void
+enqueue(const queued_job& job) {
+    if (thread_index >= 0 && state_ptr->deques[thread_index].push(job)) {
+        return;
+    }
+    if (state_ptr->shared.push(job)) {
+        return;
+    }
+
+    // Every queue is full, run it here rather than drop it
+    execute(job);
+}
+
+static bool
+find_job(queued_job& out) {
+    if (thread_index >= 0 && state_ptr->deques[thread_index].pop(out)) {
+        return true;
+    }
+
+    // Start at a random victim so thieves spread out instead of all hitting deque 0
+    const uint32_t count = state_ptr->thread_count;
+    steal_seed = steal_seed * 1664525u + 1013904223u;
+    uint32_t start = (steal_seed >> 16) % count;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t victim = (start + i) % count;
+        if (static_cast<int32_t>(victim) != thread_index && state_ptr->deques[victim].steal(out)) {
+            return true;
+        }
+    }
+
+    return state_ptr->shared.pop(out);
+}
+
+static bool
+counter_done(void* data) {
+    return static_cast<const QJobCounter*>(data)->done();
+}
+
+// Returns false if the job was not ready and went back on the shared queue
+static bool
+execute(const queued_job& job) {
+    if (job.ready && !job.ready(job.ready_data)) {
+        // Not ready yet. Put it at the back of the shared queue so other work runs first
+        if (state_ptr && state_ptr->shared.push(job)) {
+            return false;
+        }
+        while (!job.ready(job.ready_data)) {
+            if (!JobSystem::RunPending()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    job.entry(job.data);
+
+    if (job.counter && job.counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Jobs waiting on this counter may be parked in the shared queue behind sleeping workers
+        if (state_ptr) {
+            wake_workers(state_ptr->thread_count);
+        }
+    }
+    return true;
+}
+
+static void
+worker_main(uint32_t index) {
+    thread_index = static_cast<int32_t>(index);
+    steal_seed = index * 2654435761u;
+
+    uint32_t misses = 0;
+    queued_job job;
+    while (state_ptr->running.load(std::memory_order_acquire)) {
+        if (find_job(job) && execute(job)) {
+            misses = 0;
+            continue;
+        }
+
+        if (++misses < QJOB_SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Nothing to do. Sleep until a submit or a shutdown moves the epoch on.
+        // Jobs parked on a ready check may become ready without a signal, so poll for those
+        state_ptr->sleeping.fetch_add(1, std::memory_order_seq_cst);
+        uint64_t epoch = state_ptr->wake_epoch.load(std::memory_order_seq_cst);
+        if (find_job(job)) {
+            state_ptr->sleeping.fetch_sub(1, std::memory_order_seq_cst);
+            execute(job);
+        } else {
+            auto woken = [epoch]() {
+                return state_ptr->wake_epoch.load(std::memory_order_seq_cst) != epoch ||
+                       !state_ptr->running.load(std::memory_order_acquire);
+            };
+            std::unique_lock<std::mutex> lock(state_ptr->wake_lock);
+            if (state_ptr->shared.size() > 0) {
+                state_ptr->wake.wait_for(lock, std::chrono::milliseconds(QJOB_PARKED_POLL_MS), woken);
+            } else {
+                state_ptr->wake.wait(lock, woken);
+            }
+            state_ptr->sleeping.fetch_sub(1, std::memory_order_seq_cst);
+        }
+        misses = 0;
+    }
+
+    thread_index = -1;
+}
+
+//
+// JobSystem
+//
+bool
+JobSystem::Startup(uint64_t& memory_requirements, void* state, uint32_t thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::thread::hardware_concurrency();
+    }
+    if (thread_count == 0) {
+        thread_count = 1;
+    }
+    if (thread_count > QJOB_MAX_THREADS) {
+        thread_count = QJOB_MAX_THREADS;
+    }
+
+    // The deques follow the state, aligned to a cache line
+    memory_requirements = sizeof(job_system_state) + QCACHE_LINE_SIZE + thread_count * sizeof(job_deque);
+    if (state == nullptr) {
+        return true;
+    }
+
+    if (state_ptr) {
+        qlogger::Error("JobSystem::Startup: called more than once");
+        return false;
+    }
+
+    state_ptr = new (static_cast<job_system_state*>(state)) job_system_state;
+    uintptr_t deque_memory = reinterpret_cast<uintptr_t>(state) + sizeof(job_system_state);
+    deque_memory = (deque_memory + QCACHE_LINE_SIZE - 1) & ~(uintptr_t)(QCACHE_LINE_SIZE - 1);
+    state_ptr->deques = reinterpret_cast<job_deque*>(deque_memory);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        job_deque* deque = new (&state_ptr->deques[i]) job_deque;
+        deque->top.store(0, std::memory_order_relaxed);
+        deque->bottom.store(0, std::memory_order_relaxed);
+    }
+
+    state_ptr->thread_count = thread_count;
+    state_ptr->running.store(true, std::memory_order_release);
+
+    // The calling thread is thread 0 and runs jobs whenever it waits
+    thread_index = 0;
+    steal_seed = 1;
+    for (uint32_t i = 1; i < thread_count; i++) {
+        state_ptr->workers[i] = std::thread(worker_main, i);
+    }
+
+    state_ptr->initialized = true;
+    qlogger::Info("Job system started with %u threads", thread_count);
+    return true;
+}
+
+void
+JobSystem::Shutdown() {
+    if (!state_ptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state_ptr->wake_lock);
+        state_ptr->running.store(false, std::memory_order_release);
+    }
+    state_ptr->wake.notify_all();
+
+    for (uint32_t i = 1; i < state_ptr->thread_count; i++) {
+        state_ptr->workers[i].join();
+    }
+
+    if (state_ptr->shared.size() != 0) {
+        qlogger::Warn("JobSystem::Shutdown: jobs were still queued");
+    }
+
+    state_ptr->~job_system_state();
+    state_ptr = nullptr;
+    thread_index = -1;
+}
+
+void
+JobSystem::Run(const QJob* jobs, uint32_t count, QJobCounter* counter) {
+    RunAfter(nullptr, jobs, count, counter);
+}
+
+void
+JobSystem::RunAfter(const QJobCounter* dependency, const QJob* jobs, uint32_t count, QJobCounter* counter) {
+    if (dependency) {
+        RunWhen(counter_done, const_cast<QJobCounter*>(dependency), jobs, count, counter);
+    } else {
+        RunWhen(nullptr, nullptr, jobs, count, counter);
+    }
+}
+
+void
+JobSystem::RunWhen(PFN_job_ready ready, void* ready_data, const QJob* jobs, uint32_t count, QJobCounter* counter) {
+    if (count == 0) {
+        return;
+    }
+
+    // Count the whole batch before any of it can finish
+    if (counter) {
+        counter->pending.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        queued_job job = { jobs[i].entry, jobs[i].data, counter, ready, ready_data };
+        if (!state_ptr) {
+            // No workers, run it now so callers behave the same before Startup
+            execute(job);
+            continue;
+        }
+        enqueue(job);
+    }
+
+    if (state_ptr) {
+        wake_workers(count);
+    }
+}
+
+void
+JobSystem::Spawn(QTask&& task, QJobCounter* counter) {
+    std::coroutine_handle<QTask::promise_type> handle = task.release();
+    if (!handle) {
+        return;
+    }
+
+    // The task signals the counter itself when it finishes, the job that starts it does not
+    handle.promise().counter = counter;
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    QJob job = { qtask_resume, handle.address() };
+    Run(&job, 1, nullptr);
+}
+
+bool
+JobSystem::RunPending() {
+    if (!state_ptr) {
+        return false;
+    }
+
+    queued_job job;
+    if (!find_job(job)) {
+        return false;
+    }
+    return execute(job);
+}
+
+void
+JobSystem::Wait(const QJobCounter* counter) {
+    while (!counter->done()) {
+        if (!RunPending()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+uint32_t
+JobSystem::ThreadCount() {
+    return state_ptr ? state_ptr->thread_count : 1;
+}
+
+int32_t
+JobSystem::ThreadIndex() {
+    return thread_index;
+}
+
+bool
+JobSystem::GetInitialized() {
+    return state_ptr && state_ptr->initialized;
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "defines.hh"
+#include <atomic>
+#include <cstdint>
+
+/*
+ *  Job system
+ *
+ *  A job is a function pointer and a pointer to its data. Jobs are handed to the system in batches
+ *  and run on a pool of worker threads, one per core. The main thread takes part as well whenever
+ *  it waits on a counter, so waiting never leaves a core idle.
+ *
+ *  Every worker owns a work-stealing deque (Chase-Lev). A thread pushes and pops jobs at the bottom
+ *  of its own deque, and idle threads steal from the top of someone else's. Threads that do not own
+ *  a deque submit through a shared queue.
+ *
+ *  Completion is tracked with counters. Run adds the number of jobs to the counter and each job
+ *  decrements it when it finishes, so a counter at zero means everything submitted with it is done.
+ *  A batch can also depend on a counter, or on any ready check: none of its jobs start until it passes.
+ *
+ *  Jobs that need to wait in the middle (on a counter, a file or a GPU fence) can be written as
+ *  coroutines, see core/qtask.hh. They are started with Spawn and give their thread back while suspended.
+ */
+
+#define QJOB_MAX_THREADS 32
+
+typedef void (*PFN_job_entry)(void* data);
+typedef bool (*PFN_job_ready)(void* data);
+
+class QTask;
+
+struct QJobCounter {
+    std::atomic<uint32_t> pending { 0 };
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+struct QJob {
+    PFN_job_entry entry;
+    void* data;
+};
+
+class QAPI JobSystem {
+    public:
+        /**
+         * @brief Set memory_requirements to the size of the job system state.
+         *     If state is nullptr only the requirement is set. Otherwise the worker threads
+         *     are started and the calling thread becomes the main thread of the job system
+         * @param thread_count total threads running jobs, including the main thread. 0 uses one per core
+         * @return true if the system was started
+        */
+        static bool Startup(uint64_t& memory_requirements, void* state, uint32_t thread_count = 0);
+
+        /**
+         * @brief Stop and join the worker threads. Every counter should be waited on before this
+        */
+        static void Shutdown();
+
+        /**
+         * @brief Queue count jobs on the calling thread's deque
+         * @param counter incremented by count now and decremented as each job finishes. May be nullptr
+        */
+        static void Run(const QJob* jobs, uint32_t count, QJobCounter* counter);
+
+        /**
+         * @brief Queue count jobs that must not start before dependency reaches zero
+        */
+        static void RunAfter(const QJobCounter* dependency, const QJob* jobs, uint32_t count, QJobCounter* counter);
+
+        /**
+         * @brief Queue count jobs that must not start before ready(ready_data) returns true.
+         *     ready is polled by whichever thread picks the jobs up, so it must be cheap and thread safe
+        */
+        static void RunWhen(PFN_job_ready ready, void* ready_data, const QJob* jobs, uint32_t count, QJobCounter* counter);
+
+        /**
+         * @brief Start a coroutine task. It runs on the job threads and can suspend on co_await
+         *     without holding a thread
+         * @param counter incremented now and decremented when the task runs to completion. May be nullptr
+        */
+        static void Spawn(QTask&& task, QJobCounter* counter);
+
+        /**
+         * @brief Run queued jobs on the calling thread until counter reaches zero.
+         *     Safe to call from inside a job
+        */
+        static void Wait(const QJobCounter* counter);
+
+        /**
+         * @brief Run one queued job on the calling thread, if there is one
+         * @return true if a job was run. Jobs found but not ready yet are put back and do not count
+        */
+        static bool RunPending();
+
+        // Threads running jobs, including the main thread
+        static uint32_t ThreadCount();
+
+        // 0 on the main thread, 1..ThreadCount()-1 on workers, -1 on threads the job system does not know
+        static int32_t ThreadIndex();
+
+        static bool GetInitialized();
+};
@@ -0,0 +1,400 @@
+#pragma once
+#include <cctype>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+/*
+ *  Binary log format
+ *
+ *  In binary mode a log call does not format anything. It records the address of its format string
+ *  and the raw values of its arguments, and the writer thread stores those in the log file. The text of
+ *  each format string is written the first time its address shows up. Expanding the messages is left
+ *  to the qlog_decode tool, which uses decode() below.
+ *
+ *  File layout, all values little endian:
+ *      header   u32 magic, u32 version
+ *      format   u8 ENTRY_FORMAT,  u64 format id, u32 length, text
+ *      message  u8 ENTRY_MESSAGE, u8 level, u64 sequence, u64 format id, u32 size, arguments
+ *      text     u8 ENTRY_TEXT,    u8 level, u64 sequence, u32 length, text
+ *
+ *  Arguments are a run of u8 tag followed by the value. Strings are copied, since the pointer is
+ *  meaningless by the time the file is read, which means every char pointer is taken to be a C string.
+ *
+ *  This header is shared by the engine and the decoder, so it only depends on the standard library.
+ */
+
+namespace qlog_binary
+{
+    static constexpr uint32_t FILE_MAGIC = 0x474F4C51; // "QLOG"
+    static constexpr uint32_t FILE_VERSION = 1;
+
+    // Space for the encoded arguments of one call. Strings are cut short to fit
+    static constexpr uint32_t MAX_ARGUMENT_BYTES = 512;
+
+    enum entry_kind : uint8_t {
+        ENTRY_FORMAT = 1,
+        ENTRY_MESSAGE = 2,
+        ENTRY_TEXT = 3,
+    };
+
+    enum argument_tag : uint8_t {
+        ARG_INT = 1,
+        ARG_UINT = 2,
+        ARG_DOUBLE = 3,
+        ARG_STRING = 4,
+        ARG_POINTER = 5,
+    };
+
+    inline const char*
+    level_string(uint32_t level) {
+        static const char* level_strings[6] = {
+            "[FATAL]",
+            "[ERROR]",
+            "[WARN]",
+            "[INFO]",
+            "[DEBUG]",
+            "[TRACE]",
+        };
+        return level < 6 ? level_strings[level] : "[?]";
+    }
+
+    template <typename T>
+    constexpr bool is_encodable() {
+        using U = std::remove_cv_t<std::remove_reference_t<T>>;
+        if constexpr (std::is_array_v<U>) {
+            return std::is_same_v<std::remove_cv_t<std::remove_extent_t<U>>, char>;
+        } else {
+            return std::is_arithmetic_v<U> || std::is_enum_v<U> || std::is_pointer_v<U> || std::is_null_pointer_v<U>;
+        }
+    }
+
+    // Packs arguments into a fixed buffer. Runs on the logging thread, so it only copies
+    struct argument_writer {
+        uint8_t* buffer;
+        uint32_t capacity;
+        uint32_t size;
+
+        void put_raw(argument_tag tag, const void* value, uint32_t length) {
+            if (size + 1 + length > capacity) {
+                return;
+            }
+            buffer[size] = tag;
+            memcpy(buffer + size + 1, value, length);
+            size += 1 + length;
+        }
+
+        void put_string(const char* text) {
+            if (!text) {
+                text = "(null)";
+            }
+            uint32_t length = static_cast<uint32_t>(strlen(text));
+            if (size + 5 > capacity) {
+                return;
+            }
+            if (size + 5 + length > capacity) {
+                length = capacity - size - 5;
+            }
+            buffer[size] = ARG_STRING;
+            memcpy(buffer + size + 1, &length, 4);
+            memcpy(buffer + size + 5, text, length);
+            size += 5 + length;
+        }
+
+        template <typename T>
+        void put(const T& value) {
+            using U = std::remove_cv_t<T>;
+            if constexpr (std::is_array_v<U>) {
+                put_string(value);
+            } else if constexpr (std::is_same_v<U, char*> || std::is_same_v<U, const char*>) {
+                put_string(value);
+            } else if constexpr (std::is_pointer_v<U> || std::is_null_pointer_v<U>) {
+                uint64_t address = reinterpret_cast<uintptr_t>(static_cast<const void*>(value));
+                put_raw(ARG_POINTER, &address, 8);
+            } else if constexpr (std::is_floating_point_v<U>) {
+                double number = static_cast<double>(value);
+                put_raw(ARG_DOUBLE, &number, 8);
+            } else if constexpr (std::is_signed_v<U> || std::is_enum_v<U>) {
+                int64_t number = static_cast<int64_t>(value);
+                put_raw(ARG_INT, &number, 8);
+            } else {
+                uint64_t number = static_cast<uint64_t>(value);
+                put_raw(ARG_UINT, &number, 8);
+            }
+        }
+    };
+
+    // Reads arguments back in order. Running out yields zeros and empty strings
+    struct argument_reader {
+        const uint8_t* data;
+        uint64_t size;
+        uint64_t position;
+
+        bool next(argument_tag& tag, uint64_t& bits, const char*& text, uint32_t& length) {
+            bits = 0;
+            text = "";
+            length = 0;
+            if (position >= size) {
+                tag = ARG_INT;
+                return false;
+            }
+
+            tag = static_cast<argument_tag>(data[position]);
+            if (tag == ARG_STRING) {
+                if (position + 5 > size) {
+                    position = size;
+                    return false;
+                }
+                memcpy(&length, data + position + 1, 4);
+                if (position + 5 + length > size) {
+                    length = static_cast<uint32_t>(size - position - 5);
+                }
+                text = reinterpret_cast<const char*>(data + position + 5);
+                position += 5 + length;
+                return true;
+            }
+
+            if (position + 9 > size) {
+                position = size;
+                return false;
+            }
+            memcpy(&bits, data + position + 1, 8);
+            position += 9;
+            return true;
+        }
+
+        int64_t next_integer() {
+            argument_tag tag;
+            uint64_t bits;
+            const char* text;
+            uint32_t length;
+            next(tag, bits, text, length);
+            if (tag == ARG_DOUBLE) {
+                double number;
+                memcpy(&number, &bits, 8);
+                return static_cast<int64_t>(number);
+            }
+            return static_cast<int64_t>(bits);
+        }
+    };
+
+    inline void
+    append_formatted(std::string& out, const char* spec, ...) {
+        char buffer[256];
+        va_list args;
+        va_start(args, spec);
+        int32_t length = vsnprintf(buffer, sizeof(buffer), spec, args);
+        va_end(args);
+        if (length < 0) {
+            return;
+        }
+        if (length < static_cast<int32_t>(sizeof(buffer))) {
+            out.append(buffer, length);
+            return;
+        }
+
+        std::string large(length + 1, '\0');
+        va_start(args, spec);
+        vsnprintf(large.data(), length + 1, spec, args);
+        va_end(args);
+        out.append(large.data(), length);
+    }
+
+    /**
+     * @brief Expand a printf style format string with arguments recorded by argument_writer.
+     *     Each conversion takes the next argument and is printed with the widest type of its kind,
+     *     so the recorded type does not have to match the conversion exactly
+    */
+    inline void
+    format_message(const char* format, const uint8_t* arguments, uint64_t size, std::string& out) {
+        argument_reader reader = { arguments, size, 0 };
+        const char* c = format;
+        while (*c) {
+            if (*c != '%') {
+                const char* run = c;
+                while (*c && *c != '%') {
+                    c++;
+                }
+                out.append(run, c - run);
+                continue;
+            }
+            if (c[1] == '%') {
+                out.push_back('%');
+                c += 2;
+                continue;
+            }
+
+            // Rebuild the conversion without its length modifier, adding our own below
+            char spec[32];
+            uint32_t spec_length = 0;
+            spec[spec_length++] = *c++;
+            while (*c && strchr("-+ #0", *c) && spec_length < 20) {
+                spec[spec_length++] = *c++;
+            }
+            int32_t star_values[2];
+            uint32_t stars = 0;
+            while (*c && (isdigit(static_cast<unsigned char>(*c)) || *c == '.' || *c == '*') && spec_length < 28) {
+                if (*c == '*') {
+                    star_values[stars < 2 ? stars : 1] = static_cast<int32_t>(reader.next_integer());
+                    stars++;
+                }
+                spec[spec_length++] = *c++;
+            }
+            while (*c && strchr("hlLqjzt", *c)) {
+                c++;
+            }
+            char conversion = *c;
+            if (!conversion) {
+                break;
+            }
+            c++;
+
+            argument_tag tag;
+            uint64_t bits;
+            const char* text;
+            uint32_t length;
+            reader.next(tag, bits, text, length);
+
+            double number = 0.0;
+            if (tag == ARG_DOUBLE) {
+                memcpy(&number, &bits, 8);
+            }
+            int64_t integer = tag == ARG_DOUBLE ? static_cast<int64_t>(number) : static_cast<int64_t>(bits);
+
+            switch (conversion) {
+                case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': {
+                    spec[spec_length++] = 'l';
+                    spec[spec_length++] = 'l';
+                    spec[spec_length++] = conversion;
+                    spec[spec_length] = '\0';
+                    if (stars == 2) {
+                        append_formatted(out, spec, star_values[0], star_values[1], integer);
+                    } else if (stars == 1) {
+                        append_formatted(out, spec, star_values[0], integer);
+                    } else {
+                        append_formatted(out, spec, integer);
+                    }
+                } break;
+                case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': {
+                    if (tag != ARG_DOUBLE) {
+                        number = tag == ARG_INT ? static_cast<double>(integer) : static_cast<double>(bits);
+                    }
+                    spec[spec_length++] = conversion;
+                    spec[spec_length] = '\0';
+                    if (stars == 2) {
+                        append_formatted(out, spec, star_values[0], star_values[1], number);
+                    } else if (stars == 1) {
+                        append_formatted(out, spec, star_values[0], number);
+                    } else {
+                        append_formatted(out, spec, number);
+                    }
+                } break;
+                case 'c': {
+                    spec[spec_length++] = 'c';
+                    spec[spec_length] = '\0';
+                    append_formatted(out, spec, static_cast<int32_t>(integer));
+                } break;
+                case 's': {
+                    std::string value = tag == ARG_STRING ? std::string(text, length) : std::string("(?)");
+                    spec[spec_length++] = 's';
+                    spec[spec_length] = '\0';
+                    if (stars == 2) {
+                        append_formatted(out, spec, star_values[0], star_values[1], value.c_str());
+                    } else if (stars == 1) {
+                        append_formatted(out, spec, star_values[0], value.c_str());
+                    } else {
+                        append_formatted(out, spec, value.c_str());
+                    }
+                } break;
+                case 'p': {
+                    if (tag == ARG_STRING) {
+                        out.append(text, length);
+                    } else {
+                        append_formatted(out, "%p", reinterpret_cast<void*>(static_cast<uintptr_t>(bits)));
+                    }
+                } break;
+                default:
+                    // %n and anything unknown print nothing
+                    break;
+            }
+        }
+    }
+
+    /**
+     * @brief Turn a binary log file into text, one "[LEVEL]message" line per entry
+     * @return false if the data is not a binary log or is cut short. Everything before that point is still decoded
+    */
+    inline bool
+    decode(const uint8_t* data, uint64_t size, std::string& out) {
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        if (size < 8) {
+            return false;
+        }
+        memcpy(&magic, data, 4);
+        memcpy(&version, data + 4, 4);
+        if (magic != FILE_MAGIC || version != FILE_VERSION) {
+            return false;
+        }
+
+        // Format ids are addresses in the process that wrote the file. Keep the latest text for each
+        std::unordered_map<uint64_t, std::string> formats;
+
+        uint64_t position = 8;
+        while (position < size) {
+            uint8_t kind = data[position];
+            if (kind == ENTRY_FORMAT) {
+                if (position + 13 > size) {
+                    return false;
+                }
+                uint64_t id;
+                uint32_t length;
+                memcpy(&id, data + position + 1, 8);
+                memcpy(&length, data + position + 9, 4);
+                if (position + 13 + length > size) {
+                    return false;
+                }
+                formats[id].assign(reinterpret_cast<const char*>(data + position + 13), length);
+                position += 13 + length;
+            } else if (kind == ENTRY_MESSAGE) {
+                if (position + 22 > size) {
+                    return false;
+                }
+                uint8_t level = data[position + 1];
+                uint64_t id;
+                uint32_t arguments_size;
+                memcpy(&id, data + position + 10, 8);
+                memcpy(&arguments_size, data + position + 18, 4);
+                if (position + 22 + arguments_size > size) {
+                    return false;
+                }
+                out.append(level_string(level));
+                auto format = formats.find(id);
+                format_message(format != formats.end() ? format->second.c_str() : "(unknown format)", data + position + 22, arguments_size, out);
+                out.push_back('\n');
+                position += 22 + arguments_size;
+            } else if (kind == ENTRY_TEXT) {
+                if (position + 14 > size) {
+                    return false;
+                }
+                uint8_t level = data[position + 1];
+                uint32_t length;
+                memcpy(&length, data + position + 10, 4);
+                if (position + 14 + length > size) {
+                    return false;
+                }
+                out.append(level_string(level));
+                out.append(reinterpret_cast<const char*>(data + position + 14), length);
+                out.push_back('\n');
+                position += 14 + length;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+} // qlog_binary
@@ -2,137 +2,559 @@
 #include "qmemory.hh"
 #include "platform/platform.hh"
 #include "platform/file_system.hh"
+#include "core/qjobs.hh"
 #include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <cstring>
+#include <mutex>
 #include <string>
+#include <thread>
+
+// Bytes of log records each thread can have waiting for the writer
+#define QLOG_RING_SIZE (64 * 1024)
+// Threads that can have a ring of their own at the same time: every job system thread, the main
+// thread included, plus a few more. Rings are handed back when a thread exits, and threads that find
+// them all taken share one extra ring behind a lock
+#define QLOG_MAX_THREADS (QJOB_MAX_THREADS + 8)
+// Longest message kept, longer ones are truncated
+#define QLOG_MAX_MESSAGE 32000
+// Messages that fit here are formatted without touching the heap
+#define QLOG_STACK_MESSAGE 1024
+// The writer drains at least this often even when nobody wakes it
+#define QLOG_WRITER_INTERVAL_MS 4
+// File output is gathered into batches of this size before being written
+#define QLOG_FILE_BATCH (64 * 1024)
+
+// Format ids remembered by the writer, so each format string is written to a binary log once
+#define QLOG_FORMAT_CACHE 4096
 
 namespace qlogger 
 {
+    // Header of a message in a ring. The text follows, and the record is padded to 16 bytes
+    // so a header never wraps around the end of the buffer
+    struct log_record {
+        uint64_t sequence;
+        uint32_t length;
+        uint32_t level;
+    };
+
+    // Marks the unused space at the end of the buffer when a record did not fit there
+    static constexpr uint32_t LOG_RECORD_PADDING = 0xFFFFFFFF;
+    // Set in log_record::level when the record holds a format pointer and encoded arguments instead of text
+    static constexpr uint32_t LOG_RECORD_BINARY = 0x100;
+
+    // Single producer (the owning thread), single consumer (the writer) byte ring
+    struct log_ring {
+        alignas(64) std::atomic<uint64_t> tail;
+        alignas(64) std::atomic<uint64_t> head;
+        // Where head was when the writer last finished writing and syncing the file. Flush waits on this
+        alignas(64) std::atomic<uint64_t> written;
+        alignas(64) std::atomic<bool> in_use;
+        alignas(16) uint8_t buffer[QLOG_RING_SIZE];
+    };
+
     struct logger_system_state {
         QFilesystem::QFile log_file_handle;
+        log_format format;
+
+        // rings[0] is shared by the threads that could not get one, the rest belong to one thread each
+        log_ring rings[QLOG_MAX_THREADS + 1];
+        std::atomic<uint32_t> ring_count; // shared ring plus the rings handed out at least once, the writer only scans these
+        std::mutex shared_ring_lock;
+        std::atomic<uint64_t> next_sequence;
+
+        std::thread writer;
+        std::mutex writer_lock;
+        std::condition_variable writer_wake;
+        std::atomic<bool> running;
+
+        char file_batch[QLOG_FILE_BATCH];
+        uint64_t file_batch_length;
+
+        // Binary mode only. Direct mapped, a collision just writes the format again
+        uint64_t written_formats[QLOG_FORMAT_CACHE];
     };
 
     static logger_system_state* state_ptr;
 
-    void 
-    append_to_log_file(std::string message) {
+    // Lives outside the state so it can be set before Initialize
+    static std::atomic<uint32_t> runtime_level { LOG_LEVEL_TRACE };
+
+    // Bumped on every Initialize so threads notice their ring belongs to an older logger
+    static std::atomic<uint32_t> logger_generation { 0 };
+
+    // Gives the ring back when its thread exits
+    struct ring_claim {
+        log_ring* ring = nullptr;
+        uint32_t generation = 0;
+
+        ~ring_claim() {
+            if (ring && state_ptr && generation == logger_generation.load(std::memory_order_acquire)) {
+                ring->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    static thread_local ring_claim thread_ring;
+    static thread_local bool is_writer_thread = false;
+
+    // Serializes output that does not go through a ring: from the writer thread itself, or outside
+    // Initialize/Shutdown. Only the writer adds to file_batch, so this does not cover it
+    static std::mutex direct_output_lock;
+
+    static void writer_main();
+
+    static uint64_t
+    record_size(uint64_t length) {
+        return (sizeof(log_record) + length + 15) & ~uint64_t(15);
+    }
+
+    void
+    append_to_log_file(const char* message, uint64_t length) {
         if (state_ptr && state_ptr->log_file_handle.is_valid) {
-            uint64_t length = message.length();
             uint64_t written = 0;
-            if (!state_ptr->log_file_handle.write(length, (void*)message.data(), written)) {
+            if (!state_ptr->log_file_handle.write(length, message, written)) {
                 Platform::ConsoleError("ERROR: unable to write to console.log\n", LOG_LEVEL_ERROR);
             }
         }
     }
 
-    bool 
-    Initialize(uint64_t& memory_requirement, void* state) {
+    // Add bytes to the pending file output
+    static void
+    batch_append(const void* data, uint64_t length) {
+        if (state_ptr->file_batch_length + length > QLOG_FILE_BATCH) {
+            append_to_log_file(state_ptr->file_batch, state_ptr->file_batch_length);
+            state_ptr->file_batch_length = 0;
+        }
+        if (length > QLOG_FILE_BATCH) {
+            append_to_log_file(static_cast<const char*>(data), length);
+            return;
+        }
+        QAllocator::Copy(state_ptr->file_batch + state_ptr->file_batch_length, data, length);
+        state_ptr->file_batch_length += length;
+    }
+
+    bool
+    Initialize(uint64_t& memory_requirement, void* state, const char* log_path, log_format format) {
         memory_requirement = sizeof(logger_system_state);
         if (state == nullptr) {
             return false;
         }
         // TODO: be able to configure files and other outputs
         state_ptr = new (static_cast<logger_system_state*>(state)) logger_system_state;
+        state_ptr->ring_count.store(1, std::memory_order_relaxed);
+        state_ptr->next_sequence.store(0, std::memory_order_relaxed);
+        state_ptr->file_batch_length = 0;
+        state_ptr->format = format;
+        QAllocator::Zero(state_ptr->written_formats, sizeof(state_ptr->written_formats));
+        for (uint32_t i = 0; i < QLOG_MAX_THREADS + 1; i++) {
+            state_ptr->rings[i].tail.store(0, std::memory_order_relaxed);
+            state_ptr->rings[i].head.store(0, std::memory_order_relaxed);
+            state_ptr->rings[i].written.store(0, std::memory_order_relaxed);
+            state_ptr->rings[i].in_use.store(false, std::memory_order_relaxed);
+        }
+        logger_generation.fetch_add(1, std::memory_order_acq_rel);
 
-        if (!state_ptr->log_file_handle.open("console.log", QFilesystem::FILE_MODE_WRITE, false)) {
+        if (!state_ptr->log_file_handle.open(log_path, QFilesystem::FILE_MODE_WRITE, format == LOG_FORMAT_BINARY)) {
             Platform::ConsoleError("ERRROR: Unable to open console.log for writing", LOG_LEVEL_ERROR);
+            state_ptr = nullptr;
             return false;
         }
+
+        if (format == LOG_FORMAT_BINARY) {
+            uint32_t header[2] = { qlog_binary::FILE_MAGIC, qlog_binary::FILE_VERSION };
+            batch_append(header, sizeof(header));
+        }
+
+        state_ptr->running.store(true, std::memory_order_release);
+        state_ptr->writer = std::thread(writer_main);
         return true;
     }
 
-    // Release the state pointer. 
-    // This memory is owned somewhere else
-    void 
+    // Write out everything still queued and stop the writer.
+    // The state memory is owned somewhere else
+    void
     Shutdown(void* state) {
+        (void)state;
+        if (!state_ptr) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(state_ptr->writer_lock);
+            state_ptr->running.store(false, std::memory_order_release);
+        }
+        state_ptr->writer_wake.notify_one();
+        state_ptr->writer.join();
+
+        if (state_ptr->log_file_handle.is_valid) {
+            state_ptr->log_file_handle.close();
+        }
+
+        // Messages logged from here on are written directly
+        logger_system_state* old_state = state_ptr;
         state_ptr = nullptr;
-        // TODO: likely close file descriptors
-        return;
+        old_state->~logger_system_state();
     }
 
-    void log_output(log_level level, const char* message, va_list args) {
-        // TODO: Split into a different thread once threading 
-        //    and job assignment is available
-        const char* level_strings[6] = {
-            "[FATAL]",
-            "[ERROR]",
-            "[WARN]",
-            "[INFO]",
-            "[DEBUG]",
-            "[TRACE]",
-        };
+    static void
+    wake_writer() {
+        state_ptr->writer_wake.notify_one();
+    }
 
-        bool is_error = level > LOG_LEVEL_WARN;
+    // Find this thread a ring, reusing one an exited thread gave back
+    static log_ring*
+    claim_ring() {
+        uint32_t generation = logger_generation.load(std::memory_order_acquire);
+        if (thread_ring.ring && thread_ring.generation == generation) {
+            return thread_ring.ring;
+        }
+
+        for (uint32_t i = 1; i < QLOG_MAX_THREADS + 1; i++) {
+            bool expected = false;
+            if (state_ptr->rings[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                // Publish the ring to the writer
+                uint32_t count = state_ptr->ring_count.load(std::memory_order_acquire);
+                while (count < i + 1 && !state_ptr->ring_count.compare_exchange_weak(count, i + 1, std::memory_order_acq_rel)) {
+                }
+                thread_ring.ring = &state_ptr->rings[i];
+                thread_ring.generation = generation;
+                return thread_ring.ring;
+            }
+        }
+        return nullptr;
+    }
 
-        // Massive buffer to avoid runtime allcoations that are slow
-        constexpr size_t message_length = 32000;
-        char error_message[message_length];
-        QAllocator::Zero(error_message, message_length);
+    // Append a record made of two pieces, the second may be empty
+    static void
+    ring_push(log_ring* ring, uint32_t level, const void* first, uint64_t first_length, const void* second, uint64_t second_length) {
+        const uint64_t length = first_length + second_length;
+        const uint64_t size = record_size(length);
+        const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        const uint64_t offset = tail & (QLOG_RING_SIZE - 1);
+        const uint64_t contiguous = QLOG_RING_SIZE - offset;
+        const uint64_t needed = contiguous < size ? contiguous + size : size;
+
+        // Full. Let the writer catch up rather than drop the message
+        while (tail + needed - ring->head.load(std::memory_order_acquire) > QLOG_RING_SIZE) {
+            wake_writer();
+            std::this_thread::yield();
+        }
 
-        // Format the message
-        vsnprintf(error_message, message_length, message, args);
+        uint64_t position = tail;
+        if (contiguous < size) {
+            log_record padding = { 0, 0, LOG_RECORD_PADDING };
+            QAllocator::Copy(&ring->buffer[offset], &padding, sizeof(log_record));
+            position += contiguous;
+        }
+
+        log_record record = {
+            state_ptr->next_sequence.fetch_add(1, std::memory_order_relaxed),
+            static_cast<uint32_t>(length),
+            level,
+        };
+        uint8_t* destination = &ring->buffer[position & (QLOG_RING_SIZE - 1)];
+        QAllocator::Copy(destination, &record, sizeof(log_record));
+        QAllocator::Copy(destination + sizeof(log_record), first, first_length);
+        if (second_length) {
+            QAllocator::Copy(destination + sizeof(log_record) + first_length, second, second_length);
+        }
+        ring->tail.store(position + size, std::memory_order_release);
 
-        // Prepend the error message level to the message string
-        char out_message[message_length];
-        QAllocator::Zero(out_message, message_length);
-        sprintf(out_message, "%s%s\n", level_strings[level], error_message);
+        // Wake the writer early once the ring is half full, otherwise it picks this up on its next pass
+        if (position + size - ring->head.load(std::memory_order_relaxed) > QLOG_RING_SIZE / 2) {
+            wake_writer();
+        }
+    }
 
-        // Print the error message
+    // Print one finished line. out_message must end with a newline and a terminator
+    static void
+    write_line(log_level level, const char* out_message, uint64_t length) {
+        bool is_error = level > LOG_LEVEL_WARN;
         if (is_error) {
             Platform::ConsoleError(out_message, level);
         } else {
             Platform::ConsoleWrite(out_message, level);
         }
 
-        append_to_log_file(out_message);
+        // The binary log gets its own entries from the writer
+        if (!state_ptr || state_ptr->format == LOG_FORMAT_BINARY) {
+            return;
+        }
+        batch_append(out_message, length);
     }
 
-    void 
-    Fatal(const char* message, ...) {
-        va_list args;
-        va_start(args, message);
-        log_output(LOG_LEVEL_FATAL, message, args);
-        va_end(args);
+    // Prefix the level, add a newline and print
+    static void
+    write_message(log_level level, const char* text, uint64_t length) {
+        char stack_line[QLOG_STACK_MESSAGE + 16];
+        std::string heap_line;
+
+        const char* prefix = qlog_binary::level_string(level);
+        uint64_t prefix_length = strlen(prefix);
+        uint64_t line_length = prefix_length + length + 1;
+
+        char* line = stack_line;
+        if (line_length + 1 > sizeof(stack_line)) {
+            heap_line.resize(line_length + 1);
+            line = heap_line.data();
+        }
+        QAllocator::Copy(line, prefix, prefix_length);
+        QAllocator::Copy(line + prefix_length, text, length);
+        line[line_length - 1] = '\n';
+        line[line_length] = '\0';
+        write_line(level, line, line_length);
     }
 
-    void 
-    Error(const char* message, ...) {
-        va_list args;
-        va_start(args, message);
-        log_output(LOG_LEVEL_ERROR, message, args);
-        va_end(args);
+    // Binary mode: store the record as it is, plus the format text the first time it shows up
+    static void
+    write_binary_record(const log_record* record) {
+        const uint8_t* payload = reinterpret_cast<const uint8_t*>(record + 1);
+        const uint8_t level = static_cast<uint8_t>(record->level & 0xFF);
+
+        if (!(record->level & LOG_RECORD_BINARY)) {
+            uint8_t header[14] = { qlog_binary::ENTRY_TEXT, level };
+            QAllocator::Copy(header + 2, &record->sequence, 8);
+            QAllocator::Copy(header + 10, &record->length, 4);
+            batch_append(header, sizeof(header));
+            batch_append(payload, record->length);
+            if (level <= LOG_LEVEL_WARN) {
+                write_message(static_cast<log_level>(level), reinterpret_cast<const char*>(payload), record->length);
+            }
+            return;
+        }
+
+        const char* format;
+        QAllocator::Copy(&format, payload, sizeof(format));
+        const uint64_t id = reinterpret_cast<uintptr_t>(format);
+        const uint8_t* arguments = payload + sizeof(format);
+        const uint32_t arguments_size = record->length - sizeof(format);
+
+        uint64_t& cached = state_ptr->written_formats[(id >> 3) & (QLOG_FORMAT_CACHE - 1)];
+        if (cached != id) {
+            uint32_t length = static_cast<uint32_t>(strlen(format));
+            uint8_t header[13] = { qlog_binary::ENTRY_FORMAT };
+            QAllocator::Copy(header + 1, &id, 8);
+            QAllocator::Copy(header + 9, &length, 4);
+            batch_append(header, sizeof(header));
+            batch_append(format, length);
+            cached = id;
+        }
+
+        uint8_t header[22] = { qlog_binary::ENTRY_MESSAGE, level };
+        QAllocator::Copy(header + 2, &record->sequence, 8);
+        QAllocator::Copy(header + 10, &id, 8);
+        QAllocator::Copy(header + 18, &arguments_size, 4);
+        batch_append(header, sizeof(header));
+        batch_append(arguments, arguments_size);
+
+        // Problems still show up on the console right away
+        if (level <= LOG_LEVEL_WARN) {
+            std::string text;
+            qlog_binary::format_message(format, arguments, arguments_size, text);
+            write_message(static_cast<log_level>(level), text.data(), text.size());
+        }
     }
 
-    void 
-    Warn(const char* message, ...) {
-        va_list args;
-        va_start(args, message);
-        log_output(LOG_LEVEL_WARN, message, args);
-        va_end(args);
+    // Write every record that is in the rings right now, oldest first across all threads
+    static void
+    drain_rings() {
+        const uint32_t ring_count = state_ptr->ring_count.load(std::memory_order_acquire);
+        uint64_t heads[QLOG_MAX_THREADS + 1];
+        uint64_t tails[QLOG_MAX_THREADS + 1];
+        for (uint32_t i = 0; i < ring_count; i++) {
+            heads[i] = state_ptr->rings[i].head.load(std::memory_order_relaxed);
+            tails[i] = state_ptr->rings[i].tail.load(std::memory_order_acquire);
+        }
+
+        for (;;) {
+            // Pick the ring whose next record was logged first
+            int32_t oldest = -1;
+            uint64_t oldest_sequence = 0;
+            for (uint32_t i = 0; i < ring_count; i++) {
+                log_ring& ring = state_ptr->rings[i];
+                while (heads[i] != tails[i]) {
+                    uint64_t offset = heads[i] & (QLOG_RING_SIZE - 1);
+                    const log_record* record = reinterpret_cast<const log_record*>(&ring.buffer[offset]);
+                    if (record->level != LOG_RECORD_PADDING) {
+                        if (oldest < 0 || record->sequence < oldest_sequence) {
+                            oldest = static_cast<int32_t>(i);
+                            oldest_sequence = record->sequence;
+                        }
+                        break;
+                    }
+                    heads[i] += QLOG_RING_SIZE - offset;
+                    ring.head.store(heads[i], std::memory_order_release);
+                }
+            }
+
+            if (oldest < 0) {
+                break;
+            }
+
+            log_ring& ring = state_ptr->rings[oldest];
+            const log_record* record = reinterpret_cast<const log_record*>(&ring.buffer[heads[oldest] & (QLOG_RING_SIZE - 1)]);
+            if (state_ptr->format == LOG_FORMAT_BINARY) {
+                write_binary_record(record);
+            } else {
+                write_message(static_cast<log_level>(record->level), reinterpret_cast<const char*>(record + 1), record->length);
+            }
+            heads[oldest] += record_size(record->length);
+            ring.head.store(heads[oldest], std::memory_order_release);
+        }
+
+        // One write and one sync for everything gathered in this pass
+        bool wrote = false;
+        for (uint32_t i = 0; i < ring_count; i++) {
+            wrote = wrote || heads[i] != state_ptr->rings[i].written.load(std::memory_order_relaxed);
+        }
+        if (state_ptr->file_batch_length) {
+            append_to_log_file(state_ptr->file_batch, state_ptr->file_batch_length);
+            state_ptr->file_batch_length = 0;
+        }
+        if (wrote && state_ptr->log_file_handle.is_valid) {
+            state_ptr->log_file_handle.sync();
+        }
+
+        // Only now is everything up to heads on disk
+        for (uint32_t i = 0; i < ring_count; i++) {
+            state_ptr->rings[i].written.store(heads[i], std::memory_order_release);
+        }
     }
 
-    void 
-    Info(const char* message, ...) {
-        va_list args;
-        va_start(args, message);
-        log_output(LOG_LEVEL_INFO, message, args);
-        va_end(args);
+    static void
+    writer_main() {
+        is_writer_thread = true;
+        while (state_ptr->running.load(std::memory_order_acquire)) {
+            drain_rings();
+
+            std::unique_lock<std::mutex> lock(state_ptr->writer_lock);
+            state_ptr->writer_wake.wait_for(lock, std::chrono::milliseconds(QLOG_WRITER_INTERVAL_MS));
+        }
+
+        // Whatever was logged before Shutdown
+        drain_rings();
+        is_writer_thread = false;
     }
 
-    void 
-    Debug(const char* message, ...) {
-        va_list args;
-        va_start(args, message);
-        log_output(LOG_LEVEL_DEBUG, message, args);
-        va_end(args);
+    void
+    Flush() {
+        if (!state_ptr || is_writer_thread) {
+            return;
+        }
+
+        // Threads without a ring of their own logged through the shared one
+        log_ring* ring = &state_ptr->rings[0];
+        if (thread_ring.ring && thread_ring.generation == logger_generation.load(std::memory_order_acquire)) {
+            ring = thread_ring.ring;
+        }
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        while (ring->written.load(std::memory_order_acquire) < tail) {
+            wake_writer();
+            std::this_thread::yield();
+        }
+    }
+
+    void
+    SetLevel(log_level level) {
+        runtime_level.store(level, std::memory_order_relaxed);
+    }
+
+    log_level
+    GetLevel() {
+        return static_cast<log_level>(runtime_level.load(std::memory_order_relaxed));
+    }
+
+    log_route
+    Route(log_level level) {
+        if (level > runtime_level.load(std::memory_order_relaxed)) {
+            return LOG_ROUTE_SKIP;
+        }
+        if (state_ptr && state_ptr->format == LOG_FORMAT_BINARY) {
+            return LOG_ROUTE_BINARY;
+        }
+        return LOG_ROUTE_TEXT;
+    }
+
+    // Hand a record to the writer through this thread's ring, or the shared ring when they are all taken.
+    // Returns false when the message has to be written directly: from the writer thread, and anything
+    // logged outside Initialize/Shutdown
+    static bool
+    queue_record(uint32_t level, const void* first, uint64_t first_length, const void* second, uint64_t second_length) {
+        if (!state_ptr || is_writer_thread) {
+            return false;
+        }
+
+        log_ring* ring = claim_ring();
+        if (ring) {
+            ring_push(ring, level, first, first_length, second, second_length);
+            return true;
+        }
+
+        std::lock_guard<std::mutex> lock(state_ptr->shared_ring_lock);
+        ring_push(&state_ptr->rings[0], level, first, first_length, second, second_length);
+        return true;
+    }
+
+    void log_output(log_level level, const char* message, va_list args) {
+        // Format on the stack, only going to the heap for very long messages
+        char stack_message[QLOG_STACK_MESSAGE];
+        std::string heap_message;
+
+        va_list args_copy;
+        va_copy(args_copy, args);
+        int32_t length = vsnprintf(stack_message, sizeof(stack_message), message, args);
+        const char* text = stack_message;
+        if (length < 0) {
+            va_end(args_copy);
+            return;
+        }
+        if (length >= static_cast<int32_t>(sizeof(stack_message))) {
+            if (length > QLOG_MAX_MESSAGE) {
+                length = QLOG_MAX_MESSAGE;
+            }
+            heap_message.resize(length + 1);
+            vsnprintf(heap_message.data(), length + 1, message, args_copy);
+            text = heap_message.data();
+        }
+        va_end(args_copy);
+
+        if (!queue_record(level, text, length, nullptr, 0)) {
+            std::lock_guard<std::mutex> lock(direct_output_lock);
+            write_message(level, text, length);
+            return;
+        }
+
+        // The process is likely about to go down, make sure this one is out
+        if (level == LOG_LEVEL_FATAL) {
+            Flush();
+        }
     }
 
     void 
-    Trace(const char* message, ...) {
+    LogText(log_level level, const char* message, ...) {
         va_list args;
         va_start(args, message);
-        log_output(LOG_LEVEL_TRACE, message, args);
+        log_output(level, message, args);
         va_end(args);
     }
 
-} // logger
\ No newline at end of file
+    void
+    LogBinary(log_level level, const char* message, const void* arguments, uint32_t size) {
+        if (!queue_record(level | LOG_RECORD_BINARY, &message, sizeof(message), arguments, size)) {
+            std::string text;
+            qlog_binary::format_message(message, static_cast<const uint8_t*>(arguments), size, text);
+            std::lock_guard<std::mutex> lock(direct_output_lock);
+            write_message(level, text.data(), text.size());
+            return;
+        }
+
+        if (level == LOG_LEVEL_FATAL) {
+            Flush();
+        }
+    }
+
+} // logger
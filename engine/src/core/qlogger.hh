@@ -1,6 +1,15 @@
 #pragma once
 #include "defines.hh"
+#include "core/qlog_binary.hh"
 #include <cstdint>
+#include <type_traits>
+
+// Calls below this level are compiled out. Define it before including this header, or on the
+// command line, e.g. -DQLOG_COMPILE_LEVEL=3 keeps Info and above.
+// Arguments of a compiled out call are still evaluated, so keep side effects out of log calls
+#ifndef QLOG_COMPILE_LEVEL
+#define QLOG_COMPILE_LEVEL 5
+#endif
 
 namespace qlogger 
 {
@@ -13,24 +22,96 @@ namespace qlogger
         LOG_LEVEL_TRACE = 5,
     };
 
+    enum log_format : uint32_t {
+        // Messages are formatted when logged and written out as text
+        LOG_FORMAT_TEXT = 0,
+        // Messages are stored as format string and raw arguments, see core/qlog_binary.hh.
+        // Only Warn and above are also formatted for the console. Decode the file with qlog_decode
+        LOG_FORMAT_BINARY = 1,
+    };
+
+    // What a log call at a given level should do, see Route
+    enum log_route : uint32_t {
+        LOG_ROUTE_SKIP = 0,
+        LOG_ROUTE_TEXT = 1,
+        LOG_ROUTE_BINARY = 2,
+    };
+
 
     /**
      * @brief Set the memory requirement's value to the space needed to allocate the logger system state
      *     If state is nullptr, then we only set memory requirements and return
      *     Call twice, once to get the requirement. Second to initialize the system
+     *     Messages are formatted on the calling thread and written out by a background writer thread
+     * @param log_path file every message is also written to
+     * @param format text, or binary for the cheapest possible log calls
      * @return true if we initialized. False if not
     */
-    bool Initialize(uint64_t& memory_requirement, void* state);
+    bool Initialize(uint64_t& memory_requirement, void* state, const char* log_path = "console.log",
+                    log_format format = LOG_FORMAT_TEXT);
 
     /**
-     * @brief Set the state to a nullptr
+     * @brief Write out everything still queued, stop the writer thread and set the state to a nullptr.
+     *     Messages logged after this are written directly by the calling thread
     */
     void Shutdown(void* state);
 
-    void QAPI Fatal(const char* message, ...);
-    void QAPI Error(const char* message, ...);
-    void QAPI Warn(const char* message, ...);
-    void QAPI Info(const char* message, ...);
-    void QAPI Debug(const char* message, ...);
-    void QAPI Trace(const char* message, ...);
-} // qlogger
\ No newline at end of file
+    /**
+     * @brief Block until every message this thread logged so far is in the log file and synced to
+     *     disk. Fatal messages call it before returning
+    */
+    void QAPI Flush();
+
+    /**
+     * @brief Messages above level are dropped before any formatting. Defaults to LOG_LEVEL_TRACE
+    */
+    void QAPI SetLevel(log_level level);
+    log_level QAPI GetLevel();
+
+    /**
+     * @brief Whether a message at level is dropped, formatted as text or recorded in binary
+    */
+    log_route QAPI Route(log_level level);
+
+    // Entry points behind Fatal..Trace. Prefer those, they check the level first
+    void QAPI LogText(log_level level, const char* message, ...);
+    void QAPI LogBinary(log_level level, const char* message, const void* arguments, uint32_t size);
+
+    template <log_level Level, typename Format, typename... Args>
+    static inline void
+    log(const Format& message, const Args&... args) {
+        if constexpr (Level <= QLOG_COMPILE_LEVEL) {
+            log_route route = Route(Level);
+            if (route == LOG_ROUTE_SKIP) {
+                return;
+            }
+
+            // Binary records keep a pointer to the format string, so it has to be a literal.
+            // Anything else (a char buffer, a const char*) is formatted as text
+            if constexpr (std::is_array_v<Format> && std::is_const_v<std::remove_extent_t<Format>> &&
+                          (qlog_binary::is_encodable<Args>() && ...)) {
+                if (route == LOG_ROUTE_BINARY) {
+                    uint8_t arguments[qlog_binary::MAX_ARGUMENT_BYTES];
+                    qlog_binary::argument_writer writer = { arguments, qlog_binary::MAX_ARGUMENT_BYTES, 0 };
+                    (writer.put(args), ...);
+                    LogBinary(Level, message, arguments, writer.size);
+                    return;
+                }
+            }
+            LogText(Level, message, args...);
+        }
+    }
+
+    template <typename Format, typename... Args>
+    static inline void Fatal(const Format& message, const Args&... args) { log<LOG_LEVEL_FATAL>(message, args...); }
+    template <typename Format, typename... Args>
+    static inline void Error(const Format& message, const Args&... args) { log<LOG_LEVEL_ERROR>(message, args...); }
+    template <typename Format, typename... Args>
+    static inline void Warn(const Format& message, const Args&... args) { log<LOG_LEVEL_WARN>(message, args...); }
+    template <typename Format, typename... Args>
+    static inline void Info(const Format& message, const Args&... args) { log<LOG_LEVEL_INFO>(message, args...); }
+    template <typename Format, typename... Args>
+    static inline void Debug(const Format& message, const Args&... args) { log<LOG_LEVEL_DEBUG>(message, args...); }
+    template <typename Format, typename... Args>
+    static inline void Trace(const Format& message, const Args&... args) { log<LOG_LEVEL_TRACE>(message, args...); }
+} // qlogger
@@ -1,24 +1,162 @@
 #include "qmemory.hh"
 #include "platform/platform.hh"
 #include "core/qlogger.hh"
+#include "memory/qsize_class_allocator.hh"
+#include "memory/qallocation_tracker.hh"
 #include <iostream>
 #include <memory>
 #include <cstdlib>
+#include <atomic>
 
+// Counters owned by a single thread. Only that thread writes to them, so updates are plain
+// relaxed load/store pairs with no lock prefix. Readers merge every shard.
+// Values are signed because a block can be freed on a different thread than it was allocated on
+struct stats_shard {
+    std::atomic<int64_t>  tagged_allocations[MEMORY_TAG_MAX_TAGS];
+    std::atomic<uint64_t> tagged_counts[MEMORY_TAG_MAX_TAGS];
+    // Highest tagged_allocations value since the last merge, so spikes between merges are not lost.
+    // Raised by the owner with a plain store, taken and reset by readers with an exchange
+    std::atomic<int64_t>  tagged_highs[MEMORY_TAG_MAX_TAGS];
+    std::atomic<uint64_t> num_allocs;
+    std::atomic<bool>     in_use;
+    stats_shard* next;
+    char padding[64]; // keep the next shard off this cache line
+};
+
+// Merged view of the shards. Each reader merges into its own copy
 struct memory_stats {
     uint64_t total_allocated;
     uint64_t tagged_allocations[MEMORY_TAG_MAX_TAGS];
+    uint64_t tagged_peaks[MEMORY_TAG_MAX_TAGS];
+    uint64_t tagged_counts[MEMORY_TAG_MAX_TAGS];
 };
 
 struct memory_state {
-    memory_stats stats;
-    uint64_t num_allocs;
+    // Shared between readers on any thread
+    std::atomic<uint64_t> tagged_peaks[MEMORY_TAG_MAX_TAGS];
+    std::atomic<float>    tagged_allocation_rates[MEMORY_TAG_MAX_TAGS];
+    std::atomic<float>    tagged_byte_rates[MEMORY_TAG_MAX_TAGS];
+
+    // Values at the last Update, used to work out the rates. Only touched by Update
+    double sample_time;
+    uint64_t sampled_counts[MEMORY_TAG_MAX_TAGS];
+    uint64_t sampled_bytes[MEMORY_TAG_MAX_TAGS];
 };
 
 static memory_state* state_ptr = nullptr;
 // static memory_stats stats {};
 // static memory_stats *stats = nullptr;
 
+// Shards are never freed. A thread that exits hands its shard back to be adopted by the next new thread,
+// so the list only grows to the peak number of threads that allocated at the same time
+static std::atomic<stats_shard*> shard_list { nullptr };
+
+// Returns the shard to the pool when its thread exits
+struct shard_owner {
+    stats_shard* shard = nullptr;
+    ~shard_owner() {
+        if (shard) {
+            shard->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+static thread_local shard_owner t_shard;
+
+static stats_shard*
+acquire_shard() {
+    // Adopt a shard left behind by a thread that has exited
+    for (stats_shard* shard = shard_list.load(std::memory_order_acquire); shard; shard = shard->next) {
+        bool expected = false;
+        if (!shard->in_use.load(std::memory_order_relaxed) &&
+            shard->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return shard;
+        }
+    }
+
+    // Shards come straight from the platform since QAllocator is what is being tracked
+    stats_shard* shard = new (Platform::Allocate(sizeof(stats_shard), false)) stats_shard;
+    for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
+        shard->tagged_allocations[i].store(0, std::memory_order_relaxed);
+        shard->tagged_counts[i].store(0, std::memory_order_relaxed);
+        shard->tagged_highs[i].store(0, std::memory_order_relaxed);
+    }
+    shard->num_allocs.store(0, std::memory_order_relaxed);
+    shard->in_use.store(true, std::memory_order_relaxed);
+
+    stats_shard* head = shard_list.load(std::memory_order_relaxed);
+    do {
+        shard->next = head;
+    } while (!shard_list.compare_exchange_weak(head, shard, std::memory_order_release, std::memory_order_relaxed));
+
+    return shard;
+}
+
+static inline stats_shard*
+thread_shard() {
+    if (!t_shard.shard) {
+        t_shard.shard = acquire_shard();
+    }
+    return t_shard.shard;
+}
+
+// Single-writer increment, no read-modify-write needed
+template <typename T, typename V>
+static inline void
+shard_add(std::atomic<T>& counter, V amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + static_cast<T>(amount), std::memory_order_relaxed);
+}
+
+// Add to a shard's allocated bytes and keep its high water mark
+static inline void
+shard_allocated(stats_shard* shard, memory_tag tag, int64_t amount) {
+    const int64_t allocated = shard->tagged_allocations[tag].load(std::memory_order_relaxed) + amount;
+    shard->tagged_allocations[tag].store(allocated, std::memory_order_relaxed);
+    if (allocated > shard->tagged_highs[tag].load(std::memory_order_relaxed)) {
+        // A reader resetting the mark at the same time only delays this value to the next merge
+        shard->tagged_highs[tag].store(allocated, std::memory_order_relaxed);
+    }
+}
+
+// Raise peak to at least value
+static inline void
+atomic_max(std::atomic<uint64_t>& peak, uint64_t value) {
+    uint64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Fold all shards into stats and raise the shared peaks.
+// The peak is the sum of every shard's high water mark since the last merge. That is exact when one
+// thread allocates between merges, and never lower than the real peak when several do
+static void
+merge_shards(memory_stats& stats) {
+    int64_t tagged[MEMORY_TAG_MAX_TAGS] = {};
+    int64_t highs[MEMORY_TAG_MAX_TAGS] = {};
+    uint64_t counts[MEMORY_TAG_MAX_TAGS] = {};
+    for (stats_shard* shard = shard_list.load(std::memory_order_acquire); shard; shard = shard->next) {
+        for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
+            const int64_t allocated = shard->tagged_allocations[i].load(std::memory_order_relaxed);
+            const int64_t high = shard->tagged_highs[i].exchange(allocated, std::memory_order_relaxed);
+            tagged[i] += allocated;
+            highs[i] += high > allocated ? high : allocated;
+            counts[i] += shard->tagged_counts[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    stats.total_allocated = 0;
+    for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
+        // A reader can catch a free on one thread before the matching allocation on another
+        stats.tagged_allocations[i] = tagged[i] > 0 ? static_cast<uint64_t>(tagged[i]) : 0;
+        stats.tagged_counts[i] = counts[i];
+        stats.total_allocated += stats.tagged_allocations[i];
+
+        atomic_max(state_ptr->tagged_peaks[i], highs[i] > 0 ? static_cast<uint64_t>(highs[i]) : 0);
+        atomic_max(state_ptr->tagged_peaks[i], stats.tagged_allocations[i]);
+        stats.tagged_peaks[i] = state_ptr->tagged_peaks[i].load(std::memory_order_relaxed);
+    }
+}
+
 static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "UNKNOWN    ",
     "ARRAY      ",
@@ -38,6 +176,7 @@ static const char* memory_tag_strings[MEMORY_TAG_MAX_TAGS] = {
     "ENTITY     ",
     "ENTITY_NODE",
     "SCENE      ",
+    "FILE_IO    ",
 };
 
 void 
@@ -48,52 +187,113 @@ QAllocator::Initialize(uint64_t& memory_requirements, void* state) {
     }
 
     state_ptr = new (static_cast<memory_state*>(state)) memory_state;
-    state_ptr->num_allocs = 0;
-    QAllocator::Zero(&state_ptr->stats, sizeof(state_ptr->stats));
+    for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
+        state_ptr->tagged_peaks[i].store(0, std::memory_order_relaxed);
+        state_ptr->tagged_allocation_rates[i].store(0.0f, std::memory_order_relaxed);
+        state_ptr->tagged_byte_rates[i].store(0.0f, std::memory_order_relaxed);
+    }
+    QAllocator::Zero(state_ptr->sampled_counts, sizeof(state_ptr->sampled_counts));
+    QAllocator::Zero(state_ptr->sampled_bytes, sizeof(state_ptr->sampled_bytes));
+    state_ptr->sample_time = Platform::get_absolute_time();
+
+    // Opt in only, tracking serializes every allocation on one lock
+    const char* track = std::getenv("PEGASUS_TRACK_ALLOCATIONS");
+    if (track && track[0] != '\0' && track[0] != '0') {
+        QAllocator::SetTracking(true);
+    }
+
+    // Start counting from zero. Expected to run before any other thread allocates
+    for (stats_shard* shard = shard_list.load(std::memory_order_acquire); shard; shard = shard->next) {
+        for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
+            shard->tagged_allocations[i].store(0, std::memory_order_relaxed);
+            shard->tagged_counts[i].store(0, std::memory_order_relaxed);
+            shard->tagged_highs[i].store(0, std::memory_order_relaxed);
+        }
+        shard->num_allocs.store(0, std::memory_order_relaxed);
+    }
 }
 
 void 
 QAllocator::Shutdown() {
+    if (qmemory::QAllocationTracker::IsEnabled()) {
+        std::string report = QAllocator::GetLeakReport();
+        qlogger::Warn("%s", report.c_str());
+        QAllocator::SetTracking(false);
+    }
+
     state_ptr = nullptr;
 }
 
 void*
-QAllocator::Allocate(uint64_t count, uint64_t size, memory_tag tag) {
+QAllocator::Allocate(uint64_t count, uint64_t size, memory_tag tag, const char* file, uint32_t line) {
+    return QAllocator::AllocateAligned(count, size, qmemory::QSizeClassAllocator::default_alignment, tag, file, line);
+}
+
+void*
+QAllocator::AllocateZeroed(uint64_t count, uint64_t size, memory_tag tag, const char* file, uint32_t line) {
+    void* block = QAllocator::AllocateAligned(count, size, qmemory::QSizeClassAllocator::default_alignment, tag, file, line);
+    return QAllocator::Zero(block, count * size);
+}
+
+void*
+QAllocator::AllocateAligned(uint64_t count, uint64_t size, uint64_t alignment, memory_tag tag, const char* file, uint32_t line) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         qlogger::Warn("Allocating using unknown tag");
     }
 
     if (state_ptr != nullptr) {
-        state_ptr->stats.total_allocated += size * count;
-        state_ptr->stats.tagged_allocations[tag] += size * count;
-        state_ptr->num_allocs++;
+        stats_shard* shard = thread_shard();
+        shard_allocated(shard, tag, static_cast<int64_t>(size * count));
+        shard_add(shard->tagged_counts[tag], 1);
+        shard_add(shard->num_allocs, 1);
     } else {
         qlogger::Warn("QAllocator::Allocate attempted allocation before memory subsystem is initialized");
     }
 
-    // TODO: align memory
-    // void* block = malloc(size);
-    // QAllocator::Zero(block, size);
-    void* block;
-    // block = std::calloc(count, size);
-    block = Platform::Allocate(size * count, false);
+    void* block = qmemory::QSizeClassAllocator::Allocate(size * count, alignment);
     if (!block) {
         throw std::bad_alloc{}; 
     }
 
-    Platform::ZeroMem(block, count * size);
-
+    qmemory::QAllocationTracker::OnAllocate(block, size * count, tag, file, line);
     return block;
 }
 
+void*
+QAllocator::Reallocate(void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag tag, const char* file, uint32_t line) {
+    if (!block) {
+        return QAllocator::AllocateAligned(1, new_size, alignment, tag, file, line);
+    }
+
+    uint32_t old_class = qmemory::QSizeClassAllocator::ClassIndex(old_size, alignment);
+    if (old_class != qmemory::QSizeClassAllocator::class_count &&
+        old_class == qmemory::QSizeClassAllocator::ClassIndex(new_size, alignment)) {
+        // Same size class, the block already has room
+        if (state_ptr != nullptr) {
+            stats_shard* shard = thread_shard();
+            shard_allocated(shard, tag, static_cast<int64_t>(new_size) - static_cast<int64_t>(old_size));
+        }
+        qmemory::QAllocationTracker::OnFree(block, old_size);
+        qmemory::QAllocationTracker::OnAllocate(block, new_size, tag, file, line);
+        return block;
+    }
+
+    void* new_block = QAllocator::AllocateAligned(1, new_size, alignment, tag, file, line);
+    QAllocator::Copy(new_block, block, old_size < new_size ? old_size : new_size);
+    QAllocator::FreeAligned(block, old_size, alignment, tag);
+    return new_block;
+}
+
 template <typename T> void
 QAllocator::Delete(T* block, uint64_t size, memory_tag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         qlogger::Warn("Deallocating using unknown tag");
     }
 
-    state_ptr->stats.total_allocated -= size;
-    state_ptr->stats.tagged_allocations[tag] -= size;
+    if (state_ptr != nullptr) {
+        stats_shard* shard = thread_shard();
+        shard_add(shard->tagged_allocations[tag], -static_cast<int64_t>(size));
+    }
 
     // TODO: align memory
     delete[] block;
@@ -103,17 +303,22 @@ QAllocator::Delete(T* block, uint64_t size, memory_tag tag) {
 
 void 
 QAllocator::Free(void* block, uint64_t size, memory_tag tag) {
+    QAllocator::FreeAligned(block, size, qmemory::QSizeClassAllocator::default_alignment, tag);
+}
+
+void 
+QAllocator::FreeAligned(void* block, uint64_t size, uint64_t alignment, memory_tag tag) {
     if (tag == MEMORY_TAG_UNKNOWN) {
         qlogger::Warn("Deallocating using unknown tag");
     }
 
     if (state_ptr != nullptr) {
-        state_ptr->stats.total_allocated -= size;
-        state_ptr->stats.tagged_allocations[tag] -= size;
+        stats_shard* shard = thread_shard();
+        shard_add(shard->tagged_allocations[tag], -static_cast<int64_t>(size));
     }
 
-    // TODO: align memory
-    free(block);
+    qmemory::QAllocationTracker::OnFree(block, size);
+    qmemory::QSizeClassAllocator::Free(block, size, alignment);
 }
 
 void*
@@ -131,36 +336,102 @@ QAllocator::Set(void* dst, int32_t value, uint64_t size) {
     return memset(dst, value, size);
 }
 
-std::string 
-QAllocator::GetUsageString(){
+void
+QAllocator::Update() {
+    if (state_ptr == nullptr) {
+        return;
+    }
+
+    memory_stats stats;
+    merge_shards(stats);
+    qmemory::QAllocationTracker::NextFrame();
+
+    double now = Platform::get_absolute_time();
+    double elapsed = now - state_ptr->sample_time;
+    if (elapsed <= 0.0) {
+        return;
+    }
+    state_ptr->sample_time = now;
+
+    for (uint32_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
+        uint64_t new_allocs = stats.tagged_counts[i] - state_ptr->sampled_counts[i];
+        int64_t  byte_delta = static_cast<int64_t>(stats.tagged_allocations[i]) - static_cast<int64_t>(state_ptr->sampled_bytes[i]);
+        state_ptr->tagged_allocation_rates[i].store(static_cast<float>(new_allocs / elapsed), std::memory_order_relaxed);
+        state_ptr->tagged_byte_rates[i].store(static_cast<float>(byte_delta / elapsed), std::memory_order_relaxed);
+        state_ptr->sampled_counts[i] = stats.tagged_counts[i];
+        state_ptr->sampled_bytes[i] = stats.tagged_allocations[i];
+    }
+}
+
+memory_tag_stats
+QAllocator::GetTagStats(memory_tag tag) {
+    memory_tag_stats out = {};
+    if (state_ptr == nullptr || tag >= MEMORY_TAG_MAX_TAGS) {
+        return out;
+    }
+
+    memory_stats stats;
+    merge_shards(stats);
+    out.allocated = stats.tagged_allocations[tag];
+    out.peak = stats.tagged_peaks[tag];
+    out.allocation_count = stats.tagged_counts[tag];
+    out.allocations_per_second = state_ptr->tagged_allocation_rates[tag].load(std::memory_order_relaxed);
+    out.bytes_per_second = state_ptr->tagged_byte_rates[tag].load(std::memory_order_relaxed);
+    return out;
+}
+
+// Pick a unit for a byte count
+static float
+scale_bytes(uint64_t bytes, char unit[4]) {
     const uint64_t gib = 1024 * 1024 * 1024;
     const uint64_t mib = 1024 * 1024;
     const uint64_t kib = 1024;
 
-    char buffer[8000] = "System memory use (tagged):\n";
+    unit[1] = 'i';
+    unit[2] = 'B';
+    unit[3] = 0;
+    if (bytes >= gib) {
+        unit[0] = 'G';
+        return bytes / (static_cast<float>(gib));
+    } else if (bytes >= mib) {
+        unit[0] = 'M';
+        return bytes / (static_cast<float>(mib));
+    } else if (bytes >= kib) {
+        unit[0] = 'K';
+        return bytes / (static_cast<float>(kib));
+    }
+
+    unit[0] = 'B';
+    unit[1] = 0;
+    return static_cast<float>(bytes);
+}
+
+std::string 
+QAllocator::GetUsageString(){
+    constexpr uint64_t buffer_size = 8000;
+    char buffer[buffer_size] = "System memory use (tagged):\n";
     uint64_t offset = strlen(buffer);
-    
+
+    if (state_ptr == nullptr) {
+        return buffer;
+    }
+    memory_stats stats;
+    merge_shards(stats);
+
     for (uint64_t i = 0; i < MEMORY_TAG_MAX_TAGS; i++) {
-        char unit[4] = "Xib";
-        float amount = 1.0f;
-
-        // Check for which unit we should be using
-        if (state_ptr->stats.tagged_allocations[i] >= gib) {
-            unit[0] = 'G';
-            amount = state_ptr->stats.tagged_allocations[i] / (static_cast<float>(gib));
-        } else if (state_ptr->stats.tagged_allocations[i] >= mib) {
-            unit[0] = 'M';
-            amount = state_ptr->stats.tagged_allocations[i] / (static_cast<float>(mib));
-        } else if (state_ptr->stats.tagged_allocations[i] >= kib) {
-            unit[0] = 'K';
-            amount = state_ptr->stats.tagged_allocations[i] / (static_cast<float>(kib));
-        } else {
-            unit[0] = 'B';
-            unit[1] = 0;
-            amount = static_cast<float>(state_ptr->stats.tagged_allocations[i]);
-        }
+        char unit[4];
+        char peak_unit[4];
+        float amount = scale_bytes(stats.tagged_allocations[i], unit);
+        float peak = scale_bytes(stats.tagged_peaks[i], peak_unit);
 
-        int32_t length = snprintf(buffer + offset, 8000, " %s: %.2f%s\n", memory_tag_strings[i], amount, unit);
+        int32_t length = snprintf(
+            buffer + offset, buffer_size - offset,
+            " %s: %.2f%s (peak %.2f%s, %.1f allocs/s)\n",
+            memory_tag_strings[i], amount, unit, peak, peak_unit,
+            state_ptr->tagged_allocation_rates[i].load(std::memory_order_relaxed));
+        if (length < 0 || offset + length >= buffer_size) {
+            break;
+        }
         offset += length;
     }
 
@@ -170,5 +441,83 @@ QAllocator::GetUsageString(){
 
 uint64_t
 QAllocator::AllocationCount() {
-    return (state_ptr != nullptr) ? state_ptr->num_allocs : 0;
-}
\ No newline at end of file
+    if (state_ptr == nullptr) {
+        return 0;
+    }
+
+    uint64_t count = 0;
+    for (stats_shard* shard = shard_list.load(std::memory_order_acquire); shard; shard = shard->next) {
+        count += shard->num_allocs.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+void
+QAllocator::SetTracking(bool enabled) {
+    if (enabled) {
+        qmemory::QAllocationTracker::Enable();
+    } else {
+        qmemory::QAllocationTracker::Disable();
+    }
+}
+
+bool
+QAllocator::IsTracking() {
+    return qmemory::QAllocationTracker::IsEnabled();
+}
+
+// Shared formatting for the tracker reports
+static std::string
+format_site_report(const char* title, const qmemory::allocation_site_report* sites, uint32_t count, bool live) {
+    constexpr uint64_t buffer_size = 8000;
+    char buffer[buffer_size];
+    int32_t offset = snprintf(buffer, buffer_size, "%s\n", title);
+
+    for (uint32_t i = 0; i < count && offset < static_cast<int32_t>(buffer_size); i++) {
+        char unit[4];
+        float amount = scale_bytes(sites[i].bytes, unit);
+
+        int32_t length = 0;
+        if (live) {
+            length = snprintf(
+                buffer + offset, buffer_size - offset,
+                " %s %s:%u: %.2f%s in %llu blocks (oldest from frame %llu)\n",
+                memory_tag_strings[sites[i].tag], sites[i].file, sites[i].line, amount, unit,
+                sites[i].count, sites[i].first_frame);
+        } else {
+            length = snprintf(
+                buffer + offset, buffer_size - offset,
+                " %s %s:%u: %llu allocations, %.2f%s\n",
+                memory_tag_strings[sites[i].tag], sites[i].file, sites[i].line,
+                sites[i].count, amount, unit);
+        }
+        if (length < 0 || offset + length >= static_cast<int32_t>(buffer_size)) {
+            break;
+        }
+        offset += length;
+    }
+
+    return buffer;
+}
+
+std::string
+QAllocator::GetLeakReport(uint32_t max_sites) {
+    if (!qmemory::QAllocationTracker::IsEnabled()) {
+        return "Allocation tracking is off";
+    }
+
+    qmemory::allocation_site_report sites[64];
+    uint32_t count = qmemory::QAllocationTracker::LiveSites(sites, max_sites < 64 ? max_sites : 64);
+    return format_site_report("Live allocations by call site:", sites, count, true);
+}
+
+std::string
+QAllocator::GetTopAllocatorsString(uint32_t max_sites) {
+    if (!qmemory::QAllocationTracker::IsEnabled()) {
+        return "Allocation tracking is off";
+    }
+
+    qmemory::allocation_site_report sites[64];
+    uint32_t count = qmemory::QAllocationTracker::FrameSites(sites, max_sites < 64 ? max_sites : 64);
+    return format_site_report("Top allocators last frame:", sites, count, false);
+}
@@ -22,21 +22,69 @@ enum memory_tag : uint32_t {
     MEMORY_TAG_ENTITY,
     MEMORY_TAG_ENTITY_NODE,
     MEMORY_TAG_SCENE,
+    MEMORY_TAG_FILE_IO,
 
     MEMORY_TAG_MAX_TAGS,
 };
 
+// Snapshot of the statistics for one memory tag
+struct memory_tag_stats {
+    uint64_t allocated;           // bytes currently allocated
+    uint64_t peak;                // highest value of allocated since Initialize, including spikes between reads
+    uint64_t allocation_count;    // allocations made since Initialize
+    float allocations_per_second; // measured between the last two calls to Update
+    float bytes_per_second;       // net change in allocated bytes between the last two calls to Update
+};
+
+// Call site of an allocation, filled in through default arguments so existing callers
+// do not change. Supported by clang, gcc and msvc (19.26+)
+#define Q_CALLER_FILE __builtin_FILE()
+#define Q_CALLER_LINE __builtin_LINE()
+
 class QAPI QAllocator {
     public:
         static void Initialize(uint64_t& memory_requirements, void* state);
         static void Shutdown();
 
         static uint64_t AllocationCount();
-        static void* Allocate(uint64_t count, uint64_t size, memory_tag tag);
+
+        // Counters are kept per thread and merged when read, so stats stay correct when
+        // allocating from worker threads. Each shard keeps its own high water mark, so peaks
+        // do not depend on how often they are read. Update samples the rates.
+        // Call it once per frame from the main thread
+        static void Update();
+        static memory_tag_stats GetTagStats(memory_tag tag);
+
+        // Allocations are 16 byte aligned and NOT zeroed. Use AllocateZeroed when cleared memory is needed.
+        // Free must be given the same size (and alignment) that the block was allocated with.
+        static void* Allocate(uint64_t count, uint64_t size, memory_tag tag,
+                              const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+        static void* AllocateZeroed(uint64_t count, uint64_t size, memory_tag tag,
+                                    const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+        static void* AllocateAligned(uint64_t count, uint64_t size, uint64_t alignment, memory_tag tag,
+                                     const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
+        // Resize a block, keeping its first min(old_size, new_size) bytes. Returns the same block when
+        // the new size still fits its size class. Contents are moved with memcpy, so trivially copyable data only
+        static void* Reallocate(void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag tag,
+                                const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE);
         static void  Free(void* block, uint64_t size, memory_tag tag);
+        static void  FreeAligned(void* block, uint64_t size, uint64_t alignment, memory_tag tag);
         static void* Zero(void* block, uint64_t size);
         static void* Copy(void* dst, const void* source, uint64_t size);
         static void* Set(void* dst, int32_t value, uint64_t size);
         template <typename T> static void Delete(T* block, uint64_t size, memory_tag tag);
         static std::string GetUsageString();
+
+        // Call-site tracking, for finding leaks and the code behind per-frame allocations.
+        // Every live block is recorded with its call site, size, tag and frame number.
+        // Every tracked allocation and free takes one global lock, so it is off by default in all
+        // builds. Turn it on with SetTracking, or by starting with PEGASUS_TRACK_ALLOCATIONS=1
+        // in the environment. Frames advance on Update
+        static void SetTracking(bool enabled);
+        static bool IsTracking();
+
+        // Live allocations grouped by call site, largest first. Logged by Shutdown while tracking
+        static std::string GetLeakReport(uint32_t max_sites = 16);
+        // Call sites that allocated the most during the last completed frame
+        static std::string GetTopAllocatorsString(uint32_t max_sites = 10);
 };
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+#include "defines.hh"
+#include "core/qjobs.hh"
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+/*
+ *  Coroutine jobs
+ *
+ *  A QTask is a coroutine that runs on the job system. Where a plain job would have to block its
+ *  thread to wait, a task co_awaits instead: it is suspended, its thread goes back to running other
+ *  jobs, and it is queued again once whatever it waits on is ready. It may resume on a different thread.
+ *
+ *      QTask load_shader(shader_load* load) {
+ *          QJobCounter read;
+ *          JobSystem::Run(&load->read_job, 1, &read);
+ *          co_await QWaitCounter { &read };
+ *          co_await QWaitUntil { fence_signaled, load->fence };
+ *          ...
+ *      }
+ *
+ *      JobSystem::Spawn(load_shader(&load), &loads_done);
+ *
+ *  Tasks do not start until they are spawned. A task that is never spawned is destroyed with its QTask.
+ *  The coroutine frame is allocated with operator new and freed when the task finishes.
+ */
+
+// Job entry that resumes the coroutine whose address is data
+inline void
+qtask_resume(void* data) {
+    std::coroutine_handle<>::from_address(data).resume();
+}
+
+class QTask {
+public:
+    struct promise_type {
+        QJobCounter* counter = nullptr;
+
+        // Frees the frame, then signals the counter so a waiter never sees it done before the frame is gone
+        struct final_awaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                QJobCounter* counter = handle.promise().counter;
+                handle.destroy();
+                if (counter) {
+                    counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+                }
+            }
+            void await_resume() noexcept {}
+        };
+
+        QTask get_return_object() { return QTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        final_awaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    QTask(QTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    ~QTask() {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    QTask(const QTask&) = delete;
+    QTask& operator= (const QTask&) = delete;
+    QTask& operator= (QTask&&) = delete;
+
+    // Give up ownership of the coroutine, used by JobSystem::Spawn
+    std::coroutine_handle<promise_type> release() { return std::exchange(m_handle, nullptr); }
+
+private:
+    explicit QTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// co_await QWaitCounter { &counter }; resumes once counter reaches zero
+struct QWaitCounter {
+    const QJobCounter* counter;
+
+    bool await_ready() const { return counter->done(); }
+    void await_suspend(std::coroutine_handle<> handle) const {
+        QJob job = { qtask_resume, handle.address() };
+        JobSystem::RunAfter(counter, &job, 1, nullptr);
+    }
+    void await_resume() const {}
+};
+
+// co_await QWaitUntil { ready, data }; resumes once ready(data) returns true.
+// ready is polled from the job threads, so use it for cheap checks such as vkGetFenceStatus
+struct QWaitUntil {
+    PFN_job_ready ready;
+    void* data;
+
+    bool await_ready() const { return ready(data); }
+    void await_suspend(std::coroutine_handle<> handle) const {
+        QJob job = { qtask_resume, handle.address() };
+        JobSystem::RunWhen(ready, data, &job, 1, nullptr);
+    }
+    void await_resume() const {}
+};
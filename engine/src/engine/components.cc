@@ -0,0 +1,77 @@
+#include "components.hh"
+
+namespace Pegasus {
+
+Query
+TransformSystem::CreateQuery(World& world) {
+    return world.CreateQuery(component_mask<Position, LocalToWorld>());
+}
+
+// Rows gathered into streams at a time for batch::compose_trs
+static constexpr uint32_t TRANSFORM_BLOCK = 64;
+
+static_assert(sizeof(LocalToWorld) == sizeof(qmath::Mat4<float>), "LocalToWorld arrays are written as Mat4 arrays");
+
+void
+TransformSystem::Update(World& world, Query query) {
+    world.ParallelForEachChunk(query, [](const ChunkView& chunk) {
+        const Position* positions = chunk.Get<Position>();
+        const Rotation* rotations = chunk.Get<Rotation>();
+        const Scale* scales = chunk.Get<Scale>();
+        qmath::Mat4<float>* out = reinterpret_cast<qmath::Mat4<float>*>(chunk.Get<LocalToWorld>());
+
+        // The components are stored a struct each, the batch kernel wants one array per lane.
+        // Transposing a block on the stack is cheap next to what the SIMD compose saves
+        float streams[10][TRANSFORM_BLOCK];
+        for (uint32_t first = 0; first < chunk.count; first += TRANSFORM_BLOCK) {
+            const uint32_t count = chunk.count - first < TRANSFORM_BLOCK ? chunk.count - first : TRANSFORM_BLOCK;
+            for (uint32_t i = 0; i < count; i++) {
+                const qmath::Vec3<float>& position = positions[first + i].value;
+                streams[0][i] = position.x;
+                streams[1][i] = position.y;
+                streams[2][i] = position.z;
+
+                const qmath::Quaternion<float> rotation = rotations ? rotations[first + i].value : qmath::Quaternion<float>::Identity();
+                streams[3][i] = rotation.x;
+                streams[4][i] = rotation.y;
+                streams[5][i] = rotation.z;
+                streams[6][i] = rotation.w;
+
+                const qmath::Vec3<float> scale = scales ? scales[first + i].value : qmath::Vec3<float>::One();
+                streams[7][i] = scale.x;
+                streams[8][i] = scale.y;
+                streams[9][i] = scale.z;
+            }
+
+            qmath::batch::compose_trs(
+                qmath::ConstVec3Stream { streams[0], streams[1], streams[2] },
+                qmath::ConstQuaternionStream { streams[3], streams[4], streams[5], streams[6] },
+                qmath::ConstVec3Stream { streams[7], streams[8], streams[9] },
+                out + first,
+                count
+            );
+        }
+    });
+}
+
+bool
+CameraSystem::UpdateView(World& world, Entity camera) {
+    Camera* state = world.Get<Camera>(camera);
+    const Position* position = world.Get<Position>(camera);
+    if (!state || !position) {
+        return false;
+    }
+    if (!state->view_dirty) {
+        return true;
+    }
+
+    qmath::Mat4<float> rotation = qmath::Mat4<float>::EulerXYZ(state->euler.x, state->euler.y, state->euler.z);
+    qmath::Mat4<float> translation = qmath::Mat4<float>::GetTranslation(position->value);
+
+    state->view = rotation * translation;
+    state->view.Invert();
+    state->view_dirty = false;
+    return true;
+}
+
+} // Pegasus
@@ -0,0 +1,62 @@
+#pragma once
+#include "defines.hh"
+#include "ecs.hh"
+#include <qmath/qmath.hh>
+
+/**
+ * components.hh
+ *
+ * The engine's own components and the systems that run over them
+*/
+
+namespace Pegasus {
+
+struct Position {
+    qmath::Vec3<float> value;
+};
+
+// Optional, entities without one are not rotated
+struct Rotation {
+    qmath::Quaternion<float> value;
+};
+
+// Optional, entities without one keep unit scale
+struct Scale {
+    qmath::Vec3<float> value;
+};
+
+// Written by TransformSystem from Position, Rotation and Scale
+struct LocalToWorld {
+    qmath::Mat4<float> value;
+};
+
+// A free look camera. Its position is the entity's Position
+struct Camera {
+    qmath::Vec3<float> euler;
+    qmath::Mat4<float> view;
+    bool view_dirty;
+};
+
+class QAPI TransformSystem {
+    public:
+        /**
+         * @brief The query TransformSystem::Update runs over: every entity with a Position and a LocalToWorld
+        */
+        static Query CreateQuery(World& world);
+
+        /**
+         * @brief Rebuild LocalToWorld for every entity query matches, a chunk per job
+        */
+        static void Update(World& world, Query query);
+};
+
+class QAPI CameraSystem {
+    public:
+        /**
+         * @brief Rebuild camera's view matrix if it moved or turned since the last call
+         * @return false if camera has no Camera or Position
+        */
+        static bool UpdateView(World& world, Entity camera);
+};
+
+} // Pegasus
@@ -0,0 +1,342 @@
+#include "ecs.hh"
+#include "core/qlogger.hh"
+#include <cstring>
+#include <mutex>
+#include <string>
+
+namespace Pegasus {
+
+namespace {
+    struct component_info {
+        uint32_t size;
+        uint32_t alignment;
+    };
+
+    component_info component_infos[ECS_MAX_COMPONENTS];
+    // Type name of each id, only used while registering
+    std::string component_names[ECS_MAX_COMPONENTS];
+    uint32_t component_count = 0;
+    std::mutex component_lock;
+
+    inline uint32_t
+    align_up(uint32_t value, uint32_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    // Bytes a chunk needs for capacity rows of archetype's components. Fills in the column offsets
+    uint32_t
+    layout_chunk(Archetype& archetype, uint32_t capacity) {
+        uint32_t offset = capacity * static_cast<uint32_t>(sizeof(Entity));
+        for (ComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+            if (!(archetype.mask & (ComponentMask(1) << id))) {
+                archetype.columns[id] = Archetype::NO_COLUMN;
+                continue;
+            }
+            offset = align_up(offset, component_infos[id].alignment);
+            archetype.columns[id] = offset;
+            offset += capacity * component_infos[id].size;
+        }
+        return offset;
+    }
+}
+
+ComponentId
+ecs_detail::register_component(const char* name, uint32_t size, uint32_t alignment) {
+    std::lock_guard<std::mutex> lock(component_lock);
+    for (ComponentId id = 0; id < component_count; id++) {
+        if (component_names[id] == name) {
+            if (component_infos[id].size != size || component_infos[id].alignment != alignment) {
+                qlogger::Error("ECS: component %s has a different layout in two modules", name);
+            }
+            return id;
+        }
+    }
+
+    if (component_count >= ECS_MAX_COMPONENTS) {
+        qlogger::Fatal("ECS: more than %u component types, raise ECS_MAX_COMPONENTS", ECS_MAX_COMPONENTS);
+        return INVALID_COMPONENT;
+    }
+    const ComponentId id = component_count++;
+    component_infos[id] = { size, alignment };
+    component_names[id] = name;
+    return id;
+}
+
+World::World()
+    : m_records(MEMORY_TAG_ENTITY),
+    m_free_indices(MEMORY_TAG_ENTITY),
+    m_archetypes(MEMORY_TAG_ENTITY),
+    m_archetype_lookup(MEMORY_TAG_ENTITY),
+    m_queries(MEMORY_TAG_ENTITY),
+    m_alive(0),
+    m_chunk_jobs(MEMORY_TAG_JOB),
+    m_jobs(MEMORY_TAG_JOB),
+    m_jobs_running(false)
+{
+
+}
+
+World::~World() {
+    for (uint64_t a = 0; a < m_archetypes.size(); a++) {
+        Archetype* archetype = m_archetypes[a];
+        for (uint64_t c = 0; c < archetype->chunks.size(); c++) {
+            QAllocator::FreeAligned(archetype->chunks[c], ECS_CHUNK_SIZE, 64, MEMORY_TAG_ENTITY);
+        }
+        archetype->~Archetype();
+        QAllocator::Free(archetype, sizeof(Archetype), MEMORY_TAG_ENTITY);
+    }
+}
+
+uint32_t
+World::find_or_create_archetype(ComponentMask mask) {
+    uint32_t* existing = m_archetype_lookup.find(mask);
+    if (existing) {
+        return *existing;
+    }
+
+    Archetype* archetype = new (QAllocator::Allocate(1, sizeof(Archetype), MEMORY_TAG_ENTITY)) Archetype();
+    archetype->mask = mask;
+    archetype->count = 0;
+    archetype->chunks = Vector<uint8_t*>(MEMORY_TAG_ENTITY);
+    for (uint32_t i = 0; i < ECS_MAX_COMPONENTS; i++) {
+        archetype->add_edges[i] = Archetype::NO_ARCHETYPE;
+        archetype->remove_edges[i] = Archetype::NO_ARCHETYPE;
+    }
+
+    // As many rows as fit, after padding each array to its alignment
+    uint32_t row_size = sizeof(Entity);
+    for (ComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        if (mask & (ComponentMask(1) << id)) {
+            row_size += component_infos[id].size;
+        }
+    }
+    uint32_t capacity = ECS_CHUNK_SIZE / row_size;
+    while (capacity > 1 && layout_chunk(*archetype, capacity) > ECS_CHUNK_SIZE) {
+        capacity--;
+    }
+    if (layout_chunk(*archetype, capacity) > ECS_CHUNK_SIZE) {
+        qlogger::Fatal("ECS: one entity with components %llx does not fit in a %u byte chunk", mask, ECS_CHUNK_SIZE);
+    }
+    archetype->capacity = capacity;
+
+    const uint32_t index = static_cast<uint32_t>(m_archetypes.size());
+    m_archetypes.push(archetype);
+    m_archetype_lookup.insert(mask, index);
+
+    // Queries made before the archetype existed pick it up now
+    for (uint64_t q = 0; q < m_queries.size(); q++) {
+        QueryCache& cache = m_queries[q];
+        if ((mask & cache.include) == cache.include && !(mask & cache.exclude)) {
+            cache.archetypes.push(index);
+        }
+    }
+    return index;
+}
+
+uint32_t
+World::neighbour_archetype(uint32_t from, ComponentId id, bool add) {
+    uint32_t* edges = add ? m_archetypes[from]->add_edges : m_archetypes[from]->remove_edges;
+    if (edges[id] == Archetype::NO_ARCHETYPE) {
+        const ComponentMask bit = ComponentMask(1) << id;
+        const ComponentMask mask = add ? (m_archetypes[from]->mask | bit) : (m_archetypes[from]->mask & ~bit);
+        const uint32_t to = find_or_create_archetype(mask);
+
+        // m_archetypes may have grown, but the archetypes themselves do not move
+        edges[id] = to;
+        uint32_t* back_edges = add ? m_archetypes[to]->remove_edges : m_archetypes[to]->add_edges;
+        back_edges[id] = from;
+    }
+    return edges[id];
+}
+
+Entity
+World::allocate_entity(uint32_t archetype) {
+    Entity entity;
+    if (!m_free_indices.empty()) {
+        entity.index = m_free_indices.pop();
+        entity.generation = m_records[entity.index].generation;
+    } else {
+        entity.index = static_cast<uint32_t>(m_records.size());
+        entity.generation = 0;
+        m_records.push(EntityRecord { Archetype::NO_ARCHETYPE, 0, 0 });
+    }
+
+    EntityRecord& record = m_records[entity.index];
+    record.archetype = archetype;
+    record.row = push_row(archetype, entity);
+    m_alive++;
+    return entity;
+}
+
+uint32_t
+World::push_row(uint32_t archetype_index, Entity entity) {
+    Archetype& archetype = *m_archetypes[archetype_index];
+    const uint32_t row = archetype.count;
+    const uint32_t chunk = row / archetype.capacity;
+    if (chunk == archetype.chunks.size()) {
+        archetype.chunks.push(static_cast<uint8_t*>(QAllocator::AllocateAligned(1, ECS_CHUNK_SIZE, 64, MEMORY_TAG_ENTITY)));
+    }
+    reinterpret_cast<Entity*>(archetype.chunks[chunk])[row % archetype.capacity] = entity;
+    archetype.count++;
+    return row;
+}
+
+void
+World::remove_row(uint32_t archetype_index, uint32_t row) {
+    Archetype& archetype = *m_archetypes[archetype_index];
+    const uint32_t last = archetype.count - 1;
+    uint8_t* chunk = archetype.chunks[row / archetype.capacity];
+    const uint32_t slot = row % archetype.capacity;
+
+    // The archetype's last entity fills the hole, which keeps every chunk but the last full
+    if (row != last) {
+        uint8_t* last_chunk = archetype.chunks[last / archetype.capacity];
+        const uint32_t last_slot = last % archetype.capacity;
+
+        const Entity moved = reinterpret_cast<Entity*>(last_chunk)[last_slot];
+        reinterpret_cast<Entity*>(chunk)[slot] = moved;
+        for (ComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+            const uint32_t offset = archetype.columns[id];
+            if (offset == Archetype::NO_COLUMN) {
+                continue;
+            }
+            const uint32_t size = component_infos[id].size;
+            QAllocator::Copy(chunk + offset + slot * size, last_chunk + offset + last_slot * size, size);
+        }
+        m_records[moved.index].row = row;
+    }
+
+    archetype.count--;
+    if (archetype.count % archetype.capacity == 0 && archetype.count / archetype.capacity < archetype.chunks.size()) {
+        QAllocator::FreeAligned(archetype.chunks.pop(), ECS_CHUNK_SIZE, 64, MEMORY_TAG_ENTITY);
+    }
+}
+
+void
+World::move_entity(Entity entity, uint32_t to) {
+    EntityRecord& record = m_records[entity.index];
+    const uint32_t from = record.archetype;
+    const uint32_t from_row = record.row;
+    const uint32_t to_row = push_row(to, entity);
+
+    // Components both archetypes have come along, the new one is left for the caller to fill
+    const Archetype& source = *m_archetypes[from];
+    const Archetype& destination = *m_archetypes[to];
+    const uint8_t* source_chunk = source.chunks[from_row / source.capacity];
+    uint8_t* destination_chunk = destination.chunks[to_row / destination.capacity];
+    const uint32_t source_slot = from_row % source.capacity;
+    const uint32_t destination_slot = to_row % destination.capacity;
+    for (ComponentId id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        if (source.columns[id] == Archetype::NO_COLUMN || destination.columns[id] == Archetype::NO_COLUMN) {
+            continue;
+        }
+        const uint32_t size = component_infos[id].size;
+        QAllocator::Copy(destination_chunk + destination.columns[id] + destination_slot * size,
+                         source_chunk + source.columns[id] + source_slot * size, size);
+    }
+
+    remove_row(from, from_row);
+    record.archetype = to;
+    record.row = to_row;
+}
+
+const World::EntityRecord*
+World::alive_record(Entity entity) const {
+    if (entity.index >= m_records.size()) {
+        return nullptr;
+    }
+    const EntityRecord& record = m_records[entity.index];
+    if (record.generation != entity.generation || record.archetype == Archetype::NO_ARCHETYPE) {
+        return nullptr;
+    }
+    return &record;
+}
+
+void*
+World::column(uint32_t archetype_index, uint32_t row, ComponentId id) const {
+    if (id >= ECS_MAX_COMPONENTS) {
+        return nullptr;
+    }
+    const Archetype& archetype = *m_archetypes[archetype_index];
+    if (archetype.columns[id] == Archetype::NO_COLUMN) {
+        return nullptr;
+    }
+    return archetype.chunks[row / archetype.capacity] + archetype.columns[id] + (row % archetype.capacity) * component_infos[id].size;
+}
+
+void*
+World::add_component(Entity entity, ComponentId id) {
+    const EntityRecord* record = alive_record(entity);
+    if (!record || id >= ECS_MAX_COMPONENTS) {
+        return nullptr;
+    }
+    if (m_archetypes[record->archetype]->columns[id] == Archetype::NO_COLUMN) {
+        move_entity(entity, neighbour_archetype(record->archetype, id, true));
+    }
+    return column(record->archetype, record->row, id);
+}
+
+bool
+World::remove_component(Entity entity, ComponentId id) {
+    const EntityRecord* record = alive_record(entity);
+    if (!record || id >= ECS_MAX_COMPONENTS || m_archetypes[record->archetype]->columns[id] == Archetype::NO_COLUMN) {
+        return false;
+    }
+    move_entity(entity, neighbour_archetype(record->archetype, id, false));
+    return true;
+}
+
+Entity
+World::Create() {
+    return allocate_entity(find_or_create_archetype(0));
+}
+
+bool
+World::Destroy(Entity entity) {
+    if (!alive_record(entity)) {
+        return false;
+    }
+    EntityRecord& record = m_records[entity.index];
+    remove_row(record.archetype, record.row);
+    record.archetype = Archetype::NO_ARCHETYPE;
+    record.generation++;
+    m_free_indices.push(entity.index);
+    m_alive--;
+    return true;
+}
+
+bool
+World::IsAlive(Entity entity) const {
+    return alive_record(entity) != nullptr;
+}
+
+Query
+World::CreateQuery(ComponentMask include, ComponentMask exclude) {
+    for (uint64_t q = 0; q < m_queries.size(); q++) {
+        if (m_queries[q].include == include && m_queries[q].exclude == exclude) {
+            return Query { static_cast<uint32_t>(q) };
+        }
+    }
+
+    QueryCache cache = { include, exclude, Vector<uint32_t>(MEMORY_TAG_ENTITY) };
+    for (uint64_t a = 0; a < m_archetypes.size(); a++) {
+        const ComponentMask mask = m_archetypes[a]->mask;
+        if ((mask & include) == include && !(mask & exclude)) {
+            cache.archetypes.push(static_cast<uint32_t>(a));
+        }
+    }
+    m_queries.push(std::move(cache));
+    return Query { static_cast<uint32_t>(m_queries.size() - 1) };
+}
+
+uint32_t
+World::Count(Query query) const {
+    const QueryCache& cache = m_queries[query.index];
+    uint32_t count = 0;
+    for (uint64_t a = 0; a < cache.archetypes.size(); a++) {
+        count += m_archetypes[cache.archetypes[a]]->count;
+    }
+    return count;
+}
+
+} // Pegasus
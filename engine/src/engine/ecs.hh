@@ -0,0 +1,407 @@
+#pragma once
+#include "defines.hh"
+#include "core/qjobs.hh"
+#include "core/qmemory.hh"
+#include "containers/qhashmap.inl"
+#include "containers/qvector.inl"
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+/*
+ *  Entity component system
+ *
+ *  An entity is an id. What it is made of lives in components, plain structs stored by archetype:
+ *  every distinct set of component types is one archetype. An archetype keeps its entities in fixed
+ *  size chunks, with one array per component type (structure of arrays). A system that needs Position
+ *  and Velocity streams through those two arrays chunk by chunk, and never loads the other components
+ *  the same entities carry.
+ *
+ *  Chunks stay packed. Destroying an entity moves the archetype's last entity into the hole, so every
+ *  chunk but the last is full. Adding or removing a component moves the entity to the archetype with
+ *  that component set, found through edges cached on each archetype.
+ *
+ *  Queries name the components to include and exclude. They are cached: the matching archetypes are
+ *  collected when the query is created and kept up to date as archetypes appear, so running a query
+ *  walks a short list instead of searching. Chunks of a query can be handed to the job system, one
+ *  job per chunk.
+ *
+ *  Components must be trivially copyable, since they are moved with memcpy, and aligned to at most
+ *  64 bytes. Entities must not be created, destroyed or change components while a query runs over
+ *  their world; collect the changes and apply them after.
+ */
+
+// Component types across all worlds, one bit each in a ComponentMask
+#define ECS_MAX_COMPONENTS 64
+// Bytes per chunk, entity ids included
+#define ECS_CHUNK_SIZE (16 * 1024)
+
+namespace Pegasus {
+
+typedef uint32_t ComponentId;
+typedef uint64_t ComponentMask;
+
+static constexpr ComponentId INVALID_COMPONENT = ~0u;
+
+struct Entity {
+    uint32_t index;
+    uint32_t generation;
+
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+static constexpr Entity NULL_ENTITY = { ~0u, 0 };
+
+namespace ecs_detail {
+    /**
+     * @brief The id of the component type called name, given the next free id the first time the
+     *     name is seen. The engine owns the table, so the engine and a game module loaded as a separate
+     *     binary agree on every id. Called once per type and module through component_id
+     * @return INVALID_COMPONENT once ECS_MAX_COMPONENTS types exist
+    */
+    QAPI ComponentId register_component(const char* name, uint32_t size, uint32_t alignment);
+
+    // T spelled out by the compiler. The same text in every module, unlike anything keyed by an address
+    template <typename T>
+    constexpr const char*
+    type_name() {
+#if defined(_MSC_VER)
+        return __FUNCSIG__;
+#else
+        return __PRETTY_FUNCTION__;
+#endif
+    }
+
+    // Rows of one chunk, component arrays side by side
+    template <typename Fn, typename... Ts>
+    inline void
+    each_row(uint32_t count, const Entity* entities, Fn& fn, Ts*... columns) {
+        for (uint32_t i = 0; i < count; i++) {
+            fn(entities[i], columns[i]...);
+        }
+    }
+}
+
+/**
+ * @brief The id of component type T, the same in every world
+*/
+template <typename T>
+inline ComponentId
+component_id() {
+    static_assert(std::is_trivially_copyable_v<T>, "Components are moved with memcpy");
+    static_assert(alignof(T) <= 64, "Chunks are 64 byte aligned");
+    static const ComponentId id = ecs_detail::register_component(ecs_detail::type_name<T>(), sizeof(T), alignof(T));
+    return id;
+}
+
+/**
+ * @brief The mask with the bits of every type in Ts
+*/
+template <typename... Ts>
+inline ComponentMask
+component_mask() {
+    return ((component_id<Ts>() < ECS_MAX_COMPONENTS ? ComponentMask(1) << component_id<Ts>() : 0) | ... | ComponentMask(0));
+}
+
+// All entities with exactly one set of components
+struct Archetype {
+    static constexpr uint32_t NO_COLUMN = ~0u;
+    static constexpr uint32_t NO_ARCHETYPE = ~0u;
+
+    ComponentMask mask;
+    uint32_t capacity;   // entities per chunk
+    uint32_t count;      // entities over all chunks, the last chunk holds the remainder
+    Vector<uint8_t*> chunks;
+
+    // Byte offset of each component's array in a chunk, NO_COLUMN if the archetype lacks it.
+    // The entity ids come first, at offset 0
+    uint32_t columns[ECS_MAX_COMPONENTS];
+
+    // Archetypes one component away, filled in as entities move
+    uint32_t add_edges[ECS_MAX_COMPONENTS];
+    uint32_t remove_edges[ECS_MAX_COMPONENTS];
+
+    uint32_t chunk_count(uint32_t chunk) const {
+        const uint32_t first = chunk * capacity;
+        return count - first < capacity ? count - first : capacity;
+    }
+};
+
+// One chunk of a query, as handed to the iteration callbacks
+struct ChunkView {
+    uint32_t count;
+    const Entity* entities;
+    uint8_t* data;
+    const uint32_t* columns;
+
+    /**
+     * @brief The array of T for this chunk, count long, or nullptr if the archetype has no T.
+     *     Lets a system take optional components
+    */
+    template <typename T>
+    T* Get() const {
+        const ComponentId id = component_id<T>();
+        if (id >= ECS_MAX_COMPONENTS || columns[id] == Archetype::NO_COLUMN) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(data + columns[id]);
+    }
+};
+
+// A cached query, by index into the world's queries
+struct Query {
+    uint32_t index;
+};
+
+class QAPI World {
+    public:
+        World();
+        ~World();
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+
+        /**
+         * @brief Create an entity with no components
+        */
+        Entity Create();
+
+        /**
+         * @brief Create an entity with the given components, straight in their archetype
+        */
+        template <typename... Ts>
+        Entity Create(const Ts&... components);
+
+        /**
+         * @brief Destroy an entity. Its id is reused with the next generation
+         * @return false if it was not alive
+        */
+        bool Destroy(Entity entity);
+
+        bool IsAlive(Entity entity) const;
+
+        // Entities alive in the world
+        uint32_t EntityCount() const { return m_alive; }
+
+        /**
+         * @brief Add component to entity, or overwrite it if entity already has one
+         * @return false if entity is not alive
+        */
+        template <typename T>
+        bool Add(Entity entity, const T& component);
+
+        /**
+         * @return false if entity is not alive or does not have T
+        */
+        template <typename T>
+        bool Remove(Entity entity);
+
+        /**
+         * @brief entity's T, or nullptr. Valid until entity changes archetype or any entity is destroyed
+        */
+        template <typename T>
+        T* Get(Entity entity) const;
+
+        template <typename T>
+        bool Has(Entity entity) const;
+
+        /**
+         * @brief A query for the archetypes that have everything in include and nothing in exclude.
+         *     Asking again for the same masks returns the same query
+        */
+        Query CreateQuery(ComponentMask include, ComponentMask exclude = 0);
+
+        // Entities matched by query
+        uint32_t Count(Query query) const;
+
+        /**
+         * @brief Call fn(const ChunkView&) for each non empty chunk matched by query, on this thread
+        */
+        template <typename Fn>
+        void ForEachChunk(Query query, Fn&& fn) const;
+
+        /**
+         * @brief Call fn(Entity, Ts&...) for each entity matched by query. Every Ts must be in
+         *     the query's include mask
+        */
+        template <typename... Ts, typename Fn>
+        void Each(Query query, Fn&& fn) const;
+
+        /**
+         * @brief ForEachChunk with one job per chunk, waiting for all of them. fn runs on several
+         *     threads at once and must only write to the chunk it was given. Runs on this thread
+         *     if the job system is not up
+        */
+        template <typename Fn>
+        void ParallelForEachChunk(Query query, Fn&& fn) const;
+
+        /**
+         * @brief Each, spread over the job system a chunk at a time
+        */
+        template <typename... Ts, typename Fn>
+        void ParallelEach(Query query, Fn&& fn) const;
+
+        // Archetypes created so far, for tests and stats
+        uint32_t ArchetypeCount() const { return static_cast<uint32_t>(m_archetypes.size()); }
+        const Archetype& GetArchetype(uint32_t index) const { return *m_archetypes[index]; }
+
+    private:
+        struct EntityRecord {
+            uint32_t archetype;   // NO_ARCHETYPE when the id is free
+            uint32_t row;         // over the archetype's chunks, row / capacity is the chunk
+            uint32_t generation;
+        };
+
+        struct QueryCache {
+            ComponentMask include;
+            ComponentMask exclude;
+            Vector<uint32_t> archetypes;
+        };
+
+        uint32_t find_or_create_archetype(ComponentMask mask);
+        uint32_t neighbour_archetype(uint32_t from, ComponentId id, bool add);
+        Entity allocate_entity(uint32_t archetype);
+        uint32_t push_row(uint32_t archetype, Entity entity);
+        void remove_row(uint32_t archetype, uint32_t row);
+        void move_entity(Entity entity, uint32_t to);
+        const EntityRecord* alive_record(Entity entity) const;
+        void* column(uint32_t archetype, uint32_t row, ComponentId id) const;
+        void* add_component(Entity entity, ComponentId id);
+        bool remove_component(Entity entity, ComponentId id);
+
+        // One chunk handed to a job, fn is the caller's function of type Fn
+        struct ChunkJob {
+            void* fn;
+            ChunkView chunk;
+        };
+
+        template <typename Fn>
+        static void run_chunk_job(void* data);
+
+        Vector<EntityRecord> m_records;
+        Vector<uint32_t> m_free_indices;
+        Vector<Archetype*> m_archetypes;
+        HashMap<ComponentMask, uint32_t> m_archetype_lookup;
+        Vector<QueryCache> m_queries;
+        uint32_t m_alive;
+
+        // Scratch for ParallelForEachChunk, cleared and reused so a frame's systems allocate nothing
+        mutable Vector<ChunkJob> m_chunk_jobs;
+        mutable Vector<QJob> m_jobs;
+        mutable bool m_jobs_running;
+};
+
+template <typename... Ts>
+Entity
+World::Create(const Ts&... components) {
+    const ComponentMask mask = component_mask<Ts...>();
+    const Entity entity = allocate_entity(find_or_create_archetype(mask));
+    const EntityRecord& record = m_records[entity.index];
+    ((*static_cast<Ts*>(column(record.archetype, record.row, component_id<Ts>())) = components), ...);
+    return entity;
+}
+
+template <typename T>
+bool
+World::Add(Entity entity, const T& component) {
+    T* slot = static_cast<T*>(add_component(entity, component_id<T>()));
+    if (!slot) {
+        return false;
+    }
+    *slot = component;
+    return true;
+}
+
+template <typename T>
+bool
+World::Remove(Entity entity) {
+    return remove_component(entity, component_id<T>());
+}
+
+template <typename T>
+T*
+World::Get(Entity entity) const {
+    const EntityRecord* record = alive_record(entity);
+    if (!record) {
+        return nullptr;
+    }
+    return static_cast<T*>(column(record->archetype, record->row, component_id<T>()));
+}
+
+template <typename T>
+bool
+World::Has(Entity entity) const {
+    return Get<T>(entity) != nullptr;
+}
+
+template <typename Fn>
+void
+World::ForEachChunk(Query query, Fn&& fn) const {
+    const QueryCache& cache = m_queries[query.index];
+    for (uint64_t a = 0; a < cache.archetypes.size(); a++) {
+        const Archetype& archetype = *m_archetypes[cache.archetypes[a]];
+        for (uint32_t c = 0; c * archetype.capacity < archetype.count; c++) {
+            uint8_t* data = archetype.chunks[c];
+            const ChunkView chunk = { archetype.chunk_count(c), reinterpret_cast<const Entity*>(data), data, archetype.columns };
+            fn(chunk);
+        }
+    }
+}
+
+template <typename... Ts, typename Fn>
+void
+World::Each(Query query, Fn&& fn) const {
+    ForEachChunk(query, [&fn](const ChunkView& chunk) {
+        ecs_detail::each_row(chunk.count, chunk.entities, fn, chunk.Get<Ts>()...);
+    });
+}
+
+template <typename Fn>
+void
+World::run_chunk_job(void* data) {
+    ChunkJob* job = static_cast<ChunkJob*>(data);
+    (*static_cast<Fn*>(job->fn))(job->chunk);
+}
+
+template <typename Fn>
+void
+World::ParallelForEachChunk(Query query, Fn&& fn) const {
+    typedef std::remove_reference_t<Fn> function_t;
+    // The scratch is taken when a chunk function starts another parallel query, run that one here
+    if (!JobSystem::GetInitialized() || m_jobs_running) {
+        ForEachChunk(query, fn);
+        return;
+    }
+
+    // Job data has to stay put until the jobs are done, so it is all gathered before any are run
+    m_chunk_jobs.clear();
+    void* function = const_cast<void*>(static_cast<const void*>(&fn));
+    ForEachChunk(query, [this, function](const ChunkView& chunk) {
+        m_chunk_jobs.push(ChunkJob { function, chunk });
+    });
+    if (m_chunk_jobs.empty()) {
+        return;
+    }
+
+    m_jobs.clear();
+    m_jobs.reserve(m_chunk_jobs.size());
+    for (uint64_t i = 0; i < m_chunk_jobs.size(); i++) {
+        m_jobs.push(QJob { run_chunk_job<function_t>, &m_chunk_jobs[i] });
+    }
+
+    m_jobs_running = true;
+    QJobCounter counter;
+    JobSystem::Run(m_jobs.data(), static_cast<uint32_t>(m_jobs.size()), &counter);
+    JobSystem::Wait(&counter);
+    m_jobs_running = false;
+}
+
+template <typename... Ts, typename Fn>
+void
+World::ParallelEach(Query query, Fn&& fn) const {
+    ParallelForEachChunk(query, [&fn](const ChunkView& chunk) {
+        ecs_detail::each_row(chunk.count, chunk.entities, fn, chunk.Get<Ts>()...);
+    });
+}
+
+} // Pegasus
@@ -8,6 +8,7 @@
 #include "core/input.hh"
 #include "core/qmemory.hh"
 #include "core/qlogger.hh"
+#include "core/application.hh"
 #include <cstdint>
 
 #include <renderer/renderer_frontend.hh>
@@ -15,38 +16,17 @@
 namespace Pegasus {
     static GameState game_state = {};
 
-    void recalculate_camera_view(GameState& state) {
-        if (!state.camera_view_dirty) {
-            return;
-        }
-
-        qmath::Mat4<float> rotation = qmath::Mat4<float>::EulerXYZ(
-            state.camera_euler.x,
-            state.camera_euler.y,
-            state.camera_euler.z
-        );
-
-        qmath::Mat4<float> translation = qmath::Mat4<float>::GetTranslation(state.camera_position);
-
-        state.view = rotation * translation;
-        state.view.Invert();
-
-        state.camera_view_dirty = false;
-        return;
-    }
-
-    void camera_yaw(GameState& state, float amount) {
-        state.camera_euler.y += amount;
-        state.camera_view_dirty = true;
+    void camera_yaw(Camera& camera, float amount) {
+        camera.euler.y += amount;
+        camera.view_dirty = true;
     }
     
-    void camera_pitch(GameState& state, float amount) {
-        state.camera_euler.x += amount;
+    void camera_pitch(Camera& camera, float amount) {
+        camera.euler.x += amount;
 
         float limit = qmath::deg_to_rad(89);
-        // state.camera_euler.x = std::clamp(state.camera_euler.x, limit, limit);
-        state.camera_euler.x = std::clamp(state.camera_euler.x, -limit, limit);
-        state.camera_view_dirty = true;
+        camera.euler.x = std::clamp(camera.euler.x, -limit, limit);
+        camera.view_dirty = true;
     }
 
     bool
@@ -57,21 +37,46 @@ namespace Pegasus {
 
         std::cout << "GAME INITIALIZED" << std::endl;
         game.state = static_cast<void*>(&game_state);
+        game_state.world = nullptr;
+        game_state.initialized = true;
 
-        // Camera values
-        game_state.camera_position = qmath::Vec3<float>::New(0.0f, 0.0f, 30.0f);
-        game_state.camera_euler        = qmath::Vec3<float>::Zero();
-        game_state.camera_view_dirty = true;
+        return true;
+    }
 
-        // Set the view matrix
-        game_state.view = qmath::Mat4<float>::GetTranslation(
-            game_state.camera_position
+    bool
+    Game::Initialize(Game& game) {
+        if (!game_state.initialized || game_state.world) {
+            qlogger::Error("Game::Initialize: game not created, or already initialized");
+            return false;
+        }
+
+        game_state.world = new (QAllocator::Allocate(1, sizeof(World), MEMORY_TAG_ENTITY)) World();
+        World& world = *game_state.world;
+
+        // The camera is an entity like any other
+        Camera camera = {};
+        camera.euler = qmath::Vec3<float>::Zero();
+        camera.view_dirty = true;
+        game_state.camera = world.Create(
+            Position { qmath::Vec3<float>::New(0.0f, 0.0f, 30.0f) },
+            camera
         );
-        game_state.view.Invert();
+        CameraSystem::UpdateView(world, game_state.camera);
 
+        game_state.transforms = TransformSystem::CreateQuery(world);
         return true;
     }
 
+    void
+    Game::Destroy(Game& game) {
+        if (!game_state.world) {
+            return;
+        }
+        game_state.world->~World();
+        QAllocator::Free(game_state.world, sizeof(World), MEMORY_TAG_ENTITY);
+        game_state.world = nullptr;
+    }
+
 
     bool 
     Game::Update(float delta_time) {
@@ -82,46 +87,53 @@ namespace Pegasus {
         alloc_count = QAllocator::AllocationCount();
         if (InputHandler::IsKeyUp(KEY_M) && InputHandler::WasKeyDown(KEY_M)) {
             qlogger::Debug("Allocations: %llu (%llu this frame)", alloc_count, alloc_count - prev_alloc_count);
+            qlogger::Debug("Frame allocator: %llu bytes used", Application::GetFrameAllocator().allocated);
+            if (QAllocator::IsTracking()) {
+                qlogger::Debug("%s", QAllocator::GetTopAllocatorsString().c_str());
+            }
         }
 
         // Move the camera around
+        World& world = *game_state.world;
+        Camera& camera = *world.Get<Camera>(game_state.camera);
+        Position& camera_position = *world.Get<Position>(game_state.camera);
 
         // HACK: temp hack to move the camera around
         if (InputHandler::IsKeyDown(KEY_A) || InputHandler::IsKeyDown(KEY_LEFT)) {
-            camera_yaw(game_state, 1.0f * delta_time);
+            camera_yaw(camera, 1.0f * delta_time);
         }
 
         if (InputHandler::IsKeyDown(KEY_D) || InputHandler::IsKeyDown(KEY_RIGHT)) {
-            camera_yaw(game_state, -1.0f * delta_time);
+            camera_yaw(camera, -1.0f * delta_time);
         }
         
         if (InputHandler::IsKeyDown(KEY_UP)) {
-            camera_pitch(game_state, 1.0f * delta_time);
+            camera_pitch(camera, 1.0f * delta_time);
         }
        
         if (InputHandler::IsKeyDown(KEY_DOWN)) {
-            camera_pitch(game_state, -1.0f * delta_time);
+            camera_pitch(camera, -1.0f * delta_time);
         }
         
         float temp_move_speed = 10.0f; 
         qmath::Vec3<float> velocity = qmath::Vec3<float>::Zero();
         if (InputHandler::IsKeyDown(KEY_W)) {
-            qmath::Vec3<float> forward = qmath::Mat4<float>::Forward(game_state.view);
+            qmath::Vec3<float> forward = qmath::Mat4<float>::Forward(camera.view);
             velocity = velocity + forward;
         }
 
         if (InputHandler::IsKeyDown(KEY_S)) {
-            qmath::Vec3<float> backward = qmath::Mat4<float>::Backward(game_state.view);
+            qmath::Vec3<float> backward = qmath::Mat4<float>::Backward(camera.view);
             velocity = velocity + backward;
         }
         
         if (InputHandler::IsKeyDown(KEY_Q)) {
-            qmath::Vec3<float> left = qmath::Mat4<float>::Left(game_state.view);
+            qmath::Vec3<float> left = qmath::Mat4<float>::Left(camera.view);
             velocity = velocity + left;
         }
 
         if (InputHandler::IsKeyDown(KEY_E)) {
-            qmath::Vec3<float> right = qmath::Mat4<float>::Right(game_state.view);
+            qmath::Vec3<float> right = qmath::Mat4<float>::Right(camera.view);
             velocity = velocity + right;
         }
 
@@ -136,17 +148,18 @@ namespace Pegasus {
         qmath::Vec3<float> z = qmath::Vec3<float>::Zero();
         if (!qmath::Vec3<float>::Compare(z, velocity, 0.0002f)) {
             velocity.normalize();
-            game_state.camera_position.x += velocity.x * temp_move_speed * delta_time;
-            game_state.camera_position.y += velocity.y * temp_move_speed * delta_time;
-            game_state.camera_position.z += velocity.z * temp_move_speed * delta_time;
-            game_state.camera_view_dirty = true;
+            camera_position.value.x += velocity.x * temp_move_speed * delta_time;
+            camera_position.value.y += velocity.y * temp_move_speed * delta_time;
+            camera_position.value.z += velocity.z * temp_move_speed * delta_time;
+            camera.view_dirty = true;
 
         }
 
         
-        recalculate_camera_view(game_state); // make sure view is up-to-date
+        CameraSystem::UpdateView(world, game_state.camera); // make sure view is up-to-date
+        TransformSystem::Update(world, game_state.transforms);
 
-        Renderer::SetView(game_state.view); // HACK: This should not be available outside of the engine
+        Renderer::SetView(camera.view); // HACK: This should not be available outside of the engine
 
         return true;
     }
@@ -163,23 +176,8 @@ namespace Pegasus {
         return;
     }
 
-    GameObject
-    GameObject::New(GameObject::id_t id) {
-        GameObject obj;
-        obj.m_id = id;
-        return obj;
-    }
-
-    /**
-    * Create a new object for the game
-    */
-    GameObject
-    Game::NewGameObject(void) {
-        static GameObject::id_t current_id = 0;
-
-        GameObject obj = GameObject::New(current_id);
-        current_id++;
-
-        return obj;
+    World&
+    Game::GetWorld() {
+        return *game_state.world;
     }
 }
@@ -1,12 +1,13 @@
 #pragma once
 #include "game_types.hh"
+#include "ecs.hh"
+#include "components.hh"
 #include <qmath/qmath.hh>
 
 struct GameState {
   bool initialized = false;
   float delta_time;
-  qmath::Mat4<float> view;
-  qmath::Vec3<float> camera_position;
-  qmath::Vec3<float> camera_euler;
-  bool camera_view_dirty;
+  Pegasus::World* world;      // from Game::Initialize to Game::Destroy, while the memory system is up
+  Pegasus::Entity camera;     // Position and Camera
+  Pegasus::Query transforms;  // TransformSystem's query
 };
\ No newline at end of file
@@ -1,10 +1,7 @@
 #pragma once
 #include "defines.hh"
-#include "renderer/render_types.hh"
+#include "engine/ecs.hh"
 #include <cstdint>
-#include <vector>
-
-#include <glm/glm.hpp>
 /**
  * game_types.hh
  * 
@@ -12,28 +9,30 @@
 */
 
 namespace Pegasus {
-  class QAPI GameObject  {
-  public:
-    using id_t = uint64_t;
-
-    id_t id() { return m_id; }
-
-    glm::vec3 color{};
-    std::vector <Vertex> vertices{};
-    std::vector <uint32_t> indices{};
-    static GameObject New(id_t id); 
-    
-  private:
-    id_t m_id;
-    
-  };
-
   class QAPI  Game {
     public:
       Game() {}
       ~Game() {}
+      /**
+       * @brief Hook the game state up. Allocates nothing, so it can run before Application::Create
+      */
       static bool Create(Game& game);
-      static GameObject NewGameObject();
+
+      /**
+       * @brief Build the world and the camera. Application::Create calls it once the memory
+       *     and job systems are up
+      */
+      static bool Initialize(Game& game);
+
+      /**
+       * @brief Free the world. Application::run calls it before the memory system shuts down
+      */
+      static void Destroy(Game& game);
+
+      /**
+       * @brief The world the game's entities live in
+      */
+      static World& GetWorld();
       bool Update(float delta_time);
       bool Render(float delta_time);
       void Resize(uint32_t width, uint32_t height);
@@ -0,0 +1,378 @@
+#include "qallocation_tracker.hh"
+#include "platform/platform.hh"
+#include "core/qlogger.hh"
+#include <atomic>
+#include <mutex>
+/**
+ * Implementation for the allocation tracker
+*/
+
+namespace qmemory {
+
+static constexpr uintptr_t slot_empty = 0;
+static constexpr uintptr_t slot_deleted = 1;
+static constexpr uint32_t site_none = 0xFFFFFFFF;
+
+static constexpr uint64_t initial_live_capacity = 4096;
+static constexpr uint32_t initial_site_capacity = 256;
+
+struct live_entry {
+    uintptr_t block; // slot_empty / slot_deleted mark unused slots
+    uint64_t size;
+    uint64_t frame;
+    uint32_t site;
+    memory_tag tag;
+};
+
+struct site_entry {
+    const char* file;
+    uint32_t line;
+    memory_tag tag;
+    uint64_t frame_count;
+    uint64_t frame_bytes;
+    uint64_t last_frame_count;
+    uint64_t last_frame_bytes;
+};
+
+struct tracker_state {
+    // block -> live_entry, linear probing
+    live_entry* live;
+    uint64_t live_capacity;
+    uint64_t live_count;
+    uint64_t live_used; // live entries plus tombstones
+
+    // Sites are stored densely so live entries can refer to them by index.
+    // site_slots is the open-addressing index over them
+    site_entry* sites;
+    uint32_t site_count;
+    uint32_t site_capacity;
+    uint32_t* site_slots;
+    uint32_t site_slot_capacity;
+
+    uint64_t frame;
+};
+
+static tracker_state tracker {};
+static std::mutex tracker_lock;
+static std::atomic<bool> tracker_enabled { false };
+
+static inline uint64_t
+hash_pointer(uintptr_t value) {
+    uint64_t h = static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 32);
+}
+
+static inline uint64_t
+hash_site(const char* file, uint32_t line) {
+    return hash_pointer(reinterpret_cast<uintptr_t>(file) ^ (static_cast<uintptr_t>(line) << 48));
+}
+
+static void*
+platform_allocate_zeroed(uint64_t size) {
+    void* block = Platform::Allocate(size, false);
+    return block ? Platform::ZeroMem(block, size) : nullptr;
+}
+
+static void
+rebuild_live(uint64_t new_capacity) {
+    live_entry* old = tracker.live;
+    uint64_t old_capacity = tracker.live_capacity;
+
+    tracker.live = static_cast<live_entry*>(platform_allocate_zeroed(new_capacity * sizeof(live_entry)));
+    tracker.live_capacity = new_capacity;
+    tracker.live_used = tracker.live_count;
+
+    for (uint64_t i = 0; i < old_capacity; i++) {
+        if (old[i].block > slot_deleted) {
+            uint64_t slot = hash_pointer(old[i].block) & (new_capacity - 1);
+            while (tracker.live[slot].block != slot_empty) {
+                slot = (slot + 1) & (new_capacity - 1);
+            }
+            tracker.live[slot] = old[i];
+        }
+    }
+
+    if (old) {
+        Platform::Free(old, false);
+    }
+}
+
+static void
+rebuild_site_slots(uint32_t new_capacity) {
+    if (tracker.site_slots) {
+        Platform::Free(tracker.site_slots, false);
+    }
+
+    tracker.site_slots = static_cast<uint32_t*>(Platform::Allocate(new_capacity * sizeof(uint32_t), false));
+    Platform::SetMem(tracker.site_slots, 0xFF, new_capacity * sizeof(uint32_t));
+    tracker.site_slot_capacity = new_capacity;
+
+    for (uint32_t i = 0; i < tracker.site_count; i++) {
+        uint64_t slot = hash_site(tracker.sites[i].file, tracker.sites[i].line) & (new_capacity - 1);
+        while (tracker.site_slots[slot] != site_none) {
+            slot = (slot + 1) & (new_capacity - 1);
+        }
+        tracker.site_slots[slot] = i;
+    }
+}
+
+static uint32_t
+find_or_add_site(const char* file, uint32_t line, memory_tag tag) {
+    uint64_t mask = tracker.site_slot_capacity - 1;
+    uint64_t slot = hash_site(file, line) & mask;
+    while (tracker.site_slots[slot] != site_none) {
+        site_entry& site = tracker.sites[tracker.site_slots[slot]];
+        if (site.file == file && site.line == line) {
+            return tracker.site_slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (tracker.site_count == tracker.site_capacity) {
+        uint32_t new_capacity = tracker.site_capacity * 2;
+        site_entry* sites = static_cast<site_entry*>(platform_allocate_zeroed(new_capacity * sizeof(site_entry)));
+        Platform::CopyMem(sites, tracker.sites, tracker.site_count * sizeof(site_entry));
+        Platform::Free(tracker.sites, false);
+        tracker.sites = sites;
+        tracker.site_capacity = new_capacity;
+    }
+
+    uint32_t index = tracker.site_count++;
+    site_entry& site = tracker.sites[index];
+    site.file = file;
+    site.line = line;
+    site.tag = tag;
+
+    // Keep the index at most half full
+    if (tracker.site_count * 2 > tracker.site_slot_capacity) {
+        rebuild_site_slots(tracker.site_slot_capacity * 2);
+    } else {
+        tracker.site_slots[slot] = index;
+    }
+    return index;
+}
+
+void
+QAllocationTracker::Enable() {
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    if (tracker_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    tracker.sites = static_cast<site_entry*>(platform_allocate_zeroed(initial_site_capacity * sizeof(site_entry)));
+    tracker.site_capacity = initial_site_capacity;
+    tracker.site_count = 0;
+    rebuild_site_slots(initial_site_capacity * 2);
+
+    tracker.live_count = 0;
+    rebuild_live(initial_live_capacity);
+    tracker.frame = 0;
+
+    tracker_enabled.store(true, std::memory_order_release);
+}
+
+void
+QAllocationTracker::Disable() {
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    if (!tracker_enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    tracker_enabled.store(false, std::memory_order_release);
+
+    Platform::Free(tracker.live, false);
+    Platform::Free(tracker.sites, false);
+    Platform::Free(tracker.site_slots, false);
+    tracker = tracker_state {};
+}
+
+bool
+QAllocationTracker::IsEnabled() {
+    return tracker_enabled.load(std::memory_order_acquire);
+}
+
+void
+QAllocationTracker::OnAllocate(void* block, uint64_t size, memory_tag tag, const char* file, uint32_t line) {
+    if (!block || !tracker_enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    if (!tracker.live) {
+        return;
+    }
+
+    uint32_t site = find_or_add_site(file, line, tag);
+    tracker.sites[site].frame_count++;
+    tracker.sites[site].frame_bytes += size;
+
+    // Grow at 50% load. When it is mostly tombstones a same-size rebuild is enough
+    if ((tracker.live_used + 1) * 2 > tracker.live_capacity) {
+        uint64_t capacity = tracker.live_count * 4 > tracker.live_capacity ? tracker.live_capacity * 2 : tracker.live_capacity;
+        rebuild_live(capacity);
+    }
+
+    uint64_t mask = tracker.live_capacity - 1;
+    uint64_t slot = hash_pointer(reinterpret_cast<uintptr_t>(block)) & mask;
+    while (tracker.live[slot].block > slot_deleted) {
+        slot = (slot + 1) & mask;
+    }
+
+    if (tracker.live[slot].block == slot_empty) {
+        tracker.live_used++;
+    }
+    tracker.live_count++;
+
+    live_entry& entry = tracker.live[slot];
+    entry.block = reinterpret_cast<uintptr_t>(block);
+    entry.size = size;
+    entry.frame = tracker.frame;
+    entry.site = site;
+    entry.tag = tag;
+}
+
+void
+QAllocationTracker::OnFree(void* block, uint64_t size) {
+    if (!block || !tracker_enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    uint64_t recorded_size = size;
+    const char* file = nullptr;
+    uint32_t line = 0;
+    {
+        std::lock_guard<std::mutex> guard(tracker_lock);
+        if (!tracker.live) {
+            return;
+        }
+
+        uint64_t mask = tracker.live_capacity - 1;
+        uint64_t slot = hash_pointer(reinterpret_cast<uintptr_t>(block)) & mask;
+        while (tracker.live[slot].block != slot_empty) {
+            if (tracker.live[slot].block == reinterpret_cast<uintptr_t>(block)) {
+                recorded_size = tracker.live[slot].size;
+                file = tracker.sites[tracker.live[slot].site].file;
+                line = tracker.sites[tracker.live[slot].site].line;
+
+                tracker.live[slot].block = slot_deleted;
+                tracker.live_count--;
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    // Blocks allocated before tracking was enabled are not in the table
+    if (file && recorded_size != size) {
+        qlogger::Warn("QAllocator::Free(): %llu bytes freed, but the block from %s:%u was %llu bytes", size, file, line, recorded_size);
+    }
+}
+
+void
+QAllocationTracker::NextFrame() {
+    if (!tracker_enabled.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    for (uint32_t i = 0; i < tracker.site_count; i++) {
+        site_entry& site = tracker.sites[i];
+        site.last_frame_count = site.frame_count;
+        site.last_frame_bytes = site.frame_bytes;
+        site.frame_count = 0;
+        site.frame_bytes = 0;
+    }
+    tracker.frame++;
+}
+
+uint64_t
+QAllocationTracker::FrameNumber() {
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    return tracker.frame;
+}
+
+// Insert into a top-N list kept sorted by key, descending
+static uint32_t
+insert_sorted(allocation_site_report* out, uint32_t count, uint32_t max_sites, const allocation_site_report& report, bool by_bytes) {
+    auto key = [by_bytes](const allocation_site_report& r) { return by_bytes ? r.bytes : r.count; };
+
+    uint32_t position = count;
+    while (position > 0 && key(out[position - 1]) < key(report)) {
+        position--;
+    }
+    if (position >= max_sites) {
+        return count;
+    }
+
+    uint32_t last = count < max_sites ? count : max_sites - 1;
+    for (uint32_t i = last; i > position; i--) {
+        out[i] = out[i - 1];
+    }
+    out[position] = report;
+    return count < max_sites ? count + 1 : count;
+}
+
+uint32_t
+QAllocationTracker::LiveSites(allocation_site_report* out, uint32_t max_sites) {
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    if (!tracker.live || max_sites == 0 || tracker.site_count == 0) {
+        return 0;
+    }
+
+    // Group the live blocks by site
+    allocation_site_report* totals = static_cast<allocation_site_report*>(
+        platform_allocate_zeroed(tracker.site_count * sizeof(allocation_site_report)));
+    for (uint32_t i = 0; i < tracker.site_count; i++) {
+        totals[i].file = tracker.sites[i].file;
+        totals[i].line = tracker.sites[i].line;
+        totals[i].tag = tracker.sites[i].tag;
+        totals[i].first_frame = UINT64_MAX;
+    }
+
+    for (uint64_t i = 0; i < tracker.live_capacity; i++) {
+        const live_entry& entry = tracker.live[i];
+        if (entry.block > slot_deleted) {
+            allocation_site_report& total = totals[entry.site];
+            total.bytes += entry.size;
+            total.count++;
+            if (entry.frame < total.first_frame) {
+                total.first_frame = entry.frame;
+            }
+        }
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < tracker.site_count; i++) {
+        if (totals[i].count) {
+            count = insert_sorted(out, count, max_sites, totals[i], true);
+        }
+    }
+
+    Platform::Free(totals, false);
+    return count;
+}
+
+uint32_t
+QAllocationTracker::FrameSites(allocation_site_report* out, uint32_t max_sites) {
+    std::lock_guard<std::mutex> guard(tracker_lock);
+    if (max_sites == 0) {
+        return 0;
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < tracker.site_count; i++) {
+        const site_entry& site = tracker.sites[i];
+        if (site.last_frame_count) {
+            allocation_site_report report {};
+            report.file = site.file;
+            report.line = site.line;
+            report.tag = site.tag;
+            report.bytes = site.last_frame_bytes;
+            report.count = site.last_frame_count;
+            report.first_frame = tracker.frame - 1;
+            count = insert_sorted(out, count, max_sites, report, false);
+        }
+    }
+    return count;
+}
+
+} // qmemory
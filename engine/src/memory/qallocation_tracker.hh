@@ -0,0 +1,55 @@
+#pragma once
+#include "defines.hh"
+#include "core/qmemory.hh"
+#include <cstdint>
+
+/**
+ * qallocation_tracker.hh
+ *
+ * Records where QAllocator allocations come from. Every live block is kept in an
+ * open-addressing table (block -> call site, size, tag, frame) and every call site keeps
+ * counters for the current and the previous frame.
+ *
+ * The tracker takes its memory straight from the platform, so it never shows up in its
+ * own reports. It is only used through QAllocator (SetTracking, GetLeakReport, GetTopAllocatorsString).
+*/
+
+namespace qmemory {
+    // One call site in a report
+    struct allocation_site_report {
+        const char* file;
+        uint32_t line;
+        memory_tag tag;
+        uint64_t bytes;        // live bytes (leak report) or bytes allocated in the last frame
+        uint64_t count;        // live blocks (leak report) or allocations in the last frame
+        uint64_t first_frame;  // frame of the oldest live block (leak report only)
+    };
+
+    class QAllocationTracker {
+        public:
+            static void Enable();
+            static void Disable(); // drops everything that has been recorded
+            static bool IsEnabled();
+
+            static void OnAllocate(void* block, uint64_t size, memory_tag tag, const char* file, uint32_t line);
+            static void OnFree(void* block, uint64_t size);
+
+            /**
+             * @brief Close the current frame. Its per-site counters become the "last frame" ones
+            */
+            static void NextFrame();
+            static uint64_t FrameNumber();
+
+            /**
+             * @brief Live allocations grouped by call site, largest total first
+             * @returns number of entries written to out
+            */
+            static uint32_t LiveSites(allocation_site_report* out, uint32_t max_sites);
+
+            /**
+             * @brief Call sites that allocated during the last completed frame, most allocations first
+             * @returns number of entries written to out
+            */
+            static uint32_t FrameSites(allocation_site_report* out, uint32_t max_sites);
+    };
+} // qmemory
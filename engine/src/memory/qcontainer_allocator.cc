@@ -0,0 +1,116 @@
+#include "qcontainer_allocator.hh"
+#include "qlinear_allocator.hh"
+#include "qdynamic_allocator.hh"
+/**
+ * Implementation for the container allocator adapters
+*/
+
+namespace qmemory {
+
+//
+// QAllocator
+//
+static void*
+default_allocate(void*, uint64_t size, uint64_t alignment, memory_tag tag, const char* file, uint32_t line) {
+    return QAllocator::AllocateAligned(1, size, alignment, tag, file, line);
+}
+
+static void*
+default_reallocate(void*, void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag tag,
+                   const char* file, uint32_t line) {
+    return QAllocator::Reallocate(block, old_size, new_size, alignment, tag, file, line);
+}
+
+static void
+default_free(void*, void* block, uint64_t size, uint64_t alignment, memory_tag tag) {
+    QAllocator::FreeAligned(block, size, alignment, tag);
+}
+
+static const QContainerAllocatorOps default_ops = { default_allocate, default_reallocate, default_free };
+
+//
+// Linear allocator
+//
+static void*
+linear_allocate(void* context, uint64_t size, uint64_t alignment, memory_tag, const char*, uint32_t) {
+    return static_cast<QLinearAllocator*>(context)->Allocate(size, alignment);
+}
+
+static void*
+linear_reallocate(void* context, void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag,
+                  const char*, uint32_t) {
+    QLinearAllocator* allocator = static_cast<QLinearAllocator*>(context);
+
+    // The most recent allocation can grow or shrink by moving the top
+    uint8_t* top = static_cast<uint8_t*>(allocator->memory) + allocator->allocated;
+    if (block && static_cast<uint8_t*>(block) + old_size == top) {
+        uint64_t start = allocator->allocated - old_size;
+        if (start + new_size <= allocator->total_size) {
+            allocator->allocated = start + new_size;
+            return block;
+        }
+    }
+
+    void* new_block = allocator->Allocate(new_size, alignment);
+    if (new_block && block) {
+        QAllocator::Copy(new_block, block, old_size < new_size ? old_size : new_size);
+    }
+    return new_block;
+}
+
+static void
+linear_free(void*, void*, uint64_t, uint64_t, memory_tag) {
+    // Released with the rest of the arena
+}
+
+static const QContainerAllocatorOps linear_ops = { linear_allocate, linear_reallocate, linear_free };
+
+//
+// Dynamic allocator
+//
+static void*
+dynamic_allocate(void* context, uint64_t size, uint64_t alignment, memory_tag, const char*, uint32_t) {
+    return static_cast<QDynamicAllocator*>(context)->Allocate(size, alignment);
+}
+
+static void*
+dynamic_reallocate(void* context, void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag,
+                   const char*, uint32_t) {
+    QDynamicAllocator* allocator = static_cast<QDynamicAllocator*>(context);
+
+    // Blocks are rounded up internally, so small growth often still fits
+    if (block && allocator->BlockSize(block) >= new_size) {
+        return block;
+    }
+
+    void* new_block = allocator->Allocate(new_size, alignment);
+    if (new_block && block) {
+        QAllocator::Copy(new_block, block, old_size < new_size ? old_size : new_size);
+        allocator->Free(block);
+    }
+    return new_block;
+}
+
+static void
+dynamic_free(void* context, void* block, uint64_t, uint64_t, memory_tag) {
+    static_cast<QDynamicAllocator*>(context)->Free(block);
+}
+
+static const QContainerAllocatorOps dynamic_ops = { dynamic_allocate, dynamic_reallocate, dynamic_free };
+
+QContainerAllocator
+QContainerAllocator::Default() {
+    return QContainerAllocator { &default_ops, nullptr };
+}
+
+QContainerAllocator
+QContainerAllocator::FromLinear(QLinearAllocator& allocator) {
+    return QContainerAllocator { &linear_ops, &allocator };
+}
+
+QContainerAllocator
+QContainerAllocator::FromDynamic(QDynamicAllocator& allocator) {
+    return QContainerAllocator { &dynamic_ops, &allocator };
+}
+
+} // qmemory
@@ -0,0 +1,59 @@
+#pragma once
+#include "defines.hh"
+#include "core/qmemory.hh"
+#include <cstdint>
+
+/**
+ * qcontainer_allocator.hh
+ *
+ * Where containers get their memory from. A container holds a QContainerAllocator by value:
+ * a pointer to a static table of functions and a context pointer for the allocator instance.
+ * The default routes to QAllocator, the others let a container live in an arena (frame
+ * allocator, linear allocator) or in the dynamic allocator.
+*/
+
+namespace qmemory {
+    struct QLinearAllocator;
+    struct QDynamicAllocator;
+
+    // file and line are where the container was asked to grow, for the allocation tracker
+    struct QContainerAllocatorOps {
+        void* (*allocate)(void* context, uint64_t size, uint64_t alignment, memory_tag tag, const char* file, uint32_t line);
+        // Contents are carried over bytewise, so only used for trivially copyable data
+        void* (*reallocate)(void* context, void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag tag,
+                            const char* file, uint32_t line);
+        void  (*free)(void* context, void* block, uint64_t size, uint64_t alignment, memory_tag tag);
+    };
+
+    struct QAPI QContainerAllocator {
+        const QContainerAllocatorOps* ops;
+        void* context;
+
+        // QAllocator, accounted under the container's memory tag
+        static QContainerAllocator Default();
+
+        // Arena memory. Free is a no-op and the last block can grow in place.
+        // The arena must outlive the container
+        static QContainerAllocator FromLinear(QLinearAllocator& allocator);
+
+        // Blocks from a dynamic (TLSF) allocator. The allocator must outlive the container
+        static QContainerAllocator FromDynamic(QDynamicAllocator& allocator);
+
+        void* Allocate(uint64_t size, uint64_t alignment, memory_tag tag,
+                       const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE) const {
+            return ops->allocate(context, size, alignment, tag, file, line);
+        }
+
+        void* Reallocate(void* block, uint64_t old_size, uint64_t new_size, uint64_t alignment, memory_tag tag,
+                         const char* file = Q_CALLER_FILE, uint32_t line = Q_CALLER_LINE) const {
+            return ops->reallocate(context, block, old_size, new_size, alignment, tag, file, line);
+        }
+
+        void Free(void* block, uint64_t size, uint64_t alignment, memory_tag tag) const {
+            ops->free(context, block, size, alignment, tag);
+        }
+
+        bool operator==(const QContainerAllocator& other) const { return ops == other.ops && context == other.context; }
+        bool operator!=(const QContainerAllocator& other) const { return !(*this == other); }
+    };
+} // qmemory
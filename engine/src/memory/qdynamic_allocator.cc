@@ -0,0 +1,453 @@
+#include "qdynamic_allocator.hh"
+#include "core/qmemory.hh"
+#include "core/qlogger.hh"
+/**
+ * Implementation for the dynamic (TLSF) allocator
+*/
+
+namespace qmemory {
+
+// Blocks and their payloads are kept 16 byte aligned
+static constexpr uint64_t align_size = 16;
+static constexpr uint32_t align_size_log2 = 4;
+
+// Second level: each power of two range is split into 32 lists
+static constexpr uint32_t sl_index_count_log2 = 5;
+static constexpr uint32_t sl_index_count = 1 << sl_index_count_log2;
+
+// First level: everything below small_block_size goes into the first row in linear steps
+static constexpr uint32_t fl_index_shift = sl_index_count_log2 + align_size_log2;
+static constexpr uint32_t fl_index_max = 32; // 4 GiB blocks
+static constexpr uint32_t fl_index_count = fl_index_max - fl_index_shift + 1;
+static constexpr uint64_t small_block_size = uint64_t(1) << fl_index_shift;
+
+// Low bits of block_header::size are flags since sizes are multiples of align_size
+static constexpr uint64_t block_free_bit = 1 << 0;
+static constexpr uint64_t block_prev_free_bit = 1 << 1;
+static constexpr uint64_t block_flag_mask = block_free_bit | block_prev_free_bit;
+
+// Header in front of every block. next_free/prev_free overlap the payload and
+// are only valid while the block is free
+struct block_header {
+    block_header* prev_phys; // valid only if the previous block is free
+    uint64_t size;           // payload size | flags
+
+    block_header* next_free;
+    block_header* prev_free;
+};
+
+static constexpr uint64_t block_header_overhead = 16; // prev_phys + size
+static constexpr uint64_t block_size_min = 16;       // room for the free list links
+static constexpr uint64_t block_size_max = uint64_t(1) << fl_index_max;
+
+struct dynamic_allocator_state {
+    uint64_t pool_size;
+    uint64_t free_space;
+    uint8_t* pool_start;
+    uint8_t* pool_end;
+
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[fl_index_count];
+    block_header* blocks[fl_index_count][sl_index_count];
+};
+
+//
+// Bit helpers
+//
+static inline uint32_t
+find_first_set(uint32_t word) {
+    return static_cast<uint32_t>(__builtin_ctz(word));
+}
+
+static inline uint32_t
+find_last_set(uint64_t word) {
+    return 63 - static_cast<uint32_t>(__builtin_clzll(word));
+}
+
+static inline uint64_t
+align_up(uint64_t value, uint64_t alignment) {
+    return (value + (alignment - 1)) & ~(alignment - 1);
+}
+
+//
+// Block helpers
+//
+static inline uint64_t block_size(const block_header* block) { return block->size & ~block_flag_mask; }
+static inline void block_set_size(block_header* block, uint64_t size) { block->size = size | (block->size & block_flag_mask); }
+static inline bool block_is_free(const block_header* block) { return block->size & block_free_bit; }
+static inline bool block_is_prev_free(const block_header* block) { return block->size & block_prev_free_bit; }
+static inline bool block_is_last(const block_header* block) { return block_size(block) == 0; }
+
+static inline uint8_t* block_to_ptr(block_header* block) {
+    return reinterpret_cast<uint8_t*>(block) + block_header_overhead;
+}
+
+static inline block_header* block_from_ptr(void* ptr) {
+    return reinterpret_cast<block_header*>(static_cast<uint8_t*>(ptr) - block_header_overhead);
+}
+
+static inline block_header* block_next(block_header* block) {
+    return reinterpret_cast<block_header*>(block_to_ptr(block) + block_size(block));
+}
+
+// Point the next physical block back at this one and return it
+static inline block_header* block_link_next(block_header* block) {
+    block_header* next = block_next(block);
+    next->prev_phys = block;
+    return next;
+}
+
+static inline void block_mark_as_free(block_header* block) {
+    block_header* next = block_link_next(block);
+    next->size |= block_prev_free_bit;
+    block->size |= block_free_bit;
+}
+
+static inline void block_mark_as_used(block_header* block) {
+    block_header* next = block_next(block);
+    next->size &= ~block_prev_free_bit;
+    block->size &= ~block_free_bit;
+}
+
+//
+// Size to list mapping
+//
+static inline void
+mapping_insert(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if (size < small_block_size) {
+        fl = 0;
+        sl = static_cast<uint32_t>(size / (small_block_size / sl_index_count));
+    } else {
+        uint32_t bit = find_last_set(size);
+        sl = static_cast<uint32_t>(size >> (bit - sl_index_count_log2)) ^ (1u << sl_index_count_log2);
+        fl = bit - (fl_index_shift - 1);
+    }
+}
+
+// Round up to the next list so that any block found there is large enough
+static inline void
+mapping_search(uint64_t size, uint32_t& fl, uint32_t& sl) {
+    if (size >= small_block_size) {
+        size += (uint64_t(1) << (find_last_set(size) - sl_index_count_log2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static block_header*
+search_suitable_block(dynamic_allocator_state* state, uint32_t& fl, uint32_t& sl) {
+    if (fl >= fl_index_count) {
+        return nullptr;
+    }
+
+    uint32_t sl_map = state->sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        // Nothing in this row, look in the next non-empty first level
+        uint32_t fl_map = (fl + 1 < 32) ? state->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (!fl_map) {
+            return nullptr;
+        }
+        fl = find_first_set(fl_map);
+        sl_map = state->sl_bitmap[fl];
+    }
+
+    sl = find_first_set(sl_map);
+    return state->blocks[fl][sl];
+}
+
+static void
+remove_free_block(dynamic_allocator_state* state, block_header* block, uint32_t fl, uint32_t sl) {
+    block_header* prev = block->prev_free;
+    block_header* next = block->next_free;
+    if (next) {
+        next->prev_free = prev;
+    }
+    if (prev) {
+        prev->next_free = next;
+    }
+
+    if (state->blocks[fl][sl] == block) {
+        state->blocks[fl][sl] = next;
+        if (!next) {
+            state->sl_bitmap[fl] &= ~(1u << sl);
+            if (!state->sl_bitmap[fl]) {
+                state->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+}
+
+static void
+insert_free_block(dynamic_allocator_state* state, block_header* block, uint32_t fl, uint32_t sl) {
+    block_header* current = state->blocks[fl][sl];
+    block->next_free = current;
+    block->prev_free = nullptr;
+    if (current) {
+        current->prev_free = block;
+    }
+
+    state->blocks[fl][sl] = block;
+    state->fl_bitmap |= (1u << fl);
+    state->sl_bitmap[fl] |= (1u << sl);
+}
+
+static inline void
+block_remove(dynamic_allocator_state* state, block_header* block) {
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), fl, sl);
+    remove_free_block(state, block, fl, sl);
+}
+
+static inline void
+block_insert(dynamic_allocator_state* state, block_header* block) {
+    uint32_t fl, sl;
+    mapping_insert(block_size(block), fl, sl);
+    insert_free_block(state, block, fl, sl);
+}
+
+static inline bool
+block_can_split(block_header* block, uint64_t size) {
+    return block_size(block) >= size + block_header_overhead + block_size_min;
+}
+
+// Cut block down to size bytes. The tail becomes a new free block which is returned
+static block_header*
+block_split(block_header* block, uint64_t size) {
+    block_header* remaining = reinterpret_cast<block_header*>(block_to_ptr(block) + size);
+    uint64_t remaining_size = block_size(block) - (size + block_header_overhead);
+
+    remaining->size = remaining_size;
+    block_set_size(block, size);
+    block_mark_as_free(remaining);
+    return remaining;
+}
+
+// Merge block into prev. Both are adjacent, prev comes first
+static block_header*
+block_absorb(block_header* prev, block_header* block) {
+    block_set_size(prev, block_size(prev) + block_size(block) + block_header_overhead);
+    block_link_next(prev);
+    return prev;
+}
+
+static block_header*
+block_merge_prev(dynamic_allocator_state* state, block_header* block) {
+    if (block_is_prev_free(block)) {
+        block_header* prev = block->prev_phys;
+        block_remove(state, prev);
+        block = block_absorb(prev, block);
+    }
+    return block;
+}
+
+static block_header*
+block_merge_next(dynamic_allocator_state* state, block_header* block) {
+    block_header* next = block_next(block);
+    if (block_is_free(next)) {
+        block_remove(state, next);
+        block = block_absorb(block, next);
+    }
+    return block;
+}
+
+// Give back the end of a free-list block that is larger than needed
+static void
+block_trim_free(dynamic_allocator_state* state, block_header* block, uint64_t size) {
+    if (block_can_split(block, size)) {
+        block_header* remaining = block_split(block, size);
+        block_link_next(block);
+        remaining->size |= block_prev_free_bit;
+        block_insert(state, remaining);
+    }
+}
+
+// Split gap bytes off the front of a free block and return the block that follows
+static block_header*
+block_trim_free_leading(dynamic_allocator_state* state, block_header* block, uint64_t gap) {
+    block_header* remaining = block_split(block, gap - block_header_overhead);
+    remaining->size |= block_prev_free_bit;
+    block_link_next(block);
+    block_insert(state, block);
+    return remaining;
+}
+
+static void*
+block_prepare_used(dynamic_allocator_state* state, block_header* block, uint64_t size) {
+    block_trim_free(state, block, size);
+    block_mark_as_used(block);
+    state->free_space -= block_size(block) + block_header_overhead;
+    return block_to_ptr(block);
+}
+
+static inline uint64_t
+adjust_request_size(uint64_t size) {
+    uint64_t aligned = align_up(size, align_size);
+    return aligned < block_size_min ? block_size_min : aligned;
+}
+
+static inline dynamic_allocator_state*
+get_state(const QDynamicAllocator* allocator) {
+    return static_cast<dynamic_allocator_state*>(allocator->memory);
+}
+
+bool
+QDynamicAllocator::Create(uint64_t total_size, uint64_t& memory_requirement, void* memory) {
+    total_size = align_up(total_size, align_size);
+
+    // State, padding to align the pool, the pool, and the zero sized sentinel block at the end
+    memory_requirement = sizeof(dynamic_allocator_state) + align_size + total_size + block_header_overhead * 2;
+    if (memory == nullptr) {
+        return true;
+    }
+
+    // A block of exactly block_size_max would map to first level fl_index_count, past the end of the lists
+    if (total_size < block_size_min || total_size >= block_size_max) {
+        qlogger::Error("QDynamicAllocator::Create(): unsupported size %llu", total_size);
+        return false;
+    }
+
+    this->total_size = total_size;
+    this->memory = memory;
+
+    dynamic_allocator_state* state = static_cast<dynamic_allocator_state*>(memory);
+    QAllocator::Zero(state, sizeof(dynamic_allocator_state));
+
+    uintptr_t pool = align_up(reinterpret_cast<uintptr_t>(memory) + sizeof(dynamic_allocator_state), align_size);
+    state->pool_start = reinterpret_cast<uint8_t*>(pool);
+    state->pool_end = state->pool_start + total_size + block_header_overhead * 2;
+    state->pool_size = total_size;
+    state->free_space = total_size + block_header_overhead;
+
+    // One free block spanning the whole pool
+    block_header* block = reinterpret_cast<block_header*>(state->pool_start);
+    block->prev_phys = nullptr;
+    block->size = total_size;
+    block_mark_as_free(block);
+    block_insert(state, block);
+
+    // Sentinel: used, zero sized, stops merges running off the end
+    block_header* sentinel = block_link_next(block);
+    sentinel->size = 0 | block_prev_free_bit;
+    return true;
+}
+
+void
+QDynamicAllocator::Destroy() {
+    // Backing memory belongs to the caller
+    this->memory = nullptr;
+    this->total_size = 0;
+}
+
+void*
+QDynamicAllocator::Allocate(uint64_t size, uint64_t alignment) {
+    dynamic_allocator_state* state = get_state(this);
+    if (!state) {
+        qlogger::Error("QDynamicAllocator::Allocate(): allocator not created");
+        return nullptr;
+    }
+
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        qlogger::Error("QDynamicAllocator::Allocate(): alignment %llu is not a power of two", alignment);
+        return nullptr;
+    }
+
+    uint64_t adjusted = adjust_request_size(size);
+    if (adjusted >= block_size_max) {
+        return nullptr;
+    }
+
+    if (alignment <= align_size) {
+        uint32_t fl = 0, sl = 0;
+        mapping_search(adjusted, fl, sl);
+        block_header* block = search_suitable_block(state, fl, sl);
+        if (!block) {
+            return nullptr;
+        }
+        remove_free_block(state, block, fl, sl);
+        return block_prepare_used(state, block, adjusted);
+    }
+
+    // Over-aligned: ask for enough to slide the payload forward. A leading gap has to be
+    // big enough to become a free block of its own
+    const uint64_t gap_minimum = block_header_overhead + block_size_min;
+    uint64_t with_gap = adjust_request_size(adjusted + alignment + gap_minimum);
+
+    uint32_t fl = 0, sl = 0;
+    mapping_search(with_gap, fl, sl);
+    block_header* block = search_suitable_block(state, fl, sl);
+    if (!block) {
+        return nullptr;
+    }
+    remove_free_block(state, block, fl, sl);
+
+    uintptr_t ptr = reinterpret_cast<uintptr_t>(block_to_ptr(block));
+    uintptr_t aligned = align_up(ptr, alignment);
+    uint64_t gap = aligned - ptr;
+    if (gap && gap < gap_minimum) {
+        aligned += alignment;
+        gap = aligned - ptr;
+    }
+
+    if (gap) {
+        block = block_trim_free_leading(state, block, gap);
+    }
+
+    return block_prepare_used(state, block, adjusted);
+}
+
+bool
+QDynamicAllocator::Free(void* block) {
+    if (!block) {
+        return true;
+    }
+
+    if (!this->Owns(block)) {
+        qlogger::Error("QDynamicAllocator::Free(): block %p does not belong to this allocator", block);
+        return false;
+    }
+
+    dynamic_allocator_state* state = get_state(this);
+    block_header* header = block_from_ptr(block);
+    if (block_is_free(header)) {
+        qlogger::Error("QDynamicAllocator::Free(): double free of %p", block);
+        return false;
+    }
+
+    state->free_space += block_size(header) + block_header_overhead;
+    block_mark_as_free(header);
+    header = block_merge_prev(state, header);
+    header = block_merge_next(state, header);
+    block_insert(state, header);
+    return true;
+}
+
+uint64_t
+QDynamicAllocator::BlockSize(void* block) const {
+    if (!block) {
+        return 0;
+    }
+    return block_size(block_from_ptr(block));
+}
+
+uint64_t
+QDynamicAllocator::FreeSpace() const {
+    dynamic_allocator_state* state = get_state(this);
+    if (!state || state->free_space < block_header_overhead) {
+        return 0;
+    }
+
+    // The header of at least one free block is never usable
+    return state->free_space - block_header_overhead;
+}
+
+bool
+QDynamicAllocator::Owns(void* block) const {
+    dynamic_allocator_state* state = get_state(this);
+    if (!state) {
+        return false;
+    }
+
+    uint8_t* ptr = static_cast<uint8_t*>(block);
+    return ptr >= state->pool_start + block_header_overhead && ptr < state->pool_end;
+}
+
+} // qmemory
@@ -0,0 +1,54 @@
+#pragma once
+#include "defines.hh"
+#include <cstdint>
+
+/**
+ * qdynamic_allocator.hh
+ *
+ * General purpose allocator that lives inside one pre-reserved block of memory.
+ * Meant for long-lived engine data (textures, materials, shaders) that is created and
+ * destroyed in any order, where the linear allocator does not fit.
+ *
+ * Implemented as a two-level segregated fit (TLSF) allocator: free blocks are binned by
+ * size into 24 x 32 lists with bitmaps on top, so Allocate and Free are O(1) and
+ * fragmentation is bounded. No system calls are made after Create.
+*/
+
+namespace qmemory {
+    struct QAPI QDynamicAllocator {
+        uint64_t total_size;
+        void* memory;
+
+        /**
+         * @brief Two-phase create, same as the subsystem Initialize functions.
+         *     Call once with memory == nullptr to get memory_requirement, then again with
+         *     a block of at least that many bytes
+         * @param total_size usable bytes managed by the allocator
+         * @param memory_requirement set to the number of bytes memory must point to
+         * @param memory backing block, owned by the caller. Must stay valid until Destroy
+         * @returns true if the allocator is ready (or the requirement was written), false on error
+        */
+        bool Create(uint64_t total_size, uint64_t& memory_requirement, void* memory);
+        void Destroy();
+
+        /**
+         * @brief Allocate size bytes aligned to alignment. Memory is not zeroed
+         * @returns pointer to the block, or nullptr if there is no free block large enough
+        */
+        void* Allocate(uint64_t size, uint64_t alignment = 16);
+
+        /**
+         * @brief Return a block to the allocator. The size is tracked internally
+         * @returns false if block does not belong to this allocator
+        */
+        bool Free(void* block);
+
+        /**
+         * @brief Usable size of an allocated block. At least the size that was requested
+        */
+        uint64_t BlockSize(void* block) const;
+
+        uint64_t FreeSpace() const;
+        bool Owns(void* block) const;
+    };
+} // qmemory
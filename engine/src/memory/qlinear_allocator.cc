@@ -16,7 +16,7 @@ QLinearAllocator::Create(uint64_t total_size, void* memory) {
     if (memory) {
         this->memory = memory;
     } else {
-        this->memory = QAllocator::Allocate(1, total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
+        this->memory = QAllocator::AllocateZeroed(1, total_size, MEMORY_TAG_LINEAR_ALLOCATOR);
     }
 }
 
@@ -36,18 +36,27 @@ QLinearAllocator::Destroy() {
 }
 
 void* 
-QLinearAllocator::Allocate(uint64_t size) {
+QLinearAllocator::Allocate(uint64_t size, uint64_t alignment) {
     if (this->memory) {
-        if (this->allocated + size > this->total_size) {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+            qlogger::Error("QLinearAllocator::Allocate(): alignment %llu is not a power of two", alignment);
+            return nullptr;
+        }
+
+        // Pad the current offset up to the requested alignment
+        uintptr_t current = reinterpret_cast<uintptr_t>(this->memory) + this->allocated;
+        uintptr_t aligned = (current + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+        uint64_t padding = aligned - current;
+
+        if (this->allocated + padding + size > this->total_size) {
             uint64_t remaining = this->total_size - this->allocated;
             qlogger::Error("QLinearAllocator::Allocate(): tried to allocate %llu bytes with only %llu remaining", size, remaining);
 
             return nullptr;
         }
     
-        void* block = static_cast<uint8_t*>(this->memory) + this->allocated;
-        this->allocated += size;
-        return block;
+        this->allocated += padding + size;
+        return reinterpret_cast<void*>(aligned);
     }
 
     qlogger::Error("QLinearAllocator::Allocate(): memory not initialized when called");
@@ -55,12 +64,29 @@ QLinearAllocator::Allocate(uint64_t size) {
 }
 
 void 
-QLinearAllocator::FreeAll() {
+QLinearAllocator::FreeAll(bool zero_memory) {
     if (this->memory) {
+        if (zero_memory) {
+            QAllocator::Zero(this->memory, this->allocated);
+        }
         this->allocated = 0;
-        QAllocator::Zero(this->memory, this->total_size);
     }
 }
 
+uint64_t
+QLinearAllocator::GetMarker() const {
+    return this->allocated;
+}
+
+void
+QLinearAllocator::Rewind(uint64_t marker) {
+    if (marker > this->allocated) {
+        qlogger::Error("QLinearAllocator::Rewind(): marker %llu is past the current top %llu", marker, this->allocated);
+        return;
+    }
+
+    this->allocated = marker;
+}
+
 
 } // qmemory
\ No newline at end of file
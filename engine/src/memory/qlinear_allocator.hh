@@ -13,7 +13,43 @@ namespace qmemory {
         void Create(uint64_t total_size, void* memory);
         void Destroy();
 
-        void* Allocate(uint64_t size);
-        void FreeAll();
+        /**
+         * @brief Bump allocate size bytes from the block
+         * @param size number of bytes to allocate
+         * @param alignment power of two alignment of the returned pointer. Use 16 for SIMD data
+         * @returns pointer into the block, or nullptr if there is not enough space left
+        */
+        void* Allocate(uint64_t size, uint64_t alignment = 8);
+
+        /**
+         * @brief Release every allocation at once. This is O(1) unless zero_memory is set,
+         *     in which case the used part of the block is cleared as well
+        */
+        void FreeAll(bool zero_memory = false);
+
+        /**
+         * @brief Get a marker for the current top of the allocator.
+         *     Passing it to Rewind releases everything allocated after this call
+        */
+        uint64_t GetMarker() const;
+
+        /**
+         * @brief Release every allocation made after marker was taken
+        */
+        void Rewind(uint64_t marker);
+    };
+
+    // Releases everything allocated from the allocator during its lifetime.
+    // Used for nested scratch scopes (e.g. per render pass) on a shared arena
+    struct QLinearAllocatorScope {
+        QLinearAllocator& allocator;
+        uint64_t marker;
+
+        explicit QLinearAllocatorScope(QLinearAllocator& alloc)
+            : allocator(alloc), marker(alloc.GetMarker()) {}
+        ~QLinearAllocatorScope() { allocator.Rewind(marker); }
+
+        QLinearAllocatorScope(const QLinearAllocatorScope&) = delete;
+        QLinearAllocatorScope& operator=(const QLinearAllocatorScope&) = delete;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,167 @@
+#include "qpool_allocator.hh"
+#include "core/qlogger.hh"
+/**
+ * Implementation for pool allocator
+*/
+
+namespace qmemory {
+
+// Marks the end of the free list
+static constexpr uint32_t free_list_end = QPoolHandle::index_mask;
+
+void
+QPoolAllocator::Create(uint64_t element_size, uint64_t element_alignment, uint32_t elements_per_slab, uint32_t max_elements, memory_tag tag) {
+    if (element_alignment < alignof(uint32_t)) {
+        element_alignment = alignof(uint32_t);
+    }
+
+    // Free slots hold the index of the next free slot, so every slot must fit a uint32_t
+    if (element_size < sizeof(uint32_t)) {
+        element_size = sizeof(uint32_t);
+    }
+    element_size = (element_size + element_alignment - 1) & ~(element_alignment - 1);
+
+    if (max_elements >= QPoolHandle::index_mask) {
+        qlogger::Warn("QPoolAllocator::Create(): max_elements %u clamped to %u", max_elements, QPoolHandle::index_mask - 1);
+        max_elements = QPoolHandle::index_mask - 1;
+    }
+
+    uint32_t capacity = 1;
+    uint32_t shift = 0;
+    while (capacity < elements_per_slab) {
+        capacity <<= 1;
+        shift++;
+    }
+
+    this->element_size = element_size;
+    this->element_alignment = element_alignment;
+    this->slab_capacity = capacity;
+    this->slab_shift = shift;
+    this->slab_count = 0;
+    this->max_elements = max_elements;
+    this->max_slabs = (max_elements + capacity - 1) / capacity;
+    if (this->max_slabs > QPoolHandle::index_mask / capacity) {
+        // Keep every slot index below the free list sentinel
+        this->max_slabs = QPoolHandle::index_mask / capacity;
+    }
+    this->free_head = free_list_end;
+    this->live_count = 0;
+    this->tag = tag;
+
+    this->slabs = static_cast<uint8_t**>(QAllocator::AllocateZeroed(this->max_slabs, sizeof(uint8_t*), tag));
+    this->generations = static_cast<uint16_t**>(QAllocator::AllocateZeroed(this->max_slabs, sizeof(uint16_t*), tag));
+}
+
+void
+QPoolAllocator::Destroy() {
+    for (uint32_t i = 0; i < this->slab_count; i++) {
+        QAllocator::FreeAligned(this->slabs[i], this->element_size * this->slab_capacity, this->element_alignment, this->tag);
+        QAllocator::Free(this->generations[i], sizeof(uint16_t) * this->slab_capacity, this->tag);
+    }
+
+    if (this->slabs) {
+        QAllocator::Free(this->slabs, this->max_slabs * sizeof(uint8_t*), this->tag);
+        QAllocator::Free(this->generations, this->max_slabs * sizeof(uint16_t*), this->tag);
+    }
+
+    this->slabs = nullptr;
+    this->generations = nullptr;
+    this->slab_count = 0;
+    this->max_slabs = 0;
+    this->max_elements = 0;
+    this->free_head = free_list_end;
+    this->live_count = 0;
+}
+
+// Add a slab and thread all of its slots onto the free list in ascending order
+static bool
+grow(QPoolAllocator& pool) {
+    if (pool.slab_count == pool.max_slabs) {
+        return false;
+    }
+
+    uint32_t slab = pool.slab_count;
+    pool.slabs[slab] = static_cast<uint8_t*>(QAllocator::AllocateAligned(pool.slab_capacity, pool.element_size, pool.element_alignment, pool.tag));
+    pool.generations[slab] = static_cast<uint16_t*>(QAllocator::AllocateZeroed(pool.slab_capacity, sizeof(uint16_t), pool.tag));
+    pool.slab_count++;
+
+    uint32_t first_index = slab << pool.slab_shift;
+    for (uint32_t i = pool.slab_capacity; i > 0; i--) {
+        uint32_t* slot = reinterpret_cast<uint32_t*>(pool.slabs[slab] + (i - 1) * pool.element_size);
+        *slot = pool.free_head;
+        pool.free_head = first_index + (i - 1);
+    }
+
+    return true;
+}
+
+QPoolHandle
+QPoolAllocator::Allocate() {
+    QPoolHandle handle;
+    if (this->live_count >= this->max_elements || (this->free_head == free_list_end && !grow(*this))) {
+        qlogger::Error("QPoolAllocator::Allocate(): pool is full (%u objects)", this->live_count);
+        return handle;
+    }
+
+    uint32_t index = this->free_head;
+    uint32_t slab = index >> this->slab_shift;
+    uint32_t slot = index & (this->slab_capacity - 1);
+
+    uint32_t* free_slot = reinterpret_cast<uint32_t*>(this->slabs[slab] + slot * this->element_size);
+    this->free_head = *free_slot;
+
+    // Generation becomes odd while the slot is in use
+    uint16_t& generation = this->generations[slab][slot];
+    generation++;
+    this->live_count++;
+
+    handle.value = (static_cast<uint32_t>(generation & QPoolHandle::generation_mask) << QPoolHandle::index_bits) | index;
+    return handle;
+}
+
+bool
+QPoolAllocator::IsValid(QPoolHandle handle) const {
+    if (handle.is_null()) {
+        return false;
+    }
+
+    uint32_t index = handle.index();
+    uint32_t slab = index >> this->slab_shift;
+    if (slab >= this->slab_count) {
+        return false;
+    }
+
+    uint16_t generation = this->generations[slab][index & (this->slab_capacity - 1)];
+    return (generation & 1) && (generation & QPoolHandle::generation_mask) == handle.generation();
+}
+
+bool
+QPoolAllocator::Free(QPoolHandle handle) {
+    if (!this->IsValid(handle)) {
+        qlogger::Warn("QPoolAllocator::Free(): stale or invalid handle %u", handle.value);
+        return false;
+    }
+
+    uint32_t index = handle.index();
+    uint32_t slab = index >> this->slab_shift;
+    uint32_t slot = index & (this->slab_capacity - 1);
+
+    this->generations[slab][slot]++;
+    uint32_t* free_slot = reinterpret_cast<uint32_t*>(this->slabs[slab] + slot * this->element_size);
+    *free_slot = this->free_head;
+    this->free_head = index;
+    this->live_count--;
+    return true;
+}
+
+void*
+QPoolAllocator::Get(QPoolHandle handle) const {
+    if (!this->IsValid(handle)) {
+        return nullptr;
+    }
+
+    uint32_t index = handle.index();
+    return this->slabs[index >> this->slab_shift] + (index & (this->slab_capacity - 1)) * this->element_size;
+}
+
+} // qmemory
@@ -0,0 +1,102 @@
+#pragma once
+#include "defines.hh"
+#include "core/qmemory.hh"
+#include <cstdint>
+
+/**
+ * qpool_allocator.hh
+ *
+ * Pool allocator for fixed size objects (entities, transforms, scene nodes...)
+ *
+ * Objects live in contiguous slabs that are allocated on demand. Free slots are linked
+ * through an intrusive free list, so Allocate and Free are O(1). Instead of raw pointers
+ * the pool hands out 32 bit handles made of a slot index and a generation counter, which
+ * lets Get() catch handles to objects that have already been freed.
+*/
+
+namespace qmemory {
+    // 20 bits of slot index, 12 bits of generation
+    struct QPoolHandle {
+        static constexpr uint32_t index_bits = 20;
+        static constexpr uint32_t index_mask = (1u << index_bits) - 1;
+        static constexpr uint32_t generation_mask = (1u << (32 - index_bits)) - 1;
+        static constexpr uint32_t invalid_value = 0xFFFFFFFF;
+
+        uint32_t value = invalid_value;
+
+        uint32_t index() const { return value & index_mask; }
+        uint32_t generation() const { return value >> index_bits; }
+        bool is_null() const { return value == invalid_value; }
+
+        bool operator==(const QPoolHandle& other) const { return value == other.value; }
+        bool operator!=(const QPoolHandle& other) const { return value != other.value; }
+    };
+
+    struct QAPI QPoolAllocator {
+        uint64_t element_size;
+        uint64_t element_alignment;
+        uint32_t slab_capacity;  // elements per slab, power of two
+        uint32_t slab_shift;
+        uint32_t slab_count;
+        uint32_t max_slabs;
+        uint32_t max_elements;   // live objects allowed, the last slab can have unused slots past it
+        uint8_t** slabs;
+        uint16_t** generations;  // per-slot generation, odd while the slot is in use
+        uint32_t free_head;
+        uint32_t live_count;
+        memory_tag tag;
+
+        /**
+         * @brief Set up an empty pool. No slabs are allocated until the first Allocate
+         * @param element_size size in bytes of one object
+         * @param element_alignment power of two alignment of every object
+         * @param elements_per_slab objects per slab, rounded up to a power of two
+         * @param max_elements hard limit on live objects. At most QPoolHandle::index_mask
+         * @param tag memory tag that slab memory is accounted under
+        */
+        void Create(uint64_t element_size, uint64_t element_alignment, uint32_t elements_per_slab, uint32_t max_elements, memory_tag tag);
+        void Destroy();
+
+        /**
+         * @brief Take a slot from the pool. Contents are not cleared
+         * @returns handle to the slot, or a null handle if the pool is full
+        */
+        QPoolHandle Allocate();
+
+        /**
+         * @brief Return a slot to the pool. Stale or null handles are logged as a warning and ignored
+         * @returns true if the handle was live and has been freed
+        */
+        bool Free(QPoolHandle handle);
+
+        bool IsValid(QPoolHandle handle) const;
+
+        /**
+         * @brief Resolve a handle to its object
+         * @returns pointer to the object, or nullptr if the handle is stale
+        */
+        void* Get(QPoolHandle handle) const;
+
+        template <typename T> T* Get(QPoolHandle handle) const {
+            return static_cast<T*>(Get(handle));
+        }
+
+        /**
+         * @brief Call func(handle, pointer) for every live object, walking the slabs in memory order
+        */
+        template <typename F> void ForEach(F&& func) const {
+            for (uint32_t slab = 0; slab < slab_count; slab++) {
+                uint8_t* objects = slabs[slab];
+                const uint16_t* gens = generations[slab];
+                for (uint32_t i = 0; i < slab_capacity; i++) {
+                    if (gens[i] & 1) {
+                        QPoolHandle handle;
+                        handle.value = (static_cast<uint32_t>(gens[i] & QPoolHandle::generation_mask) << QPoolHandle::index_bits) |
+                                       ((slab << slab_shift) | i);
+                        func(handle, static_cast<void*>(objects + i * element_size));
+                    }
+                }
+            }
+        }
+    };
+} // qmemory
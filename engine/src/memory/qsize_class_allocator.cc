@@ -0,0 +1,291 @@
+#include "qsize_class_allocator.hh"
+#include "platform/platform.hh"
+#include <atomic>
+/**
+ * Implementation for the size class allocator backend
+*/
+
+namespace qmemory {
+
+// Spans are carved out of regions that are requested from the platform in one go
+static constexpr uint64_t region_size = 16 * QSizeClassAllocator::span_size;
+
+// Free blocks store the link to the next free block in their first bytes
+struct free_block {
+    free_block* next;
+};
+
+// Stored directly in front of large blocks so that Free can recover the platform pointer
+struct large_header {
+    void* raw;
+};
+
+// Locks here are held for a handful of pointer swaps, so spinning is cheaper than a mutex.
+// It is also trivially destructible, which keeps the statics below valid during thread teardown
+struct spin_lock {
+    std::atomic_flag flag = ATOMIC_FLAG_INIT;
+
+    void lock() {
+        while (flag.test_and_set(std::memory_order_acquire)) {
+        }
+    }
+
+    void unlock() {
+        flag.clear(std::memory_order_release);
+    }
+};
+
+// Shared free list and bump span for one size class.
+// Padded to a cache line so threads refilling different classes do not contend
+struct alignas(64) central_class {
+    spin_lock lock;
+    free_block* free_list;
+    uint8_t* span_cursor;
+    uint8_t* span_end;
+};
+
+struct region_state {
+    spin_lock lock;
+    uint8_t* cursor;
+    uint8_t* end;
+};
+
+// Per-thread stash of free blocks. Flushed back to the central lists when the thread exits
+struct thread_cache {
+    free_block* head[QSizeClassAllocator::class_count];
+    uint32_t count[QSizeClassAllocator::class_count];
+
+    ~thread_cache();
+};
+
+static central_class central[QSizeClassAllocator::class_count];
+static region_state regions;
+static thread_local thread_cache t_cache;
+
+static inline uint32_t
+floor_log2(uint64_t value) {
+    return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+}
+
+static inline uint64_t
+next_pow2(uint64_t value) {
+    if (value <= 1) {
+        return 1;
+    }
+    return uint64_t(1) << (floor_log2(value - 1) + 1);
+}
+
+static inline uintptr_t
+align_up(uintptr_t value, uint64_t alignment) {
+    return (value + (alignment - 1)) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+// Number of blocks moved between a thread cache and the central list at once
+static inline uint32_t
+batch_size(uint32_t class_index) {
+    uint64_t count = 8192 / QSizeClassAllocator::ClassSize(class_index);
+    if (count < 2) {
+        return 2;
+    }
+    return count > 64 ? 64 : static_cast<uint32_t>(count);
+}
+
+static uint8_t*
+take_span() {
+    regions.lock.lock();
+    if (regions.cursor == regions.end) {
+        // Over-allocate by one span so the region can be aligned to the span size
+        uint8_t* raw = static_cast<uint8_t*>(Platform::Allocate(region_size + QSizeClassAllocator::span_size, false));
+        if (!raw) {
+            regions.lock.unlock();
+            return nullptr;
+        }
+        regions.cursor = reinterpret_cast<uint8_t*>(align_up(reinterpret_cast<uintptr_t>(raw), QSizeClassAllocator::span_size));
+        regions.end = regions.cursor + region_size;
+    }
+
+    uint8_t* span = regions.cursor;
+    regions.cursor += QSizeClassAllocator::span_size;
+    regions.lock.unlock();
+    return span;
+}
+
+// Move up to one batch of blocks from the central list (or fresh spans) into the thread cache
+static void
+refill(uint32_t class_index, thread_cache& cache) {
+    central_class& c = central[class_index];
+    const uint64_t size = QSizeClassAllocator::ClassSize(class_index);
+    const uint32_t wanted = batch_size(class_index);
+    uint32_t taken = 0;
+
+    c.lock.lock();
+    while (taken < wanted && c.free_list) {
+        free_block* block = c.free_list;
+        c.free_list = block->next;
+        block->next = cache.head[class_index];
+        cache.head[class_index] = block;
+        taken++;
+    }
+
+    while (taken < wanted) {
+        if (static_cast<uint64_t>(c.span_end - c.span_cursor) < size) {
+            uint8_t* span = take_span();
+            if (!span) {
+                break;
+            }
+            c.span_cursor = span;
+            c.span_end = span + QSizeClassAllocator::span_size;
+        }
+
+        free_block* block = reinterpret_cast<free_block*>(c.span_cursor);
+        c.span_cursor += size;
+        block->next = cache.head[class_index];
+        cache.head[class_index] = block;
+        taken++;
+    }
+    c.lock.unlock();
+
+    cache.count[class_index] += taken;
+}
+
+// Hand count blocks from the thread cache back to the central list
+static void
+release(uint32_t class_index, thread_cache& cache, uint32_t count) {
+    if (count == 0 || !cache.head[class_index]) {
+        return;
+    }
+
+    // Detach the chain outside of the lock, then splice it in
+    free_block* first = cache.head[class_index];
+    free_block* last = first;
+    uint32_t moved = 1;
+    while (moved < count && last->next) {
+        last = last->next;
+        moved++;
+    }
+    cache.head[class_index] = last->next;
+    cache.count[class_index] -= moved;
+
+    central_class& c = central[class_index];
+    c.lock.lock();
+    last->next = c.free_list;
+    c.free_list = first;
+    c.lock.unlock();
+}
+
+thread_cache::~thread_cache() {
+    for (uint32_t i = 0; i < QSizeClassAllocator::class_count; i++) {
+        release(i, *this, count[i]);
+    }
+}
+
+static void*
+allocate_large(uint64_t size, uint64_t alignment) {
+    uint8_t* raw = static_cast<uint8_t*>(Platform::Allocate(size + alignment + sizeof(large_header), false));
+    if (!raw) {
+        return nullptr;
+    }
+
+    uintptr_t block = align_up(reinterpret_cast<uintptr_t>(raw) + sizeof(large_header), alignment);
+    reinterpret_cast<large_header*>(block)[-1].raw = raw;
+    return reinterpret_cast<void*>(block);
+}
+
+static void
+free_large(void* block) {
+    Platform::Free(reinterpret_cast<large_header*>(block)[-1].raw, false);
+}
+
+uint32_t
+QSizeClassAllocator::ClassIndex(uint64_t size, uint64_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    // Power of two classes are naturally aligned inside a span, so over-aligned
+    // requests are rounded up to one of those
+    if (alignment > default_alignment) {
+        size = next_pow2(size < alignment ? alignment : size);
+    }
+
+    if (size > max_small_size) {
+        return class_count;
+    }
+
+    // 16 byte steps up to 128 bytes, then four classes per doubling
+    if (size <= 128) {
+        return static_cast<uint32_t>((size + 15) / 16 - 1);
+    }
+
+    uint32_t p = floor_log2(size - 1);
+    uint64_t step_shift = p - 2;
+    return 8 + (p - 7) * 4 + static_cast<uint32_t>(((size - 1) - (uint64_t(1) << p)) >> step_shift);
+}
+
+uint64_t
+QSizeClassAllocator::ClassSize(uint32_t class_index) {
+    if (class_index < 8) {
+        return (class_index + 1) * 16;
+    }
+
+    uint32_t group = (class_index - 8) / 4;
+    uint32_t step = (class_index - 8) % 4;
+    uint64_t base = uint64_t(128) << group;
+    return base + (step + 1) * (base / 4);
+}
+
+void*
+QSizeClassAllocator::Allocate(uint64_t size, uint64_t alignment) {
+    if (alignment < default_alignment) {
+        alignment = default_alignment;
+    }
+
+    uint32_t class_index = ClassIndex(size, alignment);
+    if (class_index == class_count) {
+        return allocate_large(size, alignment);
+    }
+
+    thread_cache& cache = t_cache;
+    if (!cache.head[class_index]) {
+        refill(class_index, cache);
+        if (!cache.head[class_index]) {
+            return nullptr;
+        }
+    }
+
+    free_block* block = cache.head[class_index];
+    cache.head[class_index] = block->next;
+    cache.count[class_index]--;
+    return block;
+}
+
+void
+QSizeClassAllocator::Free(void* block, uint64_t size, uint64_t alignment) {
+    if (!block) {
+        return;
+    }
+
+    if (alignment < default_alignment) {
+        alignment = default_alignment;
+    }
+
+    uint32_t class_index = ClassIndex(size, alignment);
+    if (class_index == class_count) {
+        free_large(block);
+        return;
+    }
+
+    thread_cache& cache = t_cache;
+    free_block* freed = static_cast<free_block*>(block);
+    freed->next = cache.head[class_index];
+    cache.head[class_index] = freed;
+    cache.count[class_index]++;
+
+    // Keep the cache bounded so memory freed on one thread can be reused by others
+    uint32_t batch = batch_size(class_index);
+    if (cache.count[class_index] > 2 * batch) {
+        release(class_index, cache, batch);
+    }
+}
+
+} // qmemory
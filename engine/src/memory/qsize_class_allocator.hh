@@ -0,0 +1,53 @@
+#pragma once
+#include "defines.hh"
+#include <cstdint>
+
+/**
+ * qsize_class_allocator.hh
+ *
+ * General purpose backend that sits behind QAllocator::Allocate/Free.
+ *
+ * Small requests (up to QSizeClassAllocator::max_small_size bytes) are rounded up to one of a fixed
+ * set of size classes and served from 64 KiB spans. Each thread keeps a small cache of free
+ * blocks per class so the common alloc/free path takes no lock. Larger requests go straight
+ * to the platform layer with their alignment handled here.
+ *
+ * Frees are sized: the caller must pass the same size and alignment it allocated with,
+ * which is already how the QAllocator API is used.
+*/
+
+namespace qmemory {
+    class QAPI QSizeClassAllocator {
+        public:
+            static constexpr uint64_t default_alignment = 16;
+            static constexpr uint64_t span_size = 64 * 1024;
+            static constexpr uint64_t max_small_size = 32 * 1024;
+            static constexpr uint32_t class_count = 40;
+
+            /**
+             * @brief Allocate a block of at least size bytes aligned to alignment. Memory is not zeroed.
+             * @param size the number of bytes requested
+             * @param alignment power of two alignment of the returned block
+             * @returns pointer to the block, or nullptr if the platform is out of memory
+            */
+            static void* Allocate(uint64_t size, uint64_t alignment);
+
+            /**
+             * @brief Return a block to the allocator
+             * @param block the block returned by Allocate. nullptr is ignored
+             * @param size the size that was passed to Allocate
+             * @param alignment the alignment that was passed to Allocate
+            */
+            static void Free(void* block, uint64_t size, uint64_t alignment);
+
+            /**
+             * @brief Index of the size class used for a request, or class_count for the large-object path
+            */
+            static uint32_t ClassIndex(uint64_t size, uint64_t alignment);
+
+            /**
+             * @brief Size in bytes of the blocks handed out for a size class
+            */
+            static uint64_t ClassSize(uint32_t class_index);
+    };
+} // qmemory
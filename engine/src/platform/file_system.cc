@@ -1,11 +1,30 @@
 #include "file_system.hh"
 #include "core/qlogger.hh"
 #include "core/qmemory.hh"
+#include "core/qjobs.hh"
 
 #include <sys/stat.h>
 #include <string>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <new>
+#include <thread>
+
+#if defined(Q_PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(Q_PLATFORM_LINUX)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
 
 namespace QFilesystem {
 
@@ -43,12 +62,34 @@ QFile::open(const char* path, file_modes mode, bool bin) {
         return false;
     }
 
+    // fstream hides its descriptor, so sync goes through one of its own
+#if defined(Q_PLATFORM_WINDOWS)
+    if (mode & FILE_MODE_WRITE) {
+        HANDLE sync_file = CreateFileA(path, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                       nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        this->sync_handle = sync_file == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<intptr_t>(sync_file);
+    }
+#else
+    if (mode & FILE_MODE_WRITE) {
+        this->sync_handle = ::open(path, O_RDONLY | O_CLOEXEC);
+    }
+#endif
+
     this->is_valid = true;
     return true;
 }
 
 void 
 QFile::close() {
+    if (this->sync_handle != -1) {
+#if defined(Q_PLATFORM_WINDOWS)
+        CloseHandle(reinterpret_cast<HANDLE>(this->sync_handle));
+#else
+        ::close(static_cast<int>(this->sync_handle));
+#endif
+        this->sync_handle = -1;
+    }
+
     if (this->handle.is_open()) {
         this->handle.close();
         this->is_valid = false;
@@ -146,6 +187,798 @@ QFile::write(uint64_t data_size, const void* data, uint64_t& out_bytes_written)
     return false;
 }
 
+bool
+QFile::sync() {
+    if (!handle.is_open()) {
+        qlogger::Error("Tried syncing an invalid file stream");
+        return false;
+    }
+
+    handle.flush();
+    if (this->sync_handle == -1) {
+        return false;
+    }
+#if defined(Q_PLATFORM_WINDOWS)
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(this->sync_handle)) != 0;
+#else
+    return ::fsync(static_cast<int>(this->sync_handle)) == 0;
+#endif
+}
+
+QMappedFile::QMappedFile()
+    : data(nullptr), size(0), is_valid(false), file_handle(nullptr), mapping_handle(nullptr) {}
+
+QMappedFile::~QMappedFile() {
+    unmap();
+}
+
+QMappedFile::QMappedFile(QMappedFile&& other)
+    : data(other.data), size(other.size), is_valid(other.is_valid),
+      file_handle(other.file_handle), mapping_handle(other.mapping_handle) {
+    other.data = nullptr;
+    other.size = 0;
+    other.is_valid = false;
+    other.file_handle = nullptr;
+    other.mapping_handle = nullptr;
+}
+
+QMappedFile& 
+QMappedFile::operator=(QMappedFile&& other) {
+    if (this != &other) {
+        unmap();
+        data = other.data;
+        size = other.size;
+        is_valid = other.is_valid;
+        file_handle = other.file_handle;
+        mapping_handle = other.mapping_handle;
+        other.data = nullptr;
+        other.size = 0;
+        other.is_valid = false;
+        other.file_handle = nullptr;
+        other.mapping_handle = nullptr;
+    }
+    return *this;
+}
+
+#if defined(Q_PLATFORM_WINDOWS)
+
+bool 
+QMappedFile::map(const char* path, uint32_t hints) {
+    unmap();
+
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if (hints & FILE_ACCESS_SEQUENTIAL) {
+        flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+    } else if (hints & FILE_ACCESS_RANDOM) {
+        flags |= FILE_FLAG_RANDOM_ACCESS;
+    }
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        qlogger::Error("Error opening file %s for mapping", path);
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        qlogger::Error("Unable to get the size of %s", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    // Windows refuses to map empty files
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        is_valid = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        qlogger::Error("Unable to create a mapping of %s", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        qlogger::Error("Unable to map %s", path);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<uint64_t>(file_size.QuadPart);
+    file_handle = file;
+    mapping_handle = mapping;
+    is_valid = true;
+
+    if (hints & FILE_ACCESS_WILL_NEED) {
+        advise(0, size, FILE_ACCESS_WILL_NEED);
+    }
+    return true;
+}
+
+void 
+QMappedFile::unmap() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mapping_handle) {
+        CloseHandle(static_cast<HANDLE>(mapping_handle));
+    }
+    if (file_handle) {
+        CloseHandle(static_cast<HANDLE>(file_handle));
+    }
+    data = nullptr;
+    size = 0;
+    is_valid = false;
+    file_handle = nullptr;
+    mapping_handle = nullptr;
+}
+
+bool 
+QMappedFile::advise(uint64_t offset, uint64_t length, uint32_t hints) {
+    if (!data || offset > size || length > size - offset) {
+        return false;
+    }
+
+    // Sequential and random can only be given when the file is opened, prefetching is all there is here
+    if (hints & FILE_ACCESS_WILL_NEED) {
+        WIN32_MEMORY_RANGE_ENTRY range = { const_cast<uint8_t*>(data) + offset, static_cast<SIZE_T>(length) };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+    return true;
+}
+
+#else
+
+bool 
+QMappedFile::map(const char* path, uint32_t hints) {
+    unmap();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        qlogger::Error("Error opening file %s for mapping", path);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        qlogger::Error("Unable to get the size of %s", path);
+        ::close(fd);
+        return false;
+    }
+
+    // mmap refuses a length of zero
+    if (file_stat.st_size == 0) {
+        ::close(fd);
+        is_valid = true;
+        return true;
+    }
+
+    void* view = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        qlogger::Error("Unable to map %s", path);
+        return false;
+    }
+
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<uint64_t>(file_stat.st_size);
+    is_valid = true;
+
+    if (hints != FILE_ACCESS_NORMAL) {
+        advise(0, size, hints);
+    }
+    return true;
+}
+
+void 
+QMappedFile::unmap() {
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+    data = nullptr;
+    size = 0;
+    is_valid = false;
+}
+
+bool 
+QMappedFile::advise(uint64_t offset, uint64_t length, uint32_t hints) {
+    if (!data || offset > size || length > size - offset) {
+        return false;
+    }
+
+    // madvise wants a page aligned start
+    const uint64_t page_size = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset & ~(page_size - 1);
+    uint8_t* address = const_cast<uint8_t*>(data) + start;
+    length += offset - start;
+
+    bool result = true;
+    if (hints & FILE_ACCESS_SEQUENTIAL) {
+        result &= madvise(address, length, MADV_SEQUENTIAL) == 0;
+    } else if (hints & FILE_ACCESS_RANDOM) {
+        result &= madvise(address, length, MADV_RANDOM) == 0;
+    } else {
+        result &= madvise(address, length, MADV_NORMAL) == 0;
+    }
+    if (hints & FILE_ACCESS_WILL_NEED) {
+        result &= madvise(address, length, MADV_WILLNEED) == 0;
+    }
+    return result;
+}
+
+#endif
+
+// Asynchronous reads
+
+QAsyncFile::QAsyncFile()
+    : handle(-1), size(0), is_valid(false) {}
+
+QAsyncFile::~QAsyncFile() {
+    if (is_valid) {
+        close();
+    }
+}
+
+// A blocking read at offset, used by the fallback. Returns bytes read or -errno
+static int64_t
+read_at(const QAsyncFile* file, void* buffer, uint64_t size, uint64_t offset);
+
+struct async_reader_state {
+    bool uses_io_uring;
+    std::atomic<uint32_t> in_flight;
+    std::mutex submit_lock;
+    std::mutex complete_lock;
+
+#if defined(Q_PLATFORM_LINUX)
+    int ring_fd;
+    void* sq_ring;
+    uint64_t sq_ring_size;
+    void* cq_ring;
+    uint64_t cq_ring_size;
+    io_uring_sqe* sqes;
+    uint64_t sqes_size;
+
+    // Shared with the kernel
+    uint32_t* sq_head;
+    uint32_t* sq_tail;
+    uint32_t* sq_flags;
+    uint32_t* sq_array;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    uint32_t* cq_head;
+    uint32_t* cq_tail;
+    uint32_t cq_mask;
+    io_uring_cqe* cqes;
+#endif
+};
+
+static void
+complete_read(async_reader_state* state, QAsyncRead* read, int64_t result) {
+    if (result < 0) {
+        read->bytes_read = 0;
+        read->error = static_cast<int32_t>(-result);
+        read->status.store(ASYNC_READ_FAILED, std::memory_order_release);
+    } else {
+        read->bytes_read = static_cast<uint64_t>(result);
+        read->error = 0;
+        read->status.store(ASYNC_READ_DONE, std::memory_order_release);
+    }
+    state->in_flight.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+// Job behind the fallback, data is the QAsyncRead
+static void
+async_read_job(void* data) {
+    QAsyncRead* read = static_cast<QAsyncRead*>(data);
+    async_reader_state* state = static_cast<async_reader_state*>(read->reader->state);
+    complete_read(state, read, read_at(read->file, read->buffer, read->size, read->offset));
+}
+
+#if defined(Q_PLATFORM_LINUX)
+
+static int
+io_uring_enter_call(int fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// Create the ring and map it, false if io_uring cannot be used here
+static bool
+io_uring_create(async_reader_state* state, uint32_t queue_depth) {
+    io_uring_params params = {};
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth, &params));
+    if (fd < 0) {
+        qlogger::Info("io_uring is unavailable (%s), reading files on the job system", strerror(errno));
+        return false;
+    }
+
+    // More reads than the completion queue holds can be in flight only if the kernel keeps the overflow
+    if (!(params.features & IORING_FEAT_NODROP)) {
+        qlogger::Info("io_uring is too old, reading files on the job system");
+        ::close(fd);
+        return false;
+    }
+
+    // IORING_OP_READ came in 5.6
+    uint8_t probe_memory[sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)] = {};
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_memory);
+    if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) < 0 ||
+        probe->last_op < IORING_OP_READ || !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED)) {
+        qlogger::Info("io_uring does not support reads, reading files on the job system");
+        ::close(fd);
+        return false;
+    }
+
+    state->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    state->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_map) {
+        if (state->cq_ring_size > state->sq_ring_size) {
+            state->sq_ring_size = state->cq_ring_size;
+        }
+        state->cq_ring_size = state->sq_ring_size;
+    }
+
+    state->sq_ring = mmap(nullptr, state->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (state->sq_ring == MAP_FAILED) {
+        qlogger::Error("Unable to map the io_uring submission queue");
+        ::close(fd);
+        return false;
+    }
+    state->cq_ring = state->sq_ring;
+    if (!single_map) {
+        state->cq_ring = mmap(nullptr, state->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (state->cq_ring == MAP_FAILED) {
+            qlogger::Error("Unable to map the io_uring completion queue");
+            munmap(state->sq_ring, state->sq_ring_size);
+            ::close(fd);
+            return false;
+        }
+    }
+
+    state->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, state->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        qlogger::Error("Unable to map the io_uring submission entries");
+        if (!single_map) {
+            munmap(state->cq_ring, state->cq_ring_size);
+        }
+        munmap(state->sq_ring, state->sq_ring_size);
+        ::close(fd);
+        return false;
+    }
+    state->sqes = static_cast<io_uring_sqe*>(sqes);
+
+    uint8_t* sq = static_cast<uint8_t*>(state->sq_ring);
+    uint8_t* cq = static_cast<uint8_t*>(state->cq_ring);
+    state->sq_head = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    state->sq_tail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    state->sq_flags = reinterpret_cast<uint32_t*>(sq + params.sq_off.flags);
+    state->sq_array = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+    state->sq_mask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    state->sq_entries = params.sq_entries;
+    state->cq_head = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    state->cq_tail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    state->cq_mask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    state->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    state->ring_fd = fd;
+    return true;
+}
+
+static void
+io_uring_destroy(async_reader_state* state) {
+    munmap(state->sqes, state->sqes_size);
+    if (state->cq_ring != state->sq_ring) {
+        munmap(state->cq_ring, state->cq_ring_size);
+    }
+    munmap(state->sq_ring, state->sq_ring_size);
+    ::close(state->ring_fd);
+}
+
+// Hand everything queued in the submission ring to the kernel. Call with submit_lock held.
+// Returns 0, or the errno io_uring_enter failed with
+static int
+io_uring_flush(async_reader_state* state, uint32_t queued, QAsyncReader* reader) {
+    while (queued > 0) {
+        int submitted = io_uring_enter_call(state->ring_fd, queued, 0, 0);
+        if (submitted >= 0) {
+            queued -= static_cast<uint32_t>(submitted);
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        // The completion side is backed up, make room and try again
+        if (errno == EAGAIN || errno == EBUSY) {
+            reader->poll();
+            std::this_thread::yield();
+            continue;
+        }
+        const int error = errno;
+        qlogger::Error("io_uring_enter failed: %s", strerror(error));
+        return error;
+    }
+    return 0;
+}
+
+// After a failed flush: take back the entries the kernel never picked up and fail their reads,
+// along with the reads of the batch that were not queued yet. Call with submit_lock held
+static void
+io_uring_fail_unsubmitted(async_reader_state* state, QAsyncRead* unqueued, uint32_t unqueued_count, int error) {
+    // Without SQPOLL the kernel only consumes entries inside io_uring_enter, so head is stable here
+    const uint32_t head = std::atomic_ref<uint32_t>(*state->sq_head).load(std::memory_order_acquire);
+    const uint32_t tail = *state->sq_tail;
+    for (uint32_t position = head; position != tail; position++) {
+        const io_uring_sqe& sqe = state->sqes[state->sq_array[position & state->sq_mask]];
+        complete_read(state, reinterpret_cast<QAsyncRead*>(sqe.user_data), -error);
+    }
+    std::atomic_ref<uint32_t>(*state->sq_tail).store(head, std::memory_order_release);
+
+    for (uint32_t i = 0; i < unqueued_count; i++) {
+        complete_read(state, &unqueued[i], -error);
+    }
+}
+
+// Collect completed reads. Call with complete_lock held
+static uint32_t
+io_uring_reap(async_reader_state* state) {
+    // Completions the kernel had to keep aside are moved into the ring by entering it
+    if (std::atomic_ref<uint32_t>(*state->sq_flags).load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW) {
+        io_uring_enter_call(state->ring_fd, 0, 0, IORING_ENTER_GETEVENTS);
+    }
+
+    uint32_t head = *state->cq_head;
+    const uint32_t tail = std::atomic_ref<uint32_t>(*state->cq_tail).load(std::memory_order_acquire);
+    uint32_t completed = 0;
+    while (head != tail) {
+        const io_uring_cqe& cqe = state->cqes[head & state->cq_mask];
+        complete_read(state, reinterpret_cast<QAsyncRead*>(cqe.user_data), cqe.res);
+        head++;
+        completed++;
+    }
+    std::atomic_ref<uint32_t>(*state->cq_head).store(head, std::memory_order_release);
+    return completed;
+}
+
+#endif
+
+QAsyncReader::QAsyncReader()
+    : state(nullptr) {}
+
+QAsyncReader::~QAsyncReader() {
+    shutdown();
+}
+
+bool 
+QAsyncReader::init(uint32_t queue_depth, bool allow_io_uring) {
+    shutdown();
+
+    async_reader_state* reader_state = static_cast<async_reader_state*>(
+        QAllocator::Allocate(1, sizeof(async_reader_state), MEMORY_TAG_FILE_IO));
+    new (reader_state) async_reader_state();
+    reader_state->uses_io_uring = false;
+    reader_state->in_flight.store(0, std::memory_order_relaxed);
+
+#if defined(Q_PLATFORM_LINUX)
+    if (allow_io_uring) {
+        reader_state->uses_io_uring = io_uring_create(reader_state, queue_depth);
+    }
+#else
+    (void)queue_depth;
+    (void)allow_io_uring;
+#endif
+
+    state = reader_state;
+    return true;
+}
+
+void 
+QAsyncReader::shutdown() {
+    if (!state) {
+        return;
+    }
+
+    wait_all();
+    async_reader_state* reader_state = static_cast<async_reader_state*>(state);
+#if defined(Q_PLATFORM_LINUX)
+    if (reader_state->uses_io_uring) {
+        io_uring_destroy(reader_state);
+    }
+#endif
+    reader_state->~async_reader_state();
+    QAllocator::Free(reader_state, sizeof(async_reader_state), MEMORY_TAG_FILE_IO);
+    state = nullptr;
+}
+
+bool 
+QAsyncReader::submit(QAsyncRead* reads, uint32_t count) {
+    if (!state) {
+        qlogger::Error("QAsyncReader::submit called before init");
+        return false;
+    }
+
+    // Check the whole batch first so it is all or nothing
+    for (uint32_t i = 0; i < count; i++) {
+        const QAsyncRead& read = reads[i];
+        if (!read.file || !read.file->is_valid || (!read.buffer && read.size > 0)) {
+            qlogger::Error("QAsyncReader::submit given a read without a file or buffer");
+            return false;
+        }
+        if (read.size > 0x7FFFF000) {
+            qlogger::Error("QAsyncReader::submit given a read of %llu bytes, split it up", read.size);
+            return false;
+        }
+    }
+
+    async_reader_state* reader_state = static_cast<async_reader_state*>(state);
+    for (uint32_t i = 0; i < count; i++) {
+        reads[i].bytes_read = 0;
+        reads[i].error = 0;
+        reads[i].reader = this;
+        reads[i].status.store(ASYNC_READ_PENDING, std::memory_order_relaxed);
+    }
+    reader_state->in_flight.fetch_add(count, std::memory_order_relaxed);
+
+#if defined(Q_PLATFORM_LINUX)
+    if (reader_state->uses_io_uring) {
+        std::lock_guard<std::mutex> lock(reader_state->submit_lock);
+        uint32_t tail = *reader_state->sq_tail;
+        uint32_t queued = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            // Ring full, let the kernel take what is there
+            if (tail - std::atomic_ref<uint32_t>(*reader_state->sq_head).load(std::memory_order_acquire) == reader_state->sq_entries) {
+                const int error = io_uring_flush(reader_state, queued, this);
+                if (error) {
+                    // Nothing may stay pending that the kernel will never complete, or wait would spin
+                    io_uring_fail_unsubmitted(reader_state, reads + i, count - i, error);
+                    return false;
+                }
+                queued = 0;
+            }
+
+            const uint32_t index = tail & reader_state->sq_mask;
+            io_uring_sqe& sqe = reader_state->sqes[index];
+            QAllocator::Zero(&sqe, sizeof(io_uring_sqe));
+            sqe.opcode = IORING_OP_READ;
+            sqe.fd = static_cast<int32_t>(reads[i].file->handle);
+            sqe.off = reads[i].offset;
+            sqe.addr = reinterpret_cast<uintptr_t>(reads[i].buffer);
+            sqe.len = static_cast<uint32_t>(reads[i].size);
+            sqe.user_data = reinterpret_cast<uintptr_t>(&reads[i]);
+            reader_state->sq_array[index] = index;
+            tail++;
+            queued++;
+            std::atomic_ref<uint32_t>(*reader_state->sq_tail).store(tail, std::memory_order_release);
+        }
+        const int error = io_uring_flush(reader_state, queued, this);
+        if (error) {
+            io_uring_fail_unsubmitted(reader_state, nullptr, 0, error);
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    QJob jobs[64];
+    for (uint32_t first = 0; first < count; first += 64) {
+        uint32_t batch = count - first < 64 ? count - first : 64;
+        for (uint32_t i = 0; i < batch; i++) {
+            jobs[i] = { async_read_job, &reads[first + i] };
+        }
+        JobSystem::Run(jobs, batch, nullptr);
+    }
+    return true;
+}
+
+uint32_t 
+QAsyncReader::poll() {
+    if (!state) {
+        return 0;
+    }
+
+#if defined(Q_PLATFORM_LINUX)
+    async_reader_state* reader_state = static_cast<async_reader_state*>(state);
+    if (reader_state->uses_io_uring) {
+        // Someone else is already collecting
+        std::unique_lock<std::mutex> lock(reader_state->complete_lock, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return 0;
+        }
+        return io_uring_reap(reader_state);
+    }
+#endif
+
+    // Fallback reads complete themselves, lend a hand with the queue
+    JobSystem::RunPending();
+    return 0;
+}
+
+void 
+QAsyncReader::wait(QAsyncRead* read) {
+    if (!state) {
+        return;
+    }
+
+    async_reader_state* reader_state = static_cast<async_reader_state*>(state);
+    while (!read->done()) {
+#if defined(Q_PLATFORM_LINUX)
+        if (reader_state->uses_io_uring) {
+            std::lock_guard<std::mutex> lock(reader_state->complete_lock);
+            if (io_uring_reap(reader_state) == 0 && !read->done()) {
+                io_uring_enter_call(reader_state->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            }
+            continue;
+        }
+#endif
+        if (!JobSystem::RunPending()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void 
+QAsyncReader::wait_all() {
+    if (!state) {
+        return;
+    }
+
+    async_reader_state* reader_state = static_cast<async_reader_state*>(state);
+    while (reader_state->in_flight.load(std::memory_order_acquire) > 0) {
+#if defined(Q_PLATFORM_LINUX)
+        if (reader_state->uses_io_uring) {
+            std::lock_guard<std::mutex> lock(reader_state->complete_lock);
+            if (io_uring_reap(reader_state) == 0 && reader_state->in_flight.load(std::memory_order_acquire) > 0) {
+                io_uring_enter_call(reader_state->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            }
+            continue;
+        }
+#endif
+        if (!JobSystem::RunPending()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool 
+QAsyncReader::uses_io_uring() const {
+    return state && static_cast<async_reader_state*>(state)->uses_io_uring;
+}
+
+bool 
+async_read_ready(void* data) {
+    QAsyncRead* read = static_cast<QAsyncRead*>(data);
+    if (read->done()) {
+        return true;
+    }
+    read->reader->poll();
+    return read->done();
+}
+
+#if defined(Q_PLATFORM_WINDOWS)
+
+bool 
+QAsyncFile::open(const char* path) {
+    if (is_valid) {
+        close();
+    }
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        qlogger::Error("Error opening file %s", path);
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        qlogger::Error("Unable to get the size of %s", path);
+        CloseHandle(file);
+        return false;
+    }
+
+    handle = reinterpret_cast<intptr_t>(file);
+    size = static_cast<uint64_t>(file_size.QuadPart);
+    is_valid = true;
+    return true;
+}
+
+void 
+QAsyncFile::close() {
+    if (is_valid) {
+        CloseHandle(reinterpret_cast<HANDLE>(handle));
+    }
+    handle = -1;
+    size = 0;
+    is_valid = false;
+}
+
+static int64_t
+read_at(const QAsyncFile* file, void* buffer, uint64_t size, uint64_t offset) {
+    uint64_t total = 0;
+    while (total < size) {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>((offset + total) & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+
+        DWORD bytes = 0;
+        if (!ReadFile(reinterpret_cast<HANDLE>(file->handle), static_cast<uint8_t*>(buffer) + total,
+                      static_cast<DWORD>(size - total), &bytes, &overlapped)) {
+            DWORD error = GetLastError();
+            if (error == ERROR_HANDLE_EOF) {
+                break;
+            }
+            return -static_cast<int64_t>(error);
+        }
+        if (bytes == 0) {
+            break;
+        }
+        total += bytes;
+    }
+    return static_cast<int64_t>(total);
+}
+
+#else
+
+bool 
+QAsyncFile::open(const char* path) {
+    if (is_valid) {
+        close();
+    }
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        qlogger::Error("Error opening file %s", path);
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        qlogger::Error("Unable to get the size of %s", path);
+        ::close(fd);
+        return false;
+    }
+
+    handle = fd;
+    size = static_cast<uint64_t>(file_stat.st_size);
+    is_valid = true;
+    return true;
+}
+
+void 
+QAsyncFile::close() {
+    if (is_valid) {
+        ::close(static_cast<int>(handle));
+    }
+    handle = -1;
+    size = 0;
+    is_valid = false;
+}
+
+static int64_t
+read_at(const QAsyncFile* file, void* buffer, uint64_t size, uint64_t offset) {
+    uint64_t total = 0;
+    while (total < size) {
+        ssize_t bytes = pread(static_cast<int>(file->handle), static_cast<uint8_t*>(buffer) + total, size - total, offset + total);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -static_cast<int64_t>(errno);
+        }
+        if (bytes == 0) {
+            break;
+        }
+        total += static_cast<uint64_t>(bytes);
+    }
+    return static_cast<int64_t>(total);
+}
+
+#endif
+
 // bool 
 // file_open(const char* path, file_modes mode, bool binary, file_handle& out_handle) {
 //     out_handle.is_valid = false;
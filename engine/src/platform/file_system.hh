@@ -1,5 +1,6 @@
 #pragma once
 #include "defines.hh"
+#include <atomic>
 #include <cstdint>
 #include <fstream>
 
@@ -17,6 +18,8 @@ struct QAPI QFile {
     // void* handle;
     std::fstream handle;
     bool is_valid;
+    // A second OS handle on the same file, only used by sync
+    intptr_t sync_handle = -1;
 
     bool open(const char* path, file_modes mode, bool binary);
     void close();
@@ -25,8 +28,158 @@ struct QAPI QFile {
     bool read(uint64_t data_size, void* out_data, uint64_t& out_bytes_read);
     bool read_all_bytes(uint8_t** out_bytes, uint64_t& out_bytes_read);
     bool write(uint64_t data_size, const void* data, uint64_t& out_bytes_written);
+
+    /**
+     * @brief Push what has been written through the OS caches to the disk (fsync). Slow, call it
+     *     from a background thread
+    */
+    bool sync();
+};
+
+// Hints for how a mapped file is about to be read. They can be combined
+enum file_access_hints : uint32_t {
+    FILE_ACCESS_NORMAL = 0x0,
+    // Read front to back, so read ahead aggressively and drop pages behind
+    FILE_ACCESS_SEQUENTIAL = 0x1,
+    // Jumping around, so don't bother reading ahead
+    FILE_ACCESS_RANDOM = 0x2,
+    // Start paging the range in now, before it is touched
+    FILE_ACCESS_WILL_NEED = 0x4,
+};
+
+/**
+ * Read only view of a whole file mapped into memory. The bytes come straight from
+ * the page cache, so nothing is allocated or copied. Unmapped when it goes out of scope
+*/
+struct QAPI QMappedFile {
+    const uint8_t* data;
+    uint64_t size;
+    bool is_valid;
+    // Windows keeps the file and mapping handles open for as long as the view exists
+    void* file_handle;
+    void* mapping_handle;
+
+    QMappedFile();
+    ~QMappedFile();
+    QMappedFile(QMappedFile&& other);
+    QMappedFile& operator=(QMappedFile&& other);
+    QMappedFile(const QMappedFile&) = delete;
+    QMappedFile& operator=(const QMappedFile&) = delete;
+
+    /**
+     * Map the file at path. An empty file maps successfully with a nullptr data
+     * @param hints how the whole file is about to be read
+     * @returns true if mapped, false otherwise
+    */
+    bool map(const char* path, uint32_t hints = FILE_ACCESS_SEQUENTIAL | FILE_ACCESS_WILL_NEED);
+    void unmap();
+
+    /**
+     * Change the access hints for part of the mapping, e.g. WILL_NEED on the next chunk to parse
+     * @returns false if not mapped or the range is outside the file
+    */
+    bool advise(uint64_t offset, uint64_t length, uint32_t hints);
+};
+
+/*
+ *  Asynchronous reads
+ *
+ *  Open a file as a QAsyncFile, describe each read with a QAsyncRead and hand a batch of them to a
+ *  QAsyncReader. The data goes straight into the buffers given, which can be mapped staging memory.
+ *  Completions are picked up with poll, wait or wait_all, or awaited from a task:
+ *
+ *      co_await QWaitUntil { QFilesystem::async_read_ready, &read };
+ *
+ *  On Linux the reads go through io_uring. Where that is not available (older kernels, sandboxes
+ *  that block it, Windows) each read becomes a blocking read run on the job system, which runs them
+ *  inline if it has not been started
+*/
+
+// Raw file handle for asynchronous reads
+struct QAPI QAsyncFile {
+    intptr_t handle;
+    uint64_t size;
+    bool is_valid;
+
+    QAsyncFile();
+    ~QAsyncFile();
+    QAsyncFile(const QAsyncFile&) = delete;
+    QAsyncFile& operator=(const QAsyncFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+};
+
+enum async_read_status : uint32_t {
+    ASYNC_READ_IDLE = 0,
+    ASYNC_READ_PENDING = 1,
+    ASYNC_READ_DONE = 2,
+    ASYNC_READ_FAILED = 3,
+};
+
+struct QAsyncReader;
+
+// One read. Must stay alive and in place until it completes
+struct QAsyncRead {
+    // Filled in by the caller
+    const QAsyncFile* file;
+    uint64_t offset;
+    uint64_t size;
+    void* buffer;
+
+    // Filled in by the reader. bytes_read is short when the read runs past the end of the file
+    std::atomic<uint32_t> status { ASYNC_READ_IDLE };
+    uint64_t bytes_read;
+    int32_t error; // errno value when the read failed
+    QAsyncReader* reader;
+
+    bool done() const { return status.load(std::memory_order_acquire) >= ASYNC_READ_DONE; }
+};
+
+struct QAPI QAsyncReader {
+    void* state;
+
+    QAsyncReader();
+    ~QAsyncReader();
+    QAsyncReader(const QAsyncReader&) = delete;
+    QAsyncReader& operator=(const QAsyncReader&) = delete;
+
+    /**
+     * Set up the reader
+     * @param queue_depth reads handed to the kernel at once, more than this are submitted in rounds
+     * @param allow_io_uring false always uses the job system fallback
+     * @returns true if ready, false otherwise
+    */
+    bool init(uint32_t queue_depth = 256, bool allow_io_uring = true);
+
+    // Waits for every read still in flight, then releases the reader
+    void shutdown();
+
+    /**
+     * Start count reads. Each read is at most 2GB
+     * @returns false if a read was invalid, in which case none of them were started. Also false if
+     *     the kernel refused the batch: the reads it never took complete as ASYNC_READ_FAILED with
+     *     the error, so wait and wait_all still return
+    */
+    bool submit(QAsyncRead* reads, uint32_t count);
+
+    /**
+     * Pick up finished reads without blocking
+     * @returns number of reads completed by this call
+    */
+    uint32_t poll();
+
+    // Block until read completes
+    void wait(QAsyncRead* read);
+    // Block until every submitted read completes
+    void wait_all();
+
+    bool uses_io_uring() const;
 };
 
+// Ready check for QWaitUntil, polls the reader the read was submitted to
+QAPI bool async_read_ready(void* read);
+
 /**
  * Checks if a file with the given path exists
  * @param path the path of the file to be checked
@@ -0,0 +1,396 @@
+#pragma once
+#include "qsimd.inl"
+#include "qmatrix4.inl"
+#include "qquaternion.inl"
+#include "qvertex.inl"
+
+/*
+ *  Batched transform kernels
+ *
+ *  The per object math in Mat4 and Quaternion handles one value per call. These take whole streams,
+ *  for the inner loops of culling, skinning and instance upload where thousands of values go through
+ *  the same matrix. Streams are structure of arrays: one array per component, so a batch of x values
+ *  loads with a single instruction. Matrices come in and go out as plain Mat4 arrays, ready to upload.
+ *
+ *  8 values per step with AVX, 4 with SSE, one at a time otherwise. Counts that are not a multiple of
+ *  the width finish on the scalar path. Outputs may be the same arrays as the inputs.
+ *
+ *  qmath::scalar::compose_trs and the scalar Mat4 templates are the reference, see qsimd.inl for how
+ *  closely the SIMD paths follow them.
+ */
+
+namespace qmath {
+
+// Mutable component arrays, what the batch functions write to
+struct Vec3Stream {
+    float* x;
+    float* y;
+    float* z;
+};
+
+// Read only component arrays
+struct ConstVec3Stream {
+    const float* x;
+    const float* y;
+    const float* z;
+
+    ConstVec3Stream(const float* x, const float* y, const float* z) : x(x), y(y), z(z) {}
+    ConstVec3Stream(const Vec3Stream& stream) : x(stream.x), y(stream.y), z(stream.z) {}
+};
+
+struct ConstQuaternionStream {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* w;
+};
+
+static_assert(sizeof(Vertex3D) == 3 * sizeof(float), "batch::transform_points reads vertices as packed floats");
+
+namespace scalar {
+
+// Scale, then rotate, then translate, as one matrix. Same as Scale(scale) * rotation * GetTranslation(position)
+inline Mat4<float>
+compose_trs(const Vec3<float>& position, const Quaternion<float>& rotation, const Vec3<float>& scale) {
+    const float xx = rotation.x * rotation.x;
+    const float yy = rotation.y * rotation.y;
+    const float zz = rotation.z * rotation.z;
+    const float xy = rotation.x * rotation.y;
+    const float xz = rotation.x * rotation.z;
+    const float yz = rotation.y * rotation.z;
+    const float xw = rotation.x * rotation.w;
+    const float yw = rotation.y * rotation.w;
+    const float zw = rotation.z * rotation.w;
+
+    Mat4<float> out;
+    float* o = out.data;
+    o[0] = scale.x * (1.f - 2.f * (yy + zz));
+    o[1] = scale.x * (2.f * (xy + zw));
+    o[2] = scale.x * (2.f * (xz - yw));
+    o[3] = 0.f;
+    o[4] = scale.y * (2.f * (xy - zw));
+    o[5] = scale.y * (1.f - 2.f * (xx + zz));
+    o[6] = scale.y * (2.f * (yz + xw));
+    o[7] = 0.f;
+    o[8] = scale.z * (2.f * (xz + yw));
+    o[9] = scale.z * (2.f * (yz - xw));
+    o[10] = scale.z * (1.f - 2.f * (xx + yy));
+    o[11] = 0.f;
+    o[12] = position.x;
+    o[13] = position.y;
+    o[14] = position.z;
+    o[15] = 1.f;
+    return out;
+}
+
+} // scalar
+
+namespace batch {
+
+#if QMATH_SIMD_SSE
+
+// One register of lanes, as wide as the target allows
+#if QMATH_SIMD_AVX
+typedef __m256 lanes;
+static constexpr uint64_t WIDTH = 8;
+inline lanes load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, lanes v) { _mm256_storeu_ps(p, v); }
+inline lanes splat(float value) { return _mm256_set1_ps(value); }
+inline lanes add(lanes a, lanes b) { return _mm256_add_ps(a, b); }
+inline lanes sub(lanes a, lanes b) { return _mm256_sub_ps(a, b); }
+inline lanes mul(lanes a, lanes b) { return _mm256_mul_ps(a, b); }
+// About 12 bits, qmath::fast refines it
+inline lanes rsqrt(lanes v) { return _mm256_rsqrt_ps(v); }
+#else
+typedef __m128 lanes;
+static constexpr uint64_t WIDTH = 4;
+inline lanes load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, lanes v) { _mm_storeu_ps(p, v); }
+inline lanes splat(float value) { return _mm_set1_ps(value); }
+inline lanes add(lanes a, lanes b) { return _mm_add_ps(a, b); }
+inline lanes sub(lanes a, lanes b) { return _mm_sub_ps(a, b); }
+inline lanes mul(lanes a, lanes b) { return _mm_mul_ps(a, b); }
+// About 12 bits, qmath::fast refines it
+inline lanes rsqrt(lanes v) { return _mm_rsqrt_ps(v); }
+#endif
+
+// The translation is left out for vectors
+struct lane_matrix {
+    lanes m0, m1, m2, m4, m5, m6, m8, m9, m10, m12, m13, m14;
+
+    explicit lane_matrix(const float* m)
+        : m0(splat(m[0])), m1(splat(m[1])), m2(splat(m[2])),
+          m4(splat(m[4])), m5(splat(m[5])), m6(splat(m[6])),
+          m8(splat(m[8])), m9(splat(m[9])), m10(splat(m[10])),
+          m12(splat(m[12])), m13(splat(m[13])), m14(splat(m[14])) {}
+
+    // In the order of scalar::transform_point and transform_vector
+    void transform(lanes& x, lanes& y, lanes& z, bool translate) const {
+        lanes ox = add(add(mul(x, m0), mul(y, m4)), mul(z, m8));
+        lanes oy = add(add(mul(x, m1), mul(y, m5)), mul(z, m9));
+        lanes oz = add(add(mul(x, m2), mul(y, m6)), mul(z, m10));
+        if (translate) {
+            ox = add(ox, m12);
+            oy = add(oy, m13);
+            oz = add(oz, m14);
+        }
+        x = ox;
+        y = oy;
+        z = oz;
+    }
+};
+
+#endif // QMATH_SIMD_SSE
+
+inline void
+transform_stream(const Mat4<float>& matrix, ConstVec3Stream in, Vec3Stream out, uint64_t count, bool translate) {
+    uint64_t i = 0;
+#if QMATH_SIMD_SSE
+    const lane_matrix m(matrix.data);
+    for (; i + WIDTH <= count; i += WIDTH) {
+        lanes x = load(in.x + i);
+        lanes y = load(in.y + i);
+        lanes z = load(in.z + i);
+        m.transform(x, y, z, translate);
+        store(out.x + i, x);
+        store(out.y + i, y);
+        store(out.z + i, z);
+    }
+#endif
+    for (; i < count; i++) {
+        const Vec3<float> v = { in.x[i], in.y[i], in.z[i] };
+        const Vec3<float> r = translate ? scalar::transform_point(matrix, v) : scalar::transform_vector(matrix, v);
+        out.x[i] = r.x;
+        out.y[i] = r.y;
+        out.z[i] = r.z;
+    }
+}
+
+/**
+ * @brief Transform count points, with w = 1, by matrix
+*/
+inline void
+transform_points(const Mat4<float>& matrix, ConstVec3Stream in, Vec3Stream out, uint64_t count) {
+    transform_stream(matrix, in, out, count, true);
+}
+
+/**
+ * @brief Transform count directions, with w = 0, by matrix. The translation is ignored
+*/
+inline void
+transform_vectors(const Mat4<float>& matrix, ConstVec3Stream in, Vec3Stream out, uint64_t count) {
+    transform_stream(matrix, in, out, count, false);
+}
+
+/**
+ * @brief Transform the positions of count vertices by matrix. Vertices are packed xyz, so
+ *     batches are transposed to streams in registers and back
+*/
+inline void
+transform_points(const Mat4<float>& matrix, const Vertex3D* in, Vertex3D* out, uint64_t count) {
+    uint64_t i = 0;
+#if QMATH_SIMD_AVX
+    const lane_matrix m(matrix.data);
+    for (; i + WIDTH <= count; i += WIDTH) {
+        const float* source = &in[i].position.x;
+        float* destination = &out[i].position.x;
+
+        // 8 xyz vertices as 6 quarters, vertices 0-3 in the low halves and 4-7 in the high halves
+        __m256 m03 = _mm256_castps128_ps256(_mm_loadu_ps(source + 0));
+        __m256 m14 = _mm256_castps128_ps256(_mm_loadu_ps(source + 4));
+        __m256 m25 = _mm256_castps128_ps256(_mm_loadu_ps(source + 8));
+        m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(source + 12), 1);
+        m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(source + 16), 1);
+        m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(source + 20), 1);
+
+        const __m256 xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+        const __m256 yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+        __m256 x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        __m256 y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+
+        m.transform(x, y, z, true);
+
+        // And back
+        const __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(destination + 0, _mm256_castps256_ps128(r03));
+        _mm_storeu_ps(destination + 4, _mm256_castps256_ps128(r14));
+        _mm_storeu_ps(destination + 8, _mm256_castps256_ps128(r25));
+        _mm_storeu_ps(destination + 12, _mm256_extractf128_ps(r03, 1));
+        _mm_storeu_ps(destination + 16, _mm256_extractf128_ps(r14, 1));
+        _mm_storeu_ps(destination + 20, _mm256_extractf128_ps(r25, 1));
+    }
+#elif QMATH_SIMD_SSE
+    // Without 8 wide registers the transpose costs more than it saves, go one vertex at a time
+    for (; i < count; i++) {
+        float result[4];
+        _mm_storeu_ps(result, simd::mat4_transform_point(matrix.data, in[i].position.x, in[i].position.y, in[i].position.z));
+        out[i].position = Vec3<float> { result[0], result[1], result[2] };
+    }
+#endif
+    for (; i < count; i++) {
+        out[i].position = scalar::transform_point(matrix, in[i].position);
+    }
+}
+
+/**
+ * @brief out[i] = models[i] * view_projection for count matrices
+*/
+inline void
+multiply(const Mat4<float>* models, const Mat4<float>& view_projection, Mat4<float>* out, uint64_t count) {
+    uint64_t i = 0;
+#if QMATH_SIMD_AVX
+    // The same rows of view_projection for every model, loaded once
+    const float* b = view_projection.data;
+    const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 0));
+    const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+    const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+    const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+    for (; i < count; i++) {
+        const float* a = models[i].data;
+        for (uint32_t half = 0; half < 16; half += 8) {
+            const __m256 rows = _mm256_loadu_ps(a + half);
+            __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x00), b0);
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0x55), b1));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xAA), b2));
+            r = _mm256_add_ps(r, _mm256_mul_ps(_mm256_shuffle_ps(rows, rows, 0xFF), b3));
+            _mm256_storeu_ps(out[i].data + half, r);
+        }
+    }
+#elif QMATH_SIMD_SSE
+    const float* b = view_projection.data;
+    const __m128 b0 = _mm_loadu_ps(b + 0);
+    const __m128 b1 = _mm_loadu_ps(b + 4);
+    const __m128 b2 = _mm_loadu_ps(b + 8);
+    const __m128 b3 = _mm_loadu_ps(b + 12);
+    for (; i < count; i++) {
+        const float* a = models[i].data;
+        const __m128 r0 = simd::combine_rows(_mm_loadu_ps(a + 0), b0, b1, b2, b3);
+        const __m128 r1 = simd::combine_rows(_mm_loadu_ps(a + 4), b0, b1, b2, b3);
+        const __m128 r2 = simd::combine_rows(_mm_loadu_ps(a + 8), b0, b1, b2, b3);
+        const __m128 r3 = simd::combine_rows(_mm_loadu_ps(a + 12), b0, b1, b2, b3);
+        _mm_storeu_ps(out[i].data + 0, r0);
+        _mm_storeu_ps(out[i].data + 4, r1);
+        _mm_storeu_ps(out[i].data + 8, r2);
+        _mm_storeu_ps(out[i].data + 12, r3);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = scalar::multiply(models[i], view_projection);
+    }
+}
+
+#if QMATH_SIMD_SSE
+// Element e of WIDTH matrices in elements[e], written out as WIDTH whole matrices
+inline void
+store_matrices(lanes elements[16], Mat4<float>* out) {
+#if QMATH_SIMD_AVX
+    // Two 8x8 transposes, elements 0-7 and 8-15
+    for (uint32_t half = 0; half < 16; half += 8) {
+        lanes* e = elements + half;
+        const __m256 t0 = _mm256_unpacklo_ps(e[0], e[1]);
+        const __m256 t1 = _mm256_unpackhi_ps(e[0], e[1]);
+        const __m256 t2 = _mm256_unpacklo_ps(e[2], e[3]);
+        const __m256 t3 = _mm256_unpackhi_ps(e[2], e[3]);
+        const __m256 t4 = _mm256_unpacklo_ps(e[4], e[5]);
+        const __m256 t5 = _mm256_unpackhi_ps(e[4], e[5]);
+        const __m256 t6 = _mm256_unpacklo_ps(e[6], e[7]);
+        const __m256 t7 = _mm256_unpackhi_ps(e[6], e[7]);
+        const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_storeu_ps(out[0].data + half, _mm256_permute2f128_ps(s0, s4, 0x20));
+        _mm256_storeu_ps(out[1].data + half, _mm256_permute2f128_ps(s1, s5, 0x20));
+        _mm256_storeu_ps(out[2].data + half, _mm256_permute2f128_ps(s2, s6, 0x20));
+        _mm256_storeu_ps(out[3].data + half, _mm256_permute2f128_ps(s3, s7, 0x20));
+        _mm256_storeu_ps(out[4].data + half, _mm256_permute2f128_ps(s0, s4, 0x31));
+        _mm256_storeu_ps(out[5].data + half, _mm256_permute2f128_ps(s1, s5, 0x31));
+        _mm256_storeu_ps(out[6].data + half, _mm256_permute2f128_ps(s2, s6, 0x31));
+        _mm256_storeu_ps(out[7].data + half, _mm256_permute2f128_ps(s3, s7, 0x31));
+    }
+#else
+    // Four 4x4 transposes, one per row
+    for (uint32_t row = 0; row < 16; row += 4) {
+        __m128 r0 = elements[row + 0];
+        __m128 r1 = elements[row + 1];
+        __m128 r2 = elements[row + 2];
+        __m128 r3 = elements[row + 3];
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(out[0].data + row, r0);
+        _mm_storeu_ps(out[1].data + row, r1);
+        _mm_storeu_ps(out[2].data + row, r2);
+        _mm_storeu_ps(out[3].data + row, r3);
+    }
+#endif
+}
+#endif // QMATH_SIMD_SSE
+
+/**
+ * @brief Build count transforms from position, rotation and scale streams, see scalar::compose_trs.
+ *     Rotations should be normalized
+*/
+inline void
+compose_trs(ConstVec3Stream positions, ConstQuaternionStream rotations, ConstVec3Stream scales, Mat4<float>* out, uint64_t count) {
+    uint64_t i = 0;
+#if QMATH_SIMD_SSE
+    const lanes one = splat(1.f);
+    const lanes two = splat(2.f);
+    const lanes zero = splat(0.f);
+    for (; i + WIDTH <= count; i += WIDTH) {
+        const lanes qx = load(rotations.x + i);
+        const lanes qy = load(rotations.y + i);
+        const lanes qz = load(rotations.z + i);
+        const lanes qw = load(rotations.w + i);
+        const lanes xx = mul(qx, qx);
+        const lanes yy = mul(qy, qy);
+        const lanes zz = mul(qz, qz);
+        const lanes xy = mul(qx, qy);
+        const lanes xz = mul(qx, qz);
+        const lanes yz = mul(qy, qz);
+        const lanes xw = mul(qx, qw);
+        const lanes yw = mul(qy, qw);
+        const lanes zw = mul(qz, qw);
+        const lanes sx = load(scales.x + i);
+        const lanes sy = load(scales.y + i);
+        const lanes sz = load(scales.z + i);
+
+        lanes elements[16];
+        elements[0] = mul(sx, sub(one, mul(two, add(yy, zz))));
+        elements[1] = mul(sx, mul(two, add(xy, zw)));
+        elements[2] = mul(sx, mul(two, sub(xz, yw)));
+        elements[3] = zero;
+        elements[4] = mul(sy, mul(two, sub(xy, zw)));
+        elements[5] = mul(sy, sub(one, mul(two, add(xx, zz))));
+        elements[6] = mul(sy, mul(two, add(yz, xw)));
+        elements[7] = zero;
+        elements[8] = mul(sz, mul(two, add(xz, yw)));
+        elements[9] = mul(sz, mul(two, sub(yz, xw)));
+        elements[10] = mul(sz, sub(one, mul(two, add(xx, yy))));
+        elements[11] = zero;
+        elements[12] = load(positions.x + i);
+        elements[13] = load(positions.y + i);
+        elements[14] = load(positions.z + i);
+        elements[15] = one;
+        store_matrices(elements, out + i);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = scalar::compose_trs(
+            Vec3<float> { positions.x[i], positions.y[i], positions.z[i] },
+            Quaternion<float>::New(rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i]),
+            Vec3<float> { scales.x[i], scales.y[i], scales.z[i] });
+    }
+}
+
+} // batch
+} // qmath
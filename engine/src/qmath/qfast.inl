@@ -0,0 +1,184 @@
+#pragma once
+#include "qbatch.inl"
+
+/*
+ *  Fast approximate math
+ *
+ *  Opt in stand-ins for the precise q* functions, for hot loops where the last few bits do not matter:
+ *  camera and movement directions, particles, culling, animation blending. Nothing in qmath calls these
+ *  on its own, the precise versions stay the default.
+ *
+ *  Worst errors measured against <cmath> over the ranges in the tests:
+ *      rsqrt       relative 3e-7, for positive finite x (0 gives NaN, not infinity)
+ *      sincos      absolute 2e-7 for |x| <= 8192, the reduction loses accuracy beyond that
+ *      acos        absolute 5e-7, inputs are clamped to [-1, 1]
+ *      atan2       absolute 2e-6, atan2(0, 0) is 0
+ *      normalize   length within 5e-7 of 1. Zero length vectors give NaN, as they do precisely
+ *
+ *  rsqrt and normalize use the hardware estimate with one Newton step when SSE is there, and
+ *  1 / std::sqrt otherwise. The rest are polynomials and are the same on every target.
+ *
+ *  On recent x86 cores a single sqrt and divide is about as fast as rsqrt, so one vector at a time
+ *  gains little. Streams through fast::normalize, atan2 and acos are where it pays, see the
+ *  qmath benchmarks.
+ */
+
+namespace qmath {
+namespace fast {
+
+/**
+ * @brief 1 / sqrt(x) for positive finite x
+*/
+inline float
+rsqrt(float x) {
+#if QMATH_SIMD_SSE
+    const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+    // One Newton step takes the 12 bit estimate to about 22
+    return estimate * (1.5f - (0.5f * x * estimate) * estimate);
+#else
+    return 1.f / std::sqrt(x);
+#endif
+}
+
+/**
+ * @brief sin(x) and cos(x) from one range reduction
+*/
+inline void
+sincos(float x, float& out_sin, float& out_cos) {
+    // pi/2 in three parts, the first two exact for the quadrants the bound allows (Cody and Waite)
+    constexpr float HALF_PI_HIGH = 1.5703125f;
+    constexpr float HALF_PI_MID = 4.837512969970703125e-4f;
+    constexpr float HALF_PI_LOW = 7.54978995489188216e-8f;
+
+    // Nearest quarter turn, leaving r in [-pi/4, pi/4]
+    const float turns = x * (2.f / Q_PI);
+    const int32_t quadrant = static_cast<int32_t>(turns < 0.f ? turns - 0.5f : turns + 0.5f);
+    const float q = static_cast<float>(quadrant);
+    float r = x - q * HALF_PI_HIGH;
+    r = r - q * HALF_PI_MID;
+    r = r - q * HALF_PI_LOW;
+
+    // Minimax polynomials on [-pi/4, pi/4], from Cephes sinf and cosf
+    const float r2 = r * r;
+    const float s = r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+    const float c = 1.f - 0.5f * r2 + r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+
+    switch (quadrant & 3) {
+        case 0: out_sin = s;  out_cos = c;  break;
+        case 1: out_sin = c;  out_cos = -s; break;
+        case 2: out_sin = -s; out_cos = -c; break;
+        default: out_sin = -c; out_cos = s; break;
+    }
+}
+
+/**
+ * @brief acos(x), with x clamped to [-1, 1] so dot products that round just past 1 are fine
+*/
+inline float
+acos(float x) {
+    const bool negative = x < 0.f;
+    float a = negative ? -x : x;
+    a = a > 1.f ? 1.f : a;
+
+    // Abramowitz and Stegun 4.4.46, acos(a) = sqrt(1 - a) * p(a) on [0, 1]
+    float p = -0.0012624911f;
+    p = p * a + 0.0066700901f;
+    p = p * a - 0.0170881256f;
+    p = p * a + 0.0308918810f;
+    p = p * a - 0.0501743046f;
+    p = p * a + 0.0889789874f;
+    p = p * a - 0.2145988016f;
+    p = p * a + 1.5707963050f;
+    const float result = std::sqrt(1.f - a) * p;
+    return negative ? Q_PI - result : result;
+}
+
+/**
+ * @brief atan2(y, x), the angle of (x, y) in [-pi, pi]
+*/
+inline float
+atan2(float y, float x) {
+    const float ax = x < 0.f ? -x : x;
+    const float ay = y < 0.f ? -y : y;
+    const float big = ax > ay ? ax : ay;
+    if (big == 0.f) {
+        return 0.f;
+    }
+    const float small = ax > ay ? ay : ax;
+
+    // atan on [0, 1] as an odd minimax polynomial
+    const float a = small / big;
+    const float s = a * a;
+    float p = -0.01172120f;
+    p = p * s + 0.05265332f;
+    p = p * s - 0.11643287f;
+    p = p * s + 0.19354346f;
+    p = p * s - 0.33262347f;
+    p = p * s + 0.99997726f;
+    float angle = a * p;
+
+    // Back out to the octant and quadrant
+    if (ay > ax) {
+        angle = Q_HALF_PI - angle;
+    }
+    if (x < 0.f) {
+        angle = Q_PI - angle;
+    }
+    return y < 0.f ? -angle : angle;
+}
+
+/**
+ * @brief v scaled to unit length through rsqrt, instead of a sqrt and three divides
+*/
+inline Vec3<float>
+normalized(const Vec3<float>& v) {
+    const float inverse_length = rsqrt(v.length_squared());
+    return Vec3<float> { v.x * inverse_length, v.y * inverse_length, v.z * inverse_length };
+}
+
+inline void
+normalize(Vec3<float>& v) {
+    v = normalized(v);
+}
+
+inline Quaternion<float>
+normalized(const Quaternion<float>& q) {
+    const float inverse_length = rsqrt(Quaternion<float>::Dot(q, q));
+    return Quaternion<float>::New(q.x * inverse_length, q.y * inverse_length, q.z * inverse_length, q.w * inverse_length);
+}
+
+/**
+ * @brief Normalize count vectors. The output may be the same arrays as the input
+*/
+inline void
+normalize(ConstVec3Stream in, Vec3Stream out, uint64_t count) {
+    uint64_t i = 0;
+#if QMATH_SIMD_SSE
+    const batch::lanes half = batch::splat(0.5f);
+    const batch::lanes three_halves = batch::splat(1.5f);
+    for (; i + batch::WIDTH <= count; i += batch::WIDTH) {
+        const batch::lanes x = batch::load(in.x + i);
+        const batch::lanes y = batch::load(in.y + i);
+        const batch::lanes z = batch::load(in.z + i);
+        const batch::lanes length_squared = batch::add(batch::add(batch::mul(x, x), batch::mul(y, y)), batch::mul(z, z));
+
+        // The Newton step of rsqrt above, a lane at a time
+        const batch::lanes estimate = batch::rsqrt(length_squared);
+        const batch::lanes refine = batch::sub(three_halves, batch::mul(batch::mul(batch::mul(half, length_squared), estimate), estimate));
+        const batch::lanes inverse_length = batch::mul(estimate, refine);
+
+        batch::store(out.x + i, batch::mul(x, inverse_length));
+        batch::store(out.y + i, batch::mul(y, inverse_length));
+        batch::store(out.z + i, batch::mul(z, inverse_length));
+    }
+#endif
+    for (; i < count; i++) {
+        const Vec3<float> v = normalized(Vec3<float> { in.x[i], in.y[i], in.z[i] });
+        out.x[i] = v.x;
+        out.y[i] = v.y;
+        out.z[i] = v.z;
+    }
+}
+
+} // fast
+} // qmath
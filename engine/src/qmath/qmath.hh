@@ -3,4 +3,6 @@
 #include "qvector4.inl"
 #include "qmatrix4.inl"
 #include "qquaternion.inl"
-#include "qvertex.inl"
\ No newline at end of file
+#include "qvertex.inl"
+#include "qbatch.inl"
+#include "qfast.inl"
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include "qoperations.inl"
 #include "qdefines.hh"
 #include "qvector3.inl"
+#include "qvector4.inl"
+#include "qsimd.inl"
 
 namespace qmath {
 
@@ -13,12 +15,12 @@ template <typename T>
 struct Mat4 {
     T data[16];
 
-    Mat4();
-    Mat4(const Mat4<T>& m);
+    constexpr Mat4();
+    constexpr Mat4(const Mat4<T>& m) = default;
 
-    static Mat4<T> Identity();
+    constexpr static Mat4<T> Identity();
 
-    static Mat4<float> Orthographic(
+    constexpr static Mat4<float> Orthographic(
         float left, float right,
         float bottom, float top,
         float near_clip, float far_clip
@@ -26,68 +28,51 @@ struct Mat4 {
 
     void Print();
 
-    static uint64_t Size() { return 16 * sizeof(T); }
+    constexpr static uint64_t Size() { return 16 * sizeof(T); }
 
-    static Mat4<float> Perspective(float fov_radians, float aspect_ratio, float near_clip, float far_clip);
+    constexpr static Mat4<float> Perspective(float fov_radians, float aspect_ratio, float near_clip, float far_clip);
 
-    static Mat4<T> LookAt(Vec3<T> position, Vec3<T> target, Vec3<T> up);
+    constexpr static Mat4<T> LookAt(Vec3<T> position, Vec3<T> target, Vec3<T> up);
 
-    static Mat4<T> GetTransposed(const Mat4<T>& matrix);
-    void Transpose();
+    constexpr static Mat4<T> GetTransposed(const Mat4<T>& matrix);
+    constexpr void Transpose();
 
-    static Mat4<T> GetInverse(const Mat4<T>& matrix);
-    void Invert();
+    constexpr static Mat4<T> GetInverse(const Mat4<T>& matrix);
+    constexpr void Invert();
 
-    static Mat4<T> GetTranslation(Vec3<T> position);
+    // v as a row vector through matrix, v * matrix
+    constexpr static Vec4<T> Transform(const Mat4<T>& matrix, const Vec4<T>& v);
+    // point with w = 1, so it is translated
+    constexpr static Vec3<T> TransformPoint(const Mat4<T>& matrix, const Vec3<T>& point);
+    // direction with w = 0, so it is not
+    constexpr static Vec3<T> TransformVector(const Mat4<T>& matrix, const Vec3<T>& direction);
 
-    static Mat4<T> Scale(Vec3<T> scale);
+    constexpr static Mat4<T> GetTranslation(Vec3<T> position);
 
-    static Mat4<T> EulerX(T radians);
-    static Mat4<T> EulerY(T radians);
-    static Mat4<T> EulerZ(T radians);
-    static Mat4<T> EulerXYZ(T xrad, T yrad, T zrad);
+    constexpr static Mat4<T> Scale(Vec3<T> scale);
 
-    static Vec3<T> Forward(const Mat4<T>& matrix);
-    static Vec3<T> Backward(const Mat4<T>& matrix);
-    static Vec3<T> Up(const Mat4<T>& matrix);
-    static Vec3<T> Down(const Mat4<T>& matrix);
-    static Vec3<T> Left(const Mat4<T>& matrix);
-    static Vec3<T> Right(const Mat4<T>& matrix);
+    constexpr static Mat4<T> EulerX(T radians);
+    constexpr static Mat4<T> EulerY(T radians);
+    constexpr static Mat4<T> EulerZ(T radians);
+    constexpr static Mat4<T> EulerXYZ(T xrad, T yrad, T zrad);
 
-    Mat4<T>& operator= (const Mat4<T>& m1);
+    constexpr static Vec3<T> Forward(const Mat4<T>& matrix);
+    constexpr static Vec3<T> Backward(const Mat4<T>& matrix);
+    constexpr static Vec3<T> Up(const Mat4<T>& matrix);
+    constexpr static Vec3<T> Down(const Mat4<T>& matrix);
+    constexpr static Vec3<T> Left(const Mat4<T>& matrix);
+    constexpr static Vec3<T> Right(const Mat4<T>& matrix);
+
+    constexpr Mat4<T>& operator= (const Mat4<T>& m1) = default;
 };
 
 template <typename T>
-Mat4<T>::Mat4() {
+constexpr Mat4<T>::Mat4() {
     for(uint32_t i = 0; i < 16; i++) {
         data[i] = 0;
     }
 }
 
-// Copy Constructor
-template <typename T>
-Mat4<T>::Mat4(const Mat4<T>& m) {
-    this->data[0] = m.data[0];
-    this->data[1] = m.data[1];
-    this->data[2] = m.data[2];
-    this->data[3] = m.data[3];
-
-    this->data[4] = m.data[4];
-    this->data[5] = m.data[5];
-    this->data[6] = m.data[6];
-    this->data[7] = m.data[7];
-
-    this->data[8] = m.data[8];
-    this->data[9] = m.data[9];
-    this->data[10] = m.data[10];
-    this->data[11] = m.data[11];
-
-    this->data[12] = m.data[12];
-    this->data[13] = m.data[13];
-    this->data[14] = m.data[14];
-    this->data[15] = m.data[15];
-}
-
 template <typename T>
 void
 Mat4<T>::Print() {
@@ -98,35 +83,13 @@ Mat4<T>::Print() {
     return;
 }
 
-template <typename T>
-Mat4<T>&
-Mat4<T>::operator=(const Mat4<T>& m2) {
-    this->data[0] = m2.data[0];
-    this->data[1] = m2.data[1];
-    this->data[2] = m2.data[2];
-    this->data[3] = m2.data[3];
-
-    this->data[4] = m2.data[4];
-    this->data[5] = m2.data[5];
-    this->data[6] = m2.data[6];
-    this->data[7] = m2.data[7];
-
-    this->data[8] = m2.data[8];
-    this->data[9] = m2.data[9];
-    this->data[10] = m2.data[10];
-    this->data[11] = m2.data[11];
-
-    this->data[12] = m2.data[12];
-    this->data[13] = m2.data[13];
-    this->data[14] = m2.data[14];
-    this->data[15] = m2.data[15];
-
-    return *this;
-}
-
+// Reference versions of the hot Mat4 operations. The float ones are replaced with the kernels
+// in qsimd.inl when the target has them, and the tests check that both agree
+namespace scalar {
 
 template <typename T>
-Mat4<T> operator* (const Mat4<T>& m1, const Mat4<T>& m2) {
+constexpr Mat4<T>
+multiply(const Mat4<T>& m1, const Mat4<T>& m2) {
     Mat4<T> out = Mat4<T>::Identity();
 
     const T* m1_data = m1.data;
@@ -267,10 +230,124 @@ Mat4<T> operator* (const Mat4<T>& m1, const Mat4<T>& m2) {
 
     return out;
 }
+
+template <typename T>
+constexpr Mat4<T>
+inverse(const Mat4<T>& matrix) {
+    const T* m = matrix.data;
+
+    T t0 = m[10] * m[15];
+    T t1 = m[14] * m[11];
+    T t2 = m[6] * m[15];
+    T t3 = m[14] * m[7];
+    T t4 = m[6] * m[11];
+    T t5 = m[10] * m[7];
+    T t6 = m[2] * m[15];
+    T t7 = m[14] * m[3];
+    T t8 = m[2] * m[11];
+    T t9 = m[10] * m[3];
+    T t10 = m[2] * m[7];
+    T t11 = m[6] * m[3];
+    T t12 = m[8] * m[13];
+    T t13 = m[12] * m[9];
+    T t14 = m[4] * m[13];
+    T t15 = m[12] * m[5];
+    T t16 = m[4] * m[9];
+    T t17 = m[8] * m[5];
+    T t18 = m[0] * m[13];
+    T t19 = m[12] * m[1];
+    T t20 = m[0] * m[9];
+    T t21 = m[8] * m[1];
+    T t22 = m[0] * m[5];
+    T t23 = m[4] * m[1];
+
+    Mat4<T> out_matrix;
+    T* o = out_matrix.data;
+
+    o[0] = (t0 * m[5] + t3 * m[9] + t4 * m[13]) - (t1 * m[5] + t2 * m[9] + t5 * m[13]);
+    o[1] = (t1 * m[1] + t6 * m[9] + t9 * m[13]) - (t0 * m[1] + t7 * m[9] + t8 * m[13]);
+    o[2] = (t2 * m[1] + t7 * m[5] + t10 * m[13]) - (t3 * m[1] + t6 * m[5] + t11 * m[13]);
+    o[3] = (t5 * m[1] + t8 * m[5] + t11 * m[9]) - (t4 * m[1] + t9 * m[5] + t10 * m[9]);
+
+    T d = (T)1 / (m[0] * o[0] + m[4] * o[1] + m[8] * o[2] + m[12] * o[3]);
+
+    o[0] = d * o[0];
+    o[1] = d * o[1];
+    o[2] = d * o[2];
+    o[3] = d * o[3];
+    o[4] = d * ((t1 * m[4] + t2 * m[8] + t5 * m[12]) - (t0 * m[4] + t3 * m[8] + t4 * m[12]));
+    o[5] = d * ((t0 * m[0] + t7 * m[8] + t8 * m[12]) - (t1 * m[0] + t6 * m[8] + t9 * m[12]));
+    o[6] = d * ((t3 * m[0] + t6 * m[4] + t11 * m[12]) - (t2 * m[0] + t7 * m[4] + t10 * m[12]));
+    o[7] = d * ((t4 * m[0] + t9 * m[4] + t10 * m[8]) - (t5 * m[0] + t8 * m[4] + t11 * m[8]));
+    o[8] = d * ((t12 * m[7] + t15 * m[11] + t16 * m[15]) - (t13 * m[7] + t14 * m[11] + t17 * m[15]));
+    o[9] = d * ((t13 * m[3] + t18 * m[11] + t21 * m[15]) - (t12 * m[3] + t19 * m[11] + t20 * m[15]));
+    o[10] = d * ((t14 * m[3] + t19 * m[7] + t22 * m[15]) - (t15 * m[3] + t18 * m[7] + t23 * m[15]));
+    o[11] = d * ((t17 * m[3] + t20 * m[7] + t23 * m[11]) - (t16 * m[3] + t21 * m[7] + t22 * m[11]));
+    o[12] = d * ((t14 * m[10] + t17 * m[14] + t13 * m[6]) - (t16 * m[14] + t12 * m[6] + t15 * m[10]));
+    o[13] = d * ((t20 * m[14] + t12 * m[2] + t19 * m[10]) - (t18 * m[10] + t21 * m[14] + t13 * m[2]));
+    o[14] = d * ((t18 * m[6] + t23 * m[14] + t15 * m[2]) - (t22 * m[14] + t14 * m[2] + t19 * m[6]));
+    o[15] = d * ((t22 * m[10] + t16 * m[2] + t21 * m[6]) - (t20 * m[6] + t23 * m[10] + t17 * m[2]));
+
+    return out_matrix;
+}
+
+template <typename T>
+constexpr Vec4<T>
+transform(const Mat4<T>& matrix, const Vec4<T>& v) {
+    const T* m = matrix.data;
+    Vec4<T> out;
+    out.x = v.x * m[0] + v.y * m[4] + v.z * m[8] + v.w * m[12];
+    out.y = v.x * m[1] + v.y * m[5] + v.z * m[9] + v.w * m[13];
+    out.z = v.x * m[2] + v.y * m[6] + v.z * m[10] + v.w * m[14];
+    out.w = v.x * m[3] + v.y * m[7] + v.z * m[11] + v.w * m[15];
+    return out;
+}
+
+template <typename T>
+constexpr Vec3<T>
+transform_point(const Mat4<T>& matrix, const Vec3<T>& point) {
+    const T* m = matrix.data;
+    Vec3<T> out;
+    out.x = point.x * m[0] + point.y * m[4] + point.z * m[8] + m[12];
+    out.y = point.x * m[1] + point.y * m[5] + point.z * m[9] + m[13];
+    out.z = point.x * m[2] + point.y * m[6] + point.z * m[10] + m[14];
+    return out;
+}
+
+template <typename T>
+constexpr Vec3<T>
+transform_vector(const Mat4<T>& matrix, const Vec3<T>& direction) {
+    const T* m = matrix.data;
+    Vec3<T> out;
+    out.x = direction.x * m[0] + direction.y * m[4] + direction.z * m[8];
+    out.y = direction.x * m[1] + direction.y * m[5] + direction.z * m[9];
+    out.z = direction.x * m[2] + direction.y * m[6] + direction.z * m[10];
+    return out;
+}
+
+} // scalar
+
+template <typename T>
+constexpr Mat4<T> operator* (const Mat4<T>& m1, const Mat4<T>& m2) {
+    return scalar::multiply(m1, m2);
+}
+
+#if QMATH_SIMD_SSE
+template <>
+constexpr Mat4<float> operator* (const Mat4<float>& m1, const Mat4<float>& m2) {
+    // The intrinsics cannot run in a constant expression
+    if (std::is_constant_evaluated()) {
+        return scalar::multiply(m1, m2);
+    }
+    Mat4<float> out;
+    simd::mat4_multiply(m1.data, m2.data, out.data);
+    return out;
+}
+#endif
     
 // Static Members
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::Identity() {
     Mat4<T> out;
     out.data[0] = (T)1;
@@ -297,13 +374,13 @@ Mat4<T>::Identity() {
 }
 
 template <typename T>
-Mat4<float> 
+constexpr Mat4<float> 
 Mat4<T>::Orthographic(
     float left, float right,
     float bottom, float top,
     float near_clip, float far_clip
 ) {
-    Mat4<float> out = Matr<float>::Identity();
+    Mat4<float> out = Mat4<float>::Identity();
 
     float lr = 1.f / (left - right);
     float bt = 1.f / (bottom - top);
@@ -320,7 +397,7 @@ Mat4<T>::Orthographic(
 }
 
 template <typename T>
-Mat4<float> 
+constexpr Mat4<float> 
 Mat4<T>::Perspective(float fov_radians, float aspect_ratio, float near_clip, float far_clip) {
     float fov_half_tan = qtan(fov_radians * 0.5f);
     Mat4<float> out;
@@ -336,7 +413,7 @@ Mat4<T>::Perspective(float fov_radians, float aspect_ratio, float near_clip, flo
 }
 
 template <typename T>
-Mat4<T> 
+constexpr Mat4<T> 
 Mat4<T>::LookAt(Vec3<T> position, Vec3<T> target, Vec3<T> up) {
     Mat4<T> out;
     Vec3<T> z_axis;
@@ -369,8 +446,8 @@ Mat4<T>::LookAt(Vec3<T> position, Vec3<T> target, Vec3<T> up) {
     return out;
 }
 
-template <typename T>    
-Mat4<T> 
+template <typename T>
+constexpr Mat4<T>
 Mat4<T>::GetTransposed(const Mat4<T>& matrix) {
     Mat4<T> out = Mat4<T>::Identity();
 
@@ -398,7 +475,7 @@ Mat4<T>::GetTransposed(const Mat4<T>& matrix) {
 
 // TODO: This can be more efficient but this works for now
 template <typename T>
-void 
+constexpr void 
 Mat4<T>::Transpose() {
     Mat4<T> t = Mat4<T>::GetTransposed(*this);
     *this = t;
@@ -443,67 +520,77 @@ Mat4<T>::Transpose() {
 }
 
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::GetInverse(const Mat4<T>& matrix) {
-    const T* m = matrix.data;
+    return scalar::inverse(matrix);
+}
 
-    T t0 = m[10] * m[15];
-    T t1 = m[14] * m[11];
-    T t2 = m[6] * m[15];
-    T t3 = m[14] * m[7];
-    T t4 = m[6] * m[11];
-    T t5 = m[10] * m[7];
-    T t6 = m[2] * m[15];
-    T t7 = m[14] * m[3];
-    T t8 = m[2] * m[11];
-    T t9 = m[10] * m[3];
-    T t10 = m[2] * m[7];
-    T t11 = m[6] * m[3];
-    T t12 = m[8] * m[13];
-    T t13 = m[12] * m[9];
-    T t14 = m[4] * m[13];
-    T t15 = m[12] * m[5];
-    T t16 = m[4] * m[9];
-    T t17 = m[8] * m[5];
-    T t18 = m[0] * m[13];
-    T t19 = m[12] * m[1];
-    T t20 = m[0] * m[9];
-    T t21 = m[8] * m[1];
-    T t22 = m[0] * m[5];
-    T t23 = m[4] * m[1];
+template <typename T>
+constexpr Vec4<T>
+Mat4<T>::Transform(const Mat4<T>& matrix, const Vec4<T>& v) {
+    return scalar::transform(matrix, v);
+}
 
-    Mat4<T> out_matrix;
-    T* o = out_matrix.data;
+template <typename T>
+constexpr Vec3<T>
+Mat4<T>::TransformPoint(const Mat4<T>& matrix, const Vec3<T>& point) {
+    return scalar::transform_point(matrix, point);
+}
 
-    o[0] = (t0 * m[5] + t3 * m[9] + t4 * m[13]) - (t1 * m[5] + t2 * m[9] + t5 * m[13]);
-    o[1] = (t1 * m[1] + t6 * m[9] + t9 * m[13]) - (t0 * m[1] + t7 * m[9] + t8 * m[13]);
-    o[2] = (t2 * m[1] + t7 * m[5] + t10 * m[13]) - (t3 * m[1] + t6 * m[5] + t11 * m[13]);
-    o[3] = (t5 * m[1] + t8 * m[5] + t11 * m[9]) - (t4 * m[1] + t9 * m[5] + t10 * m[9]);
+template <typename T>
+constexpr Vec3<T>
+Mat4<T>::TransformVector(const Mat4<T>& matrix, const Vec3<T>& direction) {
+    return scalar::transform_vector(matrix, direction);
+}
 
-    T d = (T)1 / (m[0] * o[0] + m[4] * o[1] + m[8] * o[2] + m[12] * o[3]);
+#if QMATH_SIMD_SSE
+template <>
+constexpr Mat4<float>
+Mat4<float>::GetInverse(const Mat4<float>& matrix) {
+    if (std::is_constant_evaluated()) {
+        return scalar::inverse(matrix);
+    }
+    Mat4<float> out;
+    simd::mat4_inverse(matrix.data, out.data);
+    return out;
+}
 
-    o[0] = d * o[0];
-    o[1] = d * o[1];
-    o[2] = d * o[2];
-    o[3] = d * o[3];
-    o[4] = d * ((t1 * m[4] + t2 * m[8] + t5 * m[12]) - (t0 * m[4] + t3 * m[8] + t4 * m[12]));
-    o[5] = d * ((t0 * m[0] + t7 * m[8] + t8 * m[12]) - (t1 * m[0] + t6 * m[8] + t9 * m[12]));
-    o[6] = d * ((t3 * m[0] + t6 * m[4] + t11 * m[12]) - (t2 * m[0] + t7 * m[4] + t10 * m[12]));
-    o[7] = d * ((t4 * m[0] + t9 * m[4] + t10 * m[8]) - (t5 * m[0] + t8 * m[4] + t11 * m[8]));
-    o[8] = d * ((t12 * m[7] + t15 * m[11] + t16 * m[15]) - (t13 * m[7] + t14 * m[11] + t17 * m[15]));
-    o[9] = d * ((t13 * m[3] + t18 * m[11] + t21 * m[15]) - (t12 * m[3] + t19 * m[11] + t20 * m[15]));
-    o[10] = d * ((t14 * m[3] + t19 * m[7] + t22 * m[15]) - (t15 * m[3] + t18 * m[7] + t23 * m[15]));
-    o[11] = d * ((t17 * m[3] + t20 * m[7] + t23 * m[11]) - (t16 * m[3] + t21 * m[7] + t22 * m[11]));
-    o[12] = d * ((t14 * m[10] + t17 * m[14] + t13 * m[6]) - (t16 * m[14] + t12 * m[6] + t15 * m[10]));
-    o[13] = d * ((t20 * m[14] + t12 * m[2] + t19 * m[10]) - (t18 * m[10] + t21 * m[14] + t13 * m[2]));
-    o[14] = d * ((t18 * m[6] + t23 * m[14] + t15 * m[2]) - (t22 * m[14] + t14 * m[2] + t19 * m[6]));
-    o[15] = d * ((t22 * m[10] + t16 * m[2] + t21 * m[6]) - (t20 * m[6] + t23 * m[10] + t17 * m[2]));
+template <>
+constexpr Vec4<float>
+Mat4<float>::Transform(const Mat4<float>& matrix, const Vec4<float>& v) {
+    if (std::is_constant_evaluated()) {
+        return scalar::transform(matrix, v);
+    }
+    Vec4<float> out;
+    simd::mat4_transform(matrix.data, &v.x, &out.x);
+    return out;
+}
 
-    return out_matrix;
+template <>
+constexpr Vec3<float>
+Mat4<float>::TransformPoint(const Mat4<float>& matrix, const Vec3<float>& point) {
+    if (std::is_constant_evaluated()) {
+        return scalar::transform_point(matrix, point);
+    }
+    float out[4];
+    _mm_storeu_ps(out, simd::mat4_transform_point(matrix.data, point.x, point.y, point.z));
+    return Vec3<float> { out[0], out[1], out[2] };
 }
 
+template <>
+constexpr Vec3<float>
+Mat4<float>::TransformVector(const Mat4<float>& matrix, const Vec3<float>& direction) {
+    if (std::is_constant_evaluated()) {
+        return scalar::transform_vector(matrix, direction);
+    }
+    float out[4];
+    _mm_storeu_ps(out, simd::mat4_transform_vector(matrix.data, direction.x, direction.y, direction.z));
+    return Vec3<float> { out[0], out[1], out[2] };
+}
+#endif
+
 template <typename T>
-void
+constexpr void
 Mat4<T>::Invert() {
     Mat4<T> tmatrix = Mat4<T>::Identity();
     for (size_t i = 0; i < 16; i++)
@@ -514,7 +601,7 @@ Mat4<T>::Invert() {
 }
 
 template <typename T>
-Mat4<T> 
+constexpr Mat4<T> 
 Mat4<T>::GetTranslation(Vec3<T> position) {
     Mat4<T> matrix = Mat4<T>::Identity();
     matrix.data[12] = position.x;
@@ -524,7 +611,7 @@ Mat4<T>::GetTranslation(Vec3<T> position) {
 }
 
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::Scale(Vec3<T> scale) {
     Mat4<T> matrix = Mat4<T>::Identity();
     matrix.data[0] = scale.x;
@@ -534,7 +621,7 @@ Mat4<T>::Scale(Vec3<T> scale) {
 }
 
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::EulerX(T radians) {
     Mat4<T> matrix = Mat4<T>::Identity();
     T c = qcos(radians);
@@ -548,7 +635,7 @@ Mat4<T>::EulerX(T radians) {
 }
 
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::EulerY(T radians) {
     Mat4<T> matrix = Mat4<T>::Identity();
     T c = qcos(radians);
@@ -562,7 +649,7 @@ Mat4<T>::EulerY(T radians) {
 }
 
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::EulerZ(T radians) {
     Mat4<T> matrix = Mat4<T>::Identity();
     T c = qcos(radians);
@@ -576,7 +663,7 @@ Mat4<T>::EulerZ(T radians) {
 }
 
 template <typename T>
-Mat4<T>
+constexpr Mat4<T>
 Mat4<T>::EulerXYZ(T xrad, T yrad, T zrad) {
     Mat4<T> rx = Mat4<T>::EulerX(xrad);
     Mat4<T> ry = Mat4<T>::EulerY(yrad);
@@ -588,7 +675,7 @@ Mat4<T>::EulerXYZ(T xrad, T yrad, T zrad) {
 }
 
 template <typename T>
-Vec3<T>
+constexpr Vec3<T>
 Mat4<T>::Forward(const Mat4<T>& matrix) {
     Vec3<T> forward;
     forward.x = -matrix.data[2];
@@ -599,7 +686,7 @@ Mat4<T>::Forward(const Mat4<T>& matrix) {
 }
 
 template <typename T>
-Vec3<T>
+constexpr Vec3<T>
 Mat4<T>::Backward(const Mat4<T>& matrix) {
     Vec3<T> forward;
     forward.x = matrix.data[2];
@@ -610,7 +697,7 @@ Mat4<T>::Backward(const Mat4<T>& matrix) {
 }
 
 template <typename T>
-Vec3<T>
+constexpr Vec3<T>
 Mat4<T>::Up(const Mat4<T>& matrix) {
     Vec3<T> forward;
     forward.x = -matrix.data[1];
@@ -621,7 +708,7 @@ Mat4<T>::Up(const Mat4<T>& matrix) {
 }
 
 template <typename T>
-Vec3<T>
+constexpr Vec3<T>
 Mat4<T>::Down(const Mat4<T>& matrix) {
     Vec3<T> forward;
     forward.x = matrix.data[1];
@@ -632,7 +719,7 @@ Mat4<T>::Down(const Mat4<T>& matrix) {
 }
 
 template <typename T>
-Vec3<T>
+constexpr Vec3<T>
 Mat4<T>::Left(const Mat4<T>& matrix) {
     Vec3<T> forward;
     forward.x = -matrix.data[0];
@@ -643,7 +730,7 @@ Mat4<T>::Left(const Mat4<T>& matrix) {
 }
 
 template <typename T>
-Vec3<T>
+constexpr Vec3<T>
 Mat4<T>::Right(const Mat4<T>& matrix) {
     Vec3<T> forward;
     forward.x = matrix.data[0];
@@ -1,45 +1,188 @@
 #pragma once
 #include "qdefines.hh"
 #include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 namespace qmath {
 
-inline float
-deg_to_rad(int32_t deg) {
-    return (
-        static_cast<float>(Q_PI / 180) * deg
-    );
+// Versions of the <cmath> functions that work in a constant expression, where std:: cannot be called.
+// They are evaluated in double and land within an ulp or two of std:: once rounded to float,
+// so a table baked at compile time can differ from one built at runtime in the last bit
+namespace constant {
+
+constexpr double PI = 3.14159265358979323846;
+constexpr double TWO_PI = 6.28318530717958647692;
+
+constexpr double
+abs(double x) {
+    return x < 0.0 ? -x : x;
+}
+
+constexpr double
+sqrt(double x) {
+    if (x != x || x < 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (x == 0.0 || x == std::numeric_limits<double>::infinity()) {
+        return x;
+    }
+
+    // Newton's method from above only ever comes down, so stop once it does not
+    double guess = x > 1.0 ? x : 1.0;
+    while (true) {
+        double next = 0.5 * (guess + x / guess);
+        if (next >= guess) {
+            return guess;
+        }
+        guess = next;
+    }
+}
+
+// Into [-pi, pi], which keeps the series below short
+constexpr double
+wrap_angle(double x) {
+    double turns = x / TWO_PI;
+    int64_t whole = static_cast<int64_t>(turns < 0.0 ? turns - 0.5 : turns + 0.5);
+    return x - static_cast<double>(whole) * TWO_PI;
+}
+
+constexpr double
+sin(double x) {
+    x = wrap_angle(x);
+    double term = x;
+    double sum = x;
+    for (int32_t n = 1; n < 32 && term != 0.0; n++) {
+        term *= -x * x / static_cast<double>((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double
+cos(double x) {
+    x = wrap_angle(x);
+    double term = 1.0;
+    double sum = 1.0;
+    for (int32_t n = 1; n < 32 && term != 0.0; n++) {
+        term *= -x * x / static_cast<double>((2 * n - 1) * (2 * n));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double
+tan(double x) {
+    return sin(x) / cos(x);
+}
+
+constexpr double
+atan(double x) {
+    if (x != x) {
+        return x;
+    }
+    if (x < 0.0) {
+        return -atan(-x);
+    }
+    if (x > 1.0) {
+        return 0.5 * PI - atan(1.0 / x);
+    }
+
+    // atan(x) = 2 atan(x / (1 + sqrt(1 + x^2))) brings x under tan(pi/8) before the series
+    double scale = 1.0;
+    while (x > 0.25) {
+        x = x / (1.0 + sqrt(1.0 + x * x));
+        scale *= 2.0;
+    }
+
+    double x2 = x * x;
+    double power = x;
+    double sum = x;
+    for (int32_t n = 1; n < 64; n++) {
+        power *= -x2;
+        double term = power / static_cast<double>(2 * n + 1);
+        if (sum + term == sum) {
+            break;
+        }
+        sum += term;
+    }
+    return scale * sum;
+}
+
+constexpr double
+acos(double x) {
+    if (x != x || x < -1.0 || x > 1.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (x == 1.0) {
+        return 0.0;
+    }
+    if (x == -1.0) {
+        return PI;
+    }
+    return 0.5 * PI - atan(x / sqrt(1.0 - x * x));
+}
+
+} // constant
+
+constexpr float
+deg_to_rad(float deg) {
+    return static_cast<float>(Q_PI / 180) * deg;
+}
+
+constexpr float
+rad_to_deg(float rad) {
+    return static_cast<float>(180 / Q_PI) * rad;
 }
 
 template <typename T>
-T qsqrt(T num) {
+constexpr T qsqrt(T num) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<T>(constant::sqrt(static_cast<double>(num)));
+    }
     return std::sqrt(num);
 }
 
 template <typename T>
-T qabs(T num) {
+constexpr T qabs(T num) {
+    if (std::is_constant_evaluated()) {
+        return num < (T)0 ? -num : num;
+    }
     return std::abs(num);
 }
 
 template<typename T>
-T qtan(T num) {
+constexpr T qtan(T num) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<T>(constant::tan(static_cast<double>(num)));
+    }
     return std::tan(num);
 }
 
 template<typename T>
-T qsin(T num) {
+constexpr T qsin(T num) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<T>(constant::sin(static_cast<double>(num)));
+    }
     return std::sin(num);
 }
 
 template<typename T>
-T qcos(T num) {
+constexpr T qcos(T num) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<T>(constant::cos(static_cast<double>(num)));
+    }
     return std::cos(num);
 }
 
 template<typename T>
-T qacos(T num) {
+constexpr T qacos(T num) {
+    if (std::is_constant_evaluated()) {
+        return static_cast<T>(constant::acos(static_cast<double>(num)));
+    }
     return std::acos(num);
 }
 
 
-} // qmath
\ No newline at end of file
+} // qmath
@@ -25,31 +25,31 @@ struct Quaternion {
         };
     };
 
-    static Quaternion<T> Identity();
-    static Quaternion<T> New(T x, T y, T z, T w); 
-    static Quaternion<T> Zero(); 
-    static Quaternion<T> One(); 
-    static bool Compare(const Quaternion<T> &v1, const Quaternion<T>& v2, float tolerance); 
-    static T Normal(const Quaternion<T>& q);
-    static T Dot(const Quaternion<T>& q1, const Quaternion<T>& q2);
-    static Quaternion<T> FromAxisAngle(Vec3<T> axis, T angle, bool normalize);
-    static Quaternion<float> Slerp(const Quaternion<float>& q1, const Quaternion<float>& q2, float percentage);
+    constexpr static Quaternion<T> Identity();
+    constexpr static Quaternion<T> New(T x, T y, T z, T w); 
+    constexpr static Quaternion<T> Zero(); 
+    constexpr static Quaternion<T> One(); 
+    constexpr static bool Compare(const Quaternion<T> &v1, const Quaternion<T>& v2, float tolerance); 
+    constexpr static T Normal(const Quaternion<T>& q);
+    constexpr static T Dot(const Quaternion<T>& q1, const Quaternion<T>& q2);
+    constexpr static Quaternion<T> FromAxisAngle(Vec3<T> axis, T angle, bool normalize);
+    constexpr static Quaternion<T> Slerp(const Quaternion<T>& q1, const Quaternion<T>& q2, T percentage);
     
-    Quaternion<T> GetNormalized();
-    Quaternion<T> GetConjugate();
-    Quaternion<T> GetInverse();
+    constexpr Quaternion<T> GetNormalized() const;
+    constexpr Quaternion<T> GetConjugate() const;
+    constexpr Quaternion<T> GetInverse() const;
 
-    void Normalize();
-    void Inverse();
+    constexpr void Normalize();
+    constexpr void Inverse();
 
-    Mat4<T> ToMat4();
-    Mat4<T> ToRotationMatrix(Vec3<T> center);
+    constexpr Mat4<T> ToMat4() const;
+    constexpr Mat4<T> ToRotationMatrix(Vec3<T> center) const;
 
-    Quaternion<T>& operator= (Quaternion<T>& m1);
+    constexpr Quaternion<T>& operator= (const Quaternion<T>& m1) = default;
 };
 
 template <typename T>
-Quaternion<T> 
+constexpr Quaternion<T> 
 Quaternion<T>::New(T x, T y, T z, T w) {
     Quaternion<T> out_vec;
     out_vec.x = x;
@@ -60,7 +60,7 @@ Quaternion<T>::New(T x, T y, T z, T w) {
 }
 
 template <typename T>
-Quaternion<T>
+constexpr Quaternion<T>
 Quaternion<T>::Zero() {
     Quaternion<T> out_vec;
     out_vec.x = (T)0;
@@ -71,9 +71,9 @@ Quaternion<T>::Zero() {
 }
 
 template <typename T>
-Quaternion<T>
+constexpr Quaternion<T>
 Quaternion<T>::One() {
-    return (Quaternion<T>) {
+    return Quaternion<T> {
         (T)1,
         (T)1,
         (T)1,
@@ -81,22 +81,12 @@ Quaternion<T>::One() {
     };
 }
 
-template <typename T>
-Quaternion<T>&
-Quaternion<T>::operator= (Quaternion<T>& other) {
-    this.x = other.x;
-    this.y = other.y;
-    this.z = other.z;
-    this.w = other.w;
-    return this;
-}
-
 // FROM VEC4 //
 // Operator Overloads
 // Addition
 template <typename T>
-const Quaternion<T> operator+ (const Quaternion<T>& v1, const Quaternion<T>& v2) {
-    return (Quaternion<T>) {
+constexpr const Quaternion<T> operator+ (const Quaternion<T>& v1, const Quaternion<T>& v2) {
+    return Quaternion<T> {
         v1.x + v2.x,
         v1.y + v2.y,
         v1.z + v2.z,
@@ -105,7 +95,7 @@ const Quaternion<T> operator+ (const Quaternion<T>& v1, const Quaternion<T>& v2)
 }
 
 template <typename T>
-const Quaternion<T> operator+= (Quaternion<T>& v1, const Quaternion<T>& v2) {
+constexpr const Quaternion<T> operator+= (Quaternion<T>& v1, const Quaternion<T>& v2) {
     v1.x += v2.x;
     v1.y += v2.y;
     v1.z += v2.z;
@@ -115,8 +105,8 @@ const Quaternion<T> operator+= (Quaternion<T>& v1, const Quaternion<T>& v2) {
 
 // Subtraction
 template <typename T>
-const Quaternion<T> operator- (const Quaternion<T>& v1, const Quaternion<T>& v2) {
-    return (Quaternion<T>) {
+constexpr const Quaternion<T> operator- (const Quaternion<T>& v1, const Quaternion<T>& v2) {
+    return Quaternion<T> {
         v1.x - v2.x,
         v1.y - v2.y,
         v1.z - v2.z,
@@ -125,7 +115,7 @@ const Quaternion<T> operator- (const Quaternion<T>& v1, const Quaternion<T>& v2)
 }
 
 template <typename T>
-const Quaternion<T> operator-= (Quaternion<T>& v1, const Quaternion<T>& v2) {
+constexpr const Quaternion<T> operator-= (Quaternion<T>& v1, const Quaternion<T>& v2) {
     v1.x -= v2.x;
     v1.y -= v2.y;
     v1.z -= v2.z;
@@ -135,8 +125,8 @@ const Quaternion<T> operator-= (Quaternion<T>& v1, const Quaternion<T>& v2) {
 
 // Division 
 template <typename T>
-const Quaternion<T> operator/ (const Quaternion<T>& v1, const Quaternion<T>& v2) {
-    return (Quaternion<T>) {
+constexpr const Quaternion<T> operator/ (const Quaternion<T>& v1, const Quaternion<T>& v2) {
+    return Quaternion<T> {
         v1.x / v2.x,
         v1.y / v2.y,
         v1.z / v2.z,
@@ -145,8 +135,8 @@ const Quaternion<T> operator/ (const Quaternion<T>& v1, const Quaternion<T>& v2)
 }
 
 template <typename T>
-const Quaternion<T> operator/ (const Quaternion<T>& v1, const float scalar) {
-    return (Quaternion<T>) {
+constexpr const Quaternion<T> operator/ (const Quaternion<T>& v1, const float scalar) {
+    return Quaternion<T> {
         v1.x / scalar,
         v1.y / scalar,
         v1.z / scalar,
@@ -155,7 +145,7 @@ const Quaternion<T> operator/ (const Quaternion<T>& v1, const float scalar) {
 }
 
 template <typename T>
-const Quaternion<T> operator/= (Quaternion<T>& v1, const Quaternion<T>& v2) {
+constexpr const Quaternion<T> operator/= (Quaternion<T>& v1, const Quaternion<T>& v2) {
     v1.x /= v2.x;
     v1.y /= v2.y;
     v1.z /= v2.z;
@@ -165,8 +155,8 @@ const Quaternion<T> operator/= (Quaternion<T>& v1, const Quaternion<T>& v2) {
 
 // Multiply by a scalar
 template <typename T>
-const Quaternion<T> operator* (const Quaternion<T>& v1, const float scalar) {
-    return (Quaternion<T>) {
+constexpr const Quaternion<T> operator* (const Quaternion<T>& v1, const float scalar) {
+    return Quaternion<T> {
         v1.x * scalar,
         v1.y * scalar,
         v1.z * scalar,
@@ -174,39 +164,68 @@ const Quaternion<T> operator* (const Quaternion<T>& v1, const float scalar) {
     };
 }
 
-// Multiply quaternions
+// Reference versions of the hot Quaternion operations. The float ones are replaced with the
+// kernels in qsimd.inl when the target has them, and the tests check that both agree
+namespace scalar {
+
+// Hamilton product, the rotation q2 followed by q1
 template <typename T>
-Quaternion<T> operator* (const Quaternion<T>& q1, const Quaternion<T>& q2) {
+constexpr Quaternion<T>
+multiply(const Quaternion<T>& q1, const Quaternion<T>& q2) {
     Quaternion<T> qout;
 
     qout.x = q1.x * q2.w +
              q1.y * q2.z - 
              q1.z * q2.y +
-             q1.w * q1.x;
+             q1.w * q2.x;
 
     qout.y = -q1.x * q2.z +
              q1.y * q2.w + 
              q1.z * q2.x +
-             q1.w * q1.y;
+             q1.w * q2.y;
 
     qout.z = q1.x * q2.y -
              q1.y * q2.x + 
              q1.z * q2.w +
-             q1.w * q1.z;
+             q1.w * q2.z;
 
     qout.w = -q1.x * q2.x -
              q1.y * q2.y - 
              q1.z * q2.z +
-             q1.w * q1.w;
+             q1.w * q2.w;
 
     return qout;
 }
 
+template <typename T>
+constexpr Quaternion<T>
+slerp(const Quaternion<T>& q1, const Quaternion<T>& q2, T percentage);
+
+} // scalar
 
+// Multiply quaternions
 template <typename T>
-Quaternion<T> 
+constexpr Quaternion<T> operator* (const Quaternion<T>& q1, const Quaternion<T>& q2) {
+    return scalar::multiply(q1, q2);
+}
+
+#if QMATH_SIMD_SSE
+template <>
+constexpr Quaternion<float> operator* (const Quaternion<float>& q1, const Quaternion<float>& q2) {
+    if (std::is_constant_evaluated()) {
+        return scalar::multiply(q1, q2);
+    }
+    Quaternion<float> out;
+    _mm_storeu_ps(&out.x, simd::quat_multiply(_mm_loadu_ps(&q1.x), _mm_loadu_ps(&q2.x)));
+    return out;
+}
+#endif
+
+
+template <typename T>
+constexpr Quaternion<T> 
 Quaternion<T>::Identity() {
-    return (Quaternion<T>) {
+    return Quaternion<T> {
         (T)0,
         (T)0,
         (T)0,
@@ -215,7 +234,7 @@ Quaternion<T>::Identity() {
 }
 
 template <typename T>
-T 
+constexpr T 
 Quaternion<T>::Normal(const Quaternion<T>& q) {
     return qsqrt(
         q.x * q.x +
@@ -226,7 +245,7 @@ Quaternion<T>::Normal(const Quaternion<T>& q) {
 }
 
 template <typename T>
-T 
+constexpr T 
 Quaternion<T>::Dot(const Quaternion<T>& q1, const Quaternion<T>& q2) {
     return q1.x * q2.x +
            q1.y * q2.y +
@@ -235,13 +254,13 @@ Quaternion<T>::Dot(const Quaternion<T>& q1, const Quaternion<T>& q2) {
 }
 
 template <typename T>
-Quaternion<T> 
+constexpr Quaternion<T> 
 Quaternion<T>::FromAxisAngle(Vec3<T> axis, T angle, bool normalize) {
     const float half_angle = 0.5f * angle;
     float s = qsin(half_angle);
     float c = qcos(half_angle);
 
-    Quaternion<T> q = (Quaternion<T>) {
+    Quaternion<T> q = Quaternion<T> {
         s * axis.x,
         s * axis.y,
         s * axis.z,
@@ -250,28 +269,31 @@ Quaternion<T>::FromAxisAngle(Vec3<T> axis, T angle, bool normalize) {
     return q;
 }
 
+// Above this dot product the inputs are too close for acos, and slerp falls back to a normalized lerp
+static constexpr float SLERP_DOT_THRESHOLD = 0.9995f;
+
 template <typename T>
-Quaternion<float> 
-Quaternion<T>::Slerp(const Quaternion<float>& q1, const Quaternion<float>& q2, float percentage) {
-    Quaternion<float> out;
+constexpr Quaternion<T>
+scalar::slerp(const Quaternion<T>& q1, const Quaternion<T>& q2, T percentage) {
+    Quaternion<T> out;
 
-    Quaternion<float> v1 = q1.GetNormalized();
-    Quaternion<float> v2 = q2.GetNormalized();
+    Quaternion<T> v1 = q1.GetNormalized();
+    Quaternion<T> v2 = q2.GetNormalized();
 
-    float dot = Quaternion<float>::Dot(v1, v2);
+    T dot = Quaternion<T>::Dot(v1, v2);
 
-    if (dot < (float)0) {
-        v2.x = -v1.x;
-        v2.y = -v1.y;
-        v2.z = -v1.z;
-        v2.w = -v1.w;
+    // Take the shorter way round
+    if (dot < (T)0) {
+        v2.x = -v2.x;
+        v2.y = -v2.y;
+        v2.z = -v2.z;
+        v2.w = -v2.w;
         dot = -dot;
     }
 
-    const float DOfloat_floatHRESHOLD = 0.9995f;
-    if (dot > DOfloat_floatHRESHOLD) {
+    if (dot > (T)SLERP_DOT_THRESHOLD) {
         // If the inputs are too close, linearly interpolate them
-        out = (Quaternion<float>) {
+        out = Quaternion<T> {
             v1.x + ((v2.x - v1.x) * percentage),
             v1.y + ((v2.y - v1.y) * percentage),
             v1.z + ((v2.z - v1.z) * percentage),
@@ -282,66 +304,85 @@ Quaternion<T>::Slerp(const Quaternion<float>& q1, const Quaternion<float>& q2, f
     }
 
     // Since the dot is in range [0, DOT_THRESHOLD], acos is safe
-    float theta_0 = qacos(dot);
-    float theta = theta_0 * percentage;
-    float sin_theta = qsin(theta);
-    float sin_theta_0 = qsin(theta_0);
+    T theta_0 = qacos(dot);
+    T theta = theta_0 * percentage;
+    T sin_theta = qsin(theta);
+    T sin_theta_0 = qsin(theta_0);
 
-    float s0 = qcos(theta) - dot * sin_theta / sin_theta_0;
-    float s1 = sin_theta / sin_theta_0;
+    T s0 = qcos(theta) - dot * sin_theta / sin_theta_0;
+    T s1 = sin_theta / sin_theta_0;
 
-    return (Quaternion<T>) {
+    return Quaternion<T> {
         (v1.x * s0) + (v2.x * s1),
         (v1.y * s0) + (v2.y * s1),
         (v1.z * s0) + (v2.z * s1),
         (v1.w * s0) + (v2.w * s1)
     };
 }
+
+template <typename T>
+constexpr Quaternion<T> 
+Quaternion<T>::Slerp(const Quaternion<T>& q1, const Quaternion<T>& q2, T percentage) {
+    return scalar::slerp(q1, q2, percentage);
+}
+
+#if QMATH_SIMD_SSE
+template <>
+constexpr Quaternion<float>
+Quaternion<float>::Slerp(const Quaternion<float>& q1, const Quaternion<float>& q2, float percentage) {
+    if (std::is_constant_evaluated()) {
+        return scalar::slerp(q1, q2, percentage);
+    }
+    Quaternion<float> out;
+    _mm_storeu_ps(&out.x, simd::quat_slerp(_mm_loadu_ps(&q1.x), _mm_loadu_ps(&q2.x), percentage, SLERP_DOT_THRESHOLD));
+    return out;
+}
+#endif
     
 template <typename T>
-Quaternion<T> 
-Quaternion<T>::GetNormalized() {
-    T normal = this->Normal();
-    return (Quaternion<T>) {
-        q.x / normal,
-        q.y / normal,
-        q.z / normal,
-        q.w / normal
+constexpr Quaternion<T> 
+Quaternion<T>::GetNormalized() const {
+    T normal = Normal(*this);
+    return Quaternion<T> {
+        this->x / normal,
+        this->y / normal,
+        this->z / normal,
+        this->w / normal
     };
 }
 
 template <typename T>
-Quaternion<T> 
-Quaternion<T>::GetConjugate() {
-    return (Quaternion<T>) {
-        -q.x,
-        -q.y,
-        -q.z,
-        q.w
+constexpr Quaternion<T> 
+Quaternion<T>::GetConjugate() const {
+    return Quaternion<T> {
+        -this->x,
+        -this->y,
+        -this->z,
+        this->w
     };
 }
 
 template <typename T>
-Quaternion<T> 
-Quaternion<T>::GetInverse() {
-    return (this->GetConjugate).GetNormalized();
+constexpr Quaternion<T> 
+Quaternion<T>::GetInverse() const {
+    return this->GetConjugate().GetNormalized();
 }
 
 template <typename T>
-void 
+constexpr void 
 Quaternion<T>::Normalize() {
 
 }
 
 template <typename T>
-void 
+constexpr void 
 Quaternion<T>::Inverse() {
 
 }
 
 template <typename T>
-Mat4<T> 
-Quaternion<T>::ToMat4() {
+constexpr Mat4<T> 
+Quaternion<T>::ToMat4() const {
     Mat4<T> matrix = Mat4<T>::Identity();
 
     Quaternion qn = this->GetNormalized();
@@ -362,8 +403,8 @@ Quaternion<T>::ToMat4() {
 }
 
 template <typename T>
-Mat4<T> 
-Quaternion<T>::ToRotationMatrix(Vec3<T> center) {
+constexpr Mat4<T> 
+Quaternion<T>::ToRotationMatrix(Vec3<T> center) const {
     Mat4<T> out_matrix;
 
     T* o = out_matrix.data;
@@ -0,0 +1,268 @@
+#pragma once
+#include "defines.hh"
+#include <cmath>
+#include <cstdint>
+
+/*
+ *  SIMD kernels for the float math types
+ *
+ *  Picked at compile time from what the target is built for. Every x86-64 target has SSE2, and
+ *  building with AVX enabled (-mavx, -march=native) also uses 8 wide registers where it helps.
+ *  Other targets, or defining QMATH_NO_SIMD, use the scalar templates in qmath::scalar.
+ *
+ *  The scalar templates stay the reference. Multiply, transform and quaternion multiply add their
+ *  terms in the same order as those, so they give the same bits unless the compiler contracts
+ *  them into FMAs. Inverse and slerp are arranged differently and agree to a few ulp.
+ *
+ *  Matrices are 16 floats, 4 rows of 4, with no alignment requirement.
+ */
+
+#if !defined(QMATH_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define QMATH_SIMD_SSE 1
+#include <immintrin.h>
+#if defined(__AVX__)
+#define QMATH_SIMD_AVX 1
+#endif
+#endif
+
+namespace qmath {
+namespace simd {
+
+#if QMATH_SIMD_AVX
+static constexpr const char* ISA = "AVX";
+#elif QMATH_SIMD_SSE
+static constexpr const char* ISA = "SSE2";
+#else
+static constexpr const char* ISA = "scalar";
+#endif
+
+#if QMATH_SIMD_SSE
+
+// Lanes of v in the order x, y, z, w
+#define QMATH_SWIZZLE(v, x, y, z, w) _mm_shuffle_ps((v), (v), _MM_SHUFFLE((w), (z), (y), (x)))
+
+inline __m128
+splat(__m128 v, const int lane) {
+    switch (lane) {
+        case 0: return QMATH_SWIZZLE(v, 0, 0, 0, 0);
+        case 1: return QMATH_SWIZZLE(v, 1, 1, 1, 1);
+        case 2: return QMATH_SWIZZLE(v, 2, 2, 2, 2);
+        default: return QMATH_SWIZZLE(v, 3, 3, 3, 3);
+    }
+}
+
+// x*r0 + y*r1 + z*r2 + w*r3, added left to right like the scalar code
+inline __m128
+combine_rows(__m128 v, __m128 r0, __m128 r1, __m128 r2, __m128 r3) {
+    __m128 out = _mm_mul_ps(splat(v, 0), r0);
+    out = _mm_add_ps(out, _mm_mul_ps(splat(v, 1), r1));
+    out = _mm_add_ps(out, _mm_mul_ps(splat(v, 2), r2));
+    return _mm_add_ps(out, _mm_mul_ps(splat(v, 3), r3));
+}
+
+// out = a * b. out may be a or b
+inline void
+mat4_multiply(const float* a, const float* b, float* out) {
+#if QMATH_SIMD_AVX
+    // Two rows of a at a time, each broadcasting against the same rows of b
+    const __m256 b0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 0));
+    const __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+    const __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+    const __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+    const __m256 a01 = _mm256_loadu_ps(a + 0);
+    const __m256 a23 = _mm256_loadu_ps(a + 8);
+
+    __m256 r01 = _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x00), b0);
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0x55), b1));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xAA), b2));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(_mm256_shuffle_ps(a01, a01, 0xFF), b3));
+
+    __m256 r23 = _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x00), b0);
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0x55), b1));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xAA), b2));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(_mm256_shuffle_ps(a23, a23, 0xFF), b3));
+
+    _mm256_storeu_ps(out + 0, r01);
+    _mm256_storeu_ps(out + 8, r23);
+#else
+    const __m128 b0 = _mm_loadu_ps(b + 0);
+    const __m128 b1 = _mm_loadu_ps(b + 4);
+    const __m128 b2 = _mm_loadu_ps(b + 8);
+    const __m128 b3 = _mm_loadu_ps(b + 12);
+    const __m128 r0 = combine_rows(_mm_loadu_ps(a + 0), b0, b1, b2, b3);
+    const __m128 r1 = combine_rows(_mm_loadu_ps(a + 4), b0, b1, b2, b3);
+    const __m128 r2 = combine_rows(_mm_loadu_ps(a + 8), b0, b1, b2, b3);
+    const __m128 r3 = combine_rows(_mm_loadu_ps(a + 12), b0, b1, b2, b3);
+    _mm_storeu_ps(out + 0, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, r3);
+#endif
+}
+
+// out = v * m, the row vector v through m. out may be v
+inline void
+mat4_transform(const float* m, const float* v, float* out) {
+    const __m128 result = combine_rows(_mm_loadu_ps(v),
+        _mm_loadu_ps(m + 0), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12));
+    _mm_storeu_ps(out, result);
+}
+
+// (x, y, z, 1) through m
+inline __m128
+mat4_transform_point(const float* m, float x, float y, float z) {
+    __m128 out = _mm_mul_ps(_mm_set1_ps(x), _mm_loadu_ps(m + 0));
+    out = _mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(y), _mm_loadu_ps(m + 4)));
+    out = _mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(z), _mm_loadu_ps(m + 8)));
+    return _mm_add_ps(out, _mm_loadu_ps(m + 12));
+}
+
+// (x, y, z, 0) through m, ignoring the translation
+inline __m128
+mat4_transform_vector(const float* m, float x, float y, float z) {
+    __m128 out = _mm_mul_ps(_mm_set1_ps(x), _mm_loadu_ps(m + 0));
+    out = _mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(y), _mm_loadu_ps(m + 4)));
+    return _mm_add_ps(out, _mm_mul_ps(_mm_set1_ps(z), _mm_loadu_ps(m + 8)));
+}
+
+// 2x2 matrices held as (m00, m01, m10, m11), for the block inverse below
+inline __m128
+mat2_multiply(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, QMATH_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(QMATH_SWIZZLE(a, 1, 0, 3, 2), QMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adjugate(a) * b
+inline __m128
+mat2_adjugate_multiply(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(QMATH_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(QMATH_SWIZZLE(a, 1, 1, 2, 2), QMATH_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adjugate(b)
+inline __m128
+mat2_multiply_adjugate(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, QMATH_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(QMATH_SWIZZLE(a, 1, 0, 3, 2), QMATH_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// out = inverse of m, by splitting it into 2x2 blocks
+//     | A B |
+//     | C D |
+// and inverting with their adjugates. Like the scalar version, a singular matrix gives inf/nan
+inline void
+mat4_inverse(const float* m, float* out) {
+    const __m128 row0 = _mm_loadu_ps(m + 0);
+    const __m128 row1 = _mm_loadu_ps(m + 4);
+    const __m128 row2 = _mm_loadu_ps(m + 8);
+    const __m128 row3 = _mm_loadu_ps(m + 12);
+
+    const __m128 a = _mm_movelh_ps(row0, row1);
+    const __m128 b = _mm_movehl_ps(row1, row0);
+    const __m128 c = _mm_movelh_ps(row2, row3);
+    const __m128 d = _mm_movehl_ps(row3, row2);
+
+    // Determinants of the blocks, (|A|, |B|, |C|, |D|)
+    const __m128 block_determinants = _mm_sub_ps(
+        _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(3, 1, 3, 1))),
+        _mm_mul_ps(_mm_shuffle_ps(row0, row2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(row1, row3, _MM_SHUFFLE(2, 0, 2, 0))));
+    const __m128 det_a = splat(block_determinants, 0);
+    const __m128 det_b = splat(block_determinants, 1);
+    const __m128 det_c = splat(block_determinants, 2);
+    const __m128 det_d = splat(block_determinants, 3);
+
+    const __m128 d_c = mat2_adjugate_multiply(d, c);
+    const __m128 a_b = mat2_adjugate_multiply(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), mat2_multiply(b, d_c));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), mat2_multiply(c, a_b));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), mat2_multiply_adjugate(d, a_b));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), mat2_multiply_adjugate(a, d_c));
+
+    // |M| = |A||D| + |B||C| - trace(adj(A)B adj(D)C)
+    __m128 trace = _mm_mul_ps(a_b, QMATH_SWIZZLE(d_c, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, QMATH_SWIZZLE(trace, 2, 3, 0, 1));
+    trace = _mm_add_ps(trace, QMATH_SWIZZLE(trace, 1, 0, 3, 2));
+    __m128 determinant = _mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c));
+    determinant = _mm_sub_ps(determinant, trace);
+
+    // The signs of a 2x2 adjugate, folded into the reciprocal
+    const __m128 reciprocal = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), determinant);
+    x = _mm_mul_ps(x, reciprocal);
+    y = _mm_mul_ps(y, reciprocal);
+    z = _mm_mul_ps(z, reciprocal);
+    w = _mm_mul_ps(w, reciprocal);
+
+    // Adjugate and put the blocks back into rows
+    _mm_storeu_ps(out + 0, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(out + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(out + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(out + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+}
+
+// Flips the sign of the lanes set
+inline __m128
+negate_lanes(__m128 v, bool x, bool y, bool z, bool w) {
+    const __m128 mask = _mm_castsi128_ps(_mm_setr_epi32(x ? INT32_MIN : 0, y ? INT32_MIN : 0, z ? INT32_MIN : 0, w ? INT32_MIN : 0));
+    return _mm_xor_ps(v, mask);
+}
+
+// Hamilton product of two (x, y, z, w) quaternions, out = q1 * q2
+inline __m128
+quat_multiply(__m128 q1, __m128 q2) {
+    const __m128 t0 = negate_lanes(QMATH_SWIZZLE(q2, 3, 2, 1, 0), false, true, false, true);
+    const __m128 t1 = negate_lanes(QMATH_SWIZZLE(q2, 2, 3, 0, 1), false, false, true, true);
+    const __m128 t2 = negate_lanes(QMATH_SWIZZLE(q2, 1, 0, 3, 2), true, false, false, true);
+
+    __m128 out = _mm_mul_ps(splat(q1, 0), t0);
+    out = _mm_add_ps(out, _mm_mul_ps(splat(q1, 1), t1));
+    out = _mm_add_ps(out, _mm_mul_ps(splat(q1, 2), t2));
+    return _mm_add_ps(out, _mm_mul_ps(splat(q1, 3), q2));
+}
+
+inline float
+dot4(__m128 a, __m128 b) {
+    __m128 product = _mm_mul_ps(a, b);
+    product = _mm_add_ps(product, QMATH_SWIZZLE(product, 2, 3, 0, 1));
+    product = _mm_add_ps(product, QMATH_SWIZZLE(product, 1, 0, 3, 2));
+    return _mm_cvtss_f32(product);
+}
+
+inline __m128
+normalize4(__m128 v) {
+    return _mm_div_ps(v, _mm_sqrt_ps(_mm_set1_ps(dot4(v, v))));
+}
+
+// Spherical interpolation between two (x, y, z, w) quaternions along the shorter arc.
+// The lane work is vectorized, the one acos and two sines are not
+inline __m128
+quat_slerp(__m128 q1, __m128 q2, float percentage, float dot_threshold) {
+    const __m128 v1 = normalize4(q1);
+    __m128 v2 = normalize4(q2);
+    float dot = dot4(v1, v2);
+    if (dot < 0.f) {
+        v2 = negate_lanes(v2, true, true, true, true);
+        dot = -dot;
+    }
+
+    if (dot > dot_threshold) {
+        // Too close for acos, linearly interpolate instead
+        const __m128 lerp = _mm_add_ps(v1, _mm_mul_ps(_mm_sub_ps(v2, v1), _mm_set1_ps(percentage)));
+        return normalize4(lerp);
+    }
+
+    const float theta_0 = std::acos(dot);
+    const float theta = theta_0 * percentage;
+    const float sin_theta = std::sin(theta);
+    const float sin_theta_0 = std::sin(theta_0);
+    const float s0 = std::cos(theta) - dot * sin_theta / sin_theta_0;
+    const float s1 = sin_theta / sin_theta_0;
+    return _mm_add_ps(_mm_mul_ps(v1, _mm_set1_ps(s0)), _mm_mul_ps(v2, _mm_set1_ps(s1)));
+}
+
+#undef QMATH_SWIZZLE
+
+#endif // QMATH_SIMD_SSE
+
+} // simd
+} // qmath
@@ -24,31 +24,31 @@ struct Vec3 {
     };
 
     // Methods
-    PINLINE T length_squared() {
+    constexpr T length_squared() const {
         return this->x * this->x + this->y * this->y + this->z * this->z;
     }
 
-    PINLINE T length() {
+    constexpr T length() const {
         return qsqrt(this->x * this->x + this->y * this->y + this->z * this->z);
     }
 
-    PINLINE void normalize() {
+    constexpr void normalize() {
         const T length = this->length();
         this->x /= length;
         this->y /= length;
         this->z /= length;
     }
 
-    PINLINE void normalized() {
+    constexpr Vec3<T> normalized() const {
         const T length = this->length();
-        return (Vec3<T>) {
-            v.x / length,
-            v.y / length,
-            v.z / length
+        return Vec3<T> {
+            this->x / length,
+            this->y / length,
+            this->z / length
         };
     }
 
-    PINLINE Vec4<T> ToVec4(T w) {
+    constexpr Vec4<T> ToVec4(T w) const {
         Vec4<T> v;
         v.x = this->x;
         v.y = this->y;
@@ -58,7 +58,7 @@ struct Vec3 {
     }
     
     // Static Members
-    PINLINE static Vec3<T> New(T x, T y, T z) {
+    constexpr static Vec3<T> New(T x, T y, T z) {
         Vec3<T> out_vec;
         out_vec.x = x;
         out_vec.y = y;
@@ -66,7 +66,7 @@ struct Vec3 {
         return out_vec;
     }
 
-    PINLINE static Vec3<T> Zero() {
+    constexpr static Vec3<T> Zero() {
         Vec3<T> out_vec;
         out_vec.x = (T)0;
         out_vec.y = (T)0;
@@ -74,63 +74,63 @@ struct Vec3 {
         return out_vec;
     }
 
-    PINLINE static Vec3<T> One() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> One() {
+        return Vec3<T> {
             (T)1,
             (T)1,
             (T)1
         };
     }
 
-    PINLINE static Vec3<T> Up() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> Up() {
+        return Vec3<T> {
             (T)0,
             (T)1,
             (T)0
         };
     }
 
-    PINLINE static Vec3<T> Down() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> Down() {
+        return Vec3<T> {
             (T)0,
             (T)-1,
             (T)0
         };
     }
 
-    PINLINE static Vec3<T> Left() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> Left() {
+        return Vec3<T> {
             (T)-1,
             (T)0,
             (T)0
         };
     }
 
-    PINLINE static Vec3<T> Right() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> Right() {
+        return Vec3<T> {
             (T)1,
             (T)0,
             (T)0
         };
     }
 
-    PINLINE static Vec3<T> Forward() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> Forward() {
+        return Vec3<T> {
             (T)0,
             (T)0,
             (T)-1
         };
     }
 
-    PINLINE static Vec3<T> Backward() {
-        return (Vec3<T>) {
+    constexpr static Vec3<T> Backward() {
+        return Vec3<T> {
             (T)0,
             (T)0,
             (T)1
-        }
+        };
     }
     
-    PINLINE static bool Compare(const Vec3<T> &v1, const Vec3<T>& v2, float tolerance) {
+    constexpr static bool Compare(const Vec3<T> &v1, const Vec3<T>& v2, float tolerance) {
         if (qabs(v1.x - v2.x) > tolerance) {
             return false;
         }
@@ -143,8 +143,8 @@ struct Vec3 {
         return true;
     }
 
-    PINLINE static float Distance(const Vec3<T> &v1, const Vec3<T>& v2) {
-        Vec3<T> t = (Vec3<T>) {
+    constexpr static float Distance(const Vec3<T> &v1, const Vec3<T>& v2) {
+        Vec3<T> t = Vec3<T> {
             v1.x - v2.x,
             v1.y - v2.y,
             v1.z - v2.z
@@ -152,7 +152,7 @@ struct Vec3 {
         return t.length();
     }
 
-    PINLINE static T Dot(const Vec3<T>& v1, const Vec3<T>& v2) {
+    constexpr static T Dot(const Vec3<T>& v1, const Vec3<T>& v2) {
         T p = (T)0;
         p += v1.x * v2.x;
         p += v1.y * v2.y;
@@ -166,8 +166,8 @@ struct Vec3 {
 // Operator Overloads
 // Addition
 template <typename T>
-const Vec3<T> operator+ (const Vec3<T>& v1, const Vec3<T>& v2) {
-    return (Vec3<T>) {
+constexpr const Vec3<T> operator+ (const Vec3<T>& v1, const Vec3<T>& v2) {
+    return Vec3<T> {
         v1.x + v2.x,
         v1.y + v2.y,
         v1.z + v2.z
@@ -175,7 +175,7 @@ const Vec3<T> operator+ (const Vec3<T>& v1, const Vec3<T>& v2) {
 }
 
 template <typename T>
-const Vec3<T> operator+= (Vec3<T>& v1, const Vec3<T>& v2) {
+constexpr const Vec3<T> operator+= (Vec3<T>& v1, const Vec3<T>& v2) {
     v1.x += v2.x;
     v1.y += v2.y;
     v1.z += v2.z;
@@ -184,8 +184,8 @@ const Vec3<T> operator+= (Vec3<T>& v1, const Vec3<T>& v2) {
 
 // Subtraction
 template <typename T>
-const Vec3<T> operator- (const Vec3<T>& v1, const Vec3<T>& v2) {
-    return (Vec3<T>) {
+constexpr const Vec3<T> operator- (const Vec3<T>& v1, const Vec3<T>& v2) {
+    return Vec3<T> {
         v1.x - v2.x,
         v1.y - v2.y,
         v1.z - v2.z
@@ -193,7 +193,7 @@ const Vec3<T> operator- (const Vec3<T>& v1, const Vec3<T>& v2) {
 }
 
 template <typename T>
-const Vec3<T> operator-= (Vec3<T>& v1, const Vec3<T>& v2) {
+constexpr const Vec3<T> operator-= (Vec3<T>& v1, const Vec3<T>& v2) {
     v1.x -= v2.x;
     v1.y -= v2.y;
     v1.z -= v2.z;
@@ -202,8 +202,8 @@ const Vec3<T> operator-= (Vec3<T>& v1, const Vec3<T>& v2) {
 
 // Division 
 template <typename T>
-const Vec3<T> operator/ (const Vec3<T>& v1, const Vec3<T>& v2) {
-    return (Vec3<T>) {
+constexpr const Vec3<T> operator/ (const Vec3<T>& v1, const Vec3<T>& v2) {
+    return Vec3<T> {
         v1.x / v2.x,
         v1.y / v2.y,
         v1.z / v2.z
@@ -211,8 +211,8 @@ const Vec3<T> operator/ (const Vec3<T>& v1, const Vec3<T>& v2) {
 }
 
 template <typename T>
-const Vec3<T> operator/ (const Vec3<T>& v1, const float scalar) {
-    return (Vec3<T>) {
+constexpr const Vec3<T> operator/ (const Vec3<T>& v1, const float scalar) {
+    return Vec3<T> {
         v1.x / scalar,
         v1.y / scalar,
         v1.z / scalar
@@ -220,7 +220,7 @@ const Vec3<T> operator/ (const Vec3<T>& v1, const float scalar) {
 }
 
 template <typename T>
-const Vec3<T> operator/= (Vec3<T>& v1, const Vec3<T>& v2) {
+constexpr const Vec3<T> operator/= (Vec3<T>& v1, const Vec3<T>& v2) {
     v1.x /= v2.x;
     v1.y /= v2.y;
     v1.z /= v2.z;
@@ -229,8 +229,8 @@ const Vec3<T> operator/= (Vec3<T>& v1, const Vec3<T>& v2) {
 
 // Multiplication 
 template <typename T>
-const Vec3<T> operator* (const Vec3<T>& v1, const Vec3<T>& v2) {
-    return (Vec3<T>) {
+constexpr const Vec3<T> operator* (const Vec3<T>& v1, const Vec3<T>& v2) {
+    return Vec3<T> {
         v1.x * v2.x,
         v1.y * v2.y,
         v1.z * v2.z
@@ -238,8 +238,8 @@ const Vec3<T> operator* (const Vec3<T>& v1, const Vec3<T>& v2) {
 }
 
 template <typename T>
-const Vec3<T> operator* (const Vec3<T>& v1, const float scalar) {
-    return (Vec3<T>) {
+constexpr const Vec3<T> operator* (const Vec3<T>& v1, const float scalar) {
+    return Vec3<T> {
         v1.x * scalar,
         v1.y * scalar,
         v1.z * scalar
@@ -247,7 +247,7 @@ const Vec3<T> operator* (const Vec3<T>& v1, const float scalar) {
 }
 
 template <typename T>
-const Vec3<T> operator*= (Vec3<T>& v1, const Vec3<T>& v2) {
+constexpr const Vec3<T> operator*= (Vec3<T>& v1, const Vec3<T>& v2) {
     v1.x *= v2.x;
     v1.y *= v2.y;
     v1.z *= v2.z;
@@ -255,7 +255,7 @@ const Vec3<T> operator*= (Vec3<T>& v1, const Vec3<T>& v2) {
 }
 
 template <typename T>
-const Vec3<T> operator== (const Vec3<T>& v1, const Vec3<T>& v2) {
+constexpr bool operator== (const Vec3<T>& v1, const Vec3<T>& v2) {
     return (
         v1.x == v2.x &&
         v1.y == v2.y &&
@@ -264,7 +264,7 @@ const Vec3<T> operator== (const Vec3<T>& v1, const Vec3<T>& v2) {
 }
 
 template <typename T>
-const Vec3<T> operator!= (const Vec3<T>& v1, const Vec3<T>& v2) {
+constexpr bool operator!= (const Vec3<T>& v1, const Vec3<T>& v2) {
     return (
         v1.x != v2.x ||
         v1.y != v2.y ||
@@ -274,8 +274,8 @@ const Vec3<T> operator!= (const Vec3<T>& v1, const Vec3<T>& v2) {
 
 // Cross Product
 template <typename T>
-Vec3<T> operator% (const Vec3<T>& v1, const Vec3<T>& v2) {
-    return (Vec3<T>) {
+constexpr Vec3<T> operator% (const Vec3<T>& v1, const Vec3<T>& v2) {
+    return Vec3<T> {
         v1.y * v2.z - v1.z * v2.y,
         v1.z * v2.x - v1.x * v2.z,
         v1.x * v2.y - v1.y * v2.x
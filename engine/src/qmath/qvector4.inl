@@ -25,28 +25,28 @@ struct Vec4 {
     };
 
     // Methods
-    T length_squared(); 
+    constexpr T length_squared() const;
 
-    T length(); 
+    constexpr T length() const;
 
-    void normalize(); 
+    constexpr void normalize(); 
 
-    Vec4<T> normalized(); 
+    constexpr Vec4<T> normalized() const;
 
     // Static Members
-    static Vec4<T> New(T x, T y, T z, T w); 
+    constexpr static Vec4<T> New(T x, T y, T z, T w); 
 
-    static Vec4<T> Zero(); 
+    constexpr static Vec4<T> Zero(); 
 
-    static Vec4<T> One(); 
+    constexpr static Vec4<T> One(); 
     
-    static bool Compare(const Vec4<T> &v1, const Vec4<T>& v2, float tolerance); 
+    constexpr static bool Compare(const Vec4<T> &v1, const Vec4<T>& v2, float tolerance); 
 
-    static float Distance(const Vec4<T> &v1, const Vec4<T>& v2); //  {
+    constexpr static float Distance(const Vec4<T> &v1, const Vec4<T>& v2); //  {
 
-    Vec3<T> ToVec3(); 
+    constexpr Vec3<T> ToVec3() const;
 
-    T Dot(
+    constexpr T Dot(
         T a0, T a1, T a2, T a3,
         T b0, T b1, T b2, T b3
     ); 
@@ -57,8 +57,8 @@ struct Vec4 {
 // Operator Overloads
 // Addition
 template <typename T>
-const Vec4<T> operator+ (const Vec4<T>& v1, const Vec4<T>& v2) {
-    return (Vec4<T>) {
+constexpr const Vec4<T> operator+ (const Vec4<T>& v1, const Vec4<T>& v2) {
+    return Vec4<T> {
         v1.x + v2.x,
         v1.y + v2.y,
         v1.z + v2.z,
@@ -67,7 +67,7 @@ const Vec4<T> operator+ (const Vec4<T>& v1, const Vec4<T>& v2) {
 }
 
 template <typename T>
-const Vec4<T> operator+= (Vec4<T>& v1, const Vec4<T>& v2) {
+constexpr const Vec4<T> operator+= (Vec4<T>& v1, const Vec4<T>& v2) {
     v1.x += v2.x;
     v1.y += v2.y;
     v1.z += v2.z;
@@ -77,8 +77,8 @@ const Vec4<T> operator+= (Vec4<T>& v1, const Vec4<T>& v2) {
 
 // Subtraction
 template <typename T>
-const Vec4<T> operator- (const Vec4<T>& v1, const Vec4<T>& v2) {
-    return (Vec4<T>) {
+constexpr const Vec4<T> operator- (const Vec4<T>& v1, const Vec4<T>& v2) {
+    return Vec4<T> {
         v1.x - v2.x,
         v1.y - v2.y,
         v1.z - v2.z,
@@ -87,7 +87,7 @@ const Vec4<T> operator- (const Vec4<T>& v1, const Vec4<T>& v2) {
 }
 
 template <typename T>
-const Vec4<T> operator-= (Vec4<T>& v1, const Vec4<T>& v2) {
+constexpr const Vec4<T> operator-= (Vec4<T>& v1, const Vec4<T>& v2) {
     v1.x -= v2.x;
     v1.y -= v2.y;
     v1.z -= v2.z;
@@ -97,8 +97,8 @@ const Vec4<T> operator-= (Vec4<T>& v1, const Vec4<T>& v2) {
 
 // Division 
 template <typename T>
-const Vec4<T> operator/ (const Vec4<T>& v1, const Vec4<T>& v2) {
-    return (Vec4<T>) {
+constexpr const Vec4<T> operator/ (const Vec4<T>& v1, const Vec4<T>& v2) {
+    return Vec4<T> {
         v1.x / v2.x,
         v1.y / v2.y,
         v1.z / v2.z,
@@ -107,8 +107,8 @@ const Vec4<T> operator/ (const Vec4<T>& v1, const Vec4<T>& v2) {
 }
 
 template <typename T>
-const Vec4<T> operator/ (const Vec4<T>& v1, const float scalar) {
-    return (Vec4<T>) {
+constexpr const Vec4<T> operator/ (const Vec4<T>& v1, const float scalar) {
+    return Vec4<T> {
         v1.x / scalar,
         v1.y / scalar,
         v1.z / scalar,
@@ -117,7 +117,7 @@ const Vec4<T> operator/ (const Vec4<T>& v1, const float scalar) {
 }
 
 template <typename T>
-const Vec4<T> operator/= (Vec4<T>& v1, const Vec4<T>& v2) {
+constexpr const Vec4<T> operator/= (Vec4<T>& v1, const Vec4<T>& v2) {
     v1.x /= v2.x;
     v1.y /= v2.y;
     v1.z /= v2.z;
@@ -127,8 +127,8 @@ const Vec4<T> operator/= (Vec4<T>& v1, const Vec4<T>& v2) {
 
 // Multiplication 
 template <typename T>
-const Vec4<T> operator* (const Vec4<T>& v1, const Vec4<T>& v2) {
-    return (Vec4<T>) {
+constexpr const Vec4<T> operator* (const Vec4<T>& v1, const Vec4<T>& v2) {
+    return Vec4<T> {
         v1.x * v2.x,
         v1.y * v2.y,
         v1.z * v2.z,
@@ -137,8 +137,8 @@ const Vec4<T> operator* (const Vec4<T>& v1, const Vec4<T>& v2) {
 }
 
 template <typename T>
-const Vec4<T> operator* (const Vec4<T>& v1, const float scalar) {
-    return (Vec4<T>) {
+constexpr const Vec4<T> operator* (const Vec4<T>& v1, const float scalar) {
+    return Vec4<T> {
         v1.x * scalar,
         v1.y * scalar,
         v1.z * scalar,
@@ -147,7 +147,7 @@ const Vec4<T> operator* (const Vec4<T>& v1, const float scalar) {
 }
 
 template <typename T>
-const Vec4<T> operator*= (Vec4<T>& v1, const Vec4<T>& v2) {
+constexpr const Vec4<T> operator*= (Vec4<T>& v1, const Vec4<T>& v2) {
     v1.x *= v2.x;
     v1.y *= v2.y;
     v1.z *= v2.z;
@@ -156,7 +156,7 @@ const Vec4<T> operator*= (Vec4<T>& v1, const Vec4<T>& v2) {
 }
 
 template <typename T>
-const Vec4<T> operator== (const Vec4<T>& v1, const Vec4<T>& v2) {
+constexpr bool operator== (const Vec4<T>& v1, const Vec4<T>& v2) {
     return (
         v1.x == v2.x &&
         v1.y == v2.y &&
@@ -172,19 +172,19 @@ const Vec4<T> operator== (const Vec4<T>& v1, const Vec4<T>& v2) {
 //
 
 template <typename T>
-T 
-Vec4<T>::length_squared() {
+constexpr T 
+Vec4<T>::length_squared() const {
     return this->x * this->x + this->y * this->y + this->z * this->z + this->w * this->w;
 }
 
 template <typename T>
-T 
-Vec4<T>::length() {
+constexpr T 
+Vec4<T>::length() const {
     return qsqrt(this->x * this->x + this->y * this->y + this->z * this->z + this->w * this->w);
 }
 
 template <typename T>
-void 
+constexpr void 
 Vec4<T>::normalize() {
     const T length = this->length();
     this->x /= length;
@@ -194,19 +194,19 @@ Vec4<T>::normalize() {
 }
 
 template <typename T>
-Vec4<T> 
-Vec4<T>::normalized() {
+constexpr Vec4<T> 
+Vec4<T>::normalized() const {
     const T length = this->length();
-    return (Vec4<T>) {
-        v.x / length,
-        v.y / length,
-        v.z / length,
-        v.w / length
+    return Vec4<T> {
+        this->x / length,
+        this->y / length,
+        this->z / length,
+        this->w / length
     };
 }
 
 template <typename T>
-Vec4<T> 
+constexpr Vec4<T> 
 Vec4<T>::New(T x, T y, T z, T w) {
     Vec4<T> out_vec;
     out_vec.x = x;
@@ -217,7 +217,7 @@ Vec4<T>::New(T x, T y, T z, T w) {
 }
 
 template <typename T>
-Vec4<T>
+constexpr Vec4<T>
 Vec4<T>::Zero() {
     Vec4<T> out_vec;
     out_vec.x = (T)0;
@@ -228,9 +228,9 @@ Vec4<T>::Zero() {
 }
 
 template <typename T>
-Vec4<T>
+constexpr Vec4<T>
 Vec4<T>::One() {
-    return (Vec4<T>) {
+    return Vec4<T> {
         (T)1,
         (T)1,
         (T)1,
@@ -239,7 +239,7 @@ Vec4<T>::One() {
 }
 
 template <typename T> 
-bool
+constexpr bool
 Vec4<T>::Compare(const Vec4<T> &v1, const Vec4<T>& v2, float tolerance) {
     if (qabs(v1.x - v2.x) > tolerance) {
         return false;
@@ -257,9 +257,9 @@ Vec4<T>::Compare(const Vec4<T> &v1, const Vec4<T>& v2, float tolerance) {
 }
 
 template <typename T>
-float 
+constexpr float 
 Vec4<T>::Distance(const Vec4<T> &v1, const Vec4<T>& v2) {
-    Vec4<T> t = (Vec4<T>) {
+    Vec4<T> t = Vec4<T> {
         v1.x - v2.x,
         v1.y - v2.y,
         v1.z - v2.z,
@@ -269,15 +269,15 @@ Vec4<T>::Distance(const Vec4<T> &v1, const Vec4<T>& v2) {
 }
 
 template <typename T>
-Vec3<T> 
-Vec4<T>::ToVec3() {
+constexpr Vec3<T> 
+Vec4<T>::ToVec3() const {
     return Vec3<T> {
         x,y,z
     };
 }
 
 template <typename T>
-T 
+constexpr T 
 Vec4<T>::Dot(
     T a0, T a1, T a2, T a3,
     T b0, T b1, T b2, T b3
@@ -6,6 +6,7 @@
 #include <qmath/qmath.hh>
 #include "containers/qvector.inl"
 #include "resources/resource_types.hh"
+#include "memory/qlinear_allocator.hh"
 // Uniform Buffer Object
 struct UBO {
     alignas (16) glm::mat4 projectionView{1.f};
@@ -25,6 +26,10 @@ struct RenderPacket {
     UBO ubo;
     float time;
     float delta_time;
+
+    // Scratch memory for anything the renderer needs only for this frame.
+    // Owned by the application and reset two frames later, so never free from it
+    qmemory::QLinearAllocator* frame_allocator;
 };
 
 // Structure for a vertex in the model
@@ -97,7 +102,7 @@ class RendererBackend {
             int32_t width,
             int32_t height,
             int32_t channel_count,
-            Vector<uint8_t> pixels,
+            Vector<uint8_t>& pixels,
             texture& out_texture
         ) {}
 
@@ -11,7 +11,8 @@ bool
 renderer_backend_create(renderer_backend_type type, RendererBackend** backend) {
     switch (type) {
         case RENDERER_BACKEND_VULKAN: {
-            *backend = new (QAllocator::Allocate(1, sizeof(VulkanBackend), MEMORY_TAG_RENDERER)) VulkanBackend;
+            *backend = new (QAllocator::AllocateZeroed(1, sizeof(VulkanBackend), MEMORY_TAG_RENDERER)) VulkanBackend;
+            (*backend)->type = RENDERER_BACKEND_VULKAN;
             // *backend = new VulkanBackend();
             qlogger::Debug("Vulkan Backend Selected");
             return true;
@@ -27,5 +28,20 @@ renderer_backend_create(renderer_backend_type type, RendererBackend** backend) {
 
 void
 renderer_backend_destroy(RendererBackend* backend) {
+    if (!backend) {
+        return;
+    }
 
+    switch (backend->type) {
+        case RENDERER_BACKEND_VULKAN: {
+            // Memory came from QAllocator, so destroy in place instead of using delete
+            VulkanBackend* vulkan_backend = static_cast<VulkanBackend*>(backend);
+            vulkan_backend->~VulkanBackend();
+            QAllocator::Free(vulkan_backend, sizeof(VulkanBackend), MEMORY_TAG_RENDERER);
+        } break;
+        case RENDERER_BACKEND_OPENGL:
+        case RENDERER_BACKEND_DIRECTX:
+        case RENDERER_BACKEND_METAL:
+            break;
+    }
 }
\ No newline at end of file
@@ -53,7 +53,8 @@ void
 Renderer::Shutdown() {    
     // vkrenderer.OnDestroy();
     backend->Shutdown();
-    delete backend;    
+    renderer_backend_destroy(backend);
+    backend = nullptr;
 }
 
 void 
@@ -73,10 +74,10 @@ Renderer::OnResize(uint16_t width, uint16_t height) {
 }
 
 bool
-Renderer::CreateModel(Pegasus::GameObject& obj) {
+Renderer::CreateModel(const Vertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count) {
     // Builder model_builder = {
-    //     obj.vertices,
-    //     obj.indices
+    //     vertices, vertex_count,
+    //     indices, index_count
     // };
     // vkrenderer.AddModel(model_builder);
     return true;
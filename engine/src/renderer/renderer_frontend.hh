@@ -23,7 +23,7 @@ class QAPI Renderer {
 public:
   static bool Initialize(std::string name, std::string asset_path, uint32_t width, uint32_t height, RendererSettings settings);
   static void Shutdown();
-  static bool CreateModel(Pegasus::GameObject& obj);
+  static bool CreateModel(const Vertex* vertices, uint32_t vertex_count, const uint32_t* indices, uint32_t index_count);
 
   static void OnResize(uint16_t width, uint16_t height);
   static bool DrawFrame(RenderPacket packet);
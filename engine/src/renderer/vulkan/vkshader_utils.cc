@@ -19,25 +19,20 @@ bool create_shader_module(
     QAllocator::Zero(&shader_stages[stage_index].create_info, sizeof(VkShaderModuleCreateInfo));
     shader_stages[stage_index].create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 
-    QFilesystem::QFile file;
-    if (!file.open(file_name, QFilesystem::FILE_MODE_READ, true)) {
+    // Map the .spv bytecode, vkCreateShaderModule copies it out of the page cache
+    QFilesystem::QMappedFile file;
+    if (!file.map(file_name, QFilesystem::FILE_ACCESS_SEQUENTIAL | QFilesystem::FILE_ACCESS_WILL_NEED)) {
         qlogger::Error("Unable to read shader module: %s", file_name);
         return false;
     }
-
-    // Read the .spv bytecode file as binary
-    uint64_t size = 0;
-    uint8_t* file_buffer = 0;
-    if (!file.read_all_bytes(&file_buffer, size)) {
-        qlogger::Error("Unable to read binary shader module: %s", file_name);
+    if (file.size == 0) {
+        qlogger::Error("Shader module is empty: %s", file_name);
         return false;
     }
 
-    shader_stages[stage_index].create_info.codeSize = size;
-    // shader_stages[stage_index].create_info.pCode = reinterpret_cast<uint32_t*>(file_buffer);
-    shader_stages[stage_index].create_info.pCode = (uint32_t*)(file_buffer);
-
-    file.close();
+    shader_stages[stage_index].create_info.codeSize = file.size;
+    // Mappings are page aligned, so this is aligned as SPIR-V needs
+    shader_stages[stage_index].create_info.pCode = reinterpret_cast<const uint32_t*>(file.data);
 
     VK_CHECK(vkCreateShaderModule(
         context.device.logical_device,
@@ -52,12 +47,5 @@ bool create_shader_module(
     shader_stages[stage_index].shader_stage_create_info.module = shader_stages[stage_index].handle;
     shader_stages[stage_index].shader_stage_create_info.pName = "main";
 
-    if (file_buffer) {
-        QAllocator::Free(file_buffer, sizeof(uint8_t) * size, MEMORY_TAG_STRING);
-        file_buffer = nullptr;
-    }
-
-
-
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,217 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/*
+ *  LZ4 block format
+ *
+ *  A small compressor and a bounds checked decompressor for the LZ4 block format, so packed assets
+ *  can be compressed without pulling in a library. Blocks are compatible with the reference LZ4
+ *  (LZ4_decompress_safe reads what compress writes, and the other way around).
+ *
+ *  The compressor is a single pass greedy match finder, closer to LZ4 level 1 than to LZ4HC.
+ *  Decompression is the part that runs at load time, and that is the same speed either way.
+ *
+ *  Only depends on the standard library, the packer tool uses it too.
+ */
+
+namespace qlz4 {
+    static constexpr uint32_t MIN_MATCH = 4;
+    // The last match has to start this far before the end of the input
+    static constexpr uint32_t MATCH_FIND_LIMIT = 12;
+    // And the last bytes are always literals
+    static constexpr uint32_t LAST_LITERALS = 5;
+    static constexpr uint32_t MAX_OFFSET = 65535;
+    static constexpr uint32_t HASH_BITS = 12;
+
+    // Largest output compress can produce for size bytes of input
+    inline uint64_t
+    compress_bound(uint64_t size) {
+        return size + size / 255 + 16;
+    }
+
+    inline uint32_t
+    read32(const uint8_t* p) {
+        uint32_t value;
+        memcpy(&value, p, 4);
+        return value;
+    }
+
+    // Write a length that did not fit in its 4 bits of the token
+    inline bool
+    write_length(uint8_t*& op, const uint8_t* end, uint64_t length) {
+        while (length >= 255) {
+            if (op >= end) {
+                return false;
+            }
+            *op++ = 255;
+            length -= 255;
+        }
+        if (op >= end) {
+            return false;
+        }
+        *op++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    // One sequence: literals, then a match at offset unless this is the last one
+    inline bool
+    write_sequence(uint8_t*& op, const uint8_t* end, const uint8_t* literals, uint64_t literal_length,
+                   uint32_t offset, uint64_t match_length, bool last) {
+        if (op >= end) {
+            return false;
+        }
+        uint8_t* token = op++;
+        *token = static_cast<uint8_t>((literal_length >= 15 ? 15 : literal_length) << 4);
+        if (literal_length >= 15 && !write_length(op, end, literal_length - 15)) {
+            return false;
+        }
+        if (static_cast<uint64_t>(end - op) < literal_length) {
+            return false;
+        }
+        memcpy(op, literals, literal_length);
+        op += literal_length;
+        if (last) {
+            return true;
+        }
+
+        if (end - op < 2) {
+            return false;
+        }
+        *op++ = static_cast<uint8_t>(offset & 0xFF);
+        *op++ = static_cast<uint8_t>(offset >> 8);
+        const uint64_t extra = match_length - MIN_MATCH;
+        *token |= static_cast<uint8_t>(extra >= 15 ? 15 : extra);
+        if (extra >= 15 && !write_length(op, end, extra - 15)) {
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Compress size bytes into out
+     * @return compressed size, or 0 if it does not fit in capacity. Size compress_bound(size) always fits
+    */
+    inline uint64_t
+    compress(const void* data, uint64_t size, void* out, uint64_t capacity) {
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        uint8_t* op = static_cast<uint8_t*>(out);
+        const uint8_t* end = op + capacity;
+
+        uint64_t anchor = 0;
+        if (size > MATCH_FIND_LIMIT) {
+            // Last position seen for each hash of 4 bytes, plus one so zero means empty
+            uint32_t table[1u << HASH_BITS] = {};
+            const uint64_t match_limit = size - MATCH_FIND_LIMIT;
+            const uint64_t extend_limit = size - LAST_LITERALS;
+
+            uint64_t ip = 0;
+            while (ip < match_limit) {
+                const uint32_t sequence = read32(source + ip);
+                const uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+                const uint64_t candidate = table[hash];
+                table[hash] = static_cast<uint32_t>(ip + 1);
+
+                if (candidate == 0 || ip - (candidate - 1) > MAX_OFFSET || read32(source + candidate - 1) != sequence) {
+                    ip++;
+                    continue;
+                }
+
+                const uint64_t match = candidate - 1;
+                uint64_t length = MIN_MATCH;
+                while (ip + length < extend_limit && source[match + length] == source[ip + length]) {
+                    length++;
+                }
+
+                if (!write_sequence(op, end, source + anchor, ip - anchor, static_cast<uint32_t>(ip - match), length, false)) {
+                    return 0;
+                }
+                ip += length;
+                anchor = ip;
+            }
+        }
+
+        if (!write_sequence(op, end, source + anchor, size - anchor, 0, 0, true)) {
+            return 0;
+        }
+        return static_cast<uint64_t>(op - static_cast<uint8_t*>(out));
+    }
+
+    /**
+     * @brief Decompress a block that expands to exactly size bytes
+     * @return false if the block is malformed or does not expand to size bytes. Never reads or writes out of bounds
+    */
+    inline bool
+    decompress(const void* data, uint64_t compressed_size, void* out, uint64_t size) {
+        const uint8_t* ip = static_cast<const uint8_t*>(data);
+        const uint8_t* const input_end = ip + compressed_size;
+        uint8_t* op = static_cast<uint8_t*>(out);
+        uint8_t* const output = op;
+        uint8_t* const output_end = op + size;
+
+        while (ip < input_end) {
+            const uint8_t token = *ip++;
+
+            uint64_t literal_length = token >> 4;
+            if (literal_length == 15) {
+                uint8_t byte;
+                do {
+                    if (ip >= input_end) {
+                        return false;
+                    }
+                    byte = *ip++;
+                    literal_length += byte;
+                } while (byte == 255);
+            }
+            if (static_cast<uint64_t>(input_end - ip) < literal_length || static_cast<uint64_t>(output_end - op) < literal_length) {
+                return false;
+            }
+            memcpy(op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+
+            // The last sequence has no match
+            if (ip == input_end) {
+                break;
+            }
+
+            if (input_end - ip < 2) {
+                return false;
+            }
+            const uint64_t offset = ip[0] | (static_cast<uint64_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<uint64_t>(op - output)) {
+                return false;
+            }
+
+            uint64_t match_length = token & 15;
+            if (match_length == 15) {
+                uint8_t byte;
+                do {
+                    if (ip >= input_end) {
+                        return false;
+                    }
+                    byte = *ip++;
+                    match_length += byte;
+                } while (byte == 255);
+            }
+            match_length += MIN_MATCH;
+            if (static_cast<uint64_t>(output_end - op) < match_length) {
+                return false;
+            }
+
+            // Matches may overlap the bytes they produce, so copy forwards one at a time when they do
+            const uint8_t* match = op - offset;
+            if (offset >= match_length) {
+                memcpy(op, match, match_length);
+                op += match_length;
+            } else {
+                for (uint64_t i = 0; i < match_length; i++) {
+                    *op++ = *match++;
+                }
+            }
+        }
+
+        return op == output_end;
+    }
+} // qlz4
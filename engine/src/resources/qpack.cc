@@ -0,0 +1,151 @@
+#include "qpack.hh"
+#include "core/qlogger.hh"
+#include "core/qmemory.hh"
+
+#include <cstring>
+
+// Null terminated copy of an entry's name for log messages
+static const char*
+entry_name(const QPack* pack, const qpack::pack_entry* entry, char* buffer, uint32_t capacity) {
+    uint32_t length = entry->name_length < capacity - 1 ? entry->name_length : capacity - 1;
+    QAllocator::Copy(buffer, pack->names + entry->name_offset, length);
+    buffer[length] = '\0';
+    return buffer;
+}
+
+QPack::QPack()
+    : header(nullptr), entries(nullptr), names(nullptr) {}
+
+bool 
+QPack::open(const char* path) {
+    close();
+
+    // Lookups jump around the index, and entries are read in whatever order assets are needed
+    if (!file.map(path, QFilesystem::FILE_ACCESS_RANDOM)) {
+        qlogger::Error("Unable to open pack %s", path);
+        return false;
+    }
+
+    if (file.size < sizeof(qpack::pack_header)) {
+        qlogger::Error("%s is too small to be a pack", path);
+        close();
+        return false;
+    }
+
+    const qpack::pack_header* pack_header = reinterpret_cast<const qpack::pack_header*>(file.data);
+    if (pack_header->magic != qpack::FILE_MAGIC || pack_header->version != qpack::FILE_VERSION) {
+        qlogger::Error("%s is not a version %u pack", path, qpack::FILE_VERSION);
+        close();
+        return false;
+    }
+
+    const uint64_t index_end = sizeof(qpack::pack_header) + static_cast<uint64_t>(pack_header->entry_count) * sizeof(qpack::pack_entry);
+    if (pack_header->file_size != file.size || pack_header->names_offset != index_end ||
+        pack_header->names_offset + pack_header->names_size > file.size) {
+        qlogger::Error("Pack %s is truncated or its header is corrupt", path);
+        close();
+        return false;
+    }
+
+    // Check every entry once here, so lookups and reads can trust the index
+    const qpack::pack_entry* pack_entries = reinterpret_cast<const qpack::pack_entry*>(file.data + sizeof(qpack::pack_header));
+    for (uint32_t i = 0; i < pack_header->entry_count; i++) {
+        const qpack::pack_entry& entry = pack_entries[i];
+        const bool bad_name = static_cast<uint64_t>(entry.name_offset) + entry.name_length > pack_header->names_size;
+        const bool bad_data = entry.offset > file.size || entry.stored_size > file.size - entry.offset;
+        const bool bad_compression = entry.compression > qpack::COMPRESSION_LZ4 ||
+            (entry.compression == qpack::COMPRESSION_NONE && entry.stored_size != entry.size);
+        if (bad_name || bad_data || bad_compression) {
+            qlogger::Error("Pack %s has a corrupt index entry %u", path, i);
+            close();
+            return false;
+        }
+    }
+
+    header = pack_header;
+    entries = pack_entries;
+    names = reinterpret_cast<const char*>(file.data + pack_header->names_offset);
+
+    // The index is what every lookup touches, get it in now
+    file.advise(0, pack_header->names_offset + pack_header->names_size, QFilesystem::FILE_ACCESS_WILL_NEED);
+    return true;
+}
+
+void 
+QPack::close() {
+    file.unmap();
+    header = nullptr;
+    entries = nullptr;
+    names = nullptr;
+}
+
+uint32_t 
+QPack::count() const {
+    return header ? header->entry_count : 0;
+}
+
+const qpack::pack_entry* 
+QPack::find(const char* name) const {
+    if (!header) {
+        return nullptr;
+    }
+
+    const uint32_t length = static_cast<uint32_t>(strlen(name));
+    const uint64_t hash = qpack::name_hash(name, length);
+
+    uint32_t low = 0;
+    uint32_t high = header->entry_count;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        int32_t order = qpack::compare(hash, name, length, entries[middle], names);
+        if (order == 0) {
+            return &entries[middle];
+        }
+        if (order < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return nullptr;
+}
+
+const uint8_t* 
+QPack::view(const qpack::pack_entry* entry) const {
+    if (!entry || entry->compression != qpack::COMPRESSION_NONE) {
+        return nullptr;
+    }
+    return file.data + entry->offset;
+}
+
+bool 
+QPack::read(const qpack::pack_entry* entry, void* out) const {
+    if (!header || !entry) {
+        return false;
+    }
+
+    const uint8_t* stored = file.data + entry->offset;
+    if (entry->compression == qpack::COMPRESSION_LZ4) {
+        if (!qlz4::decompress(stored, entry->stored_size, out, entry->size)) {
+            char name[256];
+            qlogger::Error("Pack entry %s failed to decompress", entry_name(this, entry, name, sizeof(name)));
+            return false;
+        }
+    } else {
+        QAllocator::Copy(out, stored, entry->size);
+    }
+
+    if (qpack::content_hash(out, entry->size) != entry->content_hash) {
+        char name[256];
+        qlogger::Error("Pack entry %s does not match its content hash", entry_name(this, entry, name, sizeof(name)));
+        return false;
+    }
+    return true;
+}
+
+void 
+QPack::prefetch(const qpack::pack_entry* entry) {
+    if (entry) {
+        file.advise(entry->offset, entry->stored_size, QFilesystem::FILE_ACCESS_WILL_NEED);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "defines.hh"
+#include "platform/file_system.hh"
+#include "resources/qpack_format.hh"
+#include <cstdint>
+
+/**
+ * Read side of an asset pack, see resources/qpack_format.hh. The pack is memory mapped once, entries are
+ * found by binary search over the index, and uncompressed entries can be used in place with no copy
+*/
+struct QAPI QPack {
+    QFilesystem::QMappedFile file;
+    const qpack::pack_header* header;
+    const qpack::pack_entry* entries;
+    const char* names;
+
+    QPack();
+
+    /**
+     * Map the pack and check its index
+     * @returns false if it cannot be opened or is not a valid pack
+    */
+    bool open(const char* path);
+    void close();
+
+    uint32_t count() const;
+
+    // nullptr if the pack has no entry with this name
+    const qpack::pack_entry* find(const char* name) const;
+
+    // Bytes of an uncompressed entry straight from the mapping. nullptr for compressed entries, use read
+    const uint8_t* view(const qpack::pack_entry* entry) const;
+
+    /**
+     * Copy or decompress an entry into out, which holds at least entry->size bytes, and check its content hash
+     * @returns false if the data is corrupt
+    */
+    bool read(const qpack::pack_entry* entry, void* out) const;
+
+    // Start paging an entry in before it is needed
+    void prefetch(const qpack::pack_entry* entry);
+};
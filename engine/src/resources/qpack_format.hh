@@ -0,0 +1,178 @@
+#pragma once
+#include "containers/qhash.hh"
+#include "resources/qlz4.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ *  Asset pack format
+ *
+ *  Many asset files stored in one archive, so loading does one open and one map instead of an open
+ *  and a stat per file. File layout, all values little endian:
+ *
+ *      pack_header
+ *      pack_entry[entry_count]   sorted by name hash, then name
+ *      names                     every entry's name, not null terminated
+ *      data                      each entry starts on a multiple of alignment
+ *
+ *  Entries are stored raw or as one LZ4 block (see resources/qlz4.hh), whichever is smaller.
+ *  content_hash is qhash_bytes of the original bytes, so corruption and stale packs can be caught.
+ *  Names are paths relative to the packed directory with '/' separators, e.g. "shaders/Builtin.ObjectShader.vert.spv"
+ *
+ *  This header is shared by the engine and the packer tool, so it only depends on the standard library
+ *  and other headers like it.
+ */
+
+namespace qpack {
+    static constexpr uint32_t FILE_MAGIC = 0x4B415051; // "QPAK"
+    static constexpr uint32_t FILE_VERSION = 1;
+    static constexpr uint32_t DEFAULT_ALIGNMENT = 16;
+
+    enum compression : uint32_t {
+        COMPRESSION_NONE = 0,
+        COMPRESSION_LZ4 = 1,
+    };
+
+    struct pack_header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t alignment;
+        uint64_t names_offset;
+        uint64_t names_size;
+        uint64_t data_offset;
+        uint64_t file_size;
+    };
+    static_assert(sizeof(pack_header) == 48, "pack_header is part of the file format");
+
+    struct pack_entry {
+        uint64_t name_hash;
+        uint32_t name_offset;  // from names_offset
+        uint32_t name_length;
+        uint64_t offset;       // from the start of the file
+        uint64_t stored_size;  // bytes in the pack
+        uint64_t size;         // bytes once decompressed
+        uint64_t content_hash;
+        uint32_t compression;
+        uint32_t reserved;
+    };
+    static_assert(sizeof(pack_entry) == 56, "pack_entry is part of the file format");
+
+    inline uint64_t
+    name_hash(const char* name, uint64_t length) {
+        return qhash_bytes(name, length);
+    }
+
+    inline uint64_t
+    content_hash(const void* data, uint64_t size) {
+        return qhash_bytes(data, size, FILE_MAGIC);
+    }
+
+    // Index order: by hash, and by name when hashes collide
+    inline int32_t
+    compare(uint64_t hash, const char* name, uint32_t length, const pack_entry& entry, const char* names) {
+        if (hash != entry.name_hash) {
+            return hash < entry.name_hash ? -1 : 1;
+        }
+        const uint32_t shorter = length < entry.name_length ? length : entry.name_length;
+        int32_t result = memcmp(name, names + entry.name_offset, shorter);
+        if (result != 0) {
+            return result;
+        }
+        if (length != entry.name_length) {
+            return length < entry.name_length ? -1 : 1;
+        }
+        return 0;
+    }
+
+    // A file to be packed
+    struct source_file {
+        std::string name;
+        std::vector<uint8_t> data;
+    };
+
+    /**
+     * @brief Build a pack from files. Used by the packer tool, and by tests
+     * @param alignment power of two every entry's data starts on
+     * @param compress try LZ4 on every entry, keeping it only when it is smaller
+     * @return false if alignment is not a power of two or two files share a name
+    */
+    inline bool
+    build(const std::vector<source_file>& files, uint32_t alignment, bool compress, std::vector<uint8_t>& out) {
+        if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+            return false;
+        }
+
+        std::vector<pack_entry> entries(files.size());
+        std::string names;
+        for (uint64_t i = 0; i < files.size(); i++) {
+            pack_entry& entry = entries[i];
+            entry = {};
+            entry.name_hash = name_hash(files[i].name.data(), files[i].name.size());
+            entry.name_offset = static_cast<uint32_t>(names.size());
+            entry.name_length = static_cast<uint32_t>(files[i].name.size());
+            entry.size = files[i].data.size();
+            entry.content_hash = content_hash(files[i].data.data(), files[i].data.size());
+            // Remember which file this is until the data is laid out
+            entry.reserved = static_cast<uint32_t>(i);
+            names += files[i].name;
+        }
+
+        std::sort(entries.begin(), entries.end(), [&](const pack_entry& a, const pack_entry& b) {
+            return compare(a.name_hash, names.data() + a.name_offset, a.name_length, b, names.data()) < 0;
+        });
+        for (uint64_t i = 1; i < entries.size(); i++) {
+            if (compare(entries[i].name_hash, names.data() + entries[i].name_offset, entries[i].name_length, entries[i - 1], names.data()) == 0) {
+                return false;
+            }
+        }
+
+        auto align = [alignment](uint64_t value) { return (value + alignment - 1) & ~static_cast<uint64_t>(alignment - 1); };
+
+        pack_header header = {};
+        header.magic = FILE_MAGIC;
+        header.version = FILE_VERSION;
+        header.entry_count = static_cast<uint32_t>(entries.size());
+        header.alignment = alignment;
+        header.names_offset = sizeof(pack_header) + entries.size() * sizeof(pack_entry);
+        header.names_size = names.size();
+        header.data_offset = align(header.names_offset + names.size());
+
+        out.assign(header.data_offset, 0);
+        std::vector<uint8_t> compressed;
+        for (pack_entry& entry : entries) {
+            const source_file& file = files[entry.reserved];
+            entry.reserved = 0;
+
+            const uint8_t* stored = file.data.data();
+            entry.stored_size = file.data.size();
+            entry.compression = COMPRESSION_NONE;
+            if (compress && !file.data.empty()) {
+                compressed.resize(qlz4::compress_bound(file.data.size()));
+                uint64_t compressed_size = qlz4::compress(file.data.data(), file.data.size(), compressed.data(), compressed.size());
+                if (compressed_size > 0 && compressed_size < file.data.size()) {
+                    stored = compressed.data();
+                    entry.stored_size = compressed_size;
+                    entry.compression = COMPRESSION_LZ4;
+                }
+            }
+
+            entry.offset = align(out.size());
+            out.resize(entry.offset, 0);
+            out.insert(out.end(), stored, stored + entry.stored_size);
+        }
+        header.file_size = out.size();
+
+        memcpy(out.data(), &header, sizeof(header));
+        if (!entries.empty()) {
+            memcpy(out.data() + sizeof(header), entries.data(), entries.size() * sizeof(pack_entry));
+        }
+        if (!names.empty()) {
+            memcpy(out.data() + header.names_offset, names.data(), names.size());
+        }
+        return true;
+    }
+} // qpack
@@ -5,8 +5,8 @@ mkdir -p ../bin
 ccFilenames=$(find . -type f -name "*.cc")
 
 assembly="tests"
-cFlags="-g -fdeclspec -fPIC -std=c++17"
-ldflags="-L../bin/ -lengine -Wl,-rpath,."
+cFlags="-g -fdeclspec -fPIC -std=c++20"
+ldflags="-L../bin/ -lengine -pthread -Wl,-rpath,."
 Includes="-Isrc -I../engine/src/"
 defines="-DP_DEBUG -DQIMPORT"
 
@@ -0,0 +1,106 @@
+#include "dynamic_allocator_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <memory/qdynamic_allocator.hh>
+#include <core/qmemory.hh>
+#include <core/qlogger.hh>
+#include <chrono>
+#include <cstdlib>
+
+// Random alloc/free churn over a fixed set of live slots. Sizes are biased towards small
+// blocks with the occasional large one, roughly what resource loading looks like
+static constexpr uint32_t bench_slot_count = 4096;
+static constexpr uint32_t bench_operations = 2000000;
+static constexpr uint64_t bench_pool_size = 64 * 1024 * 1024;
+
+struct bench_rng {
+    uint64_t state;
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state);
+    }
+};
+
+static uint64_t
+bench_size(bench_rng& rng) {
+    uint32_t r = rng.next();
+    if ((r & 0xF) == 0) {
+        return 4096 + (r >> 4) % (60 * 1024);
+    }
+    return 16 + (r >> 4) % 1024;
+}
+
+template <typename AllocFn, typename FreeFn>
+static double
+run_churn(AllocFn alloc, FreeFn free_block, uint64_t& failed) {
+    void** slots = static_cast<void**>(QAllocator::AllocateZeroed(bench_slot_count, sizeof(void*), MEMORY_TAG_APPLICATION));
+    bench_rng rng { 0x9E3779B97F4A7C15ull };
+    failed = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < bench_operations; i++) {
+        uint32_t slot = rng.next() % bench_slot_count;
+        if (slots[slot]) {
+            free_block(slots[slot]);
+            slots[slot] = nullptr;
+        } else {
+            slots[slot] = alloc(bench_size(rng));
+            if (!slots[slot]) {
+                failed++;
+            } else {
+                // Touch the block so both allocators pay for the memory they hand out
+                static_cast<uint8_t*>(slots[slot])[0] = 1;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < bench_slot_count; i++) {
+        if (slots[i]) {
+            free_block(slots[i]);
+        }
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+
+    QAllocator::Free(slots, bench_slot_count * sizeof(void*), MEMORY_TAG_APPLICATION);
+    return std::chrono::duration<double, std::nano>(finish - start).count() / bench_operations;
+}
+
+uint8_t dynamic_allocator_benchmark_churn() {
+    qmemory::QDynamicAllocator allocator;
+    uint64_t memory_requirement = 0;
+    allocator.Create(bench_pool_size, memory_requirement, nullptr);
+    void* memory = QAllocator::Allocate(1, memory_requirement, MEMORY_TAG_APPLICATION);
+    allocator.Create(bench_pool_size, memory_requirement, memory);
+
+    uint64_t tlsf_failed = 0;
+    double tlsf_ns = run_churn(
+        [&](uint64_t size) { return allocator.Allocate(size); },
+        [&](void* block) { allocator.Free(block); },
+        tlsf_failed);
+
+    uint64_t malloc_failed = 0;
+    double malloc_ns = run_churn(
+        [](uint64_t size) { return malloc(size); },
+        [](void* block) { free(block); },
+        malloc_failed);
+
+    qlogger::Info("Bench: dynamic allocator churn: %.2f ns/op (%llu failed)", tlsf_ns, tlsf_failed);
+    qlogger::Info("Bench: malloc churn:            %.2f ns/op (%llu failed)", malloc_ns, malloc_failed);
+
+    // Everything was returned, so the pool must have coalesced back into one block
+    expect_should_be(bench_pool_size, allocator.FreeSpace());
+    expect_should_be(0, tlsf_failed);
+
+    allocator.Destroy();
+    QAllocator::Free(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+void
+dynamic_allocator_register_benchmarks(TestManager& manager) {
+    manager.Register(dynamic_allocator_benchmark_churn, "dynamic allocator vs malloc random churn");
+}
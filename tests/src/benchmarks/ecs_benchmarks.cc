@@ -0,0 +1,127 @@
+#include "ecs_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <engine/ecs.hh>
+#include <engine/components.hh>
+#include <core/qjobs.hh>
+#include <core/qlogger.hh>
+#include <chrono>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace Pegasus;
+using namespace qmath;
+
+static constexpr uint32_t ecs_bench_entities = 50000;
+static constexpr uint32_t ecs_bench_rounds = 100;
+
+struct ecs_bench_velocity {
+    Vec3<float> value;
+};
+
+// What the engine had before the ECS: one heap object per thing, everything it owns inline,
+// mesh data behind its own allocations
+struct ecs_bench_object {
+    uint64_t id;
+    Vec3<float> color;
+    std::vector<Vec3<float>> vertices;
+    std::vector<uint32_t> indices;
+    Vec3<float> position;
+    Vec3<float> velocity;
+    Quaternion<float> rotation;
+    Vec3<float> scale;
+    Mat4<float> local_to_world;
+};
+
+// ns per entity for op(), which touches every entity once
+template <typename Op>
+static double
+time_entities(Op op) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t round = 0; round < ecs_bench_rounds; round++) {
+        op();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(finish - start).count() / (double(ecs_bench_rounds) * ecs_bench_entities);
+}
+
+static void
+report(const char* name, double objects_ns, double each_ns, double parallel_ns) {
+    qlogger::Info("ecs %-18s objects %6.2f ns, each %6.2f ns (%.2fx), parallel each %6.2f ns (%.2fx)",
+                  name, objects_ns, each_ns, objects_ns / each_ns, parallel_ns, objects_ns / parallel_ns);
+}
+
+uint8_t ecs_benchmark_update() {
+    std::vector<std::unique_ptr<ecs_bench_object>> objects;
+    objects.reserve(ecs_bench_entities);
+    World world;
+    for (uint32_t i = 0; i < ecs_bench_entities; i++) {
+        const float f = static_cast<float>(i);
+        const Vec3<float> position = { f, -f, 0.5f * f };
+        const Vec3<float> velocity = { 1.f, 0.5f, -0.25f };
+        const Quaternion<float> rotation = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 1.f, 0.f }, f * 0.001f, true);
+        const Vec3<float> scale = Vec3<float>::One();
+
+        std::unique_ptr<ecs_bench_object> object(new ecs_bench_object());
+        object->id = i;
+        object->vertices.resize(4);
+        object->indices = { 0, 1, 2, 2, 3, 0 };
+        object->position = position;
+        object->velocity = velocity;
+        object->rotation = rotation;
+        object->scale = scale;
+        objects.push_back(std::move(object));
+
+        world.Create(Position { position }, ecs_bench_velocity { velocity }, Rotation { rotation }, Scale { scale }, LocalToWorld {});
+    }
+    const float dt = 1.f / 60.f;
+    Query moving = world.CreateQuery(component_mask<Position, ecs_bench_velocity>());
+    Query transforms = TransformSystem::CreateQuery(world);
+
+    auto move = [dt](Entity, Position& position, const ecs_bench_velocity& velocity) {
+        position.value.x += velocity.value.x * dt;
+        position.value.y += velocity.value.y * dt;
+        position.value.z += velocity.value.z * dt;
+    };
+    const double objects_move = time_entities([&]() {
+        for (std::unique_ptr<ecs_bench_object>& object : objects) {
+            object->position.x += object->velocity.x * dt;
+            object->position.y += object->velocity.y * dt;
+            object->position.z += object->velocity.z * dt;
+        }
+    });
+    const double objects_transform = time_entities([&]() {
+        for (std::unique_ptr<ecs_bench_object>& object : objects) {
+            object->local_to_world = scalar::compose_trs(object->position, object->rotation, object->scale);
+        }
+    });
+    const double each_move = time_entities([&]() { world.Each<Position, ecs_bench_velocity>(moving, move); });
+    // Runs on this thread until the job system is up
+    const double each_transform = time_entities([&]() { TransformSystem::Update(world, transforms); });
+
+    // Same machine threads as the engine would start
+    const uint32_t threads = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 2;
+    uint64_t memory_requirement = 0;
+    JobSystem::Startup(memory_requirement, nullptr, threads);
+    void* memory = operator new(memory_requirement, std::align_val_t(64));
+    JobSystem::Startup(memory_requirement, memory, threads);
+    const double parallel_move = time_entities([&]() { world.ParallelEach<Position, ecs_bench_velocity>(moving, move); });
+    const double parallel_transform = time_entities([&]() { TransformSystem::Update(world, transforms); });
+    JobSystem::Shutdown();
+    operator delete(memory, std::align_val_t(64));
+
+    qlogger::Info("ecs %u entities, %u archetype chunks of %u, %u job threads",
+                  ecs_bench_entities, (uint32_t)world.GetArchetype(world.ArchetypeCount() - 1).chunks.size(),
+                  world.GetArchetype(world.ArchetypeCount() - 1).capacity, threads);
+    report("move", objects_move, each_move, parallel_move);
+    report("transform", objects_transform, each_transform, parallel_transform);
+    return TRUE;
+}
+
+void
+ecs_register_benchmarks(TestManager& manager) {
+    manager.Register(ecs_benchmark_update, "ecs chunked iteration against heap objects");
+}
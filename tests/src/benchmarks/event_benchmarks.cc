@@ -0,0 +1,170 @@
+#include "event_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/events.hh>
+#include <core/qlogger.hh>
+#include <chrono>
+#include <new>
+
+static constexpr uint32_t bench_startups = 200;
+static constexpr uint32_t bench_fires = 1000000;
+static constexpr uint32_t bench_listener_counts[] = { 16, 64, 256 };
+static constexpr uint32_t bench_listeners_per_code = 4;
+
+// Baseline: the layout EventState had before, one listener array for every possible code
+struct per_code_state {
+    Vector<EventDelegate> registered[MAX_MESSAGE_CODES];
+};
+
+static bool
+count_event(uint16_t, void*, void* listener, EventContext) {
+    (*static_cast<uint64_t*>(listener))++;
+    return false;
+}
+
+static void*
+event_startup() {
+    uint64_t memory_requirement = 0;
+    EventHandler::Startup(memory_requirement, nullptr);
+    void* memory = operator new(memory_requirement, std::align_val_t(64));
+    EventHandler::Startup(memory_requirement, memory);
+    return memory;
+}
+
+static void
+event_shutdown(void* memory) {
+    EventHandler::Shutdown();
+    operator delete(memory, std::align_val_t(64));
+}
+
+// Everything the event system holds on to: its state, and what its containers allocated
+static uint64_t
+event_state_bytes(EventState* state) {
+    return sizeof(EventState)
+        + state->codes.capacity() * sizeof(EventCodeEntry)
+        + state->listeners.capacity() * sizeof(EventDelegate)
+        + state->code_slots.capacity() * sizeof(uint16_t)
+        + state->queued.capacity() * (sizeof(uint64_t) + sizeof(QueuedEvent));
+}
+
+static uint64_t
+per_code_state_bytes(per_code_state* state) {
+    uint64_t bytes = sizeof(per_code_state);
+    for (const Vector<EventDelegate>& delegates : state->registered) {
+        bytes += delegates.capacity() * sizeof(EventDelegate);
+    }
+    return bytes;
+}
+
+// Spread listener_count listeners over codes, bench_listeners_per_code each
+static void
+register_listeners(uint64_t* counters, uint32_t listener_count) {
+    for (uint32_t i = 0; i < listener_count; i++) {
+        EventHandler::Register(static_cast<uint16_t>(i / bench_listeners_per_code * 7), &counters[i], count_event);
+    }
+}
+
+static void
+register_listeners(per_code_state* state, uint64_t* counters, uint32_t listener_count) {
+    for (uint32_t i = 0; i < listener_count; i++) {
+        state->registered[i / bench_listeners_per_code * 7].push(EventDelegate { count_event, &counters[i], nullptr });
+    }
+}
+
+uint8_t event_benchmark_startup() {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < bench_startups; i++) {
+        event_shutdown(event_startup());
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    double sparse_us = std::chrono::duration<double, std::micro>(finish - start).count() / bench_startups;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < bench_startups; i++) {
+        per_code_state* state = new per_code_state;
+        delete state;
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    double per_code_us = std::chrono::duration<double, std::micro>(finish - start).count() / bench_startups;
+
+    void* memory = event_startup();
+    uint64_t sparse_bytes = event_state_bytes(static_cast<EventState*>(memory));
+    event_shutdown(memory);
+
+    qlogger::Info("Event system startup + shutdown: sparse %.2f us (%llu bytes), per code arrays %.2f us (%llu bytes)",
+                  sparse_us, static_cast<unsigned long long>(sparse_bytes),
+                  per_code_us, static_cast<unsigned long long>(sizeof(per_code_state)));
+    return TRUE;
+}
+
+uint8_t event_benchmark_memory() {
+    for (uint32_t listener_count : bench_listener_counts) {
+        uint64_t* counters = new uint64_t[listener_count]();
+
+        void* memory = event_startup();
+        register_listeners(counters, listener_count);
+        uint64_t sparse_bytes = event_state_bytes(static_cast<EventState*>(memory));
+        event_shutdown(memory);
+
+        per_code_state* state = new per_code_state;
+        register_listeners(state, counters, listener_count);
+        uint64_t per_code_bytes = per_code_state_bytes(state);
+        delete state;
+
+        qlogger::Info("Event system memory with %u listeners on %u codes: sparse %llu bytes, per code arrays %llu bytes",
+                      listener_count, listener_count / bench_listeners_per_code,
+                      static_cast<unsigned long long>(sparse_bytes), static_cast<unsigned long long>(per_code_bytes));
+        delete[] counters;
+    }
+    return TRUE;
+}
+
+uint8_t event_benchmark_fire() {
+    const uint32_t listener_count = 64;
+    const uint16_t code_count = listener_count / bench_listeners_per_code;
+    uint64_t counters[listener_count] = {};
+    EventContext data = {};
+
+    void* memory = event_startup();
+    register_listeners(counters, listener_count);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < bench_fires; i++) {
+        EventHandler::Fire(static_cast<uint16_t>(i % code_count * 7), nullptr, data);
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    double sparse_ns = std::chrono::duration<double, std::nano>(finish - start).count() / bench_fires;
+    event_shutdown(memory);
+
+    // The same dispatch loop Fire used to run over the per code arrays
+    per_code_state* state = new per_code_state;
+    register_listeners(state, counters, listener_count);
+    start = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < bench_fires; i++) {
+        const uint16_t code = static_cast<uint16_t>(i % code_count * 7);
+        const Vector<EventDelegate>& delegates = state->registered[code];
+        for (uint64_t j = 0; j < delegates.size(); j++) {
+            if (delegates[j].on_event(code, nullptr, delegates[j].listener, data)) {
+                break;
+            }
+        }
+    }
+    finish = std::chrono::high_resolution_clock::now();
+    double per_code_ns = std::chrono::duration<double, std::nano>(finish - start).count() / bench_fires;
+    delete state;
+
+    // Every listener was called the same number of times by both
+    for (uint32_t i = 1; i < listener_count; i++) {
+        expect_should_be(counters[0], counters[i]);
+    }
+    qlogger::Info("Event fire with %u listeners per code: sparse %.1f ns, per code arrays %.1f ns",
+                  bench_listeners_per_code, sparse_ns, per_code_ns);
+    return TRUE;
+}
+
+void
+event_register_benchmarks(TestManager& manager) {
+    manager.Register(event_benchmark_startup, "Benchmark: event system startup time and footprint");
+    manager.Register(event_benchmark_memory, "Benchmark: event system memory against listener count");
+    manager.Register(event_benchmark_fire, "Benchmark: event fire over the listener pool");
+}
@@ -0,0 +1,167 @@
+#include "hashmap_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <containers/qhashmap.inl>
+#include <containers/qstring_table.hh>
+#include <core/qlogger.hh>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+static constexpr uint32_t bench_keys = 1000000;
+
+static volatile uint64_t bench_sink;
+
+template <typename F>
+static double
+time_ns_per_key(uint32_t keys, F&& func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto finish = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(finish - start).count() / keys;
+}
+
+// Keys spread over the whole 64 bit range, like handles or hashes would be
+static std::vector<uint64_t>
+make_keys(uint32_t count, uint64_t seed) {
+    std::vector<uint64_t> keys(count);
+    uint64_t state = seed;
+    for (uint32_t i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        keys[i] = state;
+    }
+    return keys;
+}
+
+uint8_t hashmap_benchmark_integer_keys() {
+    std::vector<uint64_t> keys = make_keys(bench_keys, 0x9E3779B97F4A7C15ull);
+    std::vector<uint64_t> misses = make_keys(bench_keys, 0x12345678ull);
+
+    HashMap<uint64_t, uint64_t> map(MEMORY_TAG_DICT);
+    std::unordered_map<uint64_t, uint64_t> std_map;
+
+    double q_insert = time_ns_per_key(bench_keys, [&]() {
+        for (uint32_t i = 0; i < bench_keys; i++) {
+            map.insert(keys[i], i);
+        }
+    });
+    double s_insert = time_ns_per_key(bench_keys, [&]() {
+        for (uint32_t i = 0; i < bench_keys; i++) {
+            std_map.emplace(keys[i], i);
+        }
+    });
+
+    double q_hit = time_ns_per_key(bench_keys, [&]() {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < bench_keys; i++) {
+            sum += *map.find(keys[i]);
+        }
+        bench_sink = sum;
+    });
+    double s_hit = time_ns_per_key(bench_keys, [&]() {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < bench_keys; i++) {
+            sum += std_map.find(keys[i])->second;
+        }
+        bench_sink = sum;
+    });
+
+    double q_miss = time_ns_per_key(bench_keys, [&]() {
+        uint64_t found = 0;
+        for (uint32_t i = 0; i < bench_keys; i++) {
+            found += map.find(misses[i]) != nullptr;
+        }
+        bench_sink = found;
+    });
+    double s_miss = time_ns_per_key(bench_keys, [&]() {
+        uint64_t found = 0;
+        for (uint32_t i = 0; i < bench_keys; i++) {
+            found += std_map.find(misses[i]) != std_map.end();
+        }
+        bench_sink = found;
+    });
+
+    qlogger::Info("Bench: uint64 insert   HashMap %.2f ns  std::unordered_map %.2f ns", q_insert, s_insert);
+    qlogger::Info("Bench: uint64 hit      HashMap %.2f ns  std::unordered_map %.2f ns", q_hit, s_hit);
+    qlogger::Info("Bench: uint64 miss     HashMap %.2f ns  std::unordered_map %.2f ns", q_miss, s_miss);
+    expect_should_be(std_map.size(), map.size());
+    return TRUE;
+}
+
+uint8_t hashmap_benchmark_string_keys() {
+    const uint32_t count = bench_keys / 10;
+    std::vector<std::string> names(count);
+    for (uint32_t i = 0; i < count; i++) {
+        names[i] = "assets/textures/material_" + std::to_string(i) + "_diffuse.png";
+    }
+
+    // Look names up in a different order than they were inserted, so node based maps do not
+    // get to walk their nodes in allocation order
+    std::vector<uint64_t> order = make_keys(count, 0xC0FFEEull);
+    std::vector<uint32_t> lookups(count);
+    for (uint32_t i = 0; i < count; i++) {
+        lookups[i] = static_cast<uint32_t>(order[i] % count);
+    }
+
+    HashMap<std::string, uint32_t> map(MEMORY_TAG_DICT);
+    std::unordered_map<std::string, uint32_t> std_map;
+
+    double q_insert = time_ns_per_key(count, [&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            map.insert(names[i], i);
+        }
+    });
+    double s_insert = time_ns_per_key(count, [&]() {
+        for (uint32_t i = 0; i < count; i++) {
+            std_map.emplace(names[i], i);
+        }
+    });
+
+    double q_hit = time_ns_per_key(count, [&]() {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            sum += *map.find(names[lookups[i]]);
+        }
+        bench_sink = sum;
+    });
+    double s_hit = time_ns_per_key(count, [&]() {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            sum += std_map.find(names[lookups[i]])->second;
+        }
+        bench_sink = sum;
+    });
+
+    // Names interned once up front, lookups by id after that
+    QStringTable table;
+    std::vector<QStringId> ids(count);
+    for (uint32_t i = 0; i < count; i++) {
+        ids[i] = table.intern(names[i].c_str(), names[i].size());
+    }
+    HashMap<QStringId, uint32_t> id_map(MEMORY_TAG_DICT);
+    for (uint32_t i = 0; i < count; i++) {
+        id_map.insert(ids[i], i);
+    }
+    double q_interned = time_ns_per_key(count, [&]() {
+        uint64_t sum = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            sum += *id_map.find(ids[lookups[i]]);
+        }
+        bench_sink = sum;
+    });
+
+    qlogger::Info("Bench: string insert   HashMap %.2f ns  std::unordered_map %.2f ns", q_insert, s_insert);
+    qlogger::Info("Bench: string hit      HashMap %.2f ns  std::unordered_map %.2f ns", q_hit, s_hit);
+    qlogger::Info("Bench: interned id hit HashMap %.2f ns", q_interned);
+    return TRUE;
+}
+
+void
+hashmap_register_benchmarks(TestManager& manager) {
+    manager.Register(hashmap_benchmark_integer_keys, "hashmap vs std::unordered_map with integer keys");
+    manager.Register(hashmap_benchmark_string_keys, "hashmap vs std::unordered_map with string keys");
+}
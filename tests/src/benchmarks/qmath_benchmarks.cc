@@ -0,0 +1,281 @@
+#include "qmath_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <qmath/qmath.hh>
+#include <core/qlogger.hh>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using namespace qmath;
+
+static constexpr uint32_t bench_values = 1024;
+static constexpr uint32_t bench_rounds = 2000;
+
+// Inputs are spread over arrays so nothing is folded into constants
+struct qmath_bench_inputs {
+    std::vector<Mat4<float>> matrices;
+    std::vector<Vec3<float>> points;
+    std::vector<Quaternion<float>> quaternions;
+
+    qmath_bench_inputs() : matrices(bench_values), points(bench_values), quaternions(bench_values) {
+        for (uint32_t i = 0; i < bench_values; i++) {
+            const float f = static_cast<float>(i);
+            Mat4<float> rotation = Mat4<float>::EulerXYZ(f * 0.01f, f * 0.02f, f * 0.03f);
+            matrices[i] = scalar::multiply(rotation, Mat4<float>::GetTranslation(Vec3<float> { f, -f, 0.5f * f }));
+            points[i] = Vec3<float> { f, f * 0.5f, -f };
+            quaternions[i] = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 0.f, 1.f }, f * 0.001f, false);
+        }
+    }
+};
+
+static qmath_bench_inputs&
+bench_inputs() {
+    static qmath_bench_inputs inputs;
+    return inputs;
+}
+
+// ns per call of op(i) over bench_rounds passes of the inputs. op returns a float that is summed,
+// so the calls cannot be thrown away
+template <typename Op>
+static double
+time_op(Op op) {
+    volatile float sink = 0.f;
+    float sum = 0.f;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t round = 0; round < bench_rounds; round++) {
+        for (uint32_t i = 0; i < bench_values; i++) {
+            sum += op(i);
+        }
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    sink = sum;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(finish - start).count() / (double(bench_rounds) * bench_values);
+}
+
+// Every component is used, otherwise the compiler drops the scalar lanes nobody reads
+static float
+total(const Mat4<float>& m) {
+    float sum = 0.f;
+    for (uint32_t i = 0; i < 16; i++) {
+        sum += m.data[i];
+    }
+    return sum;
+}
+
+static float
+total(const Vec3<float>& v) {
+    return v.x + v.y + v.z;
+}
+
+static float
+total(const Quaternion<float>& q) {
+    return q.x + q.y + q.z + q.w;
+}
+
+static void
+report(const char* name, double scalar_ns, double simd_ns) {
+    qlogger::Info("qmath %-22s scalar %6.2f ns, %s %6.2f ns (%.2fx)", name, scalar_ns, simd::ISA, simd_ns, scalar_ns / simd_ns);
+}
+
+uint8_t qmath_benchmark_mat4() {
+    qmath_bench_inputs& in = bench_inputs();
+    const uint32_t mask = bench_values - 1;
+
+    report("Mat4 multiply",
+        time_op([&](uint32_t i) { return total(scalar::multiply(in.matrices[i], in.matrices[(i + 1) & mask])); }),
+        time_op([&](uint32_t i) { return total(in.matrices[i] * in.matrices[(i + 1) & mask]); }));
+    report("Mat4 inverse",
+        time_op([&](uint32_t i) { return total(scalar::inverse(in.matrices[i])); }),
+        time_op([&](uint32_t i) { return total(Mat4<float>::GetInverse(in.matrices[i])); }));
+    report("Mat4 transform point",
+        time_op([&](uint32_t i) { return total(scalar::transform_point(in.matrices[i], in.points[i])); }),
+        time_op([&](uint32_t i) { return total(Mat4<float>::TransformPoint(in.matrices[i], in.points[i])); }));
+    report("Mat4 transform vector",
+        time_op([&](uint32_t i) { return total(scalar::transform_vector(in.matrices[i], in.points[i])); }),
+        time_op([&](uint32_t i) { return total(Mat4<float>::TransformVector(in.matrices[i], in.points[i])); }));
+    return TRUE;
+}
+
+uint8_t qmath_benchmark_quaternion() {
+    qmath_bench_inputs& in = bench_inputs();
+    const uint32_t mask = bench_values - 1;
+
+    report("Quaternion multiply",
+        time_op([&](uint32_t i) { return total(scalar::multiply(in.quaternions[i], in.quaternions[(i + 7) & mask])); }),
+        time_op([&](uint32_t i) { return total(in.quaternions[i] * in.quaternions[(i + 7) & mask]); }));
+    // Far apart inputs, so both take the acos path
+    report("Quaternion slerp",
+        time_op([&](uint32_t i) { return total(scalar::slerp(in.quaternions[i], in.quaternions[(i + 512) & mask], 0.25f)); }),
+        time_op([&](uint32_t i) { return total(Quaternion<float>::Slerp(in.quaternions[i], in.quaternions[(i + 512) & mask], 0.25f)); }));
+    return TRUE;
+}
+
+static constexpr uint32_t batch_bench_count = 10000;
+static constexpr uint32_t batch_bench_rounds = 200;
+
+// ns per element for op(), which handles batch_bench_count elements
+template <typename Op>
+static double
+time_batch(Op op) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t round = 0; round < batch_bench_rounds; round++) {
+        op();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(finish - start).count() / (double(batch_bench_rounds) * batch_bench_count);
+}
+
+static void
+report_batch(const char* name, double per_object_ns, double batch_ns) {
+    qlogger::Info("qmath %-26s per object %6.2f ns, %s batch %6.2f ns (%.2fx, %.0f M/s)",
+                  name, per_object_ns, simd::ISA, batch_ns, per_object_ns / batch_ns, 1e3 / batch_ns);
+}
+
+uint8_t qmath_benchmark_batch() {
+    qmath_bench_inputs& in = bench_inputs();
+    const Mat4<float> view_projection = in.matrices[3];
+
+    std::vector<Mat4<float>> models(batch_bench_count);
+    std::vector<Mat4<float>> matrices(batch_bench_count);
+    std::vector<Vertex3D> vertices(batch_bench_count);
+    std::vector<Vertex3D> transformed(batch_bench_count);
+    std::vector<float> streams[10];
+    for (std::vector<float>& stream : streams) {
+        stream.resize(batch_bench_count);
+    }
+    for (uint32_t i = 0; i < batch_bench_count; i++) {
+        const uint32_t j = i % bench_values;
+        models[i] = in.matrices[j];
+        vertices[i].position = in.points[j];
+        streams[0][i] = in.points[j].x;
+        streams[1][i] = in.points[j].y;
+        streams[2][i] = in.points[j].z;
+        streams[3][i] = in.quaternions[j].x;
+        streams[4][i] = in.quaternions[j].y;
+        streams[5][i] = in.quaternions[j].z;
+        streams[6][i] = in.quaternions[j].w;
+        streams[7][i] = 1.f;
+        streams[8][i] = 2.f;
+        streams[9][i] = 3.f;
+    }
+    std::vector<float> ox(batch_bench_count), oy(batch_bench_count), oz(batch_bench_count);
+    const ConstVec3Stream positions = { streams[0].data(), streams[1].data(), streams[2].data() };
+    const ConstQuaternionStream rotations = { streams[3].data(), streams[4].data(), streams[5].data(), streams[6].data() };
+    const ConstVec3Stream scales = { streams[7].data(), streams[8].data(), streams[9].data() };
+
+    report_batch("models * view_projection",
+        time_batch([&]() {
+            for (uint32_t i = 0; i < batch_bench_count; i++) {
+                matrices[i] = models[i] * view_projection;
+            }
+        }),
+        time_batch([&]() { batch::multiply(models.data(), view_projection, matrices.data(), batch_bench_count); }));
+
+    report_batch("Vertex3D transform",
+        time_batch([&]() {
+            for (uint32_t i = 0; i < batch_bench_count; i++) {
+                transformed[i].position = Mat4<float>::TransformPoint(view_projection, vertices[i].position);
+            }
+        }),
+        time_batch([&]() { batch::transform_points(view_projection, vertices.data(), transformed.data(), batch_bench_count); }));
+
+    report_batch("point stream transform",
+        time_batch([&]() {
+            for (uint32_t i = 0; i < batch_bench_count; i++) {
+                Vec3<float> p = Mat4<float>::TransformPoint(view_projection, Vec3<float> { positions.x[i], positions.y[i], positions.z[i] });
+                ox[i] = p.x;
+                oy[i] = p.y;
+                oz[i] = p.z;
+            }
+        }),
+        time_batch([&]() { batch::transform_points(view_projection, positions, Vec3Stream { ox.data(), oy.data(), oz.data() }, batch_bench_count); }));
+
+    report_batch("TRS compose",
+        time_batch([&]() {
+            for (uint32_t i = 0; i < batch_bench_count; i++) {
+                matrices[i] = scalar::compose_trs(
+                    Vec3<float> { positions.x[i], positions.y[i], positions.z[i] },
+                    Quaternion<float>::New(rotations.x[i], rotations.y[i], rotations.z[i], rotations.w[i]),
+                    Vec3<float> { scales.x[i], scales.y[i], scales.z[i] });
+            }
+        }),
+        time_batch([&]() { batch::compose_trs(positions, rotations, scales, matrices.data(), batch_bench_count); }));
+
+    // Keep the results alive
+    volatile float sink = matrices[7].data[5] + transformed[7].position.y + ox[7];
+    (void)sink;
+    return TRUE;
+}
+
+static void
+report_fast(const char* name, double precise_ns, double fast_ns) {
+    qlogger::Info("qmath %-22s precise %6.2f ns, fast %6.2f ns (%.2fx)", name, precise_ns, fast_ns, precise_ns / fast_ns);
+}
+
+uint8_t qmath_benchmark_fast() {
+    qmath_bench_inputs& in = bench_inputs();
+    std::vector<float> angles(bench_values);
+    std::vector<float> cosines(bench_values);
+    for (uint32_t i = 0; i < bench_values; i++) {
+        angles[i] = (static_cast<float>(i) / bench_values * 2.f - 1.f) * 100.f;
+        cosines[i] = static_cast<float>(i) / bench_values * 2.f - 1.f;
+    }
+
+    report_fast("rsqrt",
+        time_op([&](uint32_t i) { return 1.f / qsqrt(in.points[i].length_squared() + 1.f); }),
+        time_op([&](uint32_t i) { return fast::rsqrt(in.points[i].length_squared() + 1.f); }));
+    report_fast("sin and cos",
+        time_op([&](uint32_t i) { return qsin(angles[i]) + qcos(angles[i]); }),
+        time_op([&](uint32_t i) {
+            float s = 0.f;
+            float c = 0.f;
+            fast::sincos(angles[i], s, c);
+            return s + c;
+        }));
+    report_fast("acos",
+        time_op([&](uint32_t i) { return qacos(cosines[i]); }),
+        time_op([&](uint32_t i) { return fast::acos(cosines[i]); }));
+    report_fast("atan2",
+        time_op([&](uint32_t i) { return std::atan2(in.points[i].x + 1.f, angles[i]); }),
+        time_op([&](uint32_t i) { return fast::atan2(in.points[i].x + 1.f, angles[i]); }));
+    report_fast("Vec3 normalize",
+        time_op([&](uint32_t i) { return total((in.points[i] + Vec3<float>::One()).normalized()); }),
+        time_op([&](uint32_t i) { return total(fast::normalized(in.points[i] + Vec3<float>::One())); }));
+
+    std::vector<float> x(batch_bench_count), y(batch_bench_count), z(batch_bench_count);
+    std::vector<float> nx(batch_bench_count), ny(batch_bench_count), nz(batch_bench_count);
+    for (uint32_t i = 0; i < batch_bench_count; i++) {
+        const Vec3<float> p = in.points[i % bench_values] + Vec3<float>::One();
+        x[i] = p.x;
+        y[i] = p.y;
+        z[i] = p.z;
+    }
+    const double precise_ns = time_batch([&]() {
+        for (uint32_t i = 0; i < batch_bench_count; i++) {
+            const Vec3<float> n = Vec3<float> { x[i], y[i], z[i] }.normalized();
+            nx[i] = n.x;
+            ny[i] = n.y;
+            nz[i] = n.z;
+        }
+    });
+    const double fast_ns = time_batch([&]() {
+        fast::normalize(ConstVec3Stream { x.data(), y.data(), z.data() }, Vec3Stream { nx.data(), ny.data(), nz.data() }, batch_bench_count);
+    });
+    qlogger::Info("qmath %-22s precise %6.2f ns, %s fast batch %6.2f ns (%.2fx)",
+                  "Vec3 stream normalize", precise_ns, simd::ISA, fast_ns, precise_ns / fast_ns);
+
+    volatile float sink = nx[7] + ny[7] + nz[7];
+    (void)sink;
+    return TRUE;
+}
+
+void
+qmath_register_benchmarks(TestManager& manager) {
+    manager.Register(qmath_benchmark_mat4, "Benchmark: qmath Mat4 kernels, scalar against SIMD");
+    manager.Register(qmath_benchmark_quaternion, "Benchmark: qmath Quaternion kernels, scalar against SIMD");
+    manager.Register(qmath_benchmark_batch, "Benchmark: qmath batch kernels against per object calls");
+    manager.Register(qmath_benchmark_fast, "Benchmark: qmath fast approximations against the precise functions");
+}
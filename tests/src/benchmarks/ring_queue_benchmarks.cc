@@ -0,0 +1,125 @@
+#include "ring_queue_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <containers/qring_queue.inl>
+#include <core/qlogger.hh>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t bench_ops_per_thread = 1000000;
+static constexpr uint32_t bench_thread_counts[] = { 1, 2, 4, 8, 16 };
+
+// Baseline: the obvious locked queue
+struct locked_queue {
+    std::mutex lock;
+    std::deque<uint64_t> items;
+
+    bool push(uint64_t value) {
+        std::lock_guard<std::mutex> guard(lock);
+        items.push_back(value);
+        return true;
+    }
+
+    bool pop(uint64_t& out) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (items.empty()) {
+            return false;
+        }
+        out = items.front();
+        items.pop_front();
+        return true;
+    }
+};
+
+// Every thread pushes one value and pops one value, over and over. All threads hit both
+// ends of the queue, which is the worst case for contention. Threads yield when the queue
+// is full or empty so the numbers stay meaningful when there are more threads than cores
+template <typename Q>
+static double
+run_contention(Q& queue, uint32_t thread_count) {
+    std::atomic<bool> go { false };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([&queue, &go, t]() {
+            while (!go.load(std::memory_order_acquire)) {
+            }
+            uint64_t value = 0;
+            for (uint32_t i = 0; i < bench_ops_per_thread; i++) {
+                while (!queue.push(uint64_t(t) << 32 | i)) {
+                    std::this_thread::yield();
+                }
+                while (!queue.pop(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+
+    // Push/pop pairs per second across all threads
+    double seconds = std::chrono::duration<double>(finish - start).count();
+    return double(thread_count) * bench_ops_per_thread / seconds / 1e6;
+}
+
+uint8_t ring_queue_benchmark_mpmc_contention() {
+    for (uint32_t thread_count : bench_thread_counts) {
+        MPMCQueue<uint64_t> queue(1024);
+        double mpmc = run_contention(queue, thread_count);
+
+        locked_queue locked;
+        double baseline = run_contention(locked, thread_count);
+
+        qlogger::Info("Bench: %2u threads  MPMCQueue %7.2f Mops/s  mutex+deque %7.2f Mops/s", thread_count, mpmc, baseline);
+        expect_should_be(0, queue.size());
+    }
+    return TRUE;
+}
+
+uint8_t ring_queue_benchmark_spsc_throughput() {
+    const uint32_t count = bench_ops_per_thread * 10;
+    SPSCQueue<uint64_t> spsc(1024);
+    MPMCQueue<uint64_t> mpmc(1024);
+
+    auto transfer = [count](auto& queue) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::thread producer([&queue, count]() {
+            for (uint32_t i = 0; i < count; i++) {
+                while (!queue.push(i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            while (!queue.pop(value)) {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+        auto finish = std::chrono::high_resolution_clock::now();
+        return count / std::chrono::duration<double>(finish - start).count() / 1e6;
+    };
+
+    double spsc_rate = transfer(spsc);
+    double mpmc_rate = transfer(mpmc);
+    qlogger::Info("Bench: 1 producer 1 consumer  SPSCQueue %7.2f Mops/s  MPMCQueue %7.2f Mops/s", spsc_rate, mpmc_rate);
+    return TRUE;
+}
+
+void
+ring_queue_register_benchmarks(TestManager& manager) {
+    manager.Register(ring_queue_benchmark_mpmc_contention, "mpmc queue contention at 1-16 threads");
+    manager.Register(ring_queue_benchmark_spsc_throughput, "spsc vs mpmc single producer single consumer");
+}
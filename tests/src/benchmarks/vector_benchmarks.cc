@@ -0,0 +1,118 @@
+#include "vector_benchmarks.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <containers/qvector.inl>
+#include <memory/qlinear_allocator.hh>
+#include <core/qlogger.hh>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t bench_repeats = 200;
+static constexpr uint32_t bench_elements = 10000;
+
+template <typename F>
+static double
+time_ns_per_element(F&& func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t r = 0; r < bench_repeats; r++) {
+        func();
+    }
+    auto finish = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(finish - start).count() / (double(bench_repeats) * bench_elements);
+}
+
+// Stops the optimizer from throwing the containers away
+static volatile uint64_t bench_sink;
+
+uint8_t vector_benchmark_push_trivial() {
+    double q = time_ns_per_element([]() {
+        Vector<uint64_t> v(MEMORY_TAG_DARRAY);
+        for (uint64_t i = 0; i < bench_elements; i++) {
+            v.push(i);
+        }
+        bench_sink = v[bench_elements / 2];
+    });
+
+    double s = time_ns_per_element([]() {
+        std::vector<uint64_t> v;
+        for (uint64_t i = 0; i < bench_elements; i++) {
+            v.push_back(i);
+        }
+        bench_sink = v[bench_elements / 2];
+    });
+
+    qlogger::Info("Bench: push uint64_t    Vector %.3f ns  std::vector %.3f ns", q, s);
+    return TRUE;
+}
+
+uint8_t vector_benchmark_push_reserved() {
+    double q = time_ns_per_element([]() {
+        Vector<uint64_t> v(MEMORY_TAG_DARRAY);
+        v.reserve(bench_elements);
+        for (uint64_t i = 0; i < bench_elements; i++) {
+            v.push(i);
+        }
+        bench_sink = v[bench_elements / 2];
+    });
+
+    double s = time_ns_per_element([]() {
+        std::vector<uint64_t> v;
+        v.reserve(bench_elements);
+        for (uint64_t i = 0; i < bench_elements; i++) {
+            v.push_back(i);
+        }
+        bench_sink = v[bench_elements / 2];
+    });
+
+    qlogger::Info("Bench: push reserved    Vector %.3f ns  std::vector %.3f ns", q, s);
+    return TRUE;
+}
+
+uint8_t vector_benchmark_push_string() {
+    double q = time_ns_per_element([]() {
+        Vector<std::string> v(MEMORY_TAG_STRING);
+        for (uint32_t i = 0; i < bench_elements; i++) {
+            v.emplace_back("a string that does not fit inline");
+        }
+        bench_sink = v[bench_elements / 2].size();
+    });
+
+    double s = time_ns_per_element([]() {
+        std::vector<std::string> v;
+        for (uint32_t i = 0; i < bench_elements; i++) {
+            v.emplace_back("a string that does not fit inline");
+        }
+        bench_sink = v[bench_elements / 2].size();
+    });
+
+    qlogger::Info("Bench: emplace string   Vector %.3f ns  std::vector %.3f ns", q, s);
+    return TRUE;
+}
+
+uint8_t vector_benchmark_push_arena() {
+    qmemory::QLinearAllocator arena;
+    arena.Create(bench_elements * sizeof(uint64_t) * 4, nullptr);
+
+    double q = time_ns_per_element([&arena]() {
+        arena.FreeAll();
+        Vector<uint64_t> v(MEMORY_TAG_DARRAY, qmemory::QContainerAllocator::FromLinear(arena));
+        for (uint64_t i = 0; i < bench_elements; i++) {
+            v.push(i);
+        }
+        bench_sink = v[bench_elements / 2];
+    });
+
+    arena.Destroy();
+    qlogger::Info("Bench: push into arena  Vector %.3f ns", q);
+    return TRUE;
+}
+
+void
+vector_register_benchmarks(TestManager& manager) {
+    manager.Register(vector_benchmark_push_trivial, "vector vs std::vector push of uint64_t");
+    manager.Register(vector_benchmark_push_reserved, "vector vs std::vector push into reserved storage");
+    manager.Register(vector_benchmark_push_string, "vector vs std::vector emplace of std::string");
+    manager.Register(vector_benchmark_push_arena, "vector push into a linear allocator");
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include "../test_manager.hh"
+
+void vector_register_benchmarks(TestManager& manager);
@@ -0,0 +1,183 @@
+#include "hashmap_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <containers/qhashmap.inl>
+#include <containers/qstring_table.hh>
+#include <memory/qlinear_allocator.hh>
+#include <defines.hh>
+#include <string>
+
+uint8_t hashmap_insert_find_and_grow() {
+    HashMap<uint64_t, uint64_t> map(MEMORY_TAG_DICT);
+    expect_should_be(0, map.capacity());
+    expect_should_be(0, map.find(1));
+
+    for (uint64_t i = 0; i < 10000; i++) {
+        expect_to_be_true(map.insert(i * 7, i));
+    }
+    expect_should_be(10000, map.size());
+    expect_to_be_false(map.insert(7, 123));
+
+    for (uint64_t i = 0; i < 10000; i++) {
+        uint64_t* value = map.find(i * 7);
+        expect_should_not_be(0, value);
+        expect_should_be(i, *value);
+    }
+    expect_to_be_false(map.contains(3));
+
+    map.set(7, 123);
+    expect_should_be(123, *map.find(7));
+    map[5] += 2;
+    expect_should_be(2, map[5]);
+    expect_should_be(10001, map.size());
+    return TRUE;
+}
+
+uint8_t hashmap_remove_and_reuse() {
+    HashMap<uint32_t, uint32_t> map(MEMORY_TAG_DICT);
+    for (uint32_t round = 0; round < 50; round++) {
+        for (uint32_t i = 0; i < 1000; i++) {
+            map.insert(round * 1000 + i, i);
+        }
+        for (uint32_t i = 0; i < 1000; i++) {
+            expect_to_be_true(map.remove(round * 1000 + i));
+        }
+        expect_to_be_false(map.remove(round * 1000));
+    }
+
+    // Churn must not grow the table without bound
+    expect_should_be(0, map.size());
+    expect_to_be_true(map.capacity() <= 4096);
+
+    map.insert(1, 1);
+    map.insert(2, 2);
+    map.remove(1);
+    expect_should_be(0, map.find(1));
+    expect_should_be(2, *map.find(2));
+
+    uint32_t visited = 0;
+    map.for_each([&](uint32_t key, uint32_t value) { visited += key + value; });
+    expect_should_be(4, visited);
+
+    map.clear();
+    expect_should_be(0, map.size());
+    expect_should_be(0, map.find(2));
+    return TRUE;
+}
+
+uint8_t hashmap_string_keys_and_move() {
+    HashMap<std::string, std::string> map(MEMORY_TAG_STRING);
+    for (uint32_t i = 0; i < 200; i++) {
+        map.insert("texture_" + std::to_string(i), "path/to/texture_" + std::to_string(i) + ".png");
+    }
+
+    std::string* value = map.find("texture_42");
+    expect_should_not_be(0, value);
+    expect_to_be_true(*value == "path/to/texture_42.png");
+
+    HashMap<std::string, std::string> moved = std::move(map);
+    expect_should_be(200, moved.size());
+    expect_should_be(0, map.size());
+    expect_should_be(0, map.find("texture_42"));
+    expect_to_be_true(moved.contains("texture_199"));
+    return TRUE;
+}
+
+uint8_t hashmap_uses_custom_allocator() {
+    qmemory::QLinearAllocator arena;
+    arena.Create(256 * 1024, nullptr);
+    {
+        HashMap<uint32_t, float> map(MEMORY_TAG_DICT, qmemory::QContainerAllocator::FromLinear(arena));
+        map.reserve(1000);
+        uint64_t used = arena.allocated;
+        expect_to_be_true(used > 0);
+
+        for (uint32_t i = 0; i < 1000; i++) {
+            map.insert(i, static_cast<float>(i));
+        }
+        expect_should_be(used, arena.allocated);
+        expect_float_to_be(999.0f, *map.find(999));
+    }
+    arena.Destroy();
+    return TRUE;
+}
+
+uint8_t hashmap_keeps_contents_when_out_of_memory() {
+    qmemory::QLinearAllocator arena;
+    arena.Create(512, nullptr);
+    {
+        // Room for the 16 and 32 slot tables, not the 64 slot one
+        HashMap<uint32_t, uint32_t> map(MEMORY_TAG_DICT, qmemory::QContainerAllocator::FromLinear(arena));
+        uint32_t inserted = 0;
+        while (map.insert(inserted, inserted * 3)) {
+            inserted++;
+        }
+        expect_should_be(32, map.capacity());
+        expect_should_be(28, inserted);
+        expect_should_be(28, map.size());
+        for (uint32_t i = 0; i < inserted; i++) {
+            expect_to_be_true((map.find(i) != nullptr && *map.find(i) == i * 3));
+        }
+
+        expect_to_be_false(map.reserve(1000));
+        map.set(1000, 1);
+        expect_to_be_false(map.contains(1000));
+        map[2000] = 5;
+        expect_to_be_false(map.contains(2000));
+        expect_should_be(28, map.size());
+
+        // Existing keys still work
+        map[4] = 44;
+        expect_should_be(44, *map.find(4));
+        expect_to_be_true(map.remove(5));
+        expect_to_be_true(map.insert(5, 55));
+    }
+    arena.Destroy();
+    return TRUE;
+}
+
+uint8_t string_table_interns_once() {
+    QStringTable table;
+    QStringId a = table.intern("diffuse");
+    QStringId b = table.intern("normal");
+    std::string copy = "diffuse";
+    QStringId c = table.intern(copy.c_str());
+
+    expect_to_be_true(a == c);
+    expect_to_be_true(a != b);
+    expect_should_be(2, table.size());
+    expect_to_be_true(strcmp(table.get(b), "normal") == 0);
+    expect_should_be(6, table.length(b));
+
+    // Lookups never add strings
+    expect_to_be_true(table.find("specular").is_null());
+    expect_to_be_true(table.find("normal") == b);
+    expect_should_be(2, table.size());
+
+    // Pointers stay valid as the table grows
+    const char* diffuse = table.get(a);
+    for (uint32_t i = 0; i < 5000; i++) {
+        table.intern(("material_" + std::to_string(i)).c_str());
+    }
+    expect_should_be(diffuse, table.get(a));
+    expect_to_be_true(strcmp(table.get(table.find("material_4321")), "material_4321") == 0);
+
+    // Interned ids work as map keys
+    HashMap<QStringId, uint32_t> handles(MEMORY_TAG_DICT);
+    handles.insert(a, 10);
+    handles.insert(b, 20);
+    expect_should_be(20, *handles.find(table.intern("normal")));
+    expect_should_be(0, table.get(QStringId{}));
+    return TRUE;
+}
+
+void
+hashmap_register_tests(TestManager& manager) {
+    manager.Register(hashmap_insert_find_and_grow, "hashmap insert, find and grow");
+    manager.Register(hashmap_remove_and_reuse, "hashmap remove reuses slots");
+    manager.Register(hashmap_string_keys_and_move, "hashmap with string keys and move");
+    manager.Register(hashmap_uses_custom_allocator, "hashmap works with a linear allocator");
+    manager.Register(hashmap_keeps_contents_when_out_of_memory, "hashmap keeps its contents when its allocator runs out");
+    manager.Register(string_table_interns_once, "string table interns each string once");
+}
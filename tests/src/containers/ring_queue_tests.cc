@@ -0,0 +1,133 @@
+#include "ring_queue_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <containers/qring_queue.inl>
+#include <defines.hh>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+uint8_t spsc_queue_fifo_full_and_empty() {
+    SPSCQueue<uint32_t> queue(6);
+    expect_should_be(8, queue.capacity());
+
+    uint32_t value = 0;
+    expect_to_be_false(queue.pop(value));
+
+    for (uint32_t i = 0; i < 8; i++) {
+        expect_to_be_true(queue.push(i));
+    }
+    expect_to_be_false(queue.push(8));
+    expect_should_be(8, queue.size());
+
+    // Wrap around a few times
+    for (uint32_t i = 0; i < 100; i++) {
+        expect_to_be_true(queue.pop(value));
+        expect_should_be(i, value);
+        expect_to_be_true(queue.push(i + 8));
+    }
+    expect_should_be(8, queue.size());
+    return TRUE;
+}
+
+uint8_t spsc_queue_transfers_in_order_across_threads() {
+    const uint32_t count = 1000000;
+    SPSCQueue<uint32_t> queue(1024);
+
+    std::thread producer([&queue]() {
+        for (uint32_t i = 0; i < count; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    bool in_order = true;
+    uint32_t expected = 0;
+    while (expected < count) {
+        uint32_t value;
+        if (queue.pop(value)) {
+            in_order = in_order && value == expected;
+            expected++;
+        }
+    }
+    producer.join();
+
+    expect_to_be_true(in_order);
+    expect_should_be(0, queue.size());
+    return TRUE;
+}
+
+uint8_t mpmc_queue_delivers_everything_once() {
+    const uint32_t producers = 4;
+    const uint32_t consumers = 4;
+    const uint32_t per_producer = 200000;
+    MPMCQueue<uint64_t> queue(256);
+
+    std::atomic<uint64_t> sum { 0 };
+    std::atomic<uint32_t> received { 0 };
+    std::vector<std::thread> threads;
+
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p]() {
+            for (uint32_t i = 0; i < per_producer; i++) {
+                uint64_t value = uint64_t(p) * per_producer + i + 1;
+                while (!queue.push(value)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (uint32_t c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            uint64_t local_sum = 0;
+            uint32_t local_count = 0;
+            while (received.load(std::memory_order_relaxed) < producers * per_producer) {
+                uint64_t value;
+                if (queue.pop(value)) {
+                    local_sum += value;
+                    local_count++;
+                    received.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            sum.fetch_add(local_sum);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const uint64_t total = uint64_t(producers) * per_producer;
+    expect_should_be(total, received.load());
+    expect_should_be(total * (total + 1) / 2, sum.load());
+    expect_should_be(0, queue.size());
+    return TRUE;
+}
+
+uint8_t ring_queues_destroy_leftover_values() {
+    std::string long_value = "a string long enough to live on the heap";
+    {
+        SPSCQueue<std::string> spsc(4);
+        MPMCQueue<std::string> mpmc(4);
+        expect_to_be_true(spsc.push(long_value));
+        expect_to_be_true(spsc.emplace("second"));
+        expect_to_be_true(mpmc.push(long_value));
+        expect_to_be_true(mpmc.emplace("second"));
+
+        std::string out;
+        expect_to_be_true(mpmc.pop(out));
+        expect_to_be_true(out == long_value);
+        // One value left in each queue, released by the destructors
+    }
+    return TRUE;
+}
+
+void
+ring_queue_register_tests(TestManager& manager) {
+    manager.Register(spsc_queue_fifo_full_and_empty, "spsc queue is fifo and reports full and empty");
+    manager.Register(spsc_queue_transfers_in_order_across_threads, "spsc queue transfers in order between threads");
+    manager.Register(mpmc_queue_delivers_everything_once, "mpmc queue delivers every value exactly once");
+    manager.Register(ring_queues_destroy_leftover_values, "ring queues destroy values left in them");
+}
@@ -0,0 +1,243 @@
+#include "vector_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <containers/qvector.inl>
+#include <containers/qstring_table.hh>
+#include <memory/qlinear_allocator.hh>
+#include <memory/qdynamic_allocator.hh>
+#include <core/qmemory.hh>
+#include <defines.hh>
+#include <string>
+
+// Counts constructions, copies and destructions to check what Vector does with its elements
+struct tracked_object {
+    static int32_t live;
+    static int32_t copies;
+    int32_t value;
+
+    tracked_object() : value(0) { live++; }
+    explicit tracked_object(int32_t v) : value(v) { live++; }
+    tracked_object(const tracked_object& other) : value(other.value) { live++; copies++; }
+    tracked_object(tracked_object&& other) noexcept : value(other.value) { other.value = -1; live++; }
+    tracked_object& operator=(const tracked_object& other) { value = other.value; copies++; return *this; }
+    tracked_object& operator=(tracked_object&& other) noexcept { value = other.value; other.value = -1; return *this; }
+    ~tracked_object() { live--; }
+};
+
+int32_t tracked_object::live = 0;
+int32_t tracked_object::copies = 0;
+
+uint8_t vector_push_pop_and_grow() {
+    Vector<uint64_t> v(MEMORY_TAG_DARRAY);
+    expect_should_be(0, v.capacity());
+    expect_should_be(0, v.data());
+
+    for (uint64_t i = 0; i < 1000; i++) {
+        v.push(i * 3);
+    }
+    expect_should_be(1000, v.size());
+    expect_to_be_true(v.capacity() >= 1000);
+    for (uint64_t i = 0; i < 1000; i++) {
+        expect_should_be(i * 3, v[i]);
+    }
+
+    expect_should_be(999 * 3, v.pop());
+    expect_should_be(998 * 3, v.pop());
+    expect_should_be(998, v.size());
+
+    uint64_t sum = 0;
+    for (uint64_t value : v) {
+        sum += value;
+    }
+    expect_should_be(3 * (997 * 998 / 2), sum);
+
+    uint64_t capacity = v.capacity();
+    v.clear();
+    expect_should_be(0, v.size());
+    expect_should_be(capacity, v.capacity());
+    return TRUE;
+}
+
+uint8_t vector_moves_elements_on_growth() {
+    tracked_object::live = 0;
+    tracked_object::copies = 0;
+    {
+        Vector<tracked_object> v(MEMORY_TAG_DARRAY);
+        for (int32_t i = 0; i < 100; i++) {
+            v.emplace_back(i);
+        }
+        expect_should_be(100, tracked_object::live);
+        expect_should_be(0, tracked_object::copies);
+
+        for (int32_t i = 0; i < 100; i++) {
+            expect_should_be(i, v[i].value);
+        }
+
+        tracked_object last = v.pop();
+        expect_should_be(99, last.value);
+        expect_should_be(100, tracked_object::live);
+
+        // Pushing an element of the vector itself while it grows
+        while (v.size() < v.capacity()) {
+            v.emplace_back(7);
+        }
+        v.push(v[0]);
+        expect_should_be(0, v.back().value);
+
+        v.resize(10);
+        expect_should_be(10, v.size());
+        expect_should_be(11, tracked_object::live);
+    }
+    expect_should_be(0, tracked_object::live);
+    return TRUE;
+}
+
+uint8_t vector_copy_and_move() {
+    Vector<std::string> a(MEMORY_TAG_STRING);
+    a.push("str1");
+    a.push("str2");
+    a.push("a string long enough to not fit in the small string buffer");
+
+    Vector<std::string> b = a;
+    expect_should_be(3, b.size());
+    expect_to_be_true(b[2] == a[2]);
+    expect_should_not_be(a.data(), b.data());
+
+    Vector<std::string> c(MEMORY_TAG_STRING);
+    c.push("replaced");
+    c = a;
+    expect_should_be(3, c.size());
+    expect_to_be_true(c[0] == "str1");
+
+    std::string* buffer = a.data();
+    Vector<std::string> d = std::move(a);
+    expect_should_be(buffer, d.data());
+    expect_should_be(0, a.size());
+    expect_should_be(0, a.data());
+
+    c = std::move(d);
+    expect_should_be(buffer, c.data());
+    expect_should_be(0, d.size());
+
+    // A moved-from vector can be used again
+    a.push("again");
+    expect_should_be(1, a.size());
+    return TRUE;
+}
+
+uint8_t vector_reserve_and_resize() {
+    Vector<float> v(MEMORY_TAG_DARRAY);
+    v.reserve(64);
+    expect_should_be(64, v.capacity());
+    expect_should_be(0, v.size());
+
+    float* buffer = v.data();
+    for (int32_t i = 0; i < 64; i++) {
+        v.push(static_cast<float>(i));
+    }
+    expect_should_be(buffer, v.data());
+
+    v.resize(100);
+    expect_should_be(100, v.size());
+    expect_float_to_be(63.0f, v[63]);
+    expect_float_to_be(0.0f, v[99]);
+
+    v.resize(5);
+    expect_should_be(5, v.size());
+    expect_to_be_true(v.set(4, 42.0f));
+    expect_float_to_be(42.0f, v.at(4));
+    expect_to_be_false(v.set(5, 1.0f));
+
+    // Trivially copyable, but value-initialized to invalid_value rather than zero
+    Vector<QStringId> ids(MEMORY_TAG_DARRAY);
+    ids.resize(10);
+    for (uint32_t i = 0; i < 10; i++) {
+        expect_to_be_true(ids[i].is_null());
+    }
+    return TRUE;
+}
+
+uint8_t vector_uses_pluggable_allocators() {
+    qmemory::QLinearAllocator arena;
+    arena.Create(64 * 1024, nullptr);
+    {
+        Vector<uint32_t> v(MEMORY_TAG_DARRAY, qmemory::QContainerAllocator::FromLinear(arena));
+        for (uint32_t i = 0; i < 1000; i++) {
+            v.push(i);
+        }
+
+        // Being the only user of the arena, the buffer grew in place the whole time
+        expect_to_be_true(v.allocator() == qmemory::QContainerAllocator::FromLinear(arena));
+        expect_should_be(arena.memory, v.data());
+        expect_should_be(v.capacity() * sizeof(uint32_t), arena.allocated);
+        expect_should_be(999, v[999]);
+    }
+    arena.Destroy();
+
+    qmemory::QDynamicAllocator dynamic;
+    uint64_t memory_requirement = 0;
+    dynamic.Create(64 * 1024, memory_requirement, nullptr);
+    void* memory = QAllocator::Allocate(1, memory_requirement, MEMORY_TAG_APPLICATION);
+    dynamic.Create(64 * 1024, memory_requirement, memory);
+    {
+        Vector<std::string> v(MEMORY_TAG_STRING, qmemory::QContainerAllocator::FromDynamic(dynamic));
+        for (uint32_t i = 0; i < 100; i++) {
+            v.push(std::to_string(i));
+        }
+        expect_to_be_true(v[57] == "57");
+        expect_to_be_true(dynamic.Owns(v.data()));
+    }
+    expect_should_be(64 * 1024, dynamic.FreeSpace());
+    dynamic.Destroy();
+    QAllocator::Free(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+uint8_t vector_keeps_contents_when_out_of_memory() {
+    qmemory::QLinearAllocator arena;
+    arena.Create(256, nullptr);
+    {
+        // Trivial elements, grown with Reallocate
+        Vector<uint32_t> v(MEMORY_TAG_DARRAY, qmemory::QContainerAllocator::FromLinear(arena));
+        uint32_t pushed = 0;
+        while (v.push(pushed)) {
+            pushed++;
+        }
+        expect_should_be(64, pushed);
+        expect_should_be(64, v.size());
+        expect_to_be_true((v.data() != nullptr));
+        expect_should_be(63, v[63]);
+        expect_to_be_false(v.reserve(1000));
+        expect_to_be_false(v.resize(1000));
+        expect_should_be(64, v.size());
+        expect_to_be_true((v.emplace_back(1u) == nullptr));
+    }
+    arena.Destroy();
+
+    arena.Create(256, nullptr);
+    {
+        // Non trivial elements, moved into a new buffer from Allocate
+        Vector<std::string> v(MEMORY_TAG_STRING, qmemory::QContainerAllocator::FromLinear(arena));
+        uint32_t pushed = 0;
+        while (v.push(std::to_string(pushed))) {
+            pushed++;
+        }
+        expect_should_be(pushed, v.size());
+        for (uint32_t i = 0; i < pushed; i++) {
+            expect_to_be_true((v[i] == std::to_string(i)));
+        }
+    }
+    arena.Destroy();
+    return TRUE;
+}
+
+void
+vector_register_tests(TestManager& manager) {
+    manager.Register(vector_push_pop_and_grow, "vector push, pop and grow");
+    manager.Register(vector_moves_elements_on_growth, "vector moves elements instead of copying");
+    manager.Register(vector_copy_and_move, "vector copy and move construct and assign");
+    manager.Register(vector_reserve_and_resize, "vector reserve and resize");
+    manager.Register(vector_uses_pluggable_allocators, "vector works with arena and dynamic allocators");
+    manager.Register(vector_keeps_contents_when_out_of_memory, "vector keeps its contents when its allocator runs out");
+}
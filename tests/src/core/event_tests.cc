@@ -0,0 +1,289 @@
+#include "event_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/events.hh>
+#include <defines.hh>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Runs the event system for one test
+struct event_scope {
+    void* memory;
+
+    event_scope() {
+        uint64_t memory_requirement = 0;
+        EventHandler::Startup(memory_requirement, nullptr);
+        memory = operator new(memory_requirement, std::align_val_t(64));
+        EventHandler::Startup(memory_requirement, memory);
+    }
+
+    ~event_scope() {
+        EventHandler::Shutdown();
+        operator delete(memory, std::align_val_t(64));
+    }
+
+    EventState* state() { return static_cast<EventState*>(memory); }
+};
+
+struct event_listener {
+    std::vector<uint32_t> received;
+    bool handles;
+};
+
+static bool
+record_event(uint16_t code, void* sender, void* listener, EventContext data) {
+    (void)code;
+    (void)sender;
+    event_listener* self = static_cast<event_listener*>(listener);
+    self->received.push_back(data.u32[0]);
+    return self->handles;
+}
+
+uint8_t events_dispatch_to_delegates() {
+    event_scope scope;
+    event_listener first = { {}, false };
+    event_listener second = { {}, true };
+    event_listener third = { {}, false };
+
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_MOUSE_MOVED, &first, record_event));
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_MOUSE_MOVED, &second, record_event));
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_MOUSE_MOVED, &third, record_event));
+    // Once per listener and code
+    expect_to_be_false(EventHandler::Register(EVENT_CODE_MOUSE_MOVED, &first, record_event));
+
+    EventContext data = {};
+    data.u32[0] = 42;
+    // second handles it, so third never sees it
+    expect_to_be_true(EventHandler::Fire(EVENT_CODE_MOUSE_MOVED, nullptr, data));
+    expect_should_be(1, first.received.size());
+    expect_should_be(42, first.received[0]);
+    expect_should_be(1, second.received.size());
+    expect_should_be(0, third.received.size());
+
+    expect_to_be_true(EventHandler::Unregister(EVENT_CODE_MOUSE_MOVED, &second));
+    expect_to_be_false(EventHandler::Unregister(EVENT_CODE_MOUSE_MOVED, &second));
+    data.u32[0] = 7;
+    expect_to_be_false(EventHandler::Fire(EVENT_CODE_MOUSE_MOVED, nullptr, data));
+    expect_should_be(2, first.received.size());
+    expect_should_be(1, third.received.size());
+    expect_should_be(7, third.received[0]);
+
+    expect_to_be_false(EventHandler::Fire(EVENT_CODE_RESIZED, nullptr, data));
+    return TRUE;
+}
+
+uint8_t events_keep_callback_registrations() {
+    event_scope scope;
+    uint32_t captured_calls = 0;
+    event_listener plain = { {}, false };
+
+    // A capturing lambda is boxed, a plain function in a std::function is not
+    CallbackFunc capturing = [&captured_calls](uint16_t, void*, void*, EventContext) {
+        captured_calls++;
+        return false;
+    };
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_KEY_PRESSED, nullptr, capturing));
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_KEY_PRESSED, &plain, CallbackFunc(record_event)));
+
+    Vector<EventDelegate>& delegates = scope.state()->listeners;
+    expect_should_be(2, delegates.size());
+    expect_to_be_true(delegates[0].callback != nullptr);
+    expect_to_be_true(delegates[1].callback == nullptr);
+    expect_to_be_true(delegates[1].on_event == record_event);
+
+    EventContext data = {};
+    for (uint32_t i = 0; i < 100; i++) {
+        EventHandler::Fire(EVENT_CODE_KEY_PRESSED, nullptr, data);
+    }
+    expect_should_be(100, captured_calls);
+    expect_should_be(100, plain.received.size());
+    return TRUE;
+}
+
+static uint32_t self_removing_calls = 0;
+
+uint8_t events_listener_unregisters_while_firing() {
+    event_scope scope;
+    event_listener after = { {}, false };
+    self_removing_calls = 0;
+
+    int32_t owner = 0;
+    CallbackFunc remove_self = [](uint16_t code, void*, void* listener, EventContext) {
+        self_removing_calls++;
+        EventHandler::Unregister(code, listener);
+        return false;
+    };
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_BUTTON_PRESSED, &owner, remove_self));
+    expect_to_be_true(EventHandler::Register(EVENT_CODE_BUTTON_PRESSED, &after, record_event));
+
+    EventContext data = {};
+    EventHandler::Fire(EVENT_CODE_BUTTON_PRESSED, nullptr, data);
+    EventHandler::Fire(EVENT_CODE_BUTTON_PRESSED, nullptr, data);
+    expect_should_be(1, self_removing_calls);
+    expect_should_be(1, scope.state()->listeners.size());
+    expect_should_be(1, scope.state()->codes[0].count);
+    expect_should_be(0, scope.state()->retired.size());
+    return TRUE;
+}
+
+uint8_t events_listeners_share_one_pool() {
+    event_scope scope;
+    event_listener listeners[6] = {};
+
+    // Registered out of code order, each code's listeners still end up next to each other
+    EventHandler::Register(EVENT_CODE_RESIZED, &listeners[0], record_event);
+    EventHandler::Register(EVENT_CODE_KEY_PRESSED, &listeners[1], record_event);
+    EventHandler::Register(EVENT_CODE_RESIZED, &listeners[2], record_event);
+    EventHandler::Register(EVENT_CODE_APPLICATION_QUIT, &listeners[3], record_event);
+    EventHandler::Register(EVENT_CODE_KEY_PRESSED, &listeners[4], record_event);
+    EventHandler::Register(9000, &listeners[5], record_event);
+
+    EventState* state = scope.state();
+    expect_should_be(4, state->codes.size());
+    expect_should_be(6, state->listeners.size());
+    const uint16_t codes[] = { EVENT_CODE_APPLICATION_QUIT, EVENT_CODE_KEY_PRESSED, EVENT_CODE_RESIZED, 9000 };
+    const uint32_t firsts[] = { 0, 1, 3, 5 };
+    for (uint32_t i = 0; i < 4; i++) {
+        expect_should_be(codes[i], state->codes[i].code);
+        expect_should_be(firsts[i], state->codes[i].first);
+    }
+    expect_to_be_true(state->listeners[1].listener == &listeners[1]);
+    expect_to_be_true(state->listeners[2].listener == &listeners[4]);
+    expect_to_be_true(state->listeners[3].listener == &listeners[0]);
+    expect_to_be_true(state->listeners[4].listener == &listeners[2]);
+    // Slots only for the two pages of codes that have listeners
+    expect_should_be(2 * EVENT_CODE_PAGE_SIZE, state->code_slots.size());
+    expect_to_be_false(EventHandler::Register(MAX_MESSAGE_CODES, &listeners[5], record_event));
+
+    EventContext data = {};
+    EventHandler::Fire(EVENT_CODE_RESIZED, nullptr, data);
+    EventHandler::Fire(9000, nullptr, data);
+    expect_should_be(1, listeners[0].received.size());
+    expect_should_be(1, listeners[2].received.size());
+    expect_should_be(1, listeners[5].received.size());
+    expect_should_be(0, listeners[1].received.size());
+
+    // A code goes away with its last listener, and the codes after it move down
+    expect_to_be_true(EventHandler::Unregister(EVENT_CODE_KEY_PRESSED, &listeners[1]));
+    expect_to_be_true(EventHandler::Unregister(EVENT_CODE_KEY_PRESSED, &listeners[4]));
+    expect_to_be_false(EventHandler::Unregister(EVENT_CODE_KEY_PRESSED, &listeners[4]));
+    expect_should_be(3, state->codes.size());
+    expect_should_be(1, state->codes[1].first);
+    expect_should_be(3, state->codes[2].first);
+    expect_to_be_false(EventHandler::Fire(EVENT_CODE_KEY_PRESSED, nullptr, data));
+    EventHandler::Fire(9000, nullptr, data);
+    expect_should_be(2, listeners[5].received.size());
+    return TRUE;
+}
+
+uint8_t events_queued_dispatch_coalesces() {
+    event_scope scope;
+    event_listener moves = { {}, false };
+    event_listener keys = { {}, false };
+    EventHandler::Register(EVENT_CODE_MOUSE_MOVED, &moves, record_event);
+    EventHandler::Register(EVENT_CODE_KEY_PRESSED, &keys, record_event);
+
+    EventContext data = {};
+    for (uint32_t i = 0; i < 100; i++) {
+        data.u32[0] = i;
+        expect_to_be_true(EventHandler::Post(EVENT_CODE_MOUSE_MOVED, nullptr, data));
+        if (i % 25 == 0) {
+            expect_to_be_true(EventHandler::Post(EVENT_CODE_KEY_PRESSED, nullptr, data));
+        }
+    }
+
+    // Nothing fires until the dispatch
+    expect_should_be(0, moves.received.size());
+    expect_should_be(4 + 1, EventHandler::DispatchQueued());
+    expect_should_be(1, moves.received.size());
+    expect_should_be(99, moves.received[0]);
+    // Not coalesced, every one arrives in order
+    expect_should_be(4, keys.received.size());
+    expect_should_be(75, keys.received[3]);
+
+    // Coalescing can be turned off per code
+    EventHandler::SetCoalesced(EVENT_CODE_MOUSE_MOVED, false);
+    EventHandler::Post(EVENT_CODE_MOUSE_MOVED, nullptr, data);
+    EventHandler::Post(EVENT_CODE_MOUSE_MOVED, nullptr, data);
+    expect_should_be(2, EventHandler::DispatchQueued());
+    expect_should_be(3, moves.received.size());
+
+    expect_should_be(0, EventHandler::DispatchQueued());
+    expect_to_be_false(EventHandler::Post(MAX_MESSAGE_CODES, nullptr, data));
+    return TRUE;
+}
+
+static uint32_t reposted = 0;
+
+static bool
+post_again(uint16_t code, void* sender, void* listener, EventContext data) {
+    (void)sender;
+    (void)listener;
+    reposted++;
+    EventHandler::Post(code + 1, nullptr, data);
+    return false;
+}
+
+uint8_t events_posted_while_dispatching_wait() {
+    event_scope scope;
+    event_listener later = { {}, false };
+    reposted = 0;
+    EventHandler::Register(EVENT_CODE_BUTTON_PRESSED, nullptr, post_again);
+    EventHandler::Register(EVENT_CODE_BUTTON_RELEASED, &later, record_event);
+
+    EventContext data = {};
+    EventHandler::Post(EVENT_CODE_BUTTON_PRESSED, nullptr, data);
+    expect_should_be(1, EventHandler::DispatchQueued());
+    expect_should_be(1, reposted);
+    expect_should_be(0, later.received.size());
+    expect_should_be(1, EventHandler::DispatchQueued());
+    expect_should_be(1, later.received.size());
+    return TRUE;
+}
+
+uint8_t events_posted_from_threads() {
+    event_scope scope;
+    event_listener listener = { {}, false };
+    EventHandler::Register(EVENT_CODE_KEY_RELEASED, &listener, record_event);
+
+    const uint32_t thread_count = 4;
+    const uint32_t per_thread = 500;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([t]() {
+            EventContext data = {};
+            for (uint32_t i = 0; i < per_thread; i++) {
+                data.u32[0] = t * per_thread + i;
+                while (!EventHandler::Post(EVENT_CODE_KEY_RELEASED, nullptr, data)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    expect_should_be(thread_count * per_thread, EventHandler::DispatchQueued());
+    std::vector<uint8_t> seen(thread_count * per_thread, 0);
+    for (uint32_t value : listener.received) {
+        seen[value]++;
+    }
+    for (uint8_t count : seen) {
+        expect_should_be(1, count);
+    }
+    return TRUE;
+}
+
+void
+event_register_tests(TestManager& manager) {
+    manager.Register(events_dispatch_to_delegates, "events dispatch to delegates in order until handled");
+    manager.Register(events_keep_callback_registrations, "events still take std::function callbacks");
+    manager.Register(events_listener_unregisters_while_firing, "events listener can unregister itself while firing");
+    manager.Register(events_listeners_share_one_pool, "events keep each code's listeners together in one pool");
+    manager.Register(events_queued_dispatch_coalesces, "queued events fire on dispatch, coalescing mouse moves");
+    manager.Register(events_posted_while_dispatching_wait, "events posted by listeners wait for the next dispatch");
+    manager.Register(events_posted_from_threads, "events can be posted from several threads");
+}
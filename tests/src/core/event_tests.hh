@@ -0,0 +1,4 @@
+#pragma once
+#include "../test_manager.hh"
+
+void event_register_tests(TestManager& manager);
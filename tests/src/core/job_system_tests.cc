@@ -0,0 +1,138 @@
+#include "job_system_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/qjobs.hh>
+#include <defines.hh>
+#include <atomic>
+#include <new>
+#include <vector>
+
+// Starts the job system with a fixed thread count for one test, so results do not depend on the machine
+struct job_system_scope {
+    void* memory;
+
+    explicit job_system_scope(uint32_t thread_count) {
+        uint64_t memory_requirement = 0;
+        JobSystem::Startup(memory_requirement, nullptr, thread_count);
+        memory = operator new(memory_requirement, std::align_val_t(64));
+        JobSystem::Startup(memory_requirement, memory, thread_count);
+    }
+
+    ~job_system_scope() {
+        JobSystem::Shutdown();
+        operator delete(memory, std::align_val_t(64));
+    }
+};
+
+static void
+add_one(void* data) {
+    static_cast<std::atomic<uint32_t>*>(data)->fetch_add(1, std::memory_order_relaxed);
+}
+
+uint8_t job_system_runs_every_job() {
+    job_system_scope scope(4);
+    expect_should_be(4, JobSystem::ThreadCount());
+    expect_should_be(0, JobSystem::ThreadIndex());
+
+    std::atomic<uint32_t> total { 0 };
+    std::vector<QJob> jobs(10000, QJob { add_one, &total });
+
+    QJobCounter counter;
+    JobSystem::Run(jobs.data(), (uint32_t)jobs.size(), &counter);
+    JobSystem::Wait(&counter);
+
+    expect_to_be_true(counter.done());
+    expect_should_be(10000, total.load());
+    return TRUE;
+}
+
+struct dependency_data {
+    std::atomic<uint32_t> first_done { 0 };
+    std::atomic<uint32_t> started_early { 0 };
+};
+
+static void
+first_stage(void* data) {
+    static_cast<dependency_data*>(data)->first_done.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void
+second_stage(void* data) {
+    dependency_data* d = static_cast<dependency_data*>(data);
+    if (d->first_done.load(std::memory_order_relaxed) != 500) {
+        d->started_early.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+uint8_t job_system_dependency_orders_batches() {
+    job_system_scope scope(4);
+
+    dependency_data data;
+    std::vector<QJob> first(500, QJob { first_stage, &data });
+    std::vector<QJob> second(500, QJob { second_stage, &data });
+
+    // Submit the second batch first so it is queued before anything it depends on has run
+    QJobCounter first_counter;
+    QJobCounter second_counter;
+    first_counter.pending.fetch_add(1);
+    JobSystem::RunAfter(&first_counter, second.data(), (uint32_t)second.size(), &second_counter);
+    JobSystem::Run(first.data(), (uint32_t)first.size(), &first_counter);
+    first_counter.pending.fetch_sub(1);
+
+    JobSystem::Wait(&second_counter);
+    expect_to_be_true(first_counter.done());
+    expect_should_be(0, data.started_early.load());
+    return TRUE;
+}
+
+struct nested_data {
+    std::atomic<uint32_t> leaves { 0 };
+};
+
+static void
+nested_parent(void* data) {
+    // Waiting inside a job must run other jobs rather than block the worker
+    QJob children[16];
+    for (uint32_t i = 0; i < 16; i++) {
+        children[i] = QJob { add_one, &static_cast<nested_data*>(data)->leaves };
+    }
+
+    QJobCounter counter;
+    JobSystem::Run(children, 16, &counter);
+    JobSystem::Wait(&counter);
+}
+
+uint8_t job_system_wait_inside_job() {
+    job_system_scope scope(3);
+
+    nested_data data;
+    std::vector<QJob> parents(64, QJob { nested_parent, &data });
+    QJobCounter counter;
+    JobSystem::Run(parents.data(), (uint32_t)parents.size(), &counter);
+    JobSystem::Wait(&counter);
+
+    expect_should_be(64 * 16, data.leaves.load());
+    return TRUE;
+}
+
+uint8_t job_system_runs_inline_before_startup() {
+    expect_to_be_false(JobSystem::GetInitialized());
+
+    std::atomic<uint32_t> total { 0 };
+    QJob jobs[3] = { { add_one, &total }, { add_one, &total }, { add_one, &total } };
+    QJobCounter counter;
+    JobSystem::Run(jobs, 3, &counter);
+
+    expect_to_be_true(counter.done());
+    expect_should_be(3, total.load());
+    return TRUE;
+}
+
+void
+job_system_register_tests(TestManager& manager) {
+    manager.Register(job_system_runs_every_job, "job system runs every submitted job");
+    manager.Register(job_system_dependency_orders_batches, "job system holds back jobs until their dependency is done");
+    manager.Register(job_system_wait_inside_job, "job system wait inside a job helps instead of blocking");
+    manager.Register(job_system_runs_inline_before_startup, "job system runs jobs inline before startup");
+}
@@ -0,0 +1,257 @@
+// Compile out Trace in this file, logger_compile_level_removes_calls checks it
+#define QLOG_COMPILE_LEVEL 4
+
+#include "logger_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/qlogger.hh>
+#include <defines.hh>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const char* test_log_path = "qlogger_test.log";
+static const char* test_binary_log_path = "qlogger_test.qlog";
+
+// Runs the asynchronous logger against a scratch file for one test
+struct logger_scope {
+    void* memory;
+    const char* path;
+
+    logger_scope(qlogger::log_format format = qlogger::LOG_FORMAT_TEXT) {
+        path = format == qlogger::LOG_FORMAT_BINARY ? test_binary_log_path : test_log_path;
+        uint64_t memory_requirement = 0;
+        qlogger::Initialize(memory_requirement, nullptr, path, format);
+        memory = operator new(memory_requirement, std::align_val_t(64));
+        qlogger::Initialize(memory_requirement, memory, path, format);
+    }
+
+    ~logger_scope() {
+        end();
+        std::remove(path);
+    }
+
+    void end() {
+        if (memory) {
+            qlogger::Shutdown(memory);
+            operator delete(memory, std::align_val_t(64));
+            memory = nullptr;
+        }
+    }
+};
+
+static std::vector<std::string>
+read_log_lines() {
+    std::vector<std::string> lines;
+    std::ifstream file(test_log_path);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+uint8_t logger_keeps_every_message_in_order() {
+    logger_scope scope;
+
+    const uint32_t thread_count = 4;
+    const uint32_t messages = 50;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([t]() {
+            for (uint32_t i = 0; i < messages; i++) {
+                qlogger::Debug("logger test thread %u message %u", t, i);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    scope.end();
+
+    // Every message arrives once and each thread's messages keep their order
+    std::vector<std::string> lines = read_log_lines();
+    expect_should_be(thread_count * messages, lines.size());
+
+    uint32_t next[thread_count] = {};
+    for (const std::string& line : lines) {
+        uint32_t t = 0;
+        uint32_t i = 0;
+        expect_should_be(2, sscanf(line.c_str(), "[DEBUG]logger test thread %u message %u", &t, &i));
+        expect_should_be(next[t], i);
+        next[t]++;
+    }
+    return TRUE;
+}
+
+uint8_t logger_more_threads_than_rings() {
+    logger_scope scope;
+
+    // More threads than the logger has rings, all alive at once so the late ones have to share
+    const uint32_t thread_count = 64;
+    const uint32_t messages = 20;
+    std::atomic<uint32_t> started { 0 };
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([t, &started]() {
+            qlogger::Debug("logger test thread %u message %u", t, 0u);
+            started.fetch_add(1);
+            while (started.load() < thread_count) {
+                std::this_thread::yield();
+            }
+            for (uint32_t i = 1; i < messages; i++) {
+                qlogger::Debug("logger test thread %u message %u", t, i);
+            }
+            qlogger::Flush();
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    scope.end();
+
+    std::vector<std::string> lines = read_log_lines();
+    expect_should_be(thread_count * messages, lines.size());
+
+    uint32_t next[thread_count] = {};
+    for (const std::string& line : lines) {
+        uint32_t t = 0;
+        uint32_t i = 0;
+        expect_should_be(2, sscanf(line.c_str(), "[DEBUG]logger test thread %u message %u", &t, &i));
+        expect_to_be_true(t < thread_count);
+        expect_should_be(next[t], i);
+        next[t]++;
+    }
+    return TRUE;
+}
+
+uint8_t logger_long_messages() {
+    logger_scope scope;
+
+    std::string medium(5000, 'm');
+    std::string huge(40000, 'h');
+    qlogger::Debug("%s", medium.c_str());
+    qlogger::Debug("%s", huge.c_str());
+    scope.end();
+
+    std::vector<std::string> lines = read_log_lines();
+    expect_should_be(2, lines.size());
+    expect_to_be_true(lines[0] == "[DEBUG]" + medium);
+    // Truncated to the longest message the logger keeps
+    expect_should_be(32000 + 7, lines[1].size());
+    return TRUE;
+}
+
+uint8_t logger_flush_writes_before_returning() {
+    logger_scope scope;
+
+    qlogger::Debug("flushed message");
+    qlogger::Flush();
+
+    std::vector<std::string> lines = read_log_lines();
+    expect_should_be(1, lines.size());
+    expect_to_be_true(lines[0] == "[DEBUG]flushed message");
+
+    // The writer moves past a record before the batch reaches the file, so give a
+    // Flush that returns too early plenty of chances to show it
+    for (uint32_t i = 0; i < 200; i++) {
+        qlogger::Debug("flushed message %u", i);
+        qlogger::Flush();
+        lines = read_log_lines();
+        expect_should_be(i + 2, lines.size());
+    }
+    return TRUE;
+}
+
+uint8_t logger_runtime_level_filters() {
+    logger_scope scope;
+
+    qlogger::SetLevel(qlogger::LOG_LEVEL_INFO);
+    expect_should_be(qlogger::LOG_ROUTE_SKIP, qlogger::Route(qlogger::LOG_LEVEL_DEBUG));
+    qlogger::Debug("dropped %d", 1);
+    qlogger::Info("kept %d", 2);
+    qlogger::SetLevel(qlogger::LOG_LEVEL_TRACE);
+    qlogger::Debug("kept %d", 3);
+    scope.end();
+
+    std::vector<std::string> lines = read_log_lines();
+    expect_should_be(2, lines.size());
+    expect_to_be_true(lines[0] == "[INFO]kept 2");
+    expect_to_be_true(lines[1] == "[DEBUG]kept 3");
+    return TRUE;
+}
+
+static int32_t evaluated_arguments = 0;
+
+static int32_t
+count_evaluation() {
+    return ++evaluated_arguments;
+}
+
+uint8_t logger_compile_level_removes_calls() {
+    logger_scope scope;
+
+    // The call is gone, but its arguments are still evaluated
+    qlogger::Trace("compiled out %d", count_evaluation());
+    qlogger::Debug("compiled in");
+    scope.end();
+
+    expect_should_be(1, evaluated_arguments);
+    std::vector<std::string> lines = read_log_lines();
+    expect_should_be(1, lines.size());
+    expect_to_be_true(lines[0] == "[DEBUG]compiled in");
+    return TRUE;
+}
+
+uint8_t logger_binary_round_trip() {
+    logger_scope scope(qlogger::LOG_FORMAT_BINARY);
+    expect_should_be(qlogger::LOG_ROUTE_BINARY, qlogger::Route(qlogger::LOG_LEVEL_DEBUG));
+
+    std::string name = "pegasus";
+    const char* format = "runtime format %d";
+    int32_t value = 7;
+    for (int32_t i = 0; i < 3; i++) {
+        qlogger::Debug("frame %d took %.3f ms, %u entities", i, 16.5 + i, 100u + i);
+    }
+    qlogger::Info("%s at %p with %lld and %c%%", name.c_str(), static_cast<void*>(&value), -12345678912ll, 'x');
+    qlogger::Debug("%-6s|%5d|%x|%e", "ab", -3, 255u, 0.5f);
+    qlogger::Debug(format, 42);
+    scope.end();
+
+    std::ifstream file(test_binary_log_path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string decoded;
+    expect_to_be_true(qlog_binary::decode(data.data(), data.size(), decoded));
+
+    char pointer[32];
+    snprintf(pointer, sizeof(pointer), "%p", static_cast<void*>(&value));
+    std::string expected =
+        "[DEBUG]frame 0 took 16.500 ms, 100 entities\n"
+        "[DEBUG]frame 1 took 17.500 ms, 101 entities\n"
+        "[DEBUG]frame 2 took 18.500 ms, 102 entities\n"
+        "[INFO]pegasus at " + std::string(pointer) + " with -12345678912 and x%\n"
+        "[DEBUG]ab    |   -3|ff|5.000000e-01\n"
+        "[DEBUG]runtime format 42\n";
+    expect_to_be_true(decoded == expected);
+
+    // Not a binary log
+    expect_to_be_false(qlog_binary::decode(reinterpret_cast<const uint8_t*>("[DEBUG]x\n"), 9, decoded));
+    return TRUE;
+}
+
+void
+logger_register_tests(TestManager& manager) {
+    manager.Register(logger_keeps_every_message_in_order, "async logger keeps every message from every thread in order");
+    manager.Register(logger_more_threads_than_rings, "async logger keeps messages from threads that share a ring");
+    manager.Register(logger_long_messages, "async logger handles messages longer than its stack buffer");
+    manager.Register(logger_flush_writes_before_returning, "async logger flush waits for the writer");
+    manager.Register(logger_runtime_level_filters, "logger drops messages above the runtime level");
+    manager.Register(logger_compile_level_removes_calls, "logger compiles out calls above QLOG_COMPILE_LEVEL");
+    manager.Register(logger_binary_round_trip, "binary log decodes to the same text as printf");
+}
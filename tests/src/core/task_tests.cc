@@ -0,0 +1,136 @@
+#include "task_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/qjobs.hh>
+#include <core/qtask.hh>
+#include <defines.hh>
+#include <atomic>
+#include <new>
+#include <thread>
+#include <vector>
+
+// Starts the job system with a fixed thread count for one test
+struct task_scope {
+    void* memory;
+
+    explicit task_scope(uint32_t thread_count) {
+        uint64_t memory_requirement = 0;
+        JobSystem::Startup(memory_requirement, nullptr, thread_count);
+        memory = operator new(memory_requirement, std::align_val_t(64));
+        JobSystem::Startup(memory_requirement, memory, thread_count);
+    }
+
+    ~task_scope() {
+        JobSystem::Shutdown();
+        operator delete(memory, std::align_val_t(64));
+    }
+};
+
+struct fan_out_data {
+    std::atomic<uint32_t> leaves { 0 };
+    std::atomic<uint32_t> finished { 0 };
+    std::atomic<uint32_t> early { 0 };
+};
+
+static void
+count_leaf(void* data) {
+    static_cast<fan_out_data*>(data)->leaves.fetch_add(1, std::memory_order_relaxed);
+}
+
+static QTask
+fan_out(fan_out_data* data) {
+    QJob jobs[8];
+    for (uint32_t i = 0; i < 8; i++) {
+        jobs[i] = QJob { count_leaf, data };
+    }
+
+    QJobCounter children;
+    JobSystem::Run(jobs, 8, &children);
+    co_await QWaitCounter { &children };
+
+    if (!children.done()) {
+        data->early.fetch_add(1, std::memory_order_relaxed);
+    }
+    data->finished.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint8_t task_awaits_counter() {
+    task_scope scope(4);
+
+    fan_out_data data;
+    QJobCounter tasks;
+    for (uint32_t i = 0; i < 32; i++) {
+        JobSystem::Spawn(fan_out(&data), &tasks);
+    }
+    JobSystem::Wait(&tasks);
+
+    expect_should_be(32, data.finished.load());
+    expect_should_be(32 * 8, data.leaves.load());
+    expect_should_be(0, data.early.load());
+    return TRUE;
+}
+
+struct gate_data {
+    std::atomic<bool> open { false };
+    std::atomic<uint32_t> waiting { 0 };
+    std::atomic<uint32_t> passed { 0 };
+};
+
+static bool
+gate_open(void* data) {
+    return static_cast<gate_data*>(data)->open.load(std::memory_order_acquire);
+}
+
+static QTask
+wait_at_gate(gate_data* gate) {
+    gate->waiting.fetch_add(1, std::memory_order_relaxed);
+    co_await QWaitUntil { gate_open, gate };
+    gate->passed.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint8_t task_suspends_without_holding_a_thread() {
+    // Far more waiting tasks than threads. If a wait held its thread this would never get past the first two
+    task_scope scope(2);
+
+    gate_data gate;
+    QJobCounter tasks;
+    for (uint32_t i = 0; i < 64; i++) {
+        JobSystem::Spawn(wait_at_gate(&gate), &tasks);
+    }
+
+    while (gate.waiting.load() != 64) {
+        if (!JobSystem::RunPending()) {
+            std::this_thread::yield();
+        }
+    }
+    expect_should_be(0, gate.passed.load());
+
+    gate.open.store(true, std::memory_order_release);
+    JobSystem::Wait(&tasks);
+    expect_should_be(64, gate.passed.load());
+    return TRUE;
+}
+
+static QTask
+never_started(uint32_t* value) {
+    *value = 1;
+    co_return;
+}
+
+uint8_t task_not_spawned_is_destroyed() {
+    uint32_t value = 0;
+    {
+        QTask task = never_started(&value);
+    }
+    // The body never ran and ASan reports the frame if it leaked
+    expect_should_be(0, value);
+    return TRUE;
+}
+
+void
+task_register_tests(TestManager& manager) {
+    manager.Register(task_awaits_counter, "task co_awaits the counter of jobs it started");
+    manager.Register(task_suspends_without_holding_a_thread, "waiting tasks do not hold job threads");
+    manager.Register(task_not_spawned_is_destroyed, "task that is never spawned is destroyed");
+}
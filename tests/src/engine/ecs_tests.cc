@@ -0,0 +1,290 @@
+#include "ecs_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <engine/ecs.hh>
+#include <engine/components.hh>
+#include <core/qjobs.hh>
+#include <defines.hh>
+#include <atomic>
+#include <new>
+#include <vector>
+
+using namespace Pegasus;
+
+struct ecs_velocity {
+    float x, y, z;
+};
+
+struct ecs_health {
+    int32_t value;
+};
+
+struct ecs_frozen {
+    uint8_t unused;
+};
+
+// Big enough that a chunk only holds 16, so the tests cross chunk boundaries quickly
+struct ecs_payload {
+    uint32_t id;
+    uint8_t bytes[1000];
+};
+
+// Same as the job system tests: a fixed thread count for one test
+struct ecs_job_scope {
+    void* memory;
+
+    explicit ecs_job_scope(uint32_t thread_count) {
+        uint64_t memory_requirement = 0;
+        JobSystem::Startup(memory_requirement, nullptr, thread_count);
+        memory = operator new(memory_requirement, std::align_val_t(64));
+        JobSystem::Startup(memory_requirement, memory, thread_count);
+    }
+
+    ~ecs_job_scope() {
+        JobSystem::Shutdown();
+        operator delete(memory, std::align_val_t(64));
+    }
+};
+
+uint8_t ecs_create_destroy_generations() {
+    World world;
+    Entity a = world.Create();
+    Entity b = world.Create(ecs_health { 7 });
+    expect_should_be(2, world.EntityCount());
+    expect_to_be_true(world.IsAlive(a));
+    expect_to_be_true(world.IsAlive(b));
+    expect_should_be(7, world.Get<ecs_health>(b)->value);
+    expect_to_be_true((world.Get<ecs_health>(a) == nullptr));
+
+    expect_to_be_true(world.Destroy(a));
+    expect_to_be_false(world.IsAlive(a));
+    expect_to_be_false(world.Destroy(a));
+    expect_should_be(1, world.EntityCount());
+
+    // The index comes back with the next generation, so the old handle stays dead
+    Entity c = world.Create();
+    expect_should_be(a.index, c.index);
+    expect_should_not_be(a.generation, c.generation);
+    expect_to_be_false(world.IsAlive(a));
+    expect_to_be_true(world.IsAlive(c));
+    expect_to_be_false(world.IsAlive(NULL_ENTITY));
+    expect_to_be_true((world.Get<ecs_health>(a) == nullptr));
+    return TRUE;
+}
+
+uint8_t ecs_component_ids_shared_by_name() {
+    // A second module caches its own copy of component_id's static, but asks the engine by name
+    const ComponentId position = component_id<Position>();
+    expect_should_be(position, ecs_detail::register_component(ecs_detail::type_name<Position>(), sizeof(Position), alignof(Position)));
+    expect_should_be(component_id<ecs_health>(), ecs_detail::register_component(ecs_detail::type_name<ecs_health>(), sizeof(ecs_health), alignof(ecs_health)));
+    expect_should_not_be(position, component_id<ecs_health>());
+    return TRUE;
+}
+
+uint8_t ecs_add_remove_keeps_components() {
+    World world;
+    Entity e = world.Create(Position { qmath::Vec3<float>::New(1.f, 2.f, 3.f) });
+
+    expect_to_be_true(world.Add(e, ecs_health { 40 }));
+    expect_to_be_true(world.Add(e, ecs_velocity { 4.f, 5.f, 6.f }));
+    expect_float_to_be(2.f, world.Get<Position>(e)->value.y);
+    expect_should_be(40, world.Get<ecs_health>(e)->value);
+    expect_float_to_be(6.f, world.Get<ecs_velocity>(e)->z);
+
+    // Adding what is already there overwrites in place
+    const uint32_t archetypes = world.ArchetypeCount();
+    expect_to_be_true(world.Add(e, ecs_health { 41 }));
+    expect_should_be(41, world.Get<ecs_health>(e)->value);
+    expect_should_be(archetypes, world.ArchetypeCount());
+
+    expect_to_be_true(world.Remove<ecs_health>(e));
+    expect_to_be_false(world.Has<ecs_health>(e));
+    expect_to_be_false(world.Remove<ecs_health>(e));
+    expect_float_to_be(3.f, world.Get<Position>(e)->value.z);
+    expect_float_to_be(4.f, world.Get<ecs_velocity>(e)->x);
+
+    // Going back and forth reuses the archetypes and the edges between them
+    const uint32_t all_archetypes = world.ArchetypeCount();
+    expect_to_be_true(world.Add(e, ecs_health { 1 }));
+    expect_to_be_true(world.Remove<ecs_health>(e));
+    expect_should_be(all_archetypes, world.ArchetypeCount());
+
+    world.Destroy(e);
+    expect_to_be_false(world.Add(e, ecs_health { 1 }));
+    expect_to_be_false(world.Remove<ecs_velocity>(e));
+    return TRUE;
+}
+
+uint8_t ecs_destroy_keeps_chunks_packed() {
+    World world;
+    std::vector<Entity> entities;
+    for (uint32_t i = 0; i < 100; i++) {
+        entities.push_back(world.Create(ecs_payload { i, {} }));
+    }
+
+    const Archetype& archetype = world.GetArchetype(world.ArchetypeCount() - 1);
+    const uint32_t capacity = archetype.capacity;
+    expect_to_be_true((capacity > 1 && capacity < 100));
+    expect_should_be((100 + capacity - 1) / capacity, archetype.chunks.size());
+
+    // Every other entity goes, the survivors keep their data and end up packed at the front
+    for (uint32_t i = 0; i < 100; i += 2) {
+        expect_to_be_true(world.Destroy(entities[i]));
+    }
+    expect_should_be(50, archetype.count);
+    expect_should_be((50 + capacity - 1) / capacity, archetype.chunks.size());
+    for (uint32_t i = 1; i < 100; i += 2) {
+        expect_should_be(i, world.Get<ecs_payload>(entities[i])->id);
+    }
+
+    Query query = world.CreateQuery(component_mask<ecs_payload>());
+    uint32_t seen = 0;
+    uint32_t chunks = 0;
+    world.ForEachChunk(query, [&](const ChunkView& chunk) {
+        const ecs_payload* payloads = chunk.Get<ecs_payload>();
+        for (uint32_t i = 0; i < chunk.count; i++) {
+            if (world.Get<ecs_payload>(chunk.entities[i]) == &payloads[i]) {
+                seen++;
+            }
+        }
+        chunks++;
+    });
+    expect_should_be(50, seen);
+    expect_should_be(archetype.chunks.size(), chunks);
+
+    for (uint32_t i = 1; i < 100; i += 2) {
+        world.Destroy(entities[i]);
+    }
+    expect_should_be(0, archetype.chunks.size());
+    return TRUE;
+}
+
+uint8_t ecs_queries_follow_new_archetypes() {
+    World world;
+    Query moving = world.CreateQuery(component_mask<Position, ecs_velocity>());
+    Query thawed = world.CreateQuery(component_mask<Position>(), component_mask<ecs_frozen>());
+    expect_should_be(0, world.Count(moving));
+
+    // The same masks give back the same query
+    expect_should_be(moving.index, world.CreateQuery(component_mask<Position, ecs_velocity>()).index);
+
+    Entity a = world.Create(Position {}, ecs_velocity { 1.f, 0.f, 0.f });
+    Entity b = world.Create(Position {}, ecs_velocity { 2.f, 0.f, 0.f }, ecs_health { 3 });
+    Entity c = world.Create(Position {});
+    expect_should_be(2, world.Count(moving));
+    expect_should_be(3, world.Count(thawed));
+
+    world.Add(c, ecs_frozen {});
+    world.Add(a, ecs_frozen {});
+    expect_should_be(2, world.Count(moving));
+    expect_should_be(1, world.Count(thawed));
+
+    float total = 0.f;
+    world.Each<Position, ecs_velocity>(moving, [&](Entity, Position& position, ecs_velocity& velocity) {
+        position.value.x += velocity.x;
+        total += velocity.x;
+    });
+    expect_float_to_be(3.f, total);
+    expect_float_to_be(1.f, world.Get<Position>(a)->value.x);
+    expect_float_to_be(2.f, world.Get<Position>(b)->value.x);
+    expect_float_to_be(0.f, world.Get<Position>(c)->value.x);
+    return TRUE;
+}
+
+uint8_t ecs_parallel_each_visits_every_entity() {
+    ecs_job_scope scope(4);
+    World world;
+    for (uint32_t i = 0; i < 5000; i++) {
+        world.Create(Position { qmath::Vec3<float>::New(static_cast<float>(i), 0.f, 0.f) }, ecs_velocity { 1.f, 2.f, 3.f });
+    }
+    for (uint32_t i = 0; i < 1000; i++) {
+        world.Create(Position {}, ecs_velocity { 1.f, 2.f, 3.f }, ecs_health { 0 });
+    }
+
+    Query query = world.CreateQuery(component_mask<Position, ecs_velocity>());
+    std::atomic<uint32_t> visited { 0 };
+    world.ParallelEach<Position, ecs_velocity>(query, [&visited](Entity, Position& position, const ecs_velocity& velocity) {
+        position.value.y += velocity.y;
+        visited.fetch_add(1, std::memory_order_relaxed);
+    });
+    expect_should_be(6000, visited.load());
+
+    uint32_t moved = 0;
+    world.Each<Position>(query, [&moved](Entity, const Position& position) {
+        if (position.value.y == 2.f) {
+            moved++;
+        }
+    });
+    expect_should_be(6000, moved);
+    return TRUE;
+}
+
+uint8_t ecs_parallel_each_reuses_its_scratch() {
+    uint64_t requirement = 0;
+    QAllocator::Initialize(requirement, nullptr);
+    std::vector<uint8_t> memory_state(requirement);
+    QAllocator::Initialize(requirement, memory_state.data());
+    {
+        ecs_job_scope scope(4);
+        World world;
+        for (uint32_t i = 0; i < 2000; i++) {
+            world.Create(Position {}, ecs_velocity { 1.f, 0.f, 0.f });
+        }
+        Query query = world.CreateQuery(component_mask<Position, ecs_velocity>());
+        auto step = [](Entity, Position& position, const ecs_velocity& velocity) {
+            position.value.x += velocity.x;
+        };
+
+        // The first run sizes the scratch, every later frame allocates nothing
+        world.ParallelEach<Position, ecs_velocity>(query, step);
+        const uint64_t allocations = QAllocator::AllocationCount();
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            world.ParallelEach<Position, ecs_velocity>(query, step);
+        }
+        expect_should_be(allocations, QAllocator::AllocationCount());
+
+        uint32_t moved = 0;
+        world.Each<Position>(query, [&moved](Entity, const Position& position) {
+            moved += position.value.x == 11.f;
+        });
+        expect_should_be(2000, moved);
+    }
+    QAllocator::Shutdown();
+    return TRUE;
+}
+
+uint8_t ecs_transform_system_composes() {
+    World world;
+    Query query = TransformSystem::CreateQuery(world);
+
+    const qmath::Vec3<float> position = qmath::Vec3<float>::New(1.f, 2.f, 3.f);
+    const qmath::Quaternion<float> rotation = qmath::Quaternion<float>::FromAxisAngle(qmath::Vec3<float>::New(0.f, 0.f, 1.f), 0.5f, true);
+    const qmath::Vec3<float> scale = qmath::Vec3<float>::New(2.f, 3.f, 4.f);
+
+    Entity full = world.Create(Position { position }, Rotation { rotation }, Scale { scale }, LocalToWorld {});
+    Entity moved = world.Create(Position { position }, LocalToWorld {});
+    Entity ignored = world.Create(Position { position });
+    TransformSystem::Update(world, query);
+
+    const qmath::Mat4<float> expected = qmath::scalar::compose_trs(position, rotation, scale);
+    const qmath::Mat4<float> translation = qmath::Mat4<float>::GetTranslation(position);
+    for (uint32_t i = 0; i < 16; i++) {
+        expect_float_to_be(expected.data[i], world.Get<LocalToWorld>(full)->value.data[i]);
+        expect_float_to_be(translation.data[i], world.Get<LocalToWorld>(moved)->value.data[i]);
+    }
+    expect_to_be_false(world.Has<LocalToWorld>(ignored));
+    return TRUE;
+}
+
+void
+ecs_register_tests(TestManager& manager) {
+    manager.Register(ecs_create_destroy_generations, "ecs entities are created, destroyed and reused with a new generation");
+    manager.Register(ecs_component_ids_shared_by_name, "ecs component ids come from the engine, keyed by type name");
+    manager.Register(ecs_add_remove_keeps_components, "ecs adding and removing components keeps the others");
+    manager.Register(ecs_destroy_keeps_chunks_packed, "ecs destroying entities keeps chunks packed");
+    manager.Register(ecs_queries_follow_new_archetypes, "ecs cached queries pick up archetypes made after them");
+    manager.Register(ecs_parallel_each_visits_every_entity, "ecs parallel each visits every matching entity once");
+    manager.Register(ecs_parallel_each_reuses_its_scratch, "ecs parallel each allocates nothing once warmed up");
+    manager.Register(ecs_transform_system_composes, "ecs transform system builds local to world matrices");
+}
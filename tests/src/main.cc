@@ -1,12 +1,76 @@
 #include "test_manager.hh"
 #include "memory/linear_allocator_tests.hh"
+#include "memory/size_class_allocator_tests.hh"
+#include "memory/pool_allocator_tests.hh"
+#include "memory/memory_stats_tests.hh"
+#include "memory/dynamic_allocator_tests.hh"
+#include "memory/allocation_tracker_tests.hh"
+#include "containers/vector_tests.hh"
+#include "containers/hashmap_tests.hh"
+#include "containers/ring_queue_tests.hh"
+#include "core/job_system_tests.hh"
+#include "core/task_tests.hh"
+#include "core/logger_tests.hh"
+#include "core/event_tests.hh"
+#include "platform/file_system_tests.hh"
+#include "resources/pack_tests.hh"
+#include "qmath/qmath_tests.hh"
+#include "engine/ecs_tests.hh"
+#include "benchmarks/dynamic_allocator_benchmarks.hh"
+#include "benchmarks/vector_benchmarks.hh"
+#include "benchmarks/hashmap_benchmarks.hh"
+#include "benchmarks/ring_queue_benchmarks.hh"
+#include "benchmarks/event_benchmarks.hh"
+#include "benchmarks/qmath_benchmarks.hh"
+#include "benchmarks/ecs_benchmarks.hh"
 #include <core/qlogger.hh>
+#include <core/qmemory.hh>
+#include <cstring>
+#include <vector>
 
-int main(void) {
+int main(int argc, char** argv) {
     TestManager manager = TestManager();
 
+    // Benchmarks are slow, so they only run when asked for with --bench
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        // Measure with the memory system up, as it is in the engine
+        uint64_t memory_requirement = 0;
+        QAllocator::Initialize(memory_requirement, nullptr);
+        std::vector<uint8_t> memory_state(memory_requirement);
+        QAllocator::Initialize(memory_requirement, memory_state.data());
+
+        dynamic_allocator_register_benchmarks(manager);
+        vector_register_benchmarks(manager);
+        hashmap_register_benchmarks(manager);
+        ring_queue_register_benchmarks(manager);
+        event_register_benchmarks(manager);
+        qmath_register_benchmarks(manager);
+        ecs_register_benchmarks(manager);
+
+        qlogger::Debug("Starting benchmarks...");
+        manager.RunTests();
+        QAllocator::Shutdown();
+        return 0;
+    }
+
     // TODO: Register tests
     linear_allocator_register_tests(manager);
+    size_class_allocator_register_tests(manager);
+    pool_allocator_register_tests(manager);
+    memory_stats_register_tests(manager);
+    dynamic_allocator_register_tests(manager);
+    allocation_tracker_register_tests(manager);
+    vector_register_tests(manager);
+    hashmap_register_tests(manager);
+    ring_queue_register_tests(manager);
+    job_system_register_tests(manager);
+    task_register_tests(manager);
+    logger_register_tests(manager);
+    event_register_tests(manager);
+    file_system_register_tests(manager);
+    pack_register_tests(manager);
+    qmath_register_tests(manager);
+    ecs_register_tests(manager);
 
     qlogger::Debug("Starting tests...");
 
@@ -0,0 +1,181 @@
+#include "allocation_tracker_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/qmemory.hh>
+#include <memory/qallocation_tracker.hh>
+#include <containers/qvector.inl>
+#include <containers/qhashmap.inl>
+#include <defines.hh>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+uint8_t allocation_tracker_records_call_sites() {
+    QAllocator::SetTracking(true);
+    expect_to_be_true(QAllocator::IsTracking());
+
+    void* small_blocks[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        small_blocks[i] = QAllocator::Allocate(1, 64, MEMORY_TAG_ENTITY);
+    }
+    const uint32_t large_line = __LINE__ + 1;
+    void* large_block = QAllocator::Allocate(1, 4096, MEMORY_TAG_TEXTURE);
+
+    qmemory::allocation_site_report sites[8];
+    uint32_t count = qmemory::QAllocationTracker::LiveSites(sites, 8);
+    expect_should_be(2, count);
+
+    // Largest site first, pointing back at this file
+    expect_should_be(large_line, sites[0].line);
+    expect_should_be(4096, sites[0].bytes);
+    expect_should_be(1, sites[0].count);
+    expect_should_be(MEMORY_TAG_TEXTURE, sites[0].tag);
+    expect_to_be_true(strstr(sites[0].file, "allocation_tracker_tests.cc") != nullptr);
+    expect_should_be(256, sites[1].bytes);
+    expect_should_be(4, sites[1].count);
+
+    for (uint32_t i = 0; i < 4; i++) {
+        QAllocator::Free(small_blocks[i], 64, MEMORY_TAG_ENTITY);
+    }
+    count = qmemory::QAllocationTracker::LiveSites(sites, 8);
+    expect_should_be(1, count);
+
+    std::string report = QAllocator::GetLeakReport();
+    expect_to_be_true(report.find("allocation_tracker_tests.cc:" + std::to_string(large_line)) != std::string::npos);
+
+    QAllocator::Free(large_block, 4096, MEMORY_TAG_TEXTURE);
+    expect_should_be(0, qmemory::QAllocationTracker::LiveSites(sites, 8));
+
+    QAllocator::SetTracking(false);
+    expect_to_be_false(QAllocator::IsTracking());
+    return TRUE;
+}
+
+uint8_t allocation_tracker_reports_last_frame() {
+    QAllocator::SetTracking(true);
+    qmemory::QAllocationTracker::NextFrame();
+
+    // Churn that is freed within the frame never shows up as live, but is counted per frame
+    for (uint32_t i = 0; i < 10; i++) {
+        QAllocator::Free(QAllocator::Allocate(1, 32, MEMORY_TAG_GAME), 32, MEMORY_TAG_GAME);
+    }
+    for (uint32_t i = 0; i < 3; i++) {
+        QAllocator::Free(QAllocator::Allocate(1, 16, MEMORY_TAG_GAME), 16, MEMORY_TAG_GAME);
+    }
+
+    qmemory::allocation_site_report sites[8];
+    expect_should_be(0, qmemory::QAllocationTracker::FrameSites(sites, 8));
+
+    qmemory::QAllocationTracker::NextFrame();
+    uint32_t count = qmemory::QAllocationTracker::FrameSites(sites, 8);
+    expect_should_be(2, count);
+    expect_should_be(10, sites[0].count);
+    expect_should_be(320, sites[0].bytes);
+    expect_should_be(3, sites[1].count);
+
+    // Keeping only the top site
+    expect_should_be(1, qmemory::QAllocationTracker::FrameSites(sites, 1));
+    expect_should_be(10, sites[0].count);
+
+    // A quiet frame clears the report
+    qmemory::QAllocationTracker::NextFrame();
+    expect_should_be(0, qmemory::QAllocationTracker::FrameSites(sites, 8));
+
+    QAllocator::SetTracking(false);
+    return TRUE;
+}
+
+uint8_t allocation_tracker_survives_table_growth() {
+    QAllocator::SetTracking(true);
+
+    // Well past the initial table size, freed out of order to leave tombstones behind
+    const uint32_t block_count = 20000;
+    std::vector<void*> blocks(block_count);
+    for (uint32_t i = 0; i < block_count; i++) {
+        blocks[i] = QAllocator::Allocate(1, 16, MEMORY_TAG_ARRAY);
+    }
+    for (uint32_t i = 0; i < block_count; i += 2) {
+        QAllocator::Free(blocks[i], 16, MEMORY_TAG_ARRAY);
+    }
+
+    qmemory::allocation_site_report sites[4];
+    expect_should_be(1, qmemory::QAllocationTracker::LiveSites(sites, 4));
+    expect_should_be(block_count / 2, sites[0].count);
+
+    for (uint32_t i = 1; i < block_count; i += 2) {
+        QAllocator::Free(blocks[i], 16, MEMORY_TAG_ARRAY);
+    }
+    expect_should_be(0, qmemory::QAllocationTracker::LiveSites(sites, 4));
+
+    QAllocator::SetTracking(false);
+    return TRUE;
+}
+
+// Whether a live site points at line of this file
+static bool
+has_site(const qmemory::allocation_site_report* sites, uint32_t count, uint32_t line) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (sites[i].line == line && strstr(sites[i].file, "allocation_tracker_tests.cc") != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t allocation_tracker_credits_container_callers() {
+    QAllocator::SetTracking(true);
+    {
+        // Reallocate path
+        Vector<uint32_t> numbers(MEMORY_TAG_DARRAY);
+        const uint32_t push_line = __LINE__ + 1;
+        numbers.push(1);
+
+        // Allocate and move path
+        Vector<std::string> names(MEMORY_TAG_STRING);
+        const uint32_t reserve_line = __LINE__ + 1;
+        names.reserve(8);
+
+        HashMap<uint32_t, uint32_t> map(MEMORY_TAG_DICT);
+        const uint32_t insert_line = __LINE__ + 1;
+        map.insert(1, 2);
+
+        qmemory::allocation_site_report sites[8];
+        uint32_t count = qmemory::QAllocationTracker::LiveSites(sites, 8);
+        expect_should_be(3, count);
+        expect_to_be_true(has_site(sites, count, push_line));
+        expect_to_be_true(has_site(sites, count, reserve_line));
+        expect_to_be_true(has_site(sites, count, insert_line));
+    }
+    QAllocator::SetTracking(false);
+    return TRUE;
+}
+
+uint8_t allocation_tracker_is_opt_in() {
+    // Not turned on just because the build defines _QDEBUG, only when asked for
+    unsetenv("PEGASUS_TRACK_ALLOCATIONS");
+    uint64_t requirement = 0;
+    QAllocator::Initialize(requirement, nullptr);
+    std::vector<uint8_t> state(requirement);
+    QAllocator::Initialize(requirement, state.data());
+    expect_to_be_false(QAllocator::IsTracking());
+    QAllocator::Shutdown();
+
+    setenv("PEGASUS_TRACK_ALLOCATIONS", "1", 1);
+    QAllocator::Initialize(requirement, state.data());
+    expect_to_be_true(QAllocator::IsTracking());
+    QAllocator::Shutdown();
+    unsetenv("PEGASUS_TRACK_ALLOCATIONS");
+    expect_to_be_false(QAllocator::IsTracking());
+    return TRUE;
+}
+
+void
+allocation_tracker_register_tests(TestManager& manager) {
+    manager.Register(allocation_tracker_records_call_sites, "allocation tracker groups live blocks by call site");
+    manager.Register(allocation_tracker_reports_last_frame, "allocation tracker reports top allocators of the last frame");
+    manager.Register(allocation_tracker_survives_table_growth, "allocation tracker keeps blocks across table growth");
+    manager.Register(allocation_tracker_credits_container_callers, "allocation tracker credits container growth to the caller");
+    manager.Register(allocation_tracker_is_opt_in, "allocation tracker only starts when asked for");
+}
@@ -0,0 +1,145 @@
+#include "dynamic_allocator_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <memory/qdynamic_allocator.hh>
+#include <core/qmemory.hh>
+#include <defines.hh>
+
+static void*
+create_dynamic_allocator(qmemory::QDynamicAllocator& allocator, uint64_t size, uint64_t& memory_requirement) {
+    allocator.Create(size, memory_requirement, nullptr);
+    void* memory = QAllocator::Allocate(1, memory_requirement, MEMORY_TAG_APPLICATION);
+    allocator.Create(size, memory_requirement, memory);
+    return memory;
+}
+
+uint8_t dynamic_allocator_should_create_and_destroy() {
+    qmemory::QDynamicAllocator allocator;
+    uint64_t memory_requirement = 0;
+    expect_to_be_true(allocator.Create(1024 * 1024, memory_requirement, nullptr));
+    expect_to_be_true(memory_requirement > 1024 * 1024);
+
+    void* memory = QAllocator::Allocate(1, memory_requirement, MEMORY_TAG_APPLICATION);
+    expect_to_be_true(allocator.Create(1024 * 1024, memory_requirement, memory));
+    expect_should_be(1024 * 1024, allocator.total_size);
+    expect_should_be(1024 * 1024, allocator.FreeSpace());
+
+    allocator.Destroy();
+    expect_should_be(0, allocator.memory);
+    QAllocator::Free(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+uint8_t dynamic_allocator_allocate_and_free_in_any_order() {
+    qmemory::QDynamicAllocator allocator;
+    uint64_t memory_requirement = 0;
+    void* memory = create_dynamic_allocator(allocator, 64 * 1024, memory_requirement);
+
+    void* blocks[16];
+    for (uint32_t i = 0; i < 16; i++) {
+        blocks[i] = allocator.Allocate(100 + i * 37);
+        expect_should_not_be(0, blocks[i]);
+        expect_to_be_true(allocator.BlockSize(blocks[i]) >= 100 + i * 37);
+        expect_should_be(0, reinterpret_cast<uintptr_t>(blocks[i]) % 16);
+        QAllocator::Set(blocks[i], static_cast<int32_t>(i), 100 + i * 37);
+    }
+
+    // Free every other block, then the rest in reverse. Neighbours must not have been touched
+    for (uint32_t i = 0; i < 16; i += 2) {
+        expect_to_be_true(allocator.Free(blocks[i]));
+    }
+    for (uint32_t i = 1; i < 16; i += 2) {
+        expect_should_be(i, static_cast<uint8_t*>(blocks[i])[99 + i * 37]);
+    }
+    for (int32_t i = 15; i > 0; i -= 2) {
+        expect_to_be_true(allocator.Free(blocks[i]));
+    }
+
+    // Everything coalesced back into a single block
+    expect_should_be(64 * 1024, allocator.FreeSpace());
+    expect_should_not_be(0, allocator.Allocate(64 * 1024));
+
+    allocator.Destroy();
+    QAllocator::Free(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+uint8_t dynamic_allocator_respects_alignment() {
+    qmemory::QDynamicAllocator allocator;
+    uint64_t memory_requirement = 0;
+    void* memory = create_dynamic_allocator(allocator, 64 * 1024, memory_requirement);
+
+    uint64_t alignments[] = { 16, 32, 64, 256, 4096 };
+    void* blocks[5];
+    for (uint32_t i = 0; i < 5; i++) {
+        blocks[i] = allocator.Allocate(24, alignments[i]);
+        expect_should_not_be(0, blocks[i]);
+        expect_should_be(0, reinterpret_cast<uintptr_t>(blocks[i]) % alignments[i]);
+    }
+    expect_should_be(0, allocator.Allocate(16, 3));
+
+    for (uint32_t i = 0; i < 5; i++) {
+        expect_to_be_true(allocator.Free(blocks[i]));
+    }
+    expect_should_be(64 * 1024, allocator.FreeSpace());
+
+    allocator.Destroy();
+    QAllocator::Free(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+uint8_t dynamic_allocator_out_of_memory_returns_null() {
+    qmemory::QDynamicAllocator allocator;
+    uint64_t memory_requirement = 0;
+    void* memory = create_dynamic_allocator(allocator, 4096, memory_requirement);
+
+    expect_should_be(0, allocator.Allocate(8192));
+    void* block = allocator.Allocate(4096);
+    expect_should_not_be(0, block);
+    expect_should_be(0, allocator.Allocate(16));
+    expect_should_be(0, allocator.FreeSpace());
+
+    expect_to_be_true(allocator.Free(block));
+    expect_to_be_false(allocator.Free(block));
+
+    int32_t outside = 0;
+    expect_to_be_false(allocator.Free(&outside));
+
+    allocator.Destroy();
+    QAllocator::Free(memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+uint8_t dynamic_allocator_rejects_pool_of_max_block_size() {
+    qmemory::QDynamicAllocator allocator;
+    uint64_t memory_requirement = 0;
+    const uint64_t four_gib = uint64_t(1) << 32;
+
+    // Rejected before the memory is touched, so no real 4 GiB buffer is needed
+    uint8_t memory[64];
+    qlogger::Debug("Following error is meant to be caused by test");
+    expect_to_be_false(allocator.Create(four_gib, memory_requirement, memory));
+    qlogger::Debug("Following error is meant to be caused by test");
+    expect_to_be_false(allocator.Create(four_gib - 1, memory_requirement, memory));
+
+    // Only asking for the requirement always works
+    expect_to_be_true(allocator.Create(four_gib, memory_requirement, nullptr));
+    expect_to_be_true(memory_requirement > four_gib);
+
+    void* pool_memory = create_dynamic_allocator(allocator, 4096, memory_requirement);
+    expect_should_be(0, allocator.Allocate(four_gib));
+    expect_should_be(0, allocator.Allocate(four_gib - 8));
+    allocator.Destroy();
+    QAllocator::Free(pool_memory, memory_requirement, MEMORY_TAG_APPLICATION);
+    return TRUE;
+}
+
+void
+dynamic_allocator_register_tests(TestManager& manager) {
+    manager.Register(dynamic_allocator_should_create_and_destroy, "dynamic allocator should create and destroy");
+    manager.Register(dynamic_allocator_allocate_and_free_in_any_order, "dynamic allocator frees in any order and coalesces");
+    manager.Register(dynamic_allocator_respects_alignment, "dynamic allocator respects alignment");
+    manager.Register(dynamic_allocator_out_of_memory_returns_null, "dynamic allocator returns null when out of memory");
+    manager.Register(dynamic_allocator_rejects_pool_of_max_block_size, "dynamic allocator rejects a pool of exactly the largest block size");
+}
@@ -3,6 +3,7 @@
 #include "../expect.hh"
 
 #include <memory/qlinear_allocator.hh>
+#include <core/qmemory.hh>
 #include <defines.hh>
 
 uint8_t linear_allocator_should_create_and_destroy() {
@@ -92,6 +93,83 @@ uint8_t linear_allocator_simple_allocation_all_space() {
     return true;
 }
 
+uint8_t linear_allocator_aligned_allocation() {
+    qmemory::QLinearAllocator alloc;
+    alloc.Create(1024, nullptr);
+
+    // Knock the top off alignment first
+    void* block = alloc.Allocate(3, 1);
+    expect_should_not_be(0, block);
+    expect_should_be(3, alloc.allocated);
+
+    block = alloc.Allocate(32, 16);
+    expect_should_not_be(0, block);
+    expect_should_be(0, reinterpret_cast<uintptr_t>(block) % 16);
+
+    block = alloc.Allocate(8, 64);
+    expect_should_not_be(0, block);
+    expect_should_be(0, reinterpret_cast<uintptr_t>(block) % 64);
+
+    qlogger::Debug("Following error is meant to be caused by test");
+    block = alloc.Allocate(8, 3);
+    expect_should_be(0, block);
+
+    alloc.Destroy();
+    return TRUE;
+}
+
+uint8_t linear_allocator_rewind_to_marker() {
+    qmemory::QLinearAllocator alloc;
+    alloc.Create(1024, nullptr);
+
+    alloc.Allocate(64);
+    uint64_t marker = alloc.GetMarker();
+    expect_should_be(64, marker);
+
+    void* first = alloc.Allocate(128);
+    alloc.Allocate(128);
+    expect_should_be(320, alloc.allocated);
+
+    alloc.Rewind(marker);
+    expect_should_be(64, alloc.allocated);
+
+    // Memory after the marker gets handed out again
+    void* again = alloc.Allocate(128);
+    expect_to_be_true(first == again);
+
+    {
+        qmemory::QLinearAllocatorScope scope(alloc);
+        alloc.Allocate(256);
+        expect_should_be(448, alloc.allocated);
+    }
+    expect_should_be(192, alloc.allocated);
+
+    alloc.Destroy();
+    return TRUE;
+}
+
+uint8_t linear_allocator_free_all_zero_on_request() {
+    qmemory::QLinearAllocator alloc;
+    alloc.Create(64, nullptr);
+
+    uint8_t* block = static_cast<uint8_t*>(alloc.Allocate(64));
+    QAllocator::Set(block, 0xFF, 64);
+
+    // Plain reset leaves the contents alone
+    alloc.FreeAll();
+    expect_should_be(0, alloc.allocated);
+    expect_should_be(0xFF, block[63]);
+
+    alloc.Allocate(64);
+    alloc.FreeAll(true);
+    expect_should_be(0, alloc.allocated);
+    expect_should_be(0, block[0]);
+    expect_should_be(0, block[63]);
+
+    alloc.Destroy();
+    return TRUE;
+}
+
 void
 linear_allocator_register_tests(TestManager& manager) {
     manager.Register(linear_allocator_should_create_and_destroy, "linear allocator should create and destroy");
@@ -99,4 +177,7 @@ linear_allocator_register_tests(TestManager& manager) {
     manager.Register(linear_allocator_simple_allocation_all_space, "linear allocator single alloc for all space");
     manager.Register(linear_allocator_multi_allocation_all_space_then_free, "linear allocator allocated should be 0 after FreeAll");
     manager.Register(linear_allocator_multi_allocation_over_allocate, "linear allocator try to over allocate");
+    manager.Register(linear_allocator_aligned_allocation, "linear allocator honours alignment");
+    manager.Register(linear_allocator_rewind_to_marker, "linear allocator rewinds to a marker");
+    manager.Register(linear_allocator_free_all_zero_on_request, "linear allocator only zeroes on request");
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "memory_stats_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/qmemory.hh>
+#include <defines.hh>
+#include <thread>
+#include <vector>
+
+uint8_t memory_stats_exact_across_threads() {
+    uint64_t requirement = 0;
+    QAllocator::Initialize(requirement, nullptr);
+    std::vector<uint8_t> state(requirement);
+    QAllocator::Initialize(requirement, state.data());
+
+    const uint32_t thread_count = 8;
+    const uint32_t allocs_per_thread = 2000;
+    const uint64_t block_size = 48;
+    std::vector<void*> blocks(thread_count * allocs_per_thread);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([&blocks, t]() {
+            for (uint32_t i = 0; i < allocs_per_thread; i++) {
+                blocks[t * allocs_per_thread + i] = QAllocator::Allocate(1, block_size, MEMORY_TAG_JOB);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    const uint64_t total = thread_count * allocs_per_thread * block_size;
+    memory_tag_stats stats = QAllocator::GetTagStats(MEMORY_TAG_JOB);
+    expect_should_be(total, stats.allocated);
+    expect_should_be(thread_count * allocs_per_thread, stats.allocation_count);
+    expect_should_be(thread_count * allocs_per_thread, QAllocator::AllocationCount());
+
+    // Free everything from this thread. Per-thread shards go negative but the merged view must not
+    for (void* block : blocks) {
+        QAllocator::Free(block, block_size, MEMORY_TAG_JOB);
+    }
+
+    stats = QAllocator::GetTagStats(MEMORY_TAG_JOB);
+    expect_should_be(0, stats.allocated);
+    expect_should_be(total, stats.peak);
+
+    QAllocator::Shutdown();
+    return TRUE;
+}
+
+uint8_t memory_stats_rates_after_update() {
+    uint64_t requirement = 0;
+    QAllocator::Initialize(requirement, nullptr);
+    std::vector<uint8_t> state(requirement);
+    QAllocator::Initialize(requirement, state.data());
+
+    void* blocks[16];
+    for (uint32_t i = 0; i < 16; i++) {
+        blocks[i] = QAllocator::Allocate(1, 100, MEMORY_TAG_TEXTURE);
+    }
+
+    // Make sure some time passes between samples
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    QAllocator::Update();
+
+    memory_tag_stats stats = QAllocator::GetTagStats(MEMORY_TAG_TEXTURE);
+    expect_should_be(1600, stats.allocated);
+    expect_to_be_true(stats.allocations_per_second > 0.0f);
+    expect_to_be_true(stats.bytes_per_second > 0.0f);
+
+    for (uint32_t i = 0; i < 16; i++) {
+        QAllocator::Free(blocks[i], 100, MEMORY_TAG_TEXTURE);
+    }
+
+    QAllocator::Shutdown();
+    return TRUE;
+}
+
+uint8_t memory_stats_peak_catches_spikes_between_reads() {
+    uint64_t requirement = 0;
+    QAllocator::Initialize(requirement, nullptr);
+    std::vector<uint8_t> state(requirement);
+    QAllocator::Initialize(requirement, state.data());
+
+    // Nothing reads the stats while the block is alive
+    void* block = QAllocator::Allocate(1, 4096, MEMORY_TAG_SCENE);
+    QAllocator::Free(block, 4096, MEMORY_TAG_SCENE);
+    block = QAllocator::Allocate(1, 1024, MEMORY_TAG_SCENE);
+
+    memory_tag_stats stats = QAllocator::GetTagStats(MEMORY_TAG_SCENE);
+    expect_should_be(1024, stats.allocated);
+    expect_should_be(4096, stats.peak);
+
+    // Reading resets the per thread marks, the peak itself stays
+    QAllocator::Update();
+    QAllocator::Free(block, 1024, MEMORY_TAG_SCENE);
+    stats = QAllocator::GetTagStats(MEMORY_TAG_SCENE);
+    expect_should_be(0, stats.allocated);
+    expect_should_be(4096, stats.peak);
+
+    QAllocator::Shutdown();
+    return TRUE;
+}
+
+void
+memory_stats_register_tests(TestManager& manager) {
+    manager.Register(memory_stats_exact_across_threads, "memory stats stay exact with allocations on many threads");
+    manager.Register(memory_stats_rates_after_update, "memory stats report allocation rates after Update");
+    manager.Register(memory_stats_peak_catches_spikes_between_reads, "memory stats peaks include spikes between reads");
+}
@@ -0,0 +1,154 @@
+#include "pool_allocator_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <memory/qpool_allocator.hh>
+#include <defines.hh>
+
+struct pool_test_object {
+    float position[3];
+    uint32_t id;
+};
+
+uint8_t pool_allocator_should_create_and_destroy() {
+    qmemory::QPoolAllocator pool;
+    pool.Create(sizeof(pool_test_object), alignof(pool_test_object), 64, 1024, MEMORY_TAG_ENTITY);
+
+    expect_should_be(64, pool.slab_capacity);
+    expect_should_be(16, pool.max_slabs);
+    expect_should_be(0, pool.slab_count);
+    expect_should_be(0, pool.live_count);
+
+    pool.Destroy();
+    expect_should_be(0, pool.slabs);
+    expect_should_be(0, pool.slab_count);
+    return TRUE;
+}
+
+uint8_t pool_allocator_allocate_and_get() {
+    qmemory::QPoolAllocator pool;
+    pool.Create(sizeof(pool_test_object), alignof(pool_test_object), 16, 256, MEMORY_TAG_ENTITY);
+
+    qmemory::QPoolHandle handles[100];
+    for (uint32_t i = 0; i < 100; i++) {
+        handles[i] = pool.Allocate();
+        expect_to_be_false(handles[i].is_null());
+        pool.Get<pool_test_object>(handles[i])->id = i;
+    }
+    expect_should_be(100, pool.live_count);
+    expect_should_be(7, pool.slab_count);
+
+    for (uint32_t i = 0; i < 100; i++) {
+        pool_test_object* obj = pool.Get<pool_test_object>(handles[i]);
+        expect_should_not_be(0, obj);
+        expect_should_be(i, obj->id);
+    }
+
+    pool.Destroy();
+    return TRUE;
+}
+
+uint8_t pool_allocator_stale_handle_is_rejected() {
+    qmemory::QPoolAllocator pool;
+    pool.Create(sizeof(pool_test_object), alignof(pool_test_object), 16, 256, MEMORY_TAG_ENTITY);
+
+    qmemory::QPoolHandle first = pool.Allocate();
+    expect_to_be_true(pool.Free(first));
+    expect_to_be_false(pool.IsValid(first));
+    expect_should_be(0, pool.Get(first));
+
+    // The slot is reused with a new generation
+    qmemory::QPoolHandle second = pool.Allocate();
+    expect_should_be(first.index(), second.index());
+    expect_to_be_true(first != second);
+    expect_should_be(0, pool.Get(first));
+    expect_should_not_be(0, pool.Get(second));
+
+    qlogger::Debug("Following warning is meant to be caused by test");
+    expect_to_be_false(pool.Free(first));
+    expect_should_be(1, pool.live_count);
+
+    pool.Destroy();
+    return TRUE;
+}
+
+uint8_t pool_allocator_full_pool_returns_null() {
+    qmemory::QPoolAllocator pool;
+    pool.Create(sizeof(uint32_t), alignof(uint32_t), 4, 8, MEMORY_TAG_ENTITY);
+
+    for (uint32_t i = 0; i < 8; i++) {
+        expect_to_be_false(pool.Allocate().is_null());
+    }
+
+    qlogger::Debug("Following error is meant to be caused by test");
+    expect_to_be_true(pool.Allocate().is_null());
+
+    pool.Destroy();
+    return TRUE;
+}
+
+uint8_t pool_allocator_limit_is_live_objects_not_slots() {
+    qmemory::QPoolAllocator pool;
+    // 10 objects need 3 slabs of 4, which have room for 12
+    pool.Create(sizeof(uint32_t), alignof(uint32_t), 4, 10, MEMORY_TAG_ENTITY);
+
+    qmemory::QPoolHandle handles[10];
+    for (uint32_t i = 0; i < 10; i++) {
+        handles[i] = pool.Allocate();
+        expect_to_be_false(handles[i].is_null());
+    }
+    expect_should_be(3, pool.slab_count);
+
+    qlogger::Debug("Following error is meant to be caused by test");
+    expect_to_be_true(pool.Allocate().is_null());
+    expect_should_be(10, pool.live_count);
+
+    // Freeing one makes room for exactly one more
+    expect_to_be_true(pool.Free(handles[3]));
+    expect_to_be_false(pool.Allocate().is_null());
+    qlogger::Debug("Following error is meant to be caused by test");
+    expect_to_be_true(pool.Allocate().is_null());
+
+    pool.Destroy();
+    return TRUE;
+}
+
+uint8_t pool_allocator_for_each_visits_live_objects() {
+    qmemory::QPoolAllocator pool;
+    pool.Create(sizeof(pool_test_object), alignof(pool_test_object), 8, 64, MEMORY_TAG_TRANSFORM);
+
+    qmemory::QPoolHandle handles[20];
+    for (uint32_t i = 0; i < 20; i++) {
+        handles[i] = pool.Allocate();
+        pool.Get<pool_test_object>(handles[i])->id = i;
+    }
+    for (uint32_t i = 0; i < 20; i += 2) {
+        pool.Free(handles[i]);
+    }
+
+    uint32_t visited = 0;
+    uint32_t id_sum = 0;
+    bool handles_match = true;
+    pool.ForEach([&](qmemory::QPoolHandle handle, void* object) {
+        visited++;
+        id_sum += static_cast<pool_test_object*>(object)->id;
+        handles_match = handles_match && pool.Get(handle) == object;
+    });
+
+    expect_should_be(10, visited);
+    expect_should_be(100, id_sum); // 1 + 3 + ... + 19
+    expect_to_be_true(handles_match);
+
+    pool.Destroy();
+    return TRUE;
+}
+
+void
+pool_allocator_register_tests(TestManager& manager) {
+    manager.Register(pool_allocator_should_create_and_destroy, "pool allocator should create and destroy");
+    manager.Register(pool_allocator_allocate_and_get, "pool allocator handles resolve to their objects");
+    manager.Register(pool_allocator_stale_handle_is_rejected, "pool allocator rejects stale handles");
+    manager.Register(pool_allocator_full_pool_returns_null, "pool allocator returns null handle when full");
+    manager.Register(pool_allocator_limit_is_live_objects_not_slots, "pool allocator stops at max_elements live objects");
+    manager.Register(pool_allocator_for_each_visits_live_objects, "pool allocator iterates only live objects");
+}
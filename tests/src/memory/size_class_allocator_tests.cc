@@ -0,0 +1,111 @@
+#include "size_class_allocator_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <memory/qsize_class_allocator.hh>
+#include <core/qmemory.hh>
+#include <defines.hh>
+#include <thread>
+#include <vector>
+
+using qmemory::QSizeClassAllocator;
+
+uint8_t size_class_allocator_classes_fit_requests() {
+    uint32_t prev_index = 0;
+    for (uint64_t size = 1; size <= QSizeClassAllocator::max_small_size; size++) {
+        uint32_t index = QSizeClassAllocator::ClassIndex(size, 16);
+        expect_to_be_true(index < QSizeClassAllocator::class_count);
+        expect_to_be_true(QSizeClassAllocator::ClassSize(index) >= size);
+        expect_to_be_true(index >= prev_index);
+        prev_index = index;
+    }
+
+    expect_should_be(QSizeClassAllocator::class_count, QSizeClassAllocator::ClassIndex(QSizeClassAllocator::max_small_size + 1, 16));
+    return TRUE;
+}
+
+uint8_t size_class_allocator_respects_alignment() {
+    const uint64_t alignments[] = { 16, 32, 64, 256, 4096 };
+    const uint64_t sizes[] = { 1, 24, 100, 3000, 40000 };
+
+    for (uint64_t alignment : alignments) {
+        for (uint64_t size : sizes) {
+            void* block = QSizeClassAllocator::Allocate(size, alignment);
+            expect_should_not_be(0, block);
+            expect_should_be(0, reinterpret_cast<uintptr_t>(block) % alignment);
+            QAllocator::Set(block, 0xAB, size);
+            QSizeClassAllocator::Free(block, size, alignment);
+        }
+    }
+
+    return TRUE;
+}
+
+uint8_t size_class_allocator_reuses_freed_blocks() {
+    void* first = QSizeClassAllocator::Allocate(48, 16);
+    QSizeClassAllocator::Free(first, 48, 16);
+    void* second = QSizeClassAllocator::Allocate(48, 16);
+    expect_to_be_true(first == second);
+    QSizeClassAllocator::Free(second, 48, 16);
+    return TRUE;
+}
+
+uint8_t size_class_allocator_distinct_live_blocks() {
+    const uint64_t count = 4096;
+    std::vector<uint64_t*> blocks(count);
+    for (uint64_t i = 0; i < count; i++) {
+        blocks[i] = static_cast<uint64_t*>(QSizeClassAllocator::Allocate(sizeof(uint64_t) * 4, 16));
+        expect_should_not_be(0, blocks[i]);
+        blocks[i][0] = i;
+        blocks[i][3] = i;
+    }
+
+    for (uint64_t i = 0; i < count; i++) {
+        expect_should_be(i, blocks[i][0]);
+        expect_should_be(i, blocks[i][3]);
+        QSizeClassAllocator::Free(blocks[i], sizeof(uint64_t) * 4, 16);
+    }
+
+    return TRUE;
+}
+
+uint8_t size_class_allocator_cross_thread_free() {
+    const uint64_t count = 10000;
+    std::vector<void*> blocks(count);
+
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < count; i++) {
+            blocks[i] = QSizeClassAllocator::Allocate(64 + (i % 8) * 16, 16);
+        }
+    });
+    producer.join();
+
+    std::thread consumer([&]() {
+        for (uint64_t i = 0; i < count; i++) {
+            QSizeClassAllocator::Free(blocks[i], 64 + (i % 8) * 16, 16);
+        }
+    });
+    consumer.join();
+
+    return TRUE;
+}
+
+uint8_t qallocator_zeroed_allocation_is_zero() {
+    const uint64_t size = 300;
+    uint8_t* block = static_cast<uint8_t*>(QAllocator::AllocateZeroed(1, size, MEMORY_TAG_ARRAY));
+    for (uint64_t i = 0; i < size; i++) {
+        expect_should_be(0, block[i]);
+    }
+    QAllocator::Free(block, size, MEMORY_TAG_ARRAY);
+    return TRUE;
+}
+
+void
+size_class_allocator_register_tests(TestManager& manager) {
+    manager.Register(size_class_allocator_classes_fit_requests, "size class allocator classes cover every small size");
+    manager.Register(size_class_allocator_respects_alignment, "size class allocator returns aligned blocks");
+    manager.Register(size_class_allocator_reuses_freed_blocks, "size class allocator reuses freed blocks");
+    manager.Register(size_class_allocator_distinct_live_blocks, "size class allocator live blocks do not overlap");
+    manager.Register(size_class_allocator_cross_thread_free, "size class allocator frees blocks from another thread");
+    manager.Register(qallocator_zeroed_allocation_is_zero, "QAllocator::AllocateZeroed returns cleared memory");
+}
@@ -0,0 +1,4 @@
+#pragma once
+#include "../test_manager.hh"
+
+void size_class_allocator_register_tests(TestManager& manager);
@@ -0,0 +1,265 @@
+#include "file_system_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <core/qjobs.hh>
+#include <core/qtask.hh>
+#include <platform/file_system.hh>
+#include <defines.hh>
+#include <cstdio>
+#include <fstream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const char* test_file_path = "qfilesystem_test.bin";
+
+static void
+write_test_file(const std::string& contents) {
+    std::ofstream file(test_file_path, std::ios::binary | std::ios::trunc);
+    file.write(contents.data(), contents.size());
+}
+
+uint8_t mapped_file_reads_contents() {
+    // Spans a few pages so the hints cover more than one
+    std::string contents;
+    for (uint32_t i = 0; i < 20000; i++) {
+        contents.push_back(static_cast<char>('a' + i % 26));
+    }
+    write_test_file(contents);
+
+    {
+        QFilesystem::QMappedFile file;
+        expect_to_be_true(file.map(test_file_path));
+        expect_to_be_true(file.is_valid);
+        expect_should_be(contents.size(), file.size);
+        expect_to_be_true(std::string(reinterpret_cast<const char*>(file.data), file.size) == contents);
+
+        // Unaligned ranges are fine, ranges past the end are not
+        expect_to_be_true(file.advise(5000, 4000, QFilesystem::FILE_ACCESS_RANDOM | QFilesystem::FILE_ACCESS_WILL_NEED));
+        expect_to_be_false(file.advise(19000, 2000, QFilesystem::FILE_ACCESS_WILL_NEED));
+
+        file.unmap();
+        expect_to_be_false(file.is_valid);
+        expect_to_be_true(file.data == nullptr);
+        expect_to_be_false(file.advise(0, 1, QFilesystem::FILE_ACCESS_WILL_NEED));
+    }
+
+    std::remove(test_file_path);
+    return TRUE;
+}
+
+uint8_t mapped_file_moves_ownership() {
+    write_test_file("pegasus");
+
+    QFilesystem::QMappedFile first;
+    expect_to_be_true(first.map(test_file_path, QFilesystem::FILE_ACCESS_NORMAL));
+
+    QFilesystem::QMappedFile second(std::move(first));
+    expect_to_be_false(first.is_valid);
+    expect_to_be_true(first.data == nullptr);
+    expect_should_be(7, second.size);
+
+    QFilesystem::QMappedFile third;
+    third = std::move(second);
+    expect_to_be_false(second.is_valid);
+    expect_to_be_true(std::string(reinterpret_cast<const char*>(third.data), third.size) == "pegasus");
+
+    third.unmap();
+    std::remove(test_file_path);
+    return TRUE;
+}
+
+uint8_t mapped_file_empty_and_missing() {
+    write_test_file("");
+
+    QFilesystem::QMappedFile file;
+    expect_to_be_true(file.map(test_file_path));
+    expect_to_be_true(file.is_valid);
+    expect_should_be(0, file.size);
+    expect_to_be_true(file.data == nullptr);
+    file.unmap();
+    std::remove(test_file_path);
+
+    expect_to_be_false(file.map("qfilesystem_test_missing.bin"));
+    expect_to_be_false(file.is_valid);
+    return TRUE;
+}
+
+// Every byte of the file is its offset mod 251, so any range can be checked on its own
+static std::string
+write_pattern_file(uint32_t size) {
+    std::string contents(size, '\0');
+    for (uint32_t i = 0; i < size; i++) {
+        contents[i] = static_cast<char>(i % 251);
+    }
+    write_test_file(contents);
+    return contents;
+}
+
+static bool
+matches_pattern(const uint8_t* data, uint64_t offset, uint64_t size) {
+    for (uint64_t i = 0; i < size; i++) {
+        if (data[i] != (offset + i) % 251) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Many reads in one batch, more than the queue depth, plus reads at and past the end of the file
+static uint8_t
+run_async_reads(bool allow_io_uring) {
+    const uint32_t file_size = 256 * 1024 + 100;
+    write_pattern_file(file_size);
+
+    QFilesystem::QAsyncFile file;
+    expect_to_be_true(file.open(test_file_path));
+    expect_should_be(file_size, file.size);
+
+    QFilesystem::QAsyncReader reader;
+    expect_to_be_true(reader.init(8, allow_io_uring));
+
+    const uint32_t chunk = 4096;
+    const uint32_t chunks = 64;
+    std::vector<uint8_t> buffer(chunks * chunk + 2 * chunk);
+    std::vector<QFilesystem::QAsyncRead> reads(chunks + 2);
+    for (uint32_t i = 0; i < chunks; i++) {
+        // Back to front, so completion order has nothing to do with file order
+        reads[i].file = &file;
+        reads[i].offset = static_cast<uint64_t>(chunks - 1 - i) * chunk;
+        reads[i].size = chunk;
+        reads[i].buffer = &buffer[i * chunk];
+    }
+    // Runs 100 bytes past the end
+    reads[chunks].file = &file;
+    reads[chunks].offset = file_size - chunk + 100;
+    reads[chunks].size = chunk;
+    reads[chunks].buffer = &buffer[chunks * chunk];
+    // Starts past the end
+    reads[chunks + 1].file = &file;
+    reads[chunks + 1].offset = file_size + 10;
+    reads[chunks + 1].size = chunk;
+    reads[chunks + 1].buffer = &buffer[(chunks + 1) * chunk];
+
+    expect_to_be_true(reader.submit(reads.data(), static_cast<uint32_t>(reads.size())));
+    reader.wait(&reads[0]);
+    expect_to_be_true(reads[0].done());
+    reader.wait_all();
+
+    for (uint32_t i = 0; i < chunks; i++) {
+        expect_should_be(QFilesystem::ASYNC_READ_DONE, reads[i].status.load());
+        expect_should_be(chunk, reads[i].bytes_read);
+        expect_to_be_true(matches_pattern(&buffer[i * chunk], reads[i].offset, chunk));
+    }
+    expect_should_be(chunk - 100, reads[chunks].bytes_read);
+    expect_to_be_true(matches_pattern(&buffer[chunks * chunk], reads[chunks].offset, chunk - 100));
+    expect_should_be(QFilesystem::ASYNC_READ_DONE, reads[chunks + 1].status.load());
+    expect_should_be(0, reads[chunks + 1].bytes_read);
+
+    // A bad read rejects the whole batch
+    QFilesystem::QAsyncRead bad[2] = {
+        { &file, 0, chunk, buffer.data() },
+        { nullptr, 0, chunk, buffer.data() },
+    };
+    expect_to_be_false(reader.submit(bad, 2));
+    expect_should_be(QFilesystem::ASYNC_READ_IDLE, bad[0].status.load());
+
+    reader.shutdown();
+    file.close();
+    std::remove(test_file_path);
+    return TRUE;
+}
+
+uint8_t async_reads_io_uring() {
+    QFilesystem::QAsyncReader probe;
+    probe.init();
+    if (!probe.uses_io_uring()) {
+        // Nothing to test here, the fallback has its own test
+        return TRUE;
+    }
+    probe.shutdown();
+    return run_async_reads(true);
+}
+
+uint8_t async_reads_fallback_inline() {
+    return run_async_reads(false);
+}
+
+// Starts the job system for the duration of a test
+struct file_system_job_scope {
+    void* memory;
+
+    explicit file_system_job_scope(uint32_t thread_count) {
+        uint64_t memory_requirement = 0;
+        JobSystem::Startup(memory_requirement, nullptr, thread_count);
+        memory = operator new(memory_requirement, std::align_val_t(64));
+        JobSystem::Startup(memory_requirement, memory, thread_count);
+    }
+
+    ~file_system_job_scope() {
+        JobSystem::Shutdown();
+        operator delete(memory, std::align_val_t(64));
+    }
+};
+
+uint8_t async_reads_fallback_on_jobs() {
+    file_system_job_scope jobs(4);
+    return run_async_reads(false);
+}
+
+struct load_request {
+    QFilesystem::QAsyncReader* reader;
+    QFilesystem::QAsyncFile* file;
+    uint8_t* buffer;
+    uint64_t bytes_loaded;
+};
+
+static QTask
+load_file(load_request* load) {
+    QFilesystem::QAsyncRead read;
+    read.file = load->file;
+    read.offset = 0;
+    read.size = load->file->size;
+    read.buffer = load->buffer;
+    load->reader->submit(&read, 1);
+    co_await QWaitUntil { QFilesystem::async_read_ready, &read };
+    load->bytes_loaded = read.bytes_read;
+}
+
+uint8_t async_read_awaited_from_task() {
+    const uint32_t file_size = 64 * 1024;
+    write_pattern_file(file_size);
+
+    for (uint32_t pass = 0; pass < 2; pass++) {
+        file_system_job_scope jobs(2);
+        QFilesystem::QAsyncFile file;
+        expect_to_be_true(file.open(test_file_path));
+        QFilesystem::QAsyncReader reader;
+        reader.init(32, pass == 0);
+
+        std::vector<uint8_t> buffer(file_size);
+        load_request load = { &reader, &file, buffer.data(), 0 };
+        QJobCounter loaded;
+        JobSystem::Spawn(load_file(&load), &loaded);
+        JobSystem::Wait(&loaded);
+
+        expect_should_be(file_size, load.bytes_loaded);
+        expect_to_be_true(matches_pattern(buffer.data(), 0, file_size));
+    }
+
+    std::remove(test_file_path);
+    return TRUE;
+}
+
+void
+file_system_register_tests(TestManager& manager) {
+    manager.Register(mapped_file_reads_contents, "mapped file exposes the file contents and takes hints");
+    manager.Register(mapped_file_moves_ownership, "mapped file hands its mapping over on move");
+    manager.Register(mapped_file_empty_and_missing, "mapped file handles empty and missing files");
+    manager.Register(async_reads_io_uring, "async reads through io_uring land in the given buffers");
+    manager.Register(async_reads_fallback_inline, "async read fallback works without the job system");
+    manager.Register(async_reads_fallback_on_jobs, "async read fallback runs reads on the job system");
+    manager.Register(async_read_awaited_from_task, "async read can be awaited from a task");
+}
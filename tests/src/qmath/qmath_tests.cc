@@ -0,0 +1,511 @@
+#include "qmath_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <qmath/qmath.hh>
+#include <defines.hh>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace qmath;
+
+// The SIMD kernels add in the same order as the scalar templates, so they should match bit for bit.
+// Built with FMA the compiler may fuse either side differently, so allow rounding there. Transforms
+// hold this relative to the size of their terms, see transform_agrees
+#if defined(__FMA__)
+static constexpr float exact_tolerance = 1e-6f;
+#else
+static constexpr float exact_tolerance = 0.f;
+#endif
+// Inverse and slerp are arranged differently from the scalar code
+static constexpr float close_tolerance = 1e-5f;
+// M * inverse(M) cancels terms as large as the translation, so it only comes back to identity this closely
+static constexpr float identity_tolerance = 1e-4f;
+
+static constexpr uint32_t checked_values = 1000;
+
+// Deterministic values in [-range, range]
+struct test_random {
+    uint32_t state;
+
+    float next(float range) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (static_cast<float>(state) / 4294967295.f * 2.f - 1.f) * range;
+    }
+};
+
+// Relative to the larger magnitude, so large values are not held to an absolute bound
+static bool
+agrees(float expected, float actual, float tolerance) {
+    if (tolerance == 0.f) {
+        return memcmp(&expected, &actual, sizeof(float)) == 0;
+    }
+    float magnitude = qabs(expected) > qabs(actual) ? qabs(expected) : qabs(actual);
+    return qabs(expected - actual) <= tolerance * (magnitude > 1.f ? magnitude : 1.f);
+}
+
+static bool
+agrees(const Mat4<float>& expected, const Mat4<float>& actual, float tolerance) {
+    for (uint32_t i = 0; i < 16; i++) {
+        if (!agrees(expected.data[i], actual.data[i], tolerance)) {
+            qlogger::Error("qmath test: element %u expected %.9g, got %.9g", i, expected.data[i], actual.data[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+agrees(const float* expected, const float* actual, uint32_t count, float tolerance) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (!agrees(expected[i], actual[i], tolerance)) {
+            qlogger::Error("qmath test: component %u expected %.9g, got %.9g", i, expected[i], actual[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Each output of matrix * (v, w) against the sum of its terms' magnitudes rather than the result.
+// A fused multiply-add rounds the terms differently, and when they cancel the error stays as large
+// as the terms were
+static bool
+transform_agrees(const Mat4<float>& matrix, const float* v, float w, const float* expected, const float* actual, uint32_t count, float tolerance) {
+    for (uint32_t i = 0; i < count; i++) {
+        if (tolerance == 0.f) {
+            if (memcmp(&expected[i], &actual[i], sizeof(float)) != 0) {
+                qlogger::Error("qmath test: component %u expected %.9g, got %.9g", i, expected[i], actual[i]);
+                return false;
+            }
+            continue;
+        }
+
+        float terms = qabs(v[0] * matrix.data[i]) + qabs(v[1] * matrix.data[4 + i]) +
+                      qabs(v[2] * matrix.data[8 + i]) + qabs(w * matrix.data[12 + i]);
+        if (qabs(expected[i] - actual[i]) > tolerance * (terms > 1.f ? terms : 1.f)) {
+            qlogger::Error("qmath test: component %u expected %.9g, got %.9g", i, expected[i], actual[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static Mat4<float>
+random_matrix(test_random& random) {
+    Mat4<float> matrix;
+    for (uint32_t i = 0; i < 16; i++) {
+        matrix.data[i] = random.next(10.f);
+    }
+    return matrix;
+}
+
+// Rotation, scale and translation, the kind of matrix that actually gets inverted
+static Mat4<float>
+random_transform(test_random& random) {
+    Mat4<float> rotation = Mat4<float>::EulerXYZ(random.next(Q_PI), random.next(Q_PI), random.next(Q_PI));
+    Mat4<float> scale = Mat4<float>::Scale(Vec3<float> { 0.5f + qabs(random.next(2.f)), 0.5f + qabs(random.next(2.f)), 0.5f + qabs(random.next(2.f)) });
+    Mat4<float> translation = Mat4<float>::GetTranslation(Vec3<float> { random.next(100.f), random.next(100.f), random.next(100.f) });
+    return scalar::multiply(scalar::multiply(scale, rotation), translation);
+}
+
+static Quaternion<float>
+random_quaternion(test_random& random) {
+    return Quaternion<float>::New(random.next(1.f), random.next(1.f), random.next(1.f), random.next(1.f));
+}
+
+uint8_t qmath_mat4_multiply_matches_scalar() {
+    test_random random = { 0x1234567u };
+    for (uint32_t i = 0; i < checked_values; i++) {
+        Mat4<float> a = random_matrix(random);
+        Mat4<float> b = random_matrix(random);
+        expect_to_be_true(agrees(scalar::multiply(a, b), a * b, exact_tolerance));
+    }
+
+    // Multiplying by the identity changes nothing
+    Mat4<float> a = random_matrix(random);
+    expect_to_be_true(agrees(a, a * Mat4<float>::Identity(), 0.f));
+    expect_to_be_true(agrees(a, Mat4<float>::Identity() * a, 0.f));
+    return TRUE;
+}
+
+uint8_t qmath_mat4_inverse_matches_scalar() {
+    test_random random = { 0xBADC0DEu };
+    for (uint32_t i = 0; i < checked_values; i++) {
+        Mat4<float> matrix = random_transform(random);
+        Mat4<float> inverse = Mat4<float>::GetInverse(matrix);
+        expect_to_be_true(agrees(scalar::inverse(matrix), inverse, close_tolerance));
+        expect_to_be_true(agrees(Mat4<float>::Identity(), matrix * inverse, identity_tolerance));
+    }
+
+    Mat4<float> matrix = random_transform(random);
+    Mat4<float> inverted = matrix;
+    inverted.Invert();
+    expect_to_be_true(agrees(Mat4<float>::GetInverse(matrix), inverted, 0.f));
+    return TRUE;
+}
+
+uint8_t qmath_mat4_transform_matches_scalar() {
+    test_random random = { 0x51DEu };
+    for (uint32_t i = 0; i < checked_values; i++) {
+        Mat4<float> matrix = random_matrix(random);
+        Vec4<float> v = Vec4<float>::New(random.next(10.f), random.next(10.f), random.next(10.f), random.next(10.f));
+        Vec3<float> p = Vec3<float>::New(random.next(10.f), random.next(10.f), random.next(10.f));
+
+        Vec4<float> expected4 = scalar::transform(matrix, v);
+        Vec4<float> actual4 = Mat4<float>::Transform(matrix, v);
+        expect_to_be_true(transform_agrees(matrix, &v.x, v.w, &expected4.x, &actual4.x, 4, exact_tolerance));
+
+        Vec3<float> expected_point = scalar::transform_point(matrix, p);
+        Vec3<float> actual_point = Mat4<float>::TransformPoint(matrix, p);
+        expect_to_be_true(transform_agrees(matrix, &p.x, 1.f, &expected_point.x, &actual_point.x, 3, exact_tolerance));
+
+        Vec3<float> expected_vector = scalar::transform_vector(matrix, p);
+        Vec3<float> actual_vector = Mat4<float>::TransformVector(matrix, p);
+        expect_to_be_true(transform_agrees(matrix, &p.x, 0.f, &expected_vector.x, &actual_vector.x, 3, exact_tolerance));
+    }
+
+    // Points are translated and directions are not
+    Mat4<float> translation = Mat4<float>::GetTranslation(Vec3<float> { 1.f, 2.f, 3.f });
+    Vec3<float> moved = Mat4<float>::TransformPoint(translation, Vec3<float> { 1.f, 1.f, 1.f });
+    Vec3<float> unmoved = Mat4<float>::TransformVector(translation, Vec3<float> { 1.f, 1.f, 1.f });
+    expect_float_to_be(2.f, moved.x);
+    expect_float_to_be(3.f, moved.y);
+    expect_float_to_be(4.f, moved.z);
+    expect_float_to_be(1.f, unmoved.x);
+    expect_float_to_be(1.f, unmoved.z);
+    return TRUE;
+}
+
+uint8_t qmath_quaternion_multiply_matches_scalar() {
+    test_random random = { 0xC0FFEEu };
+    for (uint32_t i = 0; i < checked_values; i++) {
+        Quaternion<float> q1 = random_quaternion(random);
+        Quaternion<float> q2 = random_quaternion(random);
+        Quaternion<float> expected = scalar::multiply(q1, q2);
+        Quaternion<float> actual = q1 * q2;
+        expect_to_be_true(agrees(&expected.x, &actual.x, 4, exact_tolerance));
+    }
+
+    // i * j = k
+    Quaternion<float> i = Quaternion<float>::New(1.f, 0.f, 0.f, 0.f);
+    Quaternion<float> j = Quaternion<float>::New(0.f, 1.f, 0.f, 0.f);
+    Quaternion<float> k = i * j;
+    expect_float_to_be(0.f, k.x);
+    expect_float_to_be(0.f, k.y);
+    expect_float_to_be(1.f, k.z);
+    expect_float_to_be(0.f, k.w);
+
+    // Two quarter turns about z are a half turn
+    Quaternion<float> quarter = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 0.f, 1.f }, Q_PI / 2, false);
+    Quaternion<float> half = quarter * quarter;
+    expect_float_to_be(1.f, half.z);
+    expect_float_to_be(0.f, half.w);
+    return TRUE;
+}
+
+uint8_t qmath_quaternion_slerp_matches_scalar() {
+    test_random random = { 0x5EEDu };
+    for (uint32_t i = 0; i < checked_values; i++) {
+        Quaternion<float> q1 = random_quaternion(random);
+        Quaternion<float> q2 = random_quaternion(random);
+        float percentage = qabs(random.next(1.f));
+        Quaternion<float> expected = scalar::slerp(q1, q2, percentage);
+        Quaternion<float> actual = Quaternion<float>::Slerp(q1, q2, percentage);
+        expect_to_be_true(agrees(&expected.x, &actual.x, 4, close_tolerance));
+    }
+
+    // Close inputs take the lerp path
+    Quaternion<float> a = Quaternion<float>::New(0.f, 0.f, 0.01f, 1.f);
+    Quaternion<float> b = Quaternion<float>::New(0.f, 0.f, 0.011f, 1.f);
+    Quaternion<float> expected = scalar::slerp(a, b, 0.5f);
+    Quaternion<float> actual = Quaternion<float>::Slerp(a, b, 0.5f);
+    expect_to_be_true(agrees(&expected.x, &actual.x, 4, close_tolerance));
+
+    // Halfway to a turn of 120 degrees about z is a turn of 60 degrees
+    Quaternion<float> turn = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 0.f, 1.f }, 2.f * Q_PI / 3.f, false);
+    Quaternion<float> halfway = Quaternion<float>::Slerp(Quaternion<float>::Identity(), turn, 0.5f);
+    expect_float_to_be(0.5f, halfway.z);
+    expect_float_to_be(0.866025f, halfway.w);
+    return TRUE;
+}
+
+// Not a multiple of any batch width, so the scalar tail runs too
+static constexpr uint32_t batch_count = 1003;
+
+uint8_t qmath_batch_transform_matches_scalar() {
+    test_random random = { 0xBA7C4u };
+    Mat4<float> matrix = random_transform(random);
+
+    std::vector<float> xs(batch_count), ys(batch_count), zs(batch_count);
+    std::vector<Vertex3D> vertices(batch_count);
+    for (uint32_t i = 0; i < batch_count; i++) {
+        xs[i] = random.next(50.f);
+        ys[i] = random.next(50.f);
+        zs[i] = random.next(50.f);
+        vertices[i].position = Vec3<float> { xs[i], ys[i], zs[i] };
+    }
+
+    std::vector<float> px(batch_count), py(batch_count), pz(batch_count);
+    std::vector<float> vx(batch_count), vy(batch_count), vz(batch_count);
+    std::vector<Vertex3D> transformed(batch_count);
+    const ConstVec3Stream in = { xs.data(), ys.data(), zs.data() };
+    batch::transform_points(matrix, in, Vec3Stream { px.data(), py.data(), pz.data() }, batch_count);
+    batch::transform_vectors(matrix, in, Vec3Stream { vx.data(), vy.data(), vz.data() }, batch_count);
+    batch::transform_points(matrix, vertices.data(), transformed.data(), batch_count);
+
+    for (uint32_t i = 0; i < batch_count; i++) {
+        const Vec3<float> v = { xs[i], ys[i], zs[i] };
+        const Vec3<float> point = scalar::transform_point(matrix, v);
+        const Vec3<float> direction = scalar::transform_vector(matrix, v);
+        const float points[3] = { px[i], py[i], pz[i] };
+        const float directions[3] = { vx[i], vy[i], vz[i] };
+        expect_to_be_true(transform_agrees(matrix, &v.x, 1.f, &point.x, points, 3, exact_tolerance));
+        expect_to_be_true(transform_agrees(matrix, &v.x, 0.f, &direction.x, directions, 3, exact_tolerance));
+        expect_to_be_true(transform_agrees(matrix, &v.x, 1.f, &point.x, &transformed[i].position.x, 3, exact_tolerance));
+    }
+
+    // In place gives the same
+    batch::transform_points(matrix, in, Vec3Stream { xs.data(), ys.data(), zs.data() }, batch_count);
+    batch::transform_points(matrix, vertices.data(), vertices.data(), batch_count);
+    for (uint32_t i = 0; i < batch_count; i++) {
+        const float points[3] = { px[i], py[i], pz[i] };
+        const float in_place[3] = { xs[i], ys[i], zs[i] };
+        expect_to_be_true(agrees(points, in_place, 3, 0.f));
+        expect_to_be_true(agrees(&transformed[i].position.x, &vertices[i].position.x, 3, 0.f));
+    }
+    return TRUE;
+}
+
+uint8_t qmath_batch_multiply_matches_scalar() {
+    test_random random = { 0x0DE15u };
+    Mat4<float> view_projection = random_matrix(random);
+    std::vector<Mat4<float>> models(batch_count / 10);
+    for (Mat4<float>& model : models) {
+        model = random_transform(random);
+    }
+
+    std::vector<Mat4<float>> out(models.size());
+    batch::multiply(models.data(), view_projection, out.data(), models.size());
+    for (uint64_t i = 0; i < models.size(); i++) {
+        expect_to_be_true(agrees(scalar::multiply(models[i], view_projection), out[i], exact_tolerance));
+    }
+    return TRUE;
+}
+
+uint8_t qmath_batch_compose_trs_matches_scalar() {
+    test_random random = { 0x7A5u };
+    std::vector<float> streams[10];
+    for (std::vector<float>& stream : streams) {
+        stream.resize(batch_count);
+    }
+    for (uint32_t i = 0; i < batch_count; i++) {
+        Quaternion<float> rotation = random_quaternion(random).GetNormalized();
+        streams[0][i] = random.next(100.f);
+        streams[1][i] = random.next(100.f);
+        streams[2][i] = random.next(100.f);
+        streams[3][i] = rotation.x;
+        streams[4][i] = rotation.y;
+        streams[5][i] = rotation.z;
+        streams[6][i] = rotation.w;
+        streams[7][i] = 0.5f + qabs(random.next(2.f));
+        streams[8][i] = 0.5f + qabs(random.next(2.f));
+        streams[9][i] = 0.5f + qabs(random.next(2.f));
+    }
+
+    std::vector<Mat4<float>> out(batch_count);
+    batch::compose_trs(
+        ConstVec3Stream { streams[0].data(), streams[1].data(), streams[2].data() },
+        ConstQuaternionStream { streams[3].data(), streams[4].data(), streams[5].data(), streams[6].data() },
+        ConstVec3Stream { streams[7].data(), streams[8].data(), streams[9].data() },
+        out.data(), batch_count);
+    for (uint32_t i = 0; i < batch_count; i++) {
+        Mat4<float> expected = scalar::compose_trs(
+            Vec3<float> { streams[0][i], streams[1][i], streams[2][i] },
+            Quaternion<float>::New(streams[3][i], streams[4][i], streams[5][i], streams[6][i]),
+            Vec3<float> { streams[7][i], streams[8][i], streams[9][i] });
+        expect_to_be_true(agrees(expected, out[i], exact_tolerance));
+    }
+
+    // Same as building it from the separate matrices
+    const float angle = 0.7f;
+    Quaternion<float> about_z = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 0.f, 1.f }, angle, false);
+    Vec3<float> position = { 1.f, 2.f, 3.f };
+    Vec3<float> scale = { 2.f, 3.f, 4.f };
+    Mat4<float> composed = scalar::compose_trs(position, about_z, scale);
+    Mat4<float> expected = Mat4<float>::Scale(scale) * Mat4<float>::EulerZ(angle) * Mat4<float>::GetTranslation(position);
+    expect_to_be_true(agrees(expected, composed, close_tolerance));
+    return TRUE;
+}
+
+// Built by the compiler, these never run any math at startup
+static constexpr Mat4<float> baked_projection = Mat4<float>::Perspective(deg_to_rad(45), 16.f / 9.f, 0.1f, 1000.f);
+static constexpr Mat4<float> baked_ortho = Mat4<float>::Orthographic(0.f, 1280.f, 720.f, 0.f, -1.f, 1.f);
+static constexpr Mat4<float> baked_rotation = Mat4<float>::EulerXYZ(0.3f, -1.2f, 2.5f);
+static constexpr Mat4<float> baked_view = Mat4<float>::LookAt(
+    Vec3<float> { 0.f, 3.f, 10.f }, Vec3<float> { 0.f, 0.f, 0.f }, Vec3<float> { 0.f, 1.f, 0.f });
+static constexpr Quaternion<float> baked_quaternion = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 1.f, 0.f }, 1.1f, false)
+    * Quaternion<float>::FromAxisAngle(Vec3<float> { 1.f, 0.f, 0.f }, -0.4f, false);
+
+static constexpr uint32_t sine_table_size = 256;
+
+struct sine_table {
+    float values[sine_table_size];
+
+    constexpr sine_table() : values{} {
+        for (uint32_t i = 0; i < sine_table_size; i++) {
+            values[i] = qsin(static_cast<float>(i) * (Q_PI_2 / sine_table_size));
+        }
+    }
+};
+
+static constexpr sine_table baked_sines;
+
+static_assert(Mat4<float>::Identity().data[0] == 1.f && Mat4<float>::Identity().data[1] == 0.f);
+static_assert((Mat4<float>::GetTranslation(Vec3<float> { 1.f, 2.f, 3.f }) * Mat4<float>::Scale(Vec3<float> { 2.f, 2.f, 2.f })).data[12] == 2.f);
+static_assert(qsqrt(16.f) == 4.f && qabs(-2.5f) == 2.5f);
+static_assert(qabs(qcos(Q_PI) + 1.f) < 1e-6f && qabs(qacos(0.f) - Q_HALF_PI) < 1e-6f);
+static_assert(Mat4<float>::TransformPoint(Mat4<float>::EulerZ(Q_HALF_PI), Vec3<float> { 1.f, 0.f, 0.f }).y > 0.999999f);
+
+uint8_t qmath_constexpr_matches_runtime() {
+    // volatile keeps these out of the compiler's hands, so the runtime paths really run
+    volatile float fov = 45.f;
+    volatile float angles[3] = { 0.3f, -1.2f, 2.5f };
+
+    Mat4<float> projection = Mat4<float>::Perspective(deg_to_rad(fov), 16.f / 9.f, 0.1f, 1000.f);
+    expect_to_be_true(agrees(projection, baked_projection, close_tolerance));
+    Mat4<float> ortho = Mat4<float>::Orthographic(0.f, 1280.f, 720.f, 0.f, -1.f, 1.f);
+    expect_to_be_true(agrees(ortho, baked_ortho, exact_tolerance));
+    Mat4<float> rotation = Mat4<float>::EulerXYZ(angles[0], angles[1], angles[2]);
+    expect_to_be_true(agrees(rotation, baked_rotation, close_tolerance));
+    Mat4<float> view = Mat4<float>::LookAt(
+        Vec3<float> { 0.f, 3.f, 10.f }, Vec3<float> { 0.f, 0.f, 0.f }, Vec3<float> { 0.f, 1.f, 0.f });
+    expect_to_be_true(agrees(view, baked_view, close_tolerance));
+
+    // The SIMD specializations step aside for constant evaluation, and both agree
+    constexpr Mat4<float> baked_inverse = Mat4<float>::GetInverse(baked_rotation);
+    expect_to_be_true(agrees(Mat4<float>::GetInverse(rotation), baked_inverse, close_tolerance));
+
+    Quaternion<float> quaternion = Quaternion<float>::FromAxisAngle(Vec3<float> { 0.f, 1.f, 0.f }, 1.1f, false)
+        * Quaternion<float>::FromAxisAngle(Vec3<float> { 1.f, 0.f, 0.f }, -0.4f, false);
+    expect_to_be_true(agrees(&quaternion.x, &baked_quaternion.x, 4, close_tolerance));
+
+    for (uint32_t i = 0; i < sine_table_size; i++) {
+        volatile float angle = static_cast<float>(i) * (Q_PI_2 / sine_table_size);
+        expect_to_be_true(agrees(std::sin(angle), baked_sines.values[i], 1e-6f));
+    }
+    return TRUE;
+}
+
+// The bounds documented in qfast.inl, checked against <cmath> in double
+static constexpr double fast_rsqrt_bound = 3e-7;
+static constexpr double fast_sincos_bound = 2e-7;
+static constexpr double fast_acos_bound = 5e-7;
+static constexpr double fast_atan2_bound = 2e-6;
+static constexpr double fast_normalize_bound = 5e-7;
+
+static constexpr uint32_t fast_checked_values = 200000;
+
+static bool
+within(const char* name, float input, double expected, float actual, double bound) {
+    if (std::fabs(expected - static_cast<double>(actual)) > bound) {
+        qlogger::Error("qmath fast %s(%.9g): expected %.9g, got %.9g", name, input, expected, actual);
+        return false;
+    }
+    return true;
+}
+
+uint8_t qmath_fast_functions_within_bounds() {
+    // Logarithmically spaced, so every exponent is covered
+    for (float x = 1e-30f; x < 1e30f; x *= 1.001f) {
+        const double expected = 1.0 / std::sqrt(static_cast<double>(x));
+        expect_to_be_true(within("rsqrt", x, 1.0, static_cast<float>(fast::rsqrt(x) / expected), fast_rsqrt_bound));
+    }
+
+    for (uint32_t i = 0; i <= fast_checked_values; i++) {
+        const float x = (static_cast<float>(i) / fast_checked_values * 2.f - 1.f) * 8192.f;
+        float s = 0.f;
+        float c = 0.f;
+        fast::sincos(x, s, c);
+        expect_to_be_true(within("sin", x, std::sin(static_cast<double>(x)), s, fast_sincos_bound));
+        expect_to_be_true(within("cos", x, std::cos(static_cast<double>(x)), c, fast_sincos_bound));
+    }
+
+    for (uint32_t i = 0; i <= fast_checked_values; i++) {
+        const float x = static_cast<float>(i) / fast_checked_values * 2.f - 1.f;
+        expect_to_be_true(within("acos", x, std::acos(static_cast<double>(x)), fast::acos(x), fast_acos_bound));
+    }
+    // Clamped rather than NaN
+    expect_to_be_true(fast::acos(1.0001f) == 0.f);
+    expect_to_be_true(within("acos", -1.0001f, Q_PI, fast::acos(-1.0001f), fast_acos_bound));
+
+    test_random random = { 0xA7A2u };
+    for (uint32_t i = 0; i < fast_checked_values; i++) {
+        const float y = random.next(100.f);
+        const float x = random.next(100.f);
+        expect_to_be_true(within("atan2", y, std::atan2(static_cast<double>(y), static_cast<double>(x)), fast::atan2(y, x), fast_atan2_bound));
+    }
+    // The axes, where the octant fixups meet
+    const float axes[][2] = { { 0.f, 1.f }, { 1.f, 0.f }, { 0.f, -1.f }, { -1.f, 0.f }, { 1.f, 1.f }, { -1.f, -1.f } };
+    for (const float* axis : axes) {
+        expect_to_be_true(within("atan2", axis[0], std::atan2(static_cast<double>(axis[0]), static_cast<double>(axis[1])), fast::atan2(axis[0], axis[1]), fast_atan2_bound));
+    }
+    expect_to_be_true(fast::atan2(0.f, 0.f) == 0.f);
+    return TRUE;
+}
+
+static double
+length(float x, float y, float z) {
+    return std::sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y + static_cast<double>(z) * z);
+}
+
+uint8_t qmath_fast_normalize_within_bounds() {
+    test_random random = { 0x40A1u };
+    std::vector<float> x(batch_count), y(batch_count), z(batch_count);
+    std::vector<float> nx(batch_count), ny(batch_count), nz(batch_count);
+    for (uint32_t i = 0; i < batch_count; i++) {
+        // Lengths from tiny to large
+        const float scale = std::pow(10.f, random.next(6.f));
+        x[i] = random.next(1.f) * scale;
+        y[i] = random.next(1.f) * scale;
+        z[i] = random.next(1.f) * scale;
+    }
+
+    fast::normalize(ConstVec3Stream { x.data(), y.data(), z.data() }, Vec3Stream { nx.data(), ny.data(), nz.data() }, batch_count);
+    for (uint32_t i = 0; i < batch_count; i++) {
+        const Vec3<float> v = { x[i], y[i], z[i] };
+        const Vec3<float> one = fast::normalized(v);
+        expect_to_be_true(within("normalize", x[i], 1.0, static_cast<float>(length(one.x, one.y, one.z)), fast_normalize_bound));
+        expect_to_be_true(within("normalize", x[i], 1.0, static_cast<float>(length(nx[i], ny[i], nz[i])), fast_normalize_bound));
+        // Still pointing the same way as the precise result
+        const Vec3<float> precise = v.normalized();
+        expect_to_be_true(Vec3<float>::Compare(precise, one, 1e-6f));
+    }
+
+    // In place
+    fast::normalize(Vec3Stream { x.data(), y.data(), z.data() }, Vec3Stream { x.data(), y.data(), z.data() }, batch_count);
+    for (uint32_t i = 0; i < batch_count; i++) {
+        expect_to_be_true(x[i] == nx[i] && y[i] == ny[i] && z[i] == nz[i]);
+    }
+
+    Quaternion<float> q = fast::normalized(Quaternion<float>::New(1.f, 2.f, 3.f, 4.f));
+    expect_to_be_true(within("normalize", 4.f, 1.0, static_cast<float>(std::sqrt(Quaternion<float>::Dot(q, q))), fast_normalize_bound));
+    return TRUE;
+}
+
+void
+qmath_register_tests(TestManager& manager) {
+    manager.Register(qmath_mat4_multiply_matches_scalar, "qmath Mat4 multiply matches the scalar reference");
+    manager.Register(qmath_mat4_inverse_matches_scalar, "qmath Mat4 inverse matches the scalar reference");
+    manager.Register(qmath_mat4_transform_matches_scalar, "qmath Mat4 transforms match the scalar reference");
+    manager.Register(qmath_quaternion_multiply_matches_scalar, "qmath Quaternion multiply matches the scalar reference");
+    manager.Register(qmath_quaternion_slerp_matches_scalar, "qmath Quaternion slerp matches the scalar reference");
+    manager.Register(qmath_batch_transform_matches_scalar, "qmath batch point and vector transforms match the scalar reference");
+    manager.Register(qmath_batch_multiply_matches_scalar, "qmath batch matrix multiply matches the scalar reference");
+    manager.Register(qmath_batch_compose_trs_matches_scalar, "qmath batch TRS composition matches the scalar reference");
+    manager.Register(qmath_constexpr_matches_runtime, "qmath matrices and tables built at compile time match runtime");
+    manager.Register(qmath_fast_functions_within_bounds, "qmath fast rsqrt, sincos, acos and atan2 stay within their error bounds");
+    manager.Register(qmath_fast_normalize_within_bounds, "qmath fast normalize, one and batched, stays within its error bound");
+}
@@ -0,0 +1,195 @@
+#include "pack_tests.hh"
+#include "../test_manager.hh"
+#include "../expect.hh"
+
+#include <resources/qlz4.hh>
+#include <resources/qpack.hh>
+#include <resources/qpack_format.hh>
+#include <defines.hh>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+static const char* test_pack_path = "qpack_test.qpak";
+
+static bool
+lz4_round_trip(const std::vector<uint8_t>& input, uint64_t& compressed_size) {
+    std::vector<uint8_t> compressed(qlz4::compress_bound(input.size()));
+    compressed_size = qlz4::compress(input.data(), input.size(), compressed.data(), compressed.size());
+    if (compressed_size == 0) {
+        return false;
+    }
+    std::vector<uint8_t> output(input.size());
+    return qlz4::decompress(compressed.data(), compressed_size, output.data(), output.size()) && output == input;
+}
+
+uint8_t lz4_round_trips() {
+    std::mt19937 random(7);
+    uint64_t compressed_size = 0;
+
+    // Sizes around the limits on where matches may start and end
+    for (uint32_t size : { 0u, 1u, 5u, 12u, 13u, 17u, 64u, 1000u, 70000u }) {
+        std::vector<uint8_t> noise(size);
+        std::vector<uint8_t> text(size);
+        std::vector<uint8_t> run(size, 'a');
+        for (uint32_t i = 0; i < size; i++) {
+            noise[i] = static_cast<uint8_t>(random());
+            text[i] = static_cast<uint8_t>("pegasus engine asset pack "[i % 26]);
+        }
+        expect_to_be_true(lz4_round_trip(noise, compressed_size));
+        expect_to_be_true(lz4_round_trip(text, compressed_size));
+        // Overlapping matches, offset 1 with long lengths
+        expect_to_be_true(lz4_round_trip(run, compressed_size));
+    }
+
+    // Repetitive data actually shrinks
+    std::vector<uint8_t> text(70000);
+    for (uint32_t i = 0; i < text.size(); i++) {
+        text[i] = static_cast<uint8_t>("pegasus engine asset pack "[i % 26]);
+    }
+    expect_to_be_true(lz4_round_trip(text, compressed_size));
+    expect_to_be_true(compressed_size < text.size() / 20);
+
+    // Too little room is reported, not overrun
+    std::vector<uint8_t> small(16);
+    expect_should_be(0, qlz4::compress(text.data(), text.size(), small.data(), small.size()));
+    return TRUE;
+}
+
+uint8_t lz4_rejects_corrupt_blocks() {
+    std::vector<uint8_t> text(4096);
+    for (uint32_t i = 0; i < text.size(); i++) {
+        text[i] = static_cast<uint8_t>("abcdefgh"[i % 8] + (i / 512));
+    }
+    std::vector<uint8_t> compressed(qlz4::compress_bound(text.size()));
+    uint64_t compressed_size = qlz4::compress(text.data(), text.size(), compressed.data(), compressed.size());
+    std::vector<uint8_t> output(text.size());
+
+    // Cut short
+    expect_to_be_false(qlz4::decompress(compressed.data(), compressed_size / 2, output.data(), output.size()));
+    // Expands to a different size than expected
+    expect_to_be_false(qlz4::decompress(compressed.data(), compressed_size, output.data(), output.size() - 1));
+
+    // A match reaching back before the start of the output
+    const uint8_t bad_offset[] = { 0x10, 'x', 0x05, 0x00 };
+    expect_to_be_false(qlz4::decompress(bad_offset, sizeof(bad_offset), output.data(), 5));
+    return TRUE;
+}
+
+static std::vector<qpack::source_file>
+make_test_files() {
+    std::vector<qpack::source_file> files;
+    qpack::source_file shader = { "shaders/test.vert.spv", {} };
+    for (uint32_t i = 0; i < 5000; i++) {
+        shader.data.push_back(static_cast<uint8_t>(i % 16));
+    }
+    qpack::source_file noise = { "textures/noise.bin", {} };
+    std::mt19937 random(3);
+    for (uint32_t i = 0; i < 3000; i++) {
+        noise.data.push_back(static_cast<uint8_t>(random()));
+    }
+    files.push_back(shader);
+    files.push_back(noise);
+    files.push_back({ "empty.txt", {} });
+    files.push_back({ "readme.txt", { 'h', 'i' } });
+    return files;
+}
+
+static bool
+write_pack(const std::vector<uint8_t>& pack) {
+    std::ofstream file(test_pack_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(pack.data()), pack.size());
+    return file.good();
+}
+
+uint8_t pack_finds_and_reads_entries() {
+    std::vector<qpack::source_file> files = make_test_files();
+    std::vector<uint8_t> bytes;
+    expect_to_be_true(qpack::build(files, 64, true, bytes));
+    expect_to_be_true(write_pack(bytes));
+
+    QPack pack;
+    expect_to_be_true(pack.open(test_pack_path));
+    expect_should_be(files.size(), pack.count());
+
+    for (const qpack::source_file& file : files) {
+        const qpack::pack_entry* entry = pack.find(file.name.c_str());
+        expect_to_be_true(entry != nullptr);
+        expect_should_be(file.data.size(), entry->size);
+        expect_should_be(0, entry->offset % 64);
+
+        std::vector<uint8_t> data(entry->size);
+        expect_to_be_true(pack.read(entry, data.data()));
+        expect_to_be_true(data == file.data);
+        pack.prefetch(entry);
+    }
+
+    // The shader compresses, the noise does not and is readable in place
+    const qpack::pack_entry* shader = pack.find("shaders/test.vert.spv");
+    expect_should_be(qpack::COMPRESSION_LZ4, shader->compression);
+    expect_to_be_true(shader->stored_size < shader->size);
+    expect_to_be_true(pack.view(shader) == nullptr);
+
+    const qpack::pack_entry* noise = pack.find("textures/noise.bin");
+    expect_should_be(qpack::COMPRESSION_NONE, noise->compression);
+    expect_to_be_true(memcmp(pack.view(noise), files[1].data.data(), files[1].data.size()) == 0);
+
+    expect_to_be_true(pack.find("shaders/missing.spv") == nullptr);
+    expect_to_be_true(pack.find("shaders/test.vert") == nullptr);
+
+    pack.close();
+    expect_should_be(0, pack.count());
+    expect_to_be_true(pack.find("readme.txt") == nullptr);
+
+    std::remove(test_pack_path);
+    return TRUE;
+}
+
+uint8_t pack_rejects_bad_input() {
+    std::vector<qpack::source_file> files = make_test_files();
+    std::vector<uint8_t> bytes;
+
+    expect_to_be_false(qpack::build(files, 48, false, bytes));
+    files.push_back({ "readme.txt", { 'x' } });
+    expect_to_be_false(qpack::build(files, 16, false, bytes));
+    files.pop_back();
+
+    expect_to_be_true(qpack::build(files, 16, false, bytes));
+
+    // Flipped byte in an entry is caught by its content hash
+    QPack pack;
+    std::vector<uint8_t> corrupt = bytes;
+    corrupt.back() ^= 0xFF;
+    expect_to_be_true(write_pack(corrupt));
+    expect_to_be_true(pack.open(test_pack_path));
+    bool all_read = true;
+    for (const qpack::source_file& file : files) {
+        std::vector<uint8_t> data(file.data.size());
+        all_read &= pack.read(pack.find(file.name.c_str()), data.data());
+    }
+    expect_to_be_false(all_read);
+    pack.close();
+
+    // Truncated packs do not open
+    std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 10);
+    expect_to_be_true(write_pack(truncated));
+    expect_to_be_false(pack.open(test_pack_path));
+
+    // Neither do other files
+    std::vector<uint8_t> text(200, 'x');
+    expect_to_be_true(write_pack(text));
+    expect_to_be_false(pack.open(test_pack_path));
+
+    std::remove(test_pack_path);
+    return TRUE;
+}
+
+void
+pack_register_tests(TestManager& manager) {
+    manager.Register(lz4_round_trips, "lz4 blocks decompress to their input");
+    manager.Register(lz4_rejects_corrupt_blocks, "lz4 decompress rejects corrupt blocks");
+    manager.Register(pack_finds_and_reads_entries, "asset pack finds, views and reads its entries");
+    manager.Register(pack_rejects_bad_input, "asset pack rejects duplicates, corruption and truncation");
+}
@@ -0,0 +1,52 @@
+#include "core/qlog_binary.hh"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/*
+ *  qlog_decode
+ *
+ *  Turns a log written with LOG_FORMAT_BINARY back into text
+ *      qlog_decode <file.qlog> [output.log]
+ *  Without an output file the text goes to stdout
+ */
+
+int
+main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "usage: %s <file.qlog> [output.log]\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+    if (!input.is_open()) {
+        fprintf(stderr, "qlog_decode: unable to open %s\n", argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    std::string text;
+    bool complete = qlog_binary::decode(data.data(), data.size(), text);
+
+    FILE* output = stdout;
+    if (argc == 3) {
+        output = fopen(argv[2], "w");
+        if (!output) {
+            fprintf(stderr, "qlog_decode: unable to open %s for writing\n", argv[2]);
+            return 1;
+        }
+    }
+    fwrite(text.data(), 1, text.size(), output);
+    if (output != stdout) {
+        fclose(output);
+    }
+
+    // A file cut short (the process died mid write) still decodes up to that point
+    if (!complete) {
+        fprintf(stderr, "qlog_decode: %s is not a binary log or is truncated\n", argv[1]);
+        return 2;
+    }
+    return 0;
+}
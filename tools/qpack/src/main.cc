@@ -0,0 +1,93 @@
+#include "resources/qpack_format.hh"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/*
+ *  qpack
+ *
+ *  Packs every file under a directory into one asset pack, see resources/qpack_format.hh
+ *      qpack [--compress] [--align N] <directory> <output.qpak>
+ *  Entries are named by their path relative to the directory, e.g.
+ *      qpack --compress assets assets.qpak
+ *  stores assets/shaders/Builtin.ObjectShader.vert.spv as "shaders/Builtin.ObjectShader.vert.spv"
+ */
+
+static void
+usage(const char* program) {
+    fprintf(stderr, "usage: %s [--compress] [--align N] <directory> <output.qpak>\n", program);
+}
+
+int
+main(int argc, char** argv) {
+    bool compress = false;
+    uint32_t alignment = qpack::DEFAULT_ALIGNMENT;
+    const char* paths[2] = {};
+    uint32_t path_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--compress") == 0) {
+            compress = true;
+        } else if (strcmp(argv[i], "--align") == 0 && i + 1 < argc) {
+            alignment = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10));
+        } else if (path_count < 2) {
+            paths[path_count++] = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (path_count != 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const std::filesystem::path root(paths[0]);
+    std::error_code error;
+    if (!std::filesystem::is_directory(root, error)) {
+        fprintf(stderr, "qpack: %s is not a directory\n", paths[0]);
+        return 1;
+    }
+
+    std::vector<qpack::source_file> files;
+    uint64_t total_size = 0;
+    for (const auto& item : std::filesystem::recursive_directory_iterator(root)) {
+        if (!item.is_regular_file()) {
+            continue;
+        }
+
+        std::ifstream input(item.path(), std::ios::binary);
+        if (!input.is_open()) {
+            fprintf(stderr, "qpack: unable to read %s\n", item.path().string().c_str());
+            return 1;
+        }
+
+        qpack::source_file file;
+        file.name = std::filesystem::relative(item.path(), root).generic_string();
+        file.data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+        total_size += file.data.size();
+        files.push_back(std::move(file));
+    }
+
+    std::vector<uint8_t> pack;
+    if (!qpack::build(files, alignment, compress, pack)) {
+        fprintf(stderr, "qpack: unable to build the pack, alignment must be a power of two\n");
+        return 1;
+    }
+
+    std::ofstream output(paths[1], std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(pack.data()), pack.size());
+    if (!output) {
+        fprintf(stderr, "qpack: unable to write %s\n", paths[1]);
+        return 1;
+    }
+
+    printf("qpack: %zu files, %llu bytes packed into %zu bytes\n", files.size(),
+           static_cast<unsigned long long>(total_size), pack.size());
+    return 0;
+}